@@ -0,0 +1,47 @@
+// Loop kernels with invariant work that a C++ optimiser would hoist.
+// Translated with and without --optimize by run_loop_kernels.sh.
+
+int scale(int a, int b) {
+    return a * b + 7;
+}
+
+int mix(int x, int y) {
+    return (x * 31 + y) * 17 + (x ^ y);
+}
+
+// Pure helper call with invariant arguments
+int scaledSum(int n, int a, int b) {
+    int s = 0;
+    int i = 0;
+    while (i < n) {
+        s = s + scale(a, b) * i;
+        i = i + 1;
+    }
+    return s;
+}
+
+// Invariant polynomial evaluated every iteration
+int polynomial(int n, int a, int b) {
+    int s = 0;
+    int i = 0;
+    while (i < n) {
+        s = s + (a * a + b * b - a * b) * i + (a + b) % 7;
+        i = i + 1;
+    }
+    return s;
+}
+
+// Bound and row stride recomputed by the inner loop
+int nested(int rows, int cols, int seed) {
+    int s = 0;
+    int r = 0;
+    while (r < rows) {
+        int c = 0;
+        while (c < cols * 2 - 1) {
+            s = s + mix(seed, rows) * c + r * cols;
+            c = c + 1;
+        }
+        r = r + 1;
+    }
+    return s;
+}
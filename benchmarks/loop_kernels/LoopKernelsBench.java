@@ -0,0 +1,29 @@
+// Times the translated loop kernels. Compiled once against the plain
+// translation and once against the --optimize translation of LoopKernels.cpp.
+public class LoopKernelsBench {
+    interface Kernel {
+        int run(LoopKernels k);
+    }
+
+    static volatile int sink;
+
+    static void measure(String name, LoopKernels k, Kernel kernel) {
+        for (int i = 0; i < 20_000; i++) {
+            sink += kernel.run(k);  // Warm up until C2 has compiled the kernel
+        }
+        final int reps = 2_000;
+        long start = System.nanoTime();
+        for (int i = 0; i < reps; i++) {
+            sink += kernel.run(k);
+        }
+        long elapsed = System.nanoTime() - start;
+        System.out.printf("%-12s %10.1f ns/op%n", name, (double) elapsed / reps);
+    }
+
+    public static void main(String[] args) {
+        LoopKernels k = new LoopKernels();
+        measure("scaledSum", k, x -> x.scaledSum(10_000, 3, 5));
+        measure("polynomial", k, x -> x.polynomial(10_000, 3, 5));
+        measure("nested", k, x -> x.nested(100, 100, 42));
+    }
+}
@@ -0,0 +1,22 @@
+#!/bin/sh
+# Compares translated loop kernels with and without loop-invariant code motion.
+# Usage: benchmarks/run_loop_kernels.sh <path-to-CppToJavaCompiler>
+set -e
+
+COMPILER=${1:-build/src/CppToJavaCompiler}
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+for variant in baseline optimized; do
+    mkdir -p "$WORK_DIR/$variant"
+    flags=""
+    [ "$variant" = optimized ] && flags="--optimize"
+    "$COMPILER" "$BENCH_DIR/loop_kernels/LoopKernels.cpp" -o "$WORK_DIR/$variant/LoopKernels.java" $flags > /dev/null
+    javac -d "$WORK_DIR/$variant" "$WORK_DIR/$variant/LoopKernels.java" "$BENCH_DIR/loop_kernels/LoopKernelsBench.java"
+done
+
+for variant in baseline optimized; do
+    echo "== $variant"
+    java -cp "$WORK_DIR/$variant" LoopKernelsBench
+done
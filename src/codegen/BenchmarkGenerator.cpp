@@ -0,0 +1,355 @@
+#include "BenchmarkGenerator.h"
+#include "JavaEmitter.h"
+#include "../optimizer/ASTUtils.h"
+#include "../parser/TypeChecker.h"
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+struct Parameter {
+    std::string name;
+    std::string cppType;   // Normalized; the element type for pointers
+    std::string javaType;  // Likewise
+    bool pointer = false;
+    std::vector<std::string> values;  // Scalars: the sidecar's values, each run with every call site's set
+    std::string length;               // Pointers: a scalar parameter or an integer literal
+};
+
+// Function -> parameter (`x[]` for an array length) -> values, from the sidecar file
+using Sidecar = std::map<std::string, std::map<std::string, std::vector<std::string>>>;
+
+Sidecar parseSidecar(const std::string& text) {
+    Sidecar sidecar;
+    std::istringstream lines(text);
+    std::string line;
+    for (int number = 1; std::getline(lines, line); number++) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string function, setting;
+        if (!(words >> function)) continue;
+        auto& parameters = sidecar[function];
+        while (words >> setting) {
+            size_t equals = setting.find('=');
+            if (equals == std::string::npos || equals == 0 || equals + 1 == setting.size()) {
+                throw std::runtime_error("Benchmark Error: Expected 'parameter=value' instead of '" + setting +
+                                         "' in the sidecar file at line " + std::to_string(number));
+            }
+            auto& values = parameters[setting.substr(0, equals)];
+            std::istringstream list(setting.substr(equals + 1));
+            std::string value;
+            while (std::getline(list, value, ',')) {
+                if (!value.empty()) values.push_back(value);
+            }
+        }
+    }
+    return sidecar;
+}
+
+bool isIntegral(const std::string& javaType) {
+    return javaType != "float" && javaType != "double";
+}
+
+// A literal call argument as a value of `javaType`; "" for any other expression
+std::string literalValue(const ASTNodePtr& node, const std::string& javaType) {
+    std::string sign;
+    ASTNodePtr operand = node;
+    auto unary = std::dynamic_pointer_cast<UnaryExpressionNode>(node);
+    if (unary && unary->prefix && unary->op == "-") {
+        sign = "-";
+        operand = unary->operand;
+    }
+    auto number = std::dynamic_pointer_cast<NumberNode>(operand);
+    if (!number) return "";
+    if (isIntegral(javaType)) return sign + std::to_string(static_cast<long long>(number->value));
+
+    std::string text = number->text;
+    if (text.find_first_of("xX") != std::string::npos) text.clear();
+    while (!text.empty() && std::string("fFlLuU").find(text.back()) != std::string::npos) text.pop_back();
+    if (text.empty()) {
+        std::ostringstream value;
+        value << number->value;
+        text = value.str();
+    }
+    return sign + text;
+}
+
+void collectCalls(const ASTNodePtr& node, const std::string& name, std::vector<std::vector<ASTNodePtr>>& calls) {
+    if (!node) return;
+    if (auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node)) {
+        auto callee = std::dynamic_pointer_cast<IdentifierNode>(funcCall->functionName);
+        if (callee && callee->name == name) calls.push_back(funcCall->arguments);
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectCalls(child, name, calls); });
+}
+
+// A value of a parameter set as an element of a Java `javaType[]` initializer
+std::string javaLiteral(const std::string& value, const std::string& javaType) {
+    bool hex = value.find_first_of("xX") != std::string::npos;
+    if (javaType == "float" && value.find_last_of("fF") != value.size() - 1) return value + "f";
+    if (javaType == "long" && (hex || value.find_first_of(".eE") == std::string::npos)) return value + "L";
+    return value;
+}
+
+std::string capitalized(const std::string& name) {
+    return name.empty() ? name : std::string(1, static_cast<char>(toupper(name[0]))) + name.substr(1);
+}
+
+std::string quotedList(const std::vector<std::string>& values) {
+    std::string list;
+    for (const auto& value : values) list += (list.empty() ? "\"" : ", \"") + value + "\"";
+    return list;
+}
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Scalars and arrays of numbers are the parameters a harness can make up; "" when all of them are,
+// or why not
+std::string describeParameters(const std::shared_ptr<FunctionDeclarationNode>& funcDecl,
+                               std::vector<Parameter>& parameters) {
+    static const std::vector<std::string> numbers = {"byte", "short", "int", "long", "float", "double"};
+    for (size_t i = 0; i < funcDecl->parameters.size() && i < funcDecl->parameterTypes.size(); i++) {
+        auto name = std::dynamic_pointer_cast<IdentifierNode>(funcDecl->parameters[i]);
+        Parameter parameter;
+        parameter.name = name ? name->name : "";
+        std::string type = TypeChecker::normalizeType(funcDecl->parameterTypes[i]);
+        parameter.pointer = TypeChecker::isPointerType(type);
+        parameter.cppType = TypeChecker::normalizeType(parameter.pointer ? TypeChecker::elementType(type) : type);
+        parameter.javaType = JavaEmitter::toJavaType(parameter.cppType);
+        if (parameter.name.empty() || !TypeChecker::isArithmeticType(parameter.cppType) ||
+            std::find(numbers.begin(), numbers.end(), parameter.javaType) == numbers.end()) {
+            return "its parameter '" + parameter.name + "' is a " + funcDecl->parameterTypes[i];
+        }
+        parameters.push_back(parameter);
+    }
+    return "";
+}
+
+} // namespace
+
+std::vector<std::string> BenchmarkGenerator::generate(const ASTNodePtr& program, const std::string& className,
+                                                      const std::string& sourcePath, const std::string& sidecar,
+                                                      std::vector<Harness>& harnesses) {
+    std::vector<std::string> report;
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return report;
+    Sidecar settings = parseSidecar(sidecar);
+
+    std::string cppFile = className + "Benchmark.cpp";
+    std::string cpp =
+        "// Google Benchmark counterparts of the JMH classes cpp2java --emit-benchmarks wrote for " +
+        baseName(sourcePath) + ".\n"
+        "// Build with the directory of that file on the include path:\n"
+        "//   g++ -O2 -std=c++17 -I<dir> " + cppFile + " -lbenchmark -lpthread\n"
+        "#include <benchmark/benchmark.h>\n"
+        "#include <cstddef>\n"
+        "#include <vector>\n"
+        "\n"
+        "// The program's own main() makes way for the benchmark runner's\n"
+        "#define main cpp2java_original_main\n"
+        "#include \"" + baseName(sourcePath) + "\"\n"
+        "#undef main\n";
+
+    for (const auto& stmt : block->statements) {
+        auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+        auto nameNode = funcDecl ? std::dynamic_pointer_cast<IdentifierNode>(funcDecl->functionName) : nullptr;
+        if (!nameNode || !funcDecl->benchmark || !funcDecl->splitFrom.empty()) continue;
+        const std::string& name = nameNode->name;
+
+        if (funcDecl->internalLinkage) {
+            report.push_back("Benchmark skipped: " + name + " is static, so its translation is private");
+            continue;
+        }
+        std::vector<Parameter> parameters;
+        std::string unsupported = describeParameters(funcDecl, parameters);
+        if (!unsupported.empty()) {
+            report.push_back("Benchmark skipped: " + name + " cannot be called with made-up arguments, " + unsupported);
+            continue;
+        }
+
+        // Sidecar values take precedence over the literals at call sites
+        auto configured = settings.find(name);
+        if (configured != settings.end()) {
+            for (const auto& setting : configured->second) {
+                bool length = setting.first.size() > 2 && setting.first.substr(setting.first.size() - 2) == "[]";
+                std::string parameterName = length ? setting.first.substr(0, setting.first.size() - 2) : setting.first;
+                auto parameter = std::find_if(parameters.begin(), parameters.end(),
+                                              [&](const Parameter& p) { return p.name == parameterName; });
+                if (parameter == parameters.end() || parameter->pointer != length || (length && setting.second.size() != 1)) {
+                    throw std::runtime_error("Benchmark Error: '" + setting.first + "' does not name " +
+                                             (length ? "an array parameter of " : "a scalar parameter of ") + name +
+                                             (length ? " with one length" : "") + " in the sidecar file");
+                }
+                if (length) parameter->length = setting.second[0];
+                else parameter->values = setting.second;
+            }
+        }
+        // Parameter sets, one value per scalar parameter: the literal arguments of each call site,
+        // so values passed together are run together, crossed with the sidecar's values
+        std::vector<std::vector<ASTNodePtr>> calls;
+        collectCalls(program, name, calls);
+        bool fromCalls = std::any_of(parameters.begin(), parameters.end(),
+                                     [](const Parameter& p) { return !p.pointer && p.values.empty(); });
+        std::vector<std::vector<std::string>> sets;
+        if (!fromCalls) sets.emplace_back(parameters.size());
+        for (const auto& arguments : fromCalls ? calls : std::vector<std::vector<ASTNodePtr>>()) {
+            std::vector<std::string> set(parameters.size());
+            bool literal = true;
+            for (size_t i = 0; i < parameters.size() && literal; i++) {
+                if (parameters[i].pointer || !parameters[i].values.empty()) continue;
+                set[i] = i < arguments.size() ? literalValue(arguments[i], parameters[i].javaType) : "";
+                literal = !set[i].empty();
+            }
+            if (literal && std::find(sets.begin(), sets.end(), set) == sets.end()) sets.push_back(set);
+        }
+        for (size_t i = 0; i < parameters.size(); i++) {
+            if (parameters[i].pointer || parameters[i].values.empty()) continue;
+            std::vector<std::vector<std::string>> crossed;
+            for (const auto& set : sets) {
+                for (const auto& value : parameters[i].values) {
+                    crossed.push_back(set);
+                    crossed.back()[i] = value;
+                }
+            }
+            sets = crossed;
+        }
+
+        // Arrays are as long as the first integer parameter unless the sidecar says otherwise
+        auto firstInteger = std::find_if(parameters.begin(), parameters.end(),
+                                         [](const Parameter& p) { return !p.pointer && isIntegral(p.javaType); });
+        std::string missing;
+        for (auto& parameter : parameters) {
+            if (parameter.pointer && parameter.length.empty() && firstInteger != parameters.end()) {
+                parameter.length = firstInteger->name;
+            }
+            size_t index = &parameter - &parameters[0];
+            bool literal = std::any_of(calls.begin(), calls.end(), [&](const std::vector<ASTNodePtr>& arguments) {
+                return index < arguments.size() && !literalValue(arguments[index], parameter.javaType).empty();
+            });
+            if (parameter.pointer && parameter.length.empty()) {
+                missing = "array length for '" + parameter.name + "'";
+            } else if (!parameter.pointer && parameter.values.empty() && !literal) {
+                missing = "literal argument or sidecar value for '" + parameter.name + "'";
+            }
+            if (!missing.empty()) break;
+        }
+        if (missing.empty() && sets.empty()) missing = "call passing literals for all of its scalar parameters";
+        if (!missing.empty()) {
+            report.push_back("Benchmark skipped: " + name + " has no " + missing);
+            continue;
+        }
+        auto lengthOf = [&](const Parameter& array, bool java) {
+            auto scalar = std::find_if(parameters.begin(), parameters.end(),
+                                       [&](const Parameter& p) { return !p.pointer && p.name == array.length; });
+            if (scalar == parameters.end() && array.length.find_first_not_of("0123456789") != std::string::npos) {
+                throw std::runtime_error("Benchmark Error: The length of '" + array.name + "' in " + name +
+                                         " must be an integer or a scalar parameter, not '" + array.length + "'");
+            }
+            if (java && scalar != parameters.end() && scalar->javaType != "int") return "(int) " + array.length;
+            return array.length;
+        };
+
+        // JMH runs every value of a @Param field, so the sets are tables indexed by the one @Param
+        std::string javaClass = className + capitalized(name) + "Benchmark";
+        bool returnsValue = funcDecl->returnType != "void";
+        std::string java =
+            "import java.util.concurrent.TimeUnit;\n"
+            "import org.openjdk.jmh.annotations.*;\n" +
+            std::string(returnsValue ? "import org.openjdk.jmh.infra.Blackhole;\n" : "") +
+            "\n"
+            "// Generated by cpp2java --emit-benchmarks: times " + className + "." + name + ".\n"
+            "// " + cppFile + " times the C++ original on the same inputs.\n"
+            "@State(Scope.Thread)\n"
+            "@BenchmarkMode(Mode.AverageTime)\n"
+            "@OutputTimeUnit(TimeUnit.NANOSECONDS)\n"
+            "@Warmup(iterations = 5, time = 1)\n"
+            "@Measurement(iterations = 5, time = 1)\n"
+            "@Fork(1)\n"
+            "public class " + javaClass + " {\n";
+        std::string tables, fields, setUp, javaArguments, cppParameters, cppSetUp, cppArguments;
+        for (size_t i = 0; i < parameters.size(); i++) {
+            if (parameters[i].pointer) continue;
+            std::string values;
+            for (const auto& set : sets) values += (values.empty() ? "" : ", ") + javaLiteral(set[i], parameters[i].javaType);
+            tables += "    private static final " + parameters[i].javaType + "[] " + parameters[i].name + "$sets = {" +
+                      values + "};\n";
+            setUp += "        " + parameters[i].name + " = " + parameters[i].name + "$sets[parameterSet];\n";
+        }
+        if (!tables.empty()) {
+            std::vector<std::string> indices;
+            for (size_t i = 0; i < sets.size(); i++) indices.push_back(std::to_string(i));
+            java += "    // The parameter sets BM_" + name + " is registered with, in the same order\n" + tables +
+                    "\n"
+                    "    @Param({" + quotedList(indices) + "})\n"
+                    "    public int parameterSet;\n"
+                    "\n";
+        }
+        for (const auto& parameter : parameters) {
+            if (!javaArguments.empty()) javaArguments += ", ";
+            if (!cppArguments.empty()) cppArguments += ", ";
+            if (!parameter.pointer) {
+                java += "    private " + parameter.javaType + " " + parameter.name + ";\n";
+                javaArguments += parameter.name;
+                cppParameters += ", " + parameter.cppType + " " + parameter.name;
+                cppArguments += parameter.name;
+                continue;
+            }
+            java += "    private " + parameter.javaType + "[] " + parameter.name + ";\n";
+            setUp += "        " + parameter.name + " = new " + parameter.javaType + "[" + lengthOf(parameter, true) + "];\n"
+                     "        for (int i = 0; i < " + parameter.name + ".length; i++) " + parameter.name + "[i] = (" +
+                     parameter.javaType + ") (i % 17 + 1);\n";
+            javaArguments += parameter.name + ", 0";
+            cppSetUp += "    std::vector<" + parameter.cppType + "> " + parameter.name + "(" + lengthOf(parameter, false) + ");\n"
+                        "    for (std::size_t i = 0; i < " + parameter.name + ".size(); i++) " + parameter.name +
+                        "[i] = static_cast<" + parameter.cppType + ">(i % 17 + 1);\n";
+            cppArguments += parameter.name + ".data()";
+        }
+        if (!setUp.empty()) {
+            java += "\n"
+                    "    @Setup(Level.Trial)\n"
+                    "    public void setUp() {\n" + setUp +
+                    "    }\n";
+        }
+        std::string call = className + "." + name + "(" + javaArguments + ")";
+        java += "\n"
+                "    @Benchmark\n"
+                "    public void " + name + (returnsValue ? "(Blackhole bh) {\n        bh.consume(" + call + ");\n"
+                                                          : "() {\n        " + call + ";\n") +
+                "    }\n"
+                "}\n";
+        harnesses.push_back({javaClass + ".java", java});
+
+        cpp += "\n"
+               "static void BM_" + name + "(benchmark::State& state" + cppParameters + ") {\n" + cppSetUp +
+               "    for (auto _ : state) {\n" +
+               (returnsValue ? "        benchmark::DoNotOptimize(" + name + "(" + cppArguments + "));\n"
+                             : "        " + name + "(" + cppArguments + ");\n"
+                               "        benchmark::ClobberMemory();\n") +
+               "    }\n"
+               "}\n";
+
+        // One registration per parameter set, in the order of the JMH tables
+        for (const auto& set : sets) {
+            std::string label, arguments;
+            for (size_t i = 0; i < parameters.size(); i++) {
+                if (parameters[i].pointer) continue;
+                label += (label.empty() ? "" : "/") + parameters[i].name + ":" + set[i];
+                arguments += ", " + set[i];
+            }
+            cpp += label.empty() ? "BENCHMARK(BM_" + name + ");\n"
+                                 : "BENCHMARK_CAPTURE(BM_" + name + ", " + label + arguments + ");\n";
+        }
+        report.push_back("Benchmark " + javaClass + ": " + name + " with " + std::to_string(sets.size()) +
+                         " parameter set(s)");
+    }
+
+    if (!harnesses.empty()) {
+        harnesses.push_back({cppFile, cpp + "\nBENCHMARK_MAIN();\n"});
+    }
+    return report;
+}
@@ -0,0 +1,42 @@
+#ifndef BENCHMARKGENERATOR_H
+#define BENCHMARKGENERATOR_H
+
+#include "../parser/ASTNode.h"
+#include <string>
+#include <vector>
+
+// --emit-benchmarks: every function marked `// @benchmark` or `[[benchmark]]`
+// gets a JMH class that times its translation, `LoopKernelsSaxpyBenchmark`,
+// and an entry in one Google Benchmark source, `LoopKernelsBenchmark.cpp`,
+// that times the C++ original on the same inputs.
+//
+// Both harnesses run the same parameter sets, one value per scalar parameter:
+// the literal arguments of each of the program's calls to the function, crossed
+// with any values listed in a sidecar file (`kernels.bench` beside
+// `kernels.cpp`). Google Benchmark registers each set; the JMH class keeps them
+// in tables indexed by its one @Param. Each pointer parameter is given an array
+// as long as the function's first integer parameter, filled with
+// `i % 17 + 1` on both sides. A sidecar line names a function and then
+// lists values, and may set an array's length to a parameter or a number:
+//
+//     # function  parameter=value[,value...]  array[]=length
+//     saxpy n=1024,1048576 a=2.5 x[]=n
+class BenchmarkGenerator {
+public:
+    struct Harness {
+        std::string fileName;  // Relative to the translated .java file
+        std::string source;
+    };
+
+    // Harnesses for the marked functions of the translated `program`, whose class is
+    // `className`; `sourcePath` is the C++ file the Google Benchmark source includes.
+    // Returns one report line per marked function, generated or skipped.
+    static std::vector<std::string> generate(const ASTNodePtr& program, const std::string& className,
+                                             const std::string& sourcePath, const std::string& sidecar,
+                                             std::vector<Harness>& harnesses);
+
+private:
+    BenchmarkGenerator() = default;
+};
+
+#endif // BENCHMARKGENERATOR_H
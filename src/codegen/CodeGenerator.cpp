@@ -1,7 +1,25 @@
 #include "CodeGenerator.h"
+#include "BenchmarkGenerator.h"
+#include "RuntimeLibrary.h"
+#include "../optimizer/AllocationPooling.h"
+#include "../optimizer/CountedLoopCanonicalization.h"
+#include "../optimizer/DeadCodeElimination.h"
+#include "../optimizer/HotnessProfile.h"
+#include "../optimizer/LoopInvariantMotion.h"
+#include "../optimizer/MethodSplitting.h"
+#include "../optimizer/Monomorphization.h"
+#include "../optimizer/RangeForLowering.h"
+#include "../optimizer/ReferenceLowering.h"
+#include "../optimizer/TailCallElimination.h"
+#include "../utils/Logger.h"
+#include "../utils/WorkStealingPool.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
 #include <iostream>
 
-CodeGenerator::CodeGenerator(JavaEmitter& emitter) : emitter(emitter) {}
+CodeGenerator::CodeGenerator(JavaEmitter& emitter, const CodeGenOptions& options)
+    : emitter(emitter), options(options) {}
 
 void CodeGenerator::generateCode(const ASTNodePtr& root) {
     if (!root) {
@@ -9,7 +27,166 @@ void CodeGenerator::generateCode(const ASTNodePtr& root) {
         return;
     }
 
-    generateStatement(root);
+    runOptimizations(root);
+
+    // Calls may precede the callee's definition, so signatures are registered up front
+    if (auto program = std::dynamic_pointer_cast<BlockNode>(root)) {
+        for (const auto& stmt : program->statements) {
+            if (stmt->type == NodeType::STRUCT_DECLARATION) emitter.declareStruct(stmt);
+            if (stmt->type == NodeType::ENUM_DECLARATION) emitter.declareEnum(stmt);
+            auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+            auto name = funcDecl ? std::dynamic_pointer_cast<IdentifierNode>(funcDecl->functionName) : nullptr;
+            if (name) emitter.declareFunction(funcDecl);
+        }
+    }
+
+    emitter.setStructOfArrays(options.structOfArrays);
+    emitter.setVectorize(options.vectorize);
+    emitter.setResourceThreshold(options.resourceThreshold);
+    emitter.emitClassBegin(options.className);
+    auto program = std::dynamic_pointer_cast<BlockNode>(root);
+    if (program && options.codegenThreads != 1) generateInParallel(program);
+    else generateStatement(root);
+    emitter.emitClassEnd();
+
+    if (!options.runtimeDirectory.empty()) writeRuntimeSources();
+    if (options.emitBenchmarks) writeBenchmarks(root);
+}
+
+// Each function, and each run of other top-level statements, is generated into a fragment of the output.
+// A function's text depends only on its own subtree and on the declarations before it, so functions run
+// as tasks on a pool, each by its own copy of the emitter as the declarations before it left it. The
+// declarations are generated here, in order. The fragments then go to the writer in source order, which
+// gives the same bytes as serial generation.
+void CodeGenerator::generateInParallel(const std::shared_ptr<BlockNode>& program) {
+    std::vector<std::unique_ptr<OutputWriter>> fragments;
+    std::vector<std::unique_ptr<JavaEmitter>> emitters(program->statements.size());
+    std::vector<std::function<void()>> functions;
+    const JavaEmitter* declarations = &emitter;  // The state functions start from
+    JavaEmitter* run = nullptr;                  // Emitter of the current run of declarations
+    for (size_t i = 0; i < program->statements.size(); i++) {
+        const ASTNodePtr& stmt = program->statements[i];
+        if (stmt && stmt->type == NodeType::FUNCTION_DECLARATION) {
+            fragments.push_back(emitter.fragmentWriter());
+            OutputWriter& fragment = *fragments.back();
+            functions.push_back([&emitters, i, declarations, &fragment, stmt] {
+                emitters[i] = std::make_unique<JavaEmitter>(*declarations, fragment);
+                emitters[i]->emitFunction(stmt);
+            });
+            run = nullptr;
+            continue;
+        }
+        // Functions hold on to the state they start from, so a declaration after them continues in a copy
+        if (!run) {
+            fragments.push_back(emitter.fragmentWriter());
+            emitters[i] = std::make_unique<JavaEmitter>(*declarations, *fragments.back());
+            run = emitters[i].get();
+            declarations = run;
+        }
+        CodeGenerator(*run, options).generateStatement(stmt);
+    }
+
+    WorkStealingPool pool(options.codegenThreads);
+    pool.run(functions);
+    Logger::logInfo("Generated " + std::to_string(functions.size()) + " function(s) on " + std::to_string(pool.size()) +
+                    " thread(s).");
+    for (const auto& fragment : emitters) {
+        if (fragment) emitter.merge(*fragment);
+    }
+}
+
+// Harnesses go beside the translation too; the report still lists them when there is nowhere to write
+void CodeGenerator::writeBenchmarks(const ASTNodePtr& root) {
+    std::vector<BenchmarkGenerator::Harness> harnesses;
+    std::vector<std::string> generated =
+        BenchmarkGenerator::generate(root, options.className, options.sourcePath, options.benchmarkParameters, harnesses);
+    report.insert(report.end(), generated.begin(), generated.end());
+    if (options.runtimeDirectory.empty()) return;
+    for (const auto& harness : harnesses) {
+        std::string path = options.runtimeDirectory + "/" + harness.fileName;
+        OutputWriter writer(path);
+        writer.write(harness.source.substr(0, harness.source.size() - 1));
+        Logger::logInfo("Benchmark harness written to: " + path);
+    }
+}
+
+// Each runtime class is a public class of its own, so it goes in its own file beside the output,
+// as do the constant tables the class loads as resources
+void CodeGenerator::writeRuntimeSources() {
+    for (const auto& className : emitter.usedRuntimeClasses()) {
+        std::string path = options.runtimeDirectory + "/" + className + ".java";
+        std::string source = RuntimeLibrary::source(className);
+        OutputWriter writer(path);
+        writer.write(source.substr(0, source.size() - 1));
+        Logger::logInfo("Runtime class " + className + " written to: " + path);
+    }
+    for (const auto& resource : emitter.resourceFiles()) {
+        std::string path = options.runtimeDirectory + "/" + resource.first;
+        std::ofstream file(path, std::ios::binary);
+        file.write(resource.second.data(), static_cast<std::streamsize>(resource.second.size()));
+        Logger::logInfo("Constant table written to: " + path + " (" + std::to_string(resource.second.size()) + " bytes)");
+    }
+}
+
+const std::vector<std::string>& CodeGenerator::getReport() const {
+    return report;
+}
+
+void CodeGenerator::runOptimizations(const ASTNodePtr& root) {
+    // Not optional: Java has no templates, so every later pass and the emitter see only instantiations
+    std::vector<std::string> instantiated = Monomorphization::run(root);
+    report.insert(report.end(), instantiated.begin(), instantiated.end());
+    if (!instantiated.empty()) Logger::logInfo("Instantiated " + std::to_string(instantiated.size()) + " template(s).");
+    // Not optional either: the passes and the emitter know counted loops, but not range-based ones
+    int ranges = RangeForLowering::run(root);
+    if (ranges > 0) Logger::logInfo("Lowered " + std::to_string(ranges) + " range-based for loop(s).");
+    // Nor this: the passes and the emitter know pointers, but not references
+    int lowered = ReferenceLowering::run(root);
+    if (lowered > 0) Logger::logInfo("Lowered " + std::to_string(lowered) + " reference(s) and address-taken variable(s).");
+    if (options.eliminateDeadCode) {
+        // Benchmarked functions are entry points of their harnesses
+        std::vector<std::string> roots = options.roots;
+        auto program = std::dynamic_pointer_cast<BlockNode>(root);
+        for (const auto& stmt : program && options.emitBenchmarks ? program->statements : std::vector<ASTNodePtr>()) {
+            auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+            auto name = funcDecl && funcDecl->benchmark ? std::dynamic_pointer_cast<IdentifierNode>(funcDecl->functionName) : nullptr;
+            if (name) roots.push_back(name->name);
+        }
+        std::vector<std::string> removed = DeadCodeElimination::run(root, roots);
+        report.insert(report.end(), removed.begin(), removed.end());
+        Logger::logInfo("Removed " + std::to_string(removed.size()) + " unreachable declaration(s).");
+    }
+    if (!options.profile.empty()) {
+        // Before the passes it gates, and after dead code elimination so the report lists only emitted functions
+        std::vector<std::string> temperatures = HotnessProfile::run(root, HotnessProfile::parse(options.profile), options.hotCoverage);
+        report.insert(report.end(), temperatures.begin(), temperatures.end());
+        long hot = std::count_if(temperatures.begin(), temperatures.end(),
+                                 [](const std::string& line) { return line.rfind("Hot: ", 0) == 0; });
+        Logger::logInfo("Profile marks " + std::to_string(hot) + " of " + std::to_string(temperatures.size()) + " function(s) hot.");
+    }
+    if (options.eliminateTailCalls) {
+        int converted = TailCallElimination::run(root);
+        Logger::logInfo("Converted " + std::to_string(converted) + " tail-recursive function(s) to loops.");
+    }
+    if (options.hoistLoopInvariants) {
+        int hoisted = LoopInvariantMotion::run(root);
+        Logger::logInfo("Hoisted " + std::to_string(hoisted) + " loop-invariant expression(s).");
+    }
+    if (options.canonicalizeLoops) {
+        int canonicalized = CountedLoopCanonicalization::run(root);
+        Logger::logInfo("Canonicalized " + std::to_string(canonicalized) + " counted loop(s).");
+    }
+    if (options.poolAllocations) {
+        std::vector<std::string> sites = AllocationPooling::run(root);
+        report.insert(report.end(), sites.begin(), sites.end());
+        Logger::logInfo("Examined " + std::to_string(sites.size()) + " allocation site(s) for pooling.");
+    }
+    if (options.methodSizeLimit > 0) {
+        // Last, so the estimate sees the code the other passes produced
+        std::vector<std::string> split = MethodSplitting::run(root, options.methodSizeLimit);
+        report.insert(report.end(), split.begin(), split.end());
+        Logger::logInfo("Found " + std::to_string(split.size()) + " function(s) over the method size limit.");
+    }
 }
 
 void CodeGenerator::generateStatement(const ASTNodePtr& node) {
@@ -24,6 +201,10 @@ void CodeGenerator::generateStatement(const ASTNodePtr& node) {
             emitter.emitFunction(node);
             break;
 
+        case NodeType::STRUCT_DECLARATION:
+            emitter.emitStruct(node);
+            break;
+
         case NodeType::RETURN_STATEMENT:
             emitter.emitReturn(node);
             break;
@@ -36,6 +217,18 @@ void CodeGenerator::generateStatement(const ASTNodePtr& node) {
             emitter.emitWhileLoop(node);
             break;
 
+        case NodeType::FOR_LOOP:
+            emitter.emitForLoop(node);
+            break;
+
+        case NodeType::SWITCH_STATEMENT:
+            emitter.emitSwitch(node);
+            break;
+
+        case NodeType::ENUM_DECLARATION:
+            emitter.emitEnum(node);
+            break;
+
         case NodeType::BLOCK: {
             auto blockNode = std::dynamic_pointer_cast<BlockNode>(node);
             if (!blockNode) return;
@@ -60,8 +253,11 @@ void CodeGenerator::generateExpression(const ASTNodePtr& node) {
             break;
 
         case NodeType::IDENTIFIER:
+        case NodeType::UNARY_EXPRESSION:
+        case NodeType::MEMBER_ACCESS:
         case NodeType::NUMBER_LITERAL:
         case NodeType::STRING_LITERAL:
+        case NodeType::CHAR_LITERAL:
             emitter.emitExpression(node);
             break;
 
@@ -6,18 +6,52 @@
 #include "../parser/TypeChecker.h"
 #include "JavaEmitter.h"
 #include "OutputWriter.h"
+#include <string>
+#include <vector>
+
+// Options controlling how the AST is translated
+struct CodeGenOptions {
+    std::string className = "Main";     // Name of the generated Java class
+    bool eliminateDeadCode = true;      // Drop functions/globals unreachable from `roots`
+    std::vector<std::string> roots = {"main"};
+    bool eliminateTailCalls = true;     // Self tail calls become loops
+    bool hoistLoopInvariants = false;   // Loop-invariant code motion (--optimize)
+    bool canonicalizeLoops = true;      // For loops get an int induction variable and a hoisted bound
+    bool poolAllocations = true;        // Non-escaping new[]/delete[] pairs and loop-local vectors are reused
+    bool structOfArrays = false;        // Arrays of plain-data structs become one array per field (--soa)
+    bool vectorize = false;             // Counted float/double array loops get a jdk.incubator.vector kernel (--vectorize)
+    int resourceThreshold = 1024;       // Global arrays of this many constants load from `Class$name.bin`; 0 inlines all
+    int methodSizeLimit = 8000;         // Functions estimated above this many bytes of bytecode are split; 0 keeps them
+    std::string runtimeDirectory;       // Where used runtime classes (IntVector, ...) and resources are written; "" skips them
+    bool emitBenchmarks = false;        // Marked functions get JMH and Google Benchmark harnesses (--emit-benchmarks)
+    std::string sourcePath;             // The C++ file, which the Google Benchmark harness includes
+    std::string benchmarkParameters;    // Contents of the `.bench` sidecar file, if any
+    std::string profile;                // perf, gprof or CSV hotness profile (--profile); "" treats every function as hot
+    double hotCoverage = 0.9;           // Share of the profiled time the hot functions must account for
+    unsigned codegenThreads = 1;        // Functions are generated concurrently on this many threads (--jobs); 0 uses all
+};
 
 class CodeGenerator {
 public:
-    explicit CodeGenerator(JavaEmitter& emitter);
+    explicit CodeGenerator(JavaEmitter& emitter, const CodeGenOptions& options = CodeGenOptions());
 
     void generateCode(const ASTNodePtr& root);
     void generateStatement(const ASTNodePtr& node);
     void generateExpression(const ASTNodePtr& node);
 
+    // Human-readable notes about what the optimization passes changed
+    const std::vector<std::string>& getReport() const;
+
 private:
+    void runOptimizations(const ASTNodePtr& root);
+    void writeRuntimeSources();
+    void writeBenchmarks(const ASTNodePtr& root);
+    void generateInParallel(const std::shared_ptr<BlockNode>& program);
+
     SymbolTable symbolTable;
     JavaEmitter& emitter;
+    CodeGenOptions options;
+    std::vector<std::string> report;
 };
 
 #endif // CODEGENERATOR_H
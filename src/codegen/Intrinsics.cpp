@@ -0,0 +1,77 @@
+#include "Intrinsics.h"
+#include <unordered_map>
+
+const Intrinsic* Intrinsics::find(const std::string& name) {
+    static const std::unordered_map<std::string, Intrinsic> table = {
+        // Memory and ranges: pointer arguments become array + offset pairs
+        {"memcpy", {"System.arraycopy", IntrinsicForm::ARRAY_COPY, 3, ""}},
+        {"memmove", {"System.arraycopy", IntrinsicForm::ARRAY_COPY, 3, ""}},
+        {"copy", {"System.arraycopy", IntrinsicForm::RANGE_COPY, 3, ""}},
+        {"memset", {"java.util.Arrays.fill", IntrinsicForm::BYTE_FILL, 3, ""}},
+        {"fill", {"java.util.Arrays.fill", IntrinsicForm::RANGE_FILL, 3, ""}},
+        {"fill_n", {"java.util.Arrays.fill", IntrinsicForm::COUNT_FILL, 3, ""}},
+        {"sort", {"java.util.Arrays.sort", IntrinsicForm::RANGE_SORT, 2, ""}},
+        {"to_string", {"String.valueOf", IntrinsicForm::TO_STRING, 1, ""}},
+
+        {"min", {"Math.min", IntrinsicForm::MIN_MAX, 2, ""}},
+        {"max", {"Math.max", IntrinsicForm::MIN_MAX, 2, ""}},
+        {"fmin", {"Math.min", IntrinsicForm::CALL, 2, "double"}},
+        {"fmax", {"Math.max", IntrinsicForm::CALL, 2, "double"}},
+        {"abs", {"Math.abs", IntrinsicForm::CALL, 1, ""}},
+        {"labs", {"Math.abs", IntrinsicForm::CALL, 1, "long"}},
+        {"llabs", {"Math.abs", IntrinsicForm::CALL, 1, "long long"}},
+        {"fabs", {"Math.abs", IntrinsicForm::CALL, 1, "double"}},
+
+        // GCC/Clang bit builtins take unsigned operands
+        {"__builtin_popcount", {"Integer.bitCount", IntrinsicForm::CALL, 1, "unsigned int"}},
+        {"__builtin_popcountl", {"Long.bitCount", IntrinsicForm::CALL, 1, "unsigned long"}},
+        {"__builtin_popcountll", {"Long.bitCount", IntrinsicForm::CALL, 1, "unsigned long long"}},
+        {"__builtin_clz", {"Integer.numberOfLeadingZeros", IntrinsicForm::CALL, 1, "unsigned int"}},
+        {"__builtin_clzl", {"Long.numberOfLeadingZeros", IntrinsicForm::CALL, 1, "unsigned long"}},
+        {"__builtin_clzll", {"Long.numberOfLeadingZeros", IntrinsicForm::CALL, 1, "unsigned long long"}},
+        {"__builtin_ctz", {"Integer.numberOfTrailingZeros", IntrinsicForm::CALL, 1, "unsigned int"}},
+        {"__builtin_ctzl", {"Long.numberOfTrailingZeros", IntrinsicForm::CALL, 1, "unsigned long"}},
+        {"__builtin_ctzll", {"Long.numberOfTrailingZeros", IntrinsicForm::CALL, 1, "unsigned long long"}},
+        {"__builtin_bswap32", {"Integer.reverseBytes", IntrinsicForm::CALL, 1, "unsigned int"}},
+        {"__builtin_bswap64", {"Long.reverseBytes", IntrinsicForm::CALL, 1, "unsigned long"}},
+
+        // 64x64 -> 128-bit products (MSVC), high half only
+        {"__mulh", {"Math.multiplyHigh", IntrinsicForm::CALL, 2, "long long"}},
+        {"__umulh", {"CRT.multiplyHighUnsigned", IntrinsicForm::CALL, 2, "unsigned long long"}},
+
+        // std::thread::hardware_concurrency()
+        {"thread::hardware_concurrency", {"Runtime.getRuntime().availableProcessors", IntrinsicForm::CALL, 0, ""}},
+
+        // <cmath> functions whose java.lang.Math counterpart has the same semantics
+        {"sqrt", {"Math.sqrt", IntrinsicForm::CALL, 1, "double"}},
+        {"sqrtf", {"(float) Math.sqrt", IntrinsicForm::CALL, 1, "float"}},  // Exactly rounded from double
+        {"cbrt", {"Math.cbrt", IntrinsicForm::CALL, 1, "double"}},
+        {"exp", {"Math.exp", IntrinsicForm::CALL, 1, "double"}},
+        {"log", {"Math.log", IntrinsicForm::CALL, 1, "double"}},
+        {"log10", {"Math.log10", IntrinsicForm::CALL, 1, "double"}},
+        {"sin", {"Math.sin", IntrinsicForm::CALL, 1, "double"}},
+        {"cos", {"Math.cos", IntrinsicForm::CALL, 1, "double"}},
+        {"tan", {"Math.tan", IntrinsicForm::CALL, 1, "double"}},
+        {"asin", {"Math.asin", IntrinsicForm::CALL, 1, "double"}},
+        {"acos", {"Math.acos", IntrinsicForm::CALL, 1, "double"}},
+        {"atan", {"Math.atan", IntrinsicForm::CALL, 1, "double"}},
+        {"sinh", {"Math.sinh", IntrinsicForm::CALL, 1, "double"}},
+        {"cosh", {"Math.cosh", IntrinsicForm::CALL, 1, "double"}},
+        {"tanh", {"Math.tanh", IntrinsicForm::CALL, 1, "double"}},
+        {"floor", {"Math.floor", IntrinsicForm::CALL, 1, "double"}},
+        {"ceil", {"Math.ceil", IntrinsicForm::CALL, 1, "double"}},
+        // Math.round rounds halves up and returns a long; C rounds them away from zero
+        {"round", {"CRT.round", IntrinsicForm::CALL, 1, "double"}},
+        {"roundf", {"(float) CRT.round", IntrinsicForm::CALL, 1, "float"}},
+        {"trunc", {"CRT.trunc", IntrinsicForm::CALL, 1, "double"}},
+        {"truncf", {"(float) CRT.trunc", IntrinsicForm::CALL, 1, "float"}},
+        {"log2", {"CRT.log2", IntrinsicForm::CALL, 1, "double"}},
+        {"log2f", {"(float) CRT.log2", IntrinsicForm::CALL, 1, "float"}},
+        {"pow", {"Math.pow", IntrinsicForm::CALL, 2, "double"}},
+        {"atan2", {"Math.atan2", IntrinsicForm::CALL, 2, "double"}},
+        {"hypot", {"Math.hypot", IntrinsicForm::CALL, 2, "double"}}
+    };
+
+    auto it = table.find(name.rfind("std::", 0) == 0 ? name.substr(5) : name);
+    return it != table.end() ? &it->second : nullptr;
+}
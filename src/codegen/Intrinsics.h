@@ -0,0 +1,35 @@
+#ifndef INTRINSICS_H
+#define INTRINSICS_H
+
+#include <string>
+
+// How a call's arguments are rewritten for its Java counterpart
+enum class IntrinsicForm {
+    CALL,        // Same arguments, each converted to `parameterType`
+    MIN_MAX,     // Usual arithmetic conversions; unsigned operands compare with the sign bit flipped
+    ARRAY_COPY,  // memcpy(dst, src, bytes) -> System.arraycopy(src, srcOff, dst, dstOff, count)
+    RANGE_COPY,  // std::copy(first, last, out)
+    BYTE_FILL,   // memset(dst, byte, bytes)
+    RANGE_FILL,  // std::fill(first, last, value)
+    COUNT_FILL,  // std::fill_n(first, n, value)
+    RANGE_SORT,  // std::sort(first, last)
+    TO_STRING    // std::to_string(value): decimal digits, or printf's %f for floating point
+};
+
+struct Intrinsic {
+    std::string javaName;       // e.g. `Integer.bitCount`
+    IntrinsicForm form;
+    size_t arity;               // Calls with any other argument count are left alone
+    std::string parameterType;  // C++ type CALL arguments are converted to; "" keeps their own type
+};
+
+// libc and STL calls the JVM compiles to intrinsics once written in their
+// Java form: memcpy -> System.arraycopy, __builtin_popcount -> Integer.bitCount,
+// sqrt -> Math.sqrt, ...
+class Intrinsics {
+public:
+    // Entry for a function name, with or without `std::`; nullptr when there is none
+    static const Intrinsic* find(const std::string& name);
+};
+
+#endif // INTRINSICS_H
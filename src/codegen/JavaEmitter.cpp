@@ -1,7 +1,2055 @@
 #include "JavaEmitter.h"
+#include "RuntimeLibrary.h"
+#include "../optimizer/ASTUtils.h"
+#include "../optimizer/StringBuilderAnalysis.h"
+#include "../parser/TypeChecker.h"
+#include "../utils/ErrorHandler.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <unordered_map>
 
-JavaEmitter::JavaEmitter(OutputWriter& writer) : writer(writer) {}
+namespace {
+
+// Java operator precedence, higher binds tighter (assignments are lowest)
+int javaPrecedence(const std::string& op) {
+    static const std::unordered_map<std::string, int> precedence = {
+        {"||", 1}, {"&&", 2}, {"|", 3}, {"^", 4}, {"&", 5},
+        {"==", 6}, {"!=", 6},
+        {"<", 7}, {">", 7}, {"<=", 7}, {">=", 7},
+        {"<<", 8}, {">>", 8},
+        {"+", 9}, {"-", 9},
+        {"*", 10}, {"/", 10}, {"%", 10}
+    };
+    auto it = precedence.find(op);
+    return it != precedence.end() ? it->second : 0;
+}
+
+// Strips C++ suffixes (u, l, ll, f) from a numeric literal
+std::string literalDigits(const std::string& text) {
+    bool hex = text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X');
+    std::string suffixes = hex ? "uUlL" : "uUlLfF";
+    std::string digits = text;
+    while (!digits.empty() && suffixes.find(digits.back()) != std::string::npos) {
+        digits.pop_back();
+    }
+    return digits;
+}
+
+// Value of an integer constant expression as C++ computes it in 64 bits; false if it is not one.
+// `lookup` resolves the enumerators it names.
+bool constantValue(const ASTNodePtr& node, const std::function<bool(const std::string&, long long&)>& lookup,
+                   long long& value) {
+    if (auto number = std::dynamic_pointer_cast<NumberNode>(node)) {
+        if (number->text.empty()) {
+            value = static_cast<long long>(number->value);
+            return std::floor(number->value) == number->value && std::fabs(number->value) < 9.2e18;
+        }
+        std::string digits = literalDigits(number->text);
+        if (!TypeChecker::isIntegralType(TypeChecker::literalType(number->text))) return false;
+        char* end = nullptr;
+        value = static_cast<long long>(std::strtoull(digits.c_str(), &end, 0));
+        return end && *end == '\0';
+    }
+    if (auto identifier = std::dynamic_pointer_cast<IdentifierNode>(node)) return lookup(identifier->name, value);
+    if (auto unaryExpr = std::dynamic_pointer_cast<UnaryExpressionNode>(node)) {
+        long long operand;
+        if (!constantValue(unaryExpr->operand, lookup, operand)) return false;
+        auto bits = static_cast<unsigned long long>(operand);
+        if (unaryExpr->op == "-") value = static_cast<long long>(0 - bits);
+        else if (unaryExpr->op == "~") value = static_cast<long long>(~bits);
+        else if (unaryExpr->op == "+") value = operand;
+        else return false;
+        return true;
+    }
+    auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node);
+    long long left, right;
+    if (!binExpr || !constantValue(binExpr->left, lookup, left) || !constantValue(binExpr->right, lookup, right)) {
+        return false;
+    }
+    // Wrapping arithmetic on the unsigned bits, as Java's long does
+    auto a = static_cast<unsigned long long>(left), b = static_cast<unsigned long long>(right);
+    const std::string& op = binExpr->op;
+    if (op == "+") value = static_cast<long long>(a + b);
+    else if (op == "-") value = static_cast<long long>(a - b);
+    else if (op == "*") value = static_cast<long long>(a * b);
+    else if (op == "|") value = left | right;
+    else if (op == "&") value = left & right;
+    else if (op == "^") value = left ^ right;
+    else if ((op == "<<" || op == ">>") && right >= 0 && right < 64) value = op == "<<" ? static_cast<long long>(a << right) : left >> right;
+    else if ((op == "/" || op == "%") && right != 0 && !(left == INT64_MIN && right == -1)) value = op == "/" ? left / right : left % right;
+    else return false;
+    return true;
+}
+
+std::string numberToJava(const NumberNode& number) {
+    // Literals keep their source text; values made up by the passes print in their shortest exact form
+    char digits[32];
+    if (number.text.empty()) {
+        double value = number.value;
+        bool integer = std::floor(value) == value && std::fabs(value) < 2147483648.0;
+        char* end = integer ? std::to_chars(digits, digits + sizeof(digits), static_cast<long long>(value)).ptr
+                            : std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        return std::string(digits, end);
+    }
+
+    std::string type = TypeChecker::literalType(number.text);
+    std::string literal = literalDigits(number.text);
+    if (TypeChecker::isFloatingType(type)) {
+        return type == "float" ? literal + "f" : literal;
+    }
+
+    // Java has no unsigned literals: values past the signed range are written in hex
+    bool hex = literal.size() > 2 && (literal[1] == 'x' || literal[1] == 'X');
+    bool isLong = TypeChecker::bitWidth(type) == 64;
+    if (!hex) {
+        unsigned long long value = std::stoull(literal);
+        if (isLong ? value > 0x7FFFFFFFFFFFFFFFULL : value > 0x7FFFFFFFULL) {
+            char* end = std::to_chars(digits, digits + sizeof(digits), value, 16).ptr;
+            std::transform(digits, end, digits, [](char c) { return static_cast<char>(toupper(c)); });
+            literal = "0x" + std::string(digits, end);
+        }
+    }
+    return isLong ? literal + "L" : literal;
+}
+
+// Value of a numeric or character literal, possibly negated; false for any other expression
+bool literalValue(const ASTNodePtr& node, long long& integer, double& real) {
+    ASTNodePtr literal = node;
+    auto unary = std::dynamic_pointer_cast<UnaryExpressionNode>(node);
+    if (unary && (unary->op == "-" || unary->op == "+")) literal = unary->operand;
+
+    if (auto character = std::dynamic_pointer_cast<CharNode>(literal)) {
+        if (character->value.size() != 1) return false;
+        integer = static_cast<unsigned char>(character->value[0]);
+        real = static_cast<double>(integer);
+    } else if (auto number = std::dynamic_pointer_cast<NumberNode>(literal)) {
+        std::string digits = number->text.empty() ? "" : literalDigits(number->text);
+        if (digits.empty()) {
+            real = number->value;
+            integer = static_cast<long long>(real);
+        } else if (TypeChecker::isFloatingType(TypeChecker::literalType(number->text))) {
+            real = std::stod(digits);
+            integer = static_cast<long long>(real);
+        } else {
+            integer = static_cast<long long>(std::stoull(digits, nullptr, 0));
+            real = static_cast<double>(integer);
+        }
+    } else {
+        return false;
+    }
+    if (unary && unary->op == "-") {
+        integer = static_cast<long long>(0ULL - static_cast<unsigned long long>(integer));
+        real = -real;
+    }
+    return true;
+}
+
+// Java literal for the decoded bytes of a C++ literal. UTF-8 sequences become
+// \uXXXX escapes; control characters use octal escapes, because the compiler
+// translates \u000A into a real line break before the literal is lexed.
+std::string javaQuoted(const std::string& bytes, char quote) {
+    std::string out(1, quote);
+    for (size_t i = 0; i < bytes.size();) {
+        unsigned char lead = bytes[i];
+        unsigned codePoint = lead;
+        size_t length = lead >= 0xF0 && lead <= 0xF7 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+        if (length > 1 && i + length <= bytes.size()) {
+            codePoint = lead & (0x7F >> length);
+            for (size_t k = 1; k < length && length > 1; ++k) {
+                unsigned char next = bytes[i + k];
+                if ((next & 0xC0) != 0x80) {
+                    length = 1;  // Not UTF-8: keep the byte as a Latin-1 character
+                    codePoint = lead;
+                    break;
+                }
+                codePoint = (codePoint << 6) | (next & 0x3F);
+            }
+        } else {
+            length = 1;
+        }
+        i += length;
+
+        char buffer[16];
+        switch (codePoint) {
+            case '\\': out += "\\\\"; continue;
+            case '\n': out += "\\n"; continue;
+            case '\t': out += "\\t"; continue;
+            case '\r': out += "\\r"; continue;
+            case '\b': out += "\\b"; continue;
+            case '\f': out += "\\f"; continue;
+            default: break;
+        }
+        if (codePoint == static_cast<unsigned char>(quote)) {
+            out += "\\";
+            out += quote;
+        } else if (codePoint < 0x20 || codePoint == 0x7F) {
+            std::snprintf(buffer, sizeof(buffer), "\\%03o", codePoint);
+            out += buffer;
+        } else if (codePoint < 0x80) {
+            out += static_cast<char>(codePoint);
+        } else if (codePoint < 0x10000) {
+            std::snprintf(buffer, sizeof(buffer), "\\u%04X", codePoint);
+            out += buffer;
+        } else {
+            codePoint -= 0x10000;
+            std::snprintf(buffer, sizeof(buffer), "\\u%04X\\u%04X", 0xD800 + (codePoint >> 10), 0xDC00 + (codePoint & 0x3FF));
+            out += buffer;
+        }
+    }
+    return out + quote;
+}
+
+bool isAtomic(const ASTNodePtr& node) {
+    switch (node->type) {
+        case NodeType::IDENTIFIER:
+        case NodeType::NUMBER_LITERAL:
+        case NodeType::STRING_LITERAL:
+        case NodeType::CHAR_LITERAL:
+        case NodeType::FUNCTION_CALL:
+        case NodeType::MEMBER_ACCESS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// True when `text` is one parenthesized group, e.g. `(a + b)` but not `(a) + (b)`
+bool isWrapped(const std::string& text) {
+    if (text.size() < 2 || text.front() != '(' || text.back() != ')') return false;
+    int depth = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '(') depth++;
+        else if (text[i] == ')' && --depth == 0 && i + 1 < text.size()) return false;
+    }
+    return true;
+}
+
+// Java primitive widening conversions, which need no cast
+bool javaWidens(const std::string& from, const std::string& to) {
+    static const std::unordered_map<std::string, std::string> widenings = {
+        {"byte", " short int long float double "},
+        {"short", " int long float double "},
+        {"char", " int long float double "},
+        {"int", " long float double "},
+        {"long", " float double "},
+        {"float", " double "}
+    };
+    auto it = widenings.find(from);
+    return it != widenings.end() && it->second.find(" " + to + " ") != std::string::npos;
+}
+
+bool isAssignment(const std::string& op) {
+    if (op == "==" || op == "!=" || op == "<=" || op == ">=") return false;
+    return !op.empty() && op.back() == '=';
+}
+
+bool isNullPointer(const ASTNodePtr& node) {
+    if (auto identifier = std::dynamic_pointer_cast<IdentifierNode>(node)) {
+        return identifier->name == "nullptr" || identifier->name == "NULL";
+    }
+    return false;
+}
+
+std::string offsetName(const std::string& pointer) {
+    return pointer + "$off";
+}
+
+// True unless some `return` in `node` may hand back a pointer into the middle of an array
+bool returnsArrayStarts(const ASTNodePtr& node) {
+    if (!node) return true;
+    if (node->type == NodeType::RETURN_STATEMENT) {
+        const ASTNodePtr& value = std::static_pointer_cast<ReturnStatementNode>(node)->expression;
+        return !value || isNullPointer(value) || value->type == NodeType::NEW_EXPRESSION;
+    }
+    bool starts = true;
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { starts = starts && returnsArrayStarts(child); });
+    return starts;
+}
+
+// Whether `node` calls one of `functions` other than in `return f(...)` from one of them, which passes its own holder on
+bool callsAnyOf(const ASTNodePtr& node, const std::unordered_set<std::string>& functions, bool returnsOffset) {
+    if (!node) return false;
+    ASTNodePtr call = node;
+    if (returnsOffset && node->type == NodeType::RETURN_STATEMENT) {
+        call = std::static_pointer_cast<ReturnStatementNode>(node)->expression;
+        if (!functions.count(ASTUtils::calleeName(call))) call = node;
+    } else if (functions.count(ASTUtils::calleeName(node))) {
+        return true;
+    }
+    bool calls = false;
+    ASTUtils::forEachChild(call, [&](ASTNodePtr& child) { calls = calls || callsAnyOf(child, functions, returnsOffset); });
+    return calls;
+}
+
+bool isRelational(const std::string& op) {
+    return op == "<" || op == ">" || op == "<=" || op == ">=";
+}
+
+// Type argument for a Java primitive, e.g. `CompletableFuture<Long>`
+std::string boxedType(const std::string& javaType) {
+    static const std::unordered_map<std::string, std::string> boxed = {
+        {"boolean", "Boolean"}, {"byte", "Byte"}, {"char", "Character"}, {"short", "Short"},
+        {"int", "Integer"}, {"long", "Long"}, {"float", "Float"}, {"double", "Double"}, {"void", "Void"}
+    };
+    auto it = boxed.find(javaType);
+    return it != boxed.end() ? it->second : javaType;
+}
+
+// Variables assigned or stepped anywhere in `node`
+void collectReassigned(const ASTNodePtr& node, std::unordered_set<std::string>& names) {
+    if (!node) return;
+    if (auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node)) {
+        if (ASTUtils::isAssignmentOperator(binExpr->op) && binExpr->left->type == NodeType::IDENTIFIER) {
+            names.insert(std::static_pointer_cast<IdentifierNode>(binExpr->left)->name);
+        }
+    } else if (auto unaryExpr = std::dynamic_pointer_cast<UnaryExpressionNode>(node)) {
+        if ((unaryExpr->op == "++" || unaryExpr->op == "--") && unaryExpr->operand->type == NodeType::IDENTIFIER) {
+            names.insert(std::static_pointer_cast<IdentifierNode>(unaryExpr->operand)->name);
+        }
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectReassigned(child, names); });
+}
+
+void collectNames(const ASTNodePtr& node, std::unordered_set<std::string>& names) {
+    if (!node) return;
+    if (node->type == NodeType::IDENTIFIER) names.insert(std::static_pointer_cast<IdentifierNode>(node)->name);
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectNames(child, names); });
+}
+
+// `++i`, `i++` or `i += 1`
+bool isUnitStep(const ASTNodePtr& increment, const std::string& var) {
+    auto step = std::dynamic_pointer_cast<UnaryExpressionNode>(increment);
+    auto compound = std::dynamic_pointer_cast<BinaryExpressionNode>(increment);
+    auto one = compound ? std::dynamic_pointer_cast<NumberNode>(compound->right) : nullptr;
+    bool unitStep = (step && step->op == "++") || (compound && compound->op == "+=" && one && one->value == 1);
+    return unitStep && ASTUtils::rootVariable(step ? step->operand : compound->left) == var;
+}
+
+// Identifiers read or written in `node`, in order of first appearance; called function names are left out
+void collectOperands(const ASTNodePtr& node, std::vector<std::string>& names) {
+    if (!node) return;
+    if (node->type == NodeType::IDENTIFIER) {
+        const std::string& name = std::static_pointer_cast<IdentifierNode>(node)->name;
+        if (std::find(names.begin(), names.end(), name) == names.end()) names.push_back(name);
+        return;
+    }
+    if (node->type == NodeType::FUNCTION_CALL) {
+        for (const auto& argument : std::static_pointer_cast<FunctionCallNode>(node)->arguments) collectOperands(argument, names);
+        return;
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectOperands(child, names); });
+}
+
+// `return`, and `break`/`continue` aimed outside the body, cannot leave a body run as a lambda
+bool leavesBody(const ASTNodePtr& node, bool nested) {
+    if (!node) return false;
+    switch (node->type) {
+        case NodeType::RETURN_STATEMENT:
+            return true;
+        case NodeType::BREAK_STATEMENT:
+            return !nested || !std::static_pointer_cast<BreakStatementNode>(node)->label.empty();
+        case NodeType::CONTINUE_STATEMENT:
+            return !std::static_pointer_cast<ContinueStatementNode>(node)->label.empty();
+        case NodeType::WHILE_LOOP:
+        case NodeType::FOR_LOOP:
+        case NodeType::SWITCH_STATEMENT:
+            nested = true;
+            break;
+        default:
+            break;
+    }
+    bool leaves = false;
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { leaves = leaves || leavesBody(child, nested); });
+    return leaves;
+}
+
+// `std::memory_order_acquire` or `std::memory_order::acquire` -> "acquire"; seq_cst when absent
+std::string memoryOrder(const std::vector<ASTNodePtr>& arguments, size_t index) {
+    if (index >= arguments.size() || arguments[index]->type != NodeType::IDENTIFIER) return "seq_cst";
+    const std::string& name = std::static_pointer_cast<IdentifierNode>(arguments[index])->name;
+    size_t at = name.rfind("memory_order");
+    if (at == std::string::npos) return "seq_cst";
+    std::string order = name.substr(at + 12);
+    return order.substr(order.rfind("::", 0) == 0 ? 2 : order.rfind("_", 0) == 0 ? 1 : 0);
+}
+
+// Suffix of the weakest VarHandle access mode that keeps a C++ memory order.
+// Relaxed loads and stores are opaque: atomic and coherent, and unordered.
+// Java has no relaxed read-modify-write, so relaxed updates take acquire.
+std::string accessMode(const std::string& order, const std::string& operation) {
+    bool acquire = order == "acquire" || order == "consume";
+    if (operation == "load") return order == "relaxed" ? "Opaque" : acquire ? "Acquire" : "";
+    if (operation == "store") return order == "relaxed" ? "Opaque" : order == "release" ? "Release" : "";
+    if (order == "relaxed" || acquire) return "Acquire";
+    return order == "release" ? "Release" : "";
+}
+
+// Standard containers the primitive runtime classes may stand in for
+bool isStandardContainer(const std::string& type) {
+    static const std::unordered_set<std::string> containers = {
+        "vector", "deque", "list", "map", "set", "unordered_map", "unordered_set", "multimap", "multiset"
+    };
+    std::string normalized = TypeChecker::normalizeType(type);
+    return normalized.rfind("std::", 0) == 0 && containers.count(TypeChecker::templateName(normalized));
+}
+
+// Operand of `sizeof(x)`, which the parser keeps as a call when x is not a type; nullptr for other nodes
+ASTNodePtr sizeofOperand(const ASTNodePtr& node) {
+    auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node);
+    if (!funcCall || funcCall->arguments.size() != 1 || ASTUtils::calleeName(node) != "sizeof") return nullptr;
+    return funcCall->arguments[0];
+}
+
+// Bytes of an arithmetic or pointer value; 0 for arrays and other types
+int scalarSize(const std::string& type) {
+    if (type.size() > 2 && type.compare(type.size() - 2, 2, "[]") == 0) return 0;
+    int bits = TypeChecker::isPointerType(type) ? 64 : TypeChecker::bitWidth(type);
+    return bits <= 0 ? 0 : bits < 8 ? 1 : bits / 8;
+}
+
+bool isMutexType(const std::string& type) {
+    std::string normalized = TypeChecker::normalizeType(type);
+    return normalized == "std::mutex" || normalized == "std::recursive_mutex";
+}
+
+// lock_guard, unique_lock or scoped_lock, with or without template arguments
+std::string lockGuardKind(const std::string& type) {
+    std::string normalized = TypeChecker::normalizeType(type);
+    std::string name = TypeChecker::templateName(normalized);
+    if (name.empty() && normalized.rfind("std::", 0) == 0) name = normalized.substr(5);
+    return name == "lock_guard" || name == "unique_lock" || name == "scoped_lock" ? name : "";
+}
+
+// Java class whose static helpers implement unsigned arithmetic for `type`
+std::string unsignedHelper(const std::string& type) {
+    return TypeChecker::bitWidth(type) == 64 ? "Long" : "Integer";
+}
+
+// Lane-wise form of a <cmath> call on a float or double vector, e.g. `.abs()`; "" for other functions
+std::string laneFunction(const std::string& name) {
+    if (name == "sqrt" || name == "std::sqrt" || name == "sqrtf") {
+        return ".lanewise(jdk.incubator.vector.VectorOperators.SQRT)";
+    }
+    if (name == "fabs" || name == "std::fabs" || name == "fabsf" || name == "std::abs") return ".abs()";
+    return "";
+}
+
+} // namespace
+
+JavaEmitter::JavaEmitter(OutputWriter& writer) : writer(&writer) {}
+
+JavaEmitter::JavaEmitter(const JavaEmitter& state, OutputWriter& writer) : JavaEmitter(state) {
+    this->writer = &writer;
+    runtimeClasses.clear();
+    resources.clear();
+    vectorKernels.clear();
+    vectorElements.clear();
+}
+
+std::unique_ptr<OutputWriter> JavaEmitter::fragmentWriter() const {
+    return writer->fragment();
+}
+
+// Kernels keep the order of their functions, as they have when emitted serially
+void JavaEmitter::merge(const JavaEmitter& fragment) {
+    writer->insert(*fragment.writer);
+    runtimeClasses.insert(fragment.runtimeClasses.begin(), fragment.runtimeClasses.end());
+    resources.insert(fragment.resources.begin(), fragment.resources.end());
+    vectorKernels.insert(vectorKernels.end(), fragment.vectorKernels.begin(), fragment.vectorKernels.end());
+    vectorElements.insert(fragment.vectorElements.begin(), fragment.vectorElements.end());
+}
+
+void JavaEmitter::declareFunction(const std::shared_ptr<FunctionDeclarationNode>& funcDecl) {
+    std::string name = ASTUtils::rootVariable(funcDecl->functionName);
+    symbols.addSymbol(name, funcDecl->returnType);
+    functionParameterTypes[name] = funcDecl->parameterTypes;
+    std::string returnType = TypeChecker::normalizeType(funcDecl->returnType);
+    if (!returnType.empty() && returnType.back() == '*' && !returnsArrayStarts(funcDecl->body)) {
+        offsetReturning.insert(name);
+    }
+    int overload = overloadCounts[name]++;
+    if (overload > 0) overloads[funcDecl.get()] = overload;
+}
+
+std::string JavaEmitter::toJavaType(const std::string& cppType) {
+    std::string modifiers = cppType.rfind("const ", 0) == 0 ? "final " : "";
+    std::string type = TypeChecker::normalizeType(cppType);
+
+    // `T*` and `T[]` both become `T[]`; const on a pointer's target does not make the pointer final
+    if (TypeChecker::isPointerType(type)) {
+        if (type.back() == '*') modifiers.clear();
+        return modifiers + toJavaType(TypeChecker::elementType(type)) + "[]";
+    }
+
+    std::string container = RuntimeLibrary::containerClass(type);
+    if (!container.empty()) return modifiers + container;
+
+    std::string atomic = RuntimeLibrary::atomicClass(type);
+    if (!atomic.empty()) return modifiers + atomic;
+    if (isMutexType(type)) return modifiers + "java.util.concurrent.locks.ReentrantLock";
+
+    // Threads and futures are tasks of the Parallel runtime class's executor
+    if (type == "std::thread") return modifiers + "java.util.concurrent.Future<?>";
+    if (TypeChecker::templateName(type) == "future") {
+        std::vector<std::string> arguments = TypeChecker::templateArguments(type);
+        return modifiers + "java.util.concurrent.CompletableFuture<" +
+               boxedType(arguments.empty() ? "void" : toJavaType(arguments[0])) + ">";
+    }
+
+    static const std::unordered_map<std::string, std::string> javaTypes = {
+        {"bool", "boolean"}, {"char", "byte"},
+        {"signed char", "byte"}, {"unsigned char", "byte"},
+        {"short", "short"}, {"unsigned short", "char"},
+        {"int", "int"}, {"unsigned int", "int"},
+        {"long", "long"}, {"unsigned long", "long"},
+        {"long long", "long"}, {"unsigned long long", "long"},
+        {"float", "float"}, {"double", "double"}, {"long double", "double"},
+        {"auto", "var"}, {"string", "String"}, {"std::string", "String"}
+    };
+    auto it = javaTypes.find(type);
+    return modifiers + (it != javaTypes.end() ? it->second : type);
+}
+
+void JavaEmitter::declareStruct(const ASTNodePtr& node) {
+    auto structDecl = std::dynamic_pointer_cast<StructDeclarationNode>(node);
+    if (!structDecl) return;
+    structs[structDecl->name] = structDecl;
+    for (const auto& field : structDecl->fields) {
+        auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(field);
+        symbols.addSymbol(structDecl->name + "::" + ASTUtils::rootVariable(varDecl->identifier), varDecl->type);
+    }
+}
+
+void JavaEmitter::declareEnum(const ASTNodePtr& node) {
+    auto enumDecl = std::dynamic_pointer_cast<EnumDeclarationNode>(node);
+    if (!enumDecl) return;
+    for (const auto& enumerator : enumDecl->enumerators) {
+        // Scoped enumerators are only reachable qualified, so the enum name keeps them apart
+        std::string qualified = enumDecl->name + "::" + enumerator;
+        std::string javaName = enumDecl->scoped ? enumDecl->name + "$" + enumerator : enumerator;
+        enumConstants[qualified] = javaName;
+        symbols.addSymbol(qualified, enumDecl->underlyingType);
+        if (!enumDecl->scoped) {
+            enumConstants[enumerator] = javaName;
+            symbols.addSymbol(enumerator, enumDecl->underlyingType);
+        }
+    }
+
+    // Constant values let a switch on the enum use int labels
+    auto lookup = [&](const std::string& name, long long& value) {
+        auto it = enumValues.find(enumValues.count(enumDecl->name + "::" + name) ? enumDecl->name + "::" + name : name);
+        if (it == enumValues.end()) return false;
+        value = it->second.value;
+        return true;
+    };
+    std::vector<long long> values;
+    long long value = -1;
+    for (size_t i = 0; i < enumDecl->enumerators.size(); ++i) {
+        // An enumerator without a value is one more than the previous one
+        if (enumDecl->values[i] && !constantValue(enumDecl->values[i], lookup, value)) return;
+        if (!enumDecl->values[i]) value = static_cast<long long>(static_cast<unsigned long long>(value) + 1);
+        values.push_back(value);
+        enumValues[enumDecl->name + "::" + enumDecl->enumerators[i]] = {value, ""};
+        if (!enumDecl->scoped) enumValues[enumDecl->enumerators[i]] = {value, ""};
+    }
+    bool intValues = std::all_of(values.begin(), values.end(), [](long long v) { return v == static_cast<int32_t>(v); });
+    if (TypeChecker::bitWidth(enumDecl->underlyingType) != 64 || intValues) return;
+    std::string table = (enumDecl->name.empty() ? enumDecl->enumerators.front() : enumDecl->name) + "$values";
+    for (const auto& enumerator : enumDecl->enumerators) {
+        enumValues[enumDecl->name + "::" + enumerator].table = table;
+        if (!enumDecl->scoped) enumValues[enumerator].table = table;
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    enumTables[table] = values;
+}
+
+void JavaEmitter::setResourceThreshold(int elements) {
+    resourceThreshold = elements;
+}
+
+const std::map<std::string, std::string>& JavaEmitter::resourceFiles() const {
+    return resources;
+}
+
+void JavaEmitter::setVectorize(bool enabled) {
+    vectorize = enabled;
+}
+
+void JavaEmitter::setStructOfArrays(bool enabled) {
+    structOfArrays = enabled;
+}
+
+const std::set<std::string>& JavaEmitter::usedRuntimeClasses() const {
+    return runtimeClasses;
+}
+
+void JavaEmitter::useRuntimeClass(const std::string& cppType) {
+    std::string container = RuntimeLibrary::containerClass(cppType);
+    if (!container.empty()) runtimeClasses.insert(container);
+    std::string atomic = RuntimeLibrary::atomicClass(cppType);
+    if (!atomic.empty()) runtimeClasses.insert(atomic);
+}
+
+// Atomics are read as their value type; atomicClassOf() tells them apart
+std::string JavaEmitter::typeOf(const ASTNodePtr& node) const {
+    // Sizes and counts of runtime containers and strings are Java ints, e.g. IntIntMap.count()
+    auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node);
+    auto access = funcCall ? std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName) : nullptr;
+    if (access) {
+        std::string object = TypeChecker::normalizeType(typeOf(access->object));
+        if (!RuntimeLibrary::containerClass(object).empty() || object == "string") {
+            const std::string& member = access->member;
+            if (member == "size" || member == "length" || member == "count" || member == "slots") return "int";
+            if (member == "empty" || member == "contains" || member == "full") return "bool";
+        }
+    }
+    return TypeChecker::valueType(TypeChecker::inferType(node, symbols));
+}
+
+std::string JavaEmitter::operandToJava(const ASTNodePtr& node, int parentPrecedence) const {
+    std::string text = expressionToJava(node);
+    if (node && node->type == NodeType::BINARY_EXPRESSION) {
+        auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+        if (javaPrecedence(binExpr->op) <= parentPrecedence) {
+            return "(" + text + ")";
+        }
+    }
+    return text;
+}
+
+std::string JavaEmitter::convertedToJava(const ASTNodePtr& node, const std::string& toType,
+                                         int parentPrecedence, bool assignmentContext) const {
+    std::string from = TypeChecker::normalizeType(typeOf(node));
+    std::string to = TypeChecker::normalizeType(toType);
+    if (isTextCharacter(node) && toJavaType(to) == "byte") {
+        // Java narrows an ASCII constant implicitly, but only where it is assigned
+        auto literal = std::dynamic_pointer_cast<CharNode>(node);
+        bool ascii = literal && literal->value.size() == 1 && static_cast<unsigned char>(literal->value[0]) < 0x80;
+        return assignmentContext && ascii ? expressionToJava(node) : "(byte) " + expressionToJava(node);
+    }
+    if (from.empty() || to.empty() || from == to || !TypeChecker::isArithmeticType(from) ||
+        !TypeChecker::isArithmeticType(to)) {
+        return operandToJava(node, parentPrecedence);
+    }
+
+    if (to == "bool") {
+        return "(" + operandToJava(node, javaPrecedence("!=")) + " != 0)";
+    }
+    if (from == "bool") {
+        return "(" + operandToJava(node, javaPrecedence("||")) + " ? 1 : 0)";
+    }
+
+    std::string fromJava = toJavaType(from);
+    std::string toJava = toJavaType(to);
+
+    // Literals are retyped in place instead of cast
+    if (node->type == NodeType::NUMBER_LITERAL) {
+        auto number = std::static_pointer_cast<NumberNode>(node);
+        std::string digits = literalDigits(numberToJava(*number));
+        if (to == "float" && TypeChecker::isFloatingType(from)) {
+            return digits + "f";
+        }
+        bool small = number->value >= 0 && number->value <= 32767;
+        if (small && TypeChecker::isIntegralType(from) && TypeChecker::isIntegralType(to) &&
+            (assignmentContext || toJava == "int" || toJava == "long")) {
+            return toJava == "long" ? digits + "L" : digits;
+        }
+    }
+
+    std::string value = operandToJava(node, parentPrecedence);
+    bool atomic = isAtomic(node) || isWrapped(value);
+
+    // Java sign-extends every integer; unsigned C++ sources must be zero-extended
+    if (from == "unsigned char" && toJava != "byte") {
+        value = "Byte.toUnsignedInt(" + expressionToJava(node) + ")";
+        fromJava = "int";
+        atomic = true;
+    } else if (from == "unsigned int" && (toJava == "long" || toJava == "float" || toJava == "double")) {
+        value = "Integer.toUnsignedLong(" + expressionToJava(node) + ")";
+        fromJava = "long";
+        atomic = true;
+    }
+
+    // The JVM converts 64-bit integers as signed; CRT converts them as unsigned
+    bool unsignedLong = TypeChecker::isUnsignedType(from) && TypeChecker::bitWidth(from) == 64;
+    if (unsignedLong && TypeChecker::isFloatingType(to)) {
+        runtimeClasses.insert("CRT");
+        return (to == "float" ? "CRT.unsignedToFloat(" : "CRT.unsignedToDouble(") + expressionToJava(node) + ")";
+    }
+    if (TypeChecker::isFloatingType(from) && TypeChecker::isUnsignedType(to) && TypeChecker::bitWidth(to) == 64) {
+        runtimeClasses.insert("CRT");
+        return "CRT.doubleToUnsigned(" + expressionToJava(node) + ")";
+    }
+
+    if (fromJava == toJava || javaWidens(fromJava, toJava)) return value;
+
+    std::string operand = atomic ? value : "(" + value + ")";
+    if (TypeChecker::isFloatingType(from) && to == "unsigned int") {
+        return "(int) (long) " + operand;  // Values above INT_MAX wrap instead of saturating
+    }
+    return "(" + toJava + ") " + operand;
+}
+
+std::string JavaEmitter::conditionToJava(const ASTNodePtr& node) const {
+    std::string type = TypeChecker::normalizeType(typeOf(node));
+    if (TypeChecker::isArithmeticType(type) && type != "bool") {
+        return operandToJava(node, javaPrecedence("!=")) + " != 0";
+    }
+    return expressionToJava(node);
+}
+
+std::string JavaEmitter::offsetBy(const std::string& offset, const std::string& op, const ASTNodePtr& amount) const {
+    if (offset == "0") {
+        return op == "+" ? convertedToJava(amount, "int") : "-" + convertedToJava(amount, "int", 100);
+    }
+    return offset + " " + op + " " + convertedToJava(amount, "int", javaPrecedence(op));
+}
+
+bool JavaEmitter::pointerParts(const ASTNodePtr& node, std::string& base, std::string& offset) const {
+    if (!node) return false;
+    if (isNullPointer(node)) {
+        base = "null";
+        offset = "0";
+        return true;
+    }
+
+    std::string type = TypeChecker::normalizeType(typeOf(node));
+    if (!TypeChecker::isPointerType(type)) return false;
+
+    switch (node->type) {
+        case NodeType::IDENTIFIER: {
+            base = std::static_pointer_cast<IdentifierNode>(node)->name;
+            offset = type.back() == '*' ? offsetName(base) : "0";
+            return true;
+        }
+        case NodeType::NEW_EXPRESSION:
+            base = expressionToJava(node);
+            offset = "0";
+            return true;
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+            if (binExpr->op != "+" && binExpr->op != "-") break;
+            if (pointerParts(binExpr->left, base, offset)) {
+                offset = offsetBy(offset, binExpr->op, binExpr->right);
+                return true;
+            }
+            if (binExpr->op == "+" && pointerParts(binExpr->right, base, offset)) {
+                offset = offsetBy(offset, "+", binExpr->left);
+                return true;
+            }
+            break;
+        }
+        case NodeType::FUNCTION_CALL: {
+            if (offsetReturning.count(ASTUtils::calleeName(node))) {
+                if (offsetHolder.empty()) {
+                    throw std::runtime_error("Translation Error: The pointer returned by '" + ASTUtils::calleeName(node) +
+                                             "' can only be used inside a function");
+                }
+                // Read after the call has stored it; Java evaluates operands left to right
+                base = expressionToJava(node);
+                offset = offsetHolder + "[0]";
+                return true;
+            }
+            // begin(), end() and data() of a runtime vector point into its backing array
+            auto access = std::dynamic_pointer_cast<MemberAccessNode>(std::static_pointer_cast<FunctionCallNode>(node)->functionName);
+            if (!access || RuntimeLibrary::containerClass(typeOf(access->object)).empty()) break;
+            std::string vector = operandToJava(access->object, 100);
+            base = vector + ".data";
+            offset = access->member == "end" ? vector + ".size()" : "0";
+            return true;
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            if (unaryExpr->op == "&" && unaryExpr->operand->type == NodeType::ARRAY_ACCESS) {
+                auto element = std::static_pointer_cast<ArrayAccessNode>(unaryExpr->operand);
+                if (!pointerParts(element->array, base, offset)) return false;
+                offset = offsetBy(offset, "+", element->index);
+                return true;
+            }
+            if (unaryExpr->op == "&") {
+                // `&*p` is `p`
+                auto deref = std::dynamic_pointer_cast<UnaryExpressionNode>(unaryExpr->operand);
+                if (deref && deref->op == "*") return pointerParts(deref->operand, base, offset);
+                // Anything else is wrapped in an array of one. A struct object is shared with it, so field
+                // updates through the pointer reach the original; a copied scalar or pointer is not.
+                std::string target = typeOf(unaryExpr->operand);
+                if (!isValueClass(target)) {
+                    ErrorHandler::reportWarning("'" + node->toString() + "' points to a copy of '" +
+                                                unaryExpr->operand->toString() + "'; writes through it are not seen there.");
+                }
+                base = "new " + toJavaType(target) + "[] {" + expressionToJava(unaryExpr->operand) + "}";
+                offset = "0";
+                return true;
+            }
+            if ((unaryExpr->op == "++" || unaryExpr->op == "--") && unaryExpr->operand->type == NodeType::IDENTIFIER) {
+                base = std::static_pointer_cast<IdentifierNode>(unaryExpr->operand)->name;
+                offset = unaryExpr->prefix ? unaryExpr->op + offsetName(base) : offsetName(base) + unaryExpr->op;
+                return true;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    // Arrays of arrays, calls returning arrays: the value is the base itself
+    base = expressionToJava(node);
+    offset = "0";
+    return true;
+}
+
+std::string JavaEmitter::binaryToJava(const std::shared_ptr<BinaryExpressionNode>& binExpr) const {
+    const std::string& op = binExpr->op;
+    int precedence = javaPrecedence(op);
+    if (ASTUtils::isAssignmentOperator(op) && !atomicClassOf(binExpr->left).empty()) {
+        return atomicUpdateToJava(binExpr->left, op, binExpr->right);
+    }
+
+    std::string leftBase, leftOffset, rightBase, rightOffset;
+    if (TypeChecker::isPointerType(typeOf(binExpr->left)) || isNullPointer(binExpr->left)) {
+        if ((op == "+=" || op == "-=") && binExpr->left->type == NodeType::IDENTIFIER) {
+            return offsetName(expressionToJava(binExpr->left)) + " " + op + " " + convertedToJava(binExpr->right, "int");
+        }
+        bool comparison = op == "==" || op == "!=" || isRelational(op) || op == "-";
+        if (comparison && pointerParts(binExpr->left, leftBase, leftOffset) &&
+            pointerParts(binExpr->right, rightBase, rightOffset)) {
+            if (leftBase == "null" || rightBase == "null") return leftBase + " " + op + " " + rightBase;
+            // Only the offsets are compared, but a call returning one must still run
+            for (auto part : {std::make_pair(&leftBase, &leftOffset), std::make_pair(&rightBase, &rightOffset)}) {
+                if (!offsetHolder.empty() && *part.second == offsetHolder + "[0]") {
+                    *part.second = "(" + *part.first + " == null ? 0 : " + *part.second + ")";
+                }
+            }
+            // Pointers into the same array compare and subtract by offset
+            if (rightOffset.find(' ') != std::string::npos) rightOffset = "(" + rightOffset + ")";
+            if (op != "-") return leftOffset + " " + op + " " + rightOffset;
+            std::string difference = rightOffset == "0" ? leftOffset : leftOffset + " - " + rightOffset;
+            return difference.find(' ') != std::string::npos ? "(" + difference + ")" : difference;
+        }
+    }
+
+    if (ASTUtils::isAssignmentOperator(op) && TypeChecker::isPointerType(typeOf(binExpr->left))) {
+        ErrorHandler::reportWarning("Pointer assignment '" + binExpr->toString() +
+                                    "' used as a value; only its array is assigned in Java.");
+    } else if ((op == "+" || op == "-") && TypeChecker::isPointerType(typeOf(binExpr))) {
+        // Pointer arithmetic outside a pointer context: only the array can be passed on
+        ErrorHandler::reportWarning("Pointer arithmetic '" + binExpr->toString() +
+                                    "' used where no offset can be carried; only its array is used.");
+        pointerParts(binExpr, leftBase, leftOffset);
+        return leftBase;
+    }
+
+    if (isAssignment(op)) {
+        std::string map, key, valueType;
+        if (mapSubscript(binExpr->left, map, key, valueType)) {
+            std::string arithmeticOp = op.substr(0, op.size() - 1);
+            bool exact = TypeChecker::arithmeticType(valueType, typeOf(binExpr->right)) == valueType;
+            if (op == "=") return map + ".put(" + key + ", " + convertedToJava(binExpr->right, valueType) + ")";
+            if ((op == "+=" || op == "-=") && exact) {
+                std::string delta = convertedToJava(binExpr->right, valueType, op == "-=" ? 100 : 0);
+                if (op == "-=") delta = delta[0] == '-' ? "-(" + delta + ")" : "-" + delta;
+                return map + ".add(" + key + ", " + delta + ")";
+            }
+            auto combined = std::make_shared<BinaryExpressionNode>(binExpr->left, arithmeticOp, binExpr->right);
+            return map + ".put(" + key + ", " + convertedToJava(combined, valueType) + ")";
+        }
+
+        // Assignment: operands never need parentheses
+        std::string target = expressionToJava(binExpr->left);
+        std::string targetType = TypeChecker::normalizeType(typeOf(binExpr->left));
+        if (op == "=" && isValueClass(targetType)) {
+            return target + " = " + copiedToJava(binExpr->right, targetType);
+        }
+        if (op == "=") {
+            return target + " = " + convertedToJava(binExpr->right, targetType, 0, true);
+        }
+        if (op == "+=" && targetType == "string") return target + " += " + appendArgument(binExpr->right);
+
+        std::string arithmeticOp = op.substr(0, op.size() - 1);
+        bool wideUnsigned = targetType == "unsigned int" || targetType == "unsigned long" ||
+                            targetType == "unsigned long long";
+        if (wideUnsigned && (arithmeticOp == "/" || arithmeticOp == "%")) {
+            std::string method = arithmeticOp == "/" ? ".divideUnsigned(" : ".remainderUnsigned(";
+            return target + " = " + unsignedHelper(targetType) + method + target + ", " +
+                   convertedToJava(binExpr->right, targetType) + ")";
+        }
+        if (wideUnsigned && arithmeticOp == ">>") {
+            return target + " >>>= " + expressionToJava(binExpr->right);
+        }
+
+        std::string common = TypeChecker::arithmeticType(targetType, typeOf(binExpr->right));
+        if (arithmeticOp == "<<" || arithmeticOp == ">>" || common.empty()) {
+            return target + " " + op + " " + expressionToJava(binExpr->right);
+        }
+        return target + " " + op + " " + convertedToJava(binExpr->right, common);
+    }
+
+    if (op == "&&" || op == "||") {
+        return convertedToJava(binExpr->left, "bool", precedence - 1) + " " + op + " " +
+               convertedToJava(binExpr->right, "bool", precedence);
+    }
+
+    std::string leftType = TypeChecker::normalizeType(typeOf(binExpr->left));
+    std::string rightType = TypeChecker::normalizeType(typeOf(binExpr->right));
+
+    // Strings compare by contents; `==` on Java objects compares references
+    if ((op == "==" || op == "!=") && (leftType == "string" || rightType == "string")) {
+        auto builder = std::dynamic_pointer_cast<IdentifierNode>(binExpr->right);
+        std::string method = builder && stringBuilders.count(builder->name) ? ".contentEquals(" : ".equals(";
+        std::string right = method == ".equals(" ? expressionToJava(binExpr->right) : builder->name;
+        return (op == "!=" ? "!" : "") + operandToJava(binExpr->left, 100) + method + right + ")";
+    }
+
+    if (op == "+" && (leftType == "string" || rightType == "string")) {
+        std::string left = leftType == "string" ? operandToJava(binExpr->left, precedence - 1) : appendArgument(binExpr->left);
+        std::string right = rightType == "string" ? operandToJava(binExpr->right, precedence) : appendArgument(binExpr->right);
+        return left + " + " + right;
+    }
+
+    if ((op == "<<" || op == ">>") && TypeChecker::isIntegralType(leftType)) {
+        std::string resultType = TypeChecker::promote(leftType);
+        std::string javaOp = (op == ">>" && TypeChecker::isUnsignedType(resultType)) ? ">>>" : op;
+        return convertedToJava(binExpr->left, resultType, precedence - 1) + " " + javaOp + " " +
+               operandToJava(binExpr->right, precedence);
+    }
+
+    std::string common = TypeChecker::arithmeticType(leftType, rightType);
+    if (common.empty() || op == "<<" || op == ">>" || (leftType == "bool" && rightType == "bool")) {
+        // Left-associative: the right operand needs parentheses at equal precedence
+        return operandToJava(binExpr->left, precedence - 1) + " " + op + " " +
+               operandToJava(binExpr->right, precedence);
+    }
+
+    if (TypeChecker::isUnsignedType(common)) {
+        std::string helper = unsignedHelper(common);
+        if (op == "/" || op == "%" || isRelational(op)) {
+            std::string operands = convertedToJava(binExpr->left, common) + ", " +
+                                   convertedToJava(binExpr->right, common) + ")";
+            if (op == "/") return helper + ".divideUnsigned(" + operands;
+            if (op == "%") return helper + ".remainderUnsigned(" + operands;
+            return helper + ".compareUnsigned(" + operands + " " + op + " 0";
+        }
+    }
+
+    return convertedToJava(binExpr->left, common, precedence - 1) + " " + op + " " +
+           convertedToJava(binExpr->right, common, precedence);
+}
+
+std::string JavaEmitter::expressionToJava(const ASTNodePtr& node) const {
+    if (!node) return "";
+
+    switch (node->type) {
+        case NodeType::IDENTIFIER: {
+            const std::string& name = std::static_pointer_cast<IdentifierNode>(node)->name;
+            if (isNullPointer(node)) return "null";
+            std::string load = atomicClassOf(node).empty() ? "" : ".get()";
+            auto renamed = renamedLocals.find(name);
+            if (renamed != renamedLocals.end()) return renamed->second + load;
+            if (!load.empty()) return name + load;
+            auto constant = enumConstants.find(name);
+            if (constant != enumConstants.end()) return constant->second;
+            return stringBuilders.count(name) ? name + ".toString()" : name;
+        }
+
+        case NodeType::NUMBER_LITERAL:
+            return numberToJava(*std::static_pointer_cast<NumberNode>(node));
+
+        case NodeType::NEW_EXPRESSION:
+            return newToJava(std::static_pointer_cast<NewExpressionNode>(node));
+
+        case NodeType::STRING_LITERAL:
+            return javaQuoted(std::static_pointer_cast<StringNode>(node)->value, '"');
+
+        case NodeType::CHAR_LITERAL:
+            return javaQuoted(std::static_pointer_cast<CharNode>(node)->value, '\'');
+
+        case NodeType::BINARY_EXPRESSION:
+            return binaryToJava(std::static_pointer_cast<BinaryExpressionNode>(node));
+
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            if ((unaryExpr->op == "++" || unaryExpr->op == "--") && !atomicClassOf(unaryExpr->operand).empty()) {
+                std::string delta = unaryExpr->op == "++" ? "1" : "-1";
+                return atomicObjectToJava(unaryExpr->operand) + (unaryExpr->prefix ? ".addAndGet(" : ".getAndAdd(") +
+                       delta + ")";
+            }
+            std::string base, offset;
+            if (unaryExpr->op == "*" && pointerParts(unaryExpr->operand, base, offset)) {
+                return base + "[" + offset + "]";
+            }
+            std::string map, key, valueType;
+            if ((unaryExpr->op == "++" || unaryExpr->op == "--") && mapSubscript(unaryExpr->operand, map, key, valueType)) {
+                std::string update = map + ".add(" + key + (unaryExpr->op == "++" ? ", 1)" : ", -1)");
+                if (unaryExpr->prefix) return update;
+                return "(" + update + (unaryExpr->op == "++" ? " - 1)" : " + 1)");  // add() yields the new value
+            }
+            if (unaryExpr->op == "&" || unaryExpr->op == "*") {
+                if (unaryExpr->op == "&" && pointerParts(node, base, offset) && offset == "0") return base;
+                ErrorHandler::reportWarning("Cannot translate '" + unaryExpr->op + "' applied to '" +
+                                            unaryExpr->operand->toString() + "'; using the operand itself.");
+                return expressionToJava(unaryExpr->operand);
+            }
+            if ((unaryExpr->op == "++" || unaryExpr->op == "--") && unaryExpr->operand->type == NodeType::IDENTIFIER &&
+                TypeChecker::isPointerType(typeOf(unaryExpr->operand))) {
+                pointerParts(node, base, offset);
+                return offset;
+            }
+            std::string operand = unaryExpr->op == "!" ? convertedToJava(unaryExpr->operand, "bool", 100)
+                                                       : operandToJava(unaryExpr->operand, 100);
+            if (unaryExpr->prefix && !operand.empty() && operand[0] == unaryExpr->op.back()) {
+                operand = "(" + operand + ")";  // Keep `-(-x)` from becoming `--x`
+            }
+            return unaryExpr->prefix ? unaryExpr->op + operand : operand + unaryExpr->op;
+        }
+
+        case NodeType::MEMBER_ACCESS: {
+            auto memberAccess = std::static_pointer_cast<MemberAccessNode>(node);
+            auto element = std::dynamic_pointer_cast<ArrayAccessNode>(memberAccess->object);
+            if (element && splitArrays.count(ASTUtils::rootVariable(element->array))) {
+                // `pts[i].x` -> `pts$x[i]`
+                return ASTUtils::rootVariable(element->array) + "$" + memberAccess->member + "[" +
+                       convertedToJava(element->index, "int") + "]";
+            }
+            std::string base, offset, load = atomicClassOf(node).empty() ? "" : ".get()";
+            if (memberAccess->arrow && pointerParts(memberAccess->object, base, offset)) {
+                return base + "[" + offset + "]." + memberAccess->member + load;  // `p->x` is `(*p).x`
+            }
+            return operandToJava(memberAccess->object, 100) + "." + memberAccess->member + load;
+        }
+
+        case NodeType::ARRAY_ACCESS: {
+            auto arrayAccess = std::static_pointer_cast<ArrayAccessNode>(node);
+            std::string arrayType = TypeChecker::normalizeType(typeOf(arrayAccess->array));
+            if (arrayType == "string") {
+                return operandToJava(arrayAccess->array, 100) + ".charAt(" + convertedToJava(arrayAccess->index, "int") + ")";
+            }
+            std::string map, key, valueType;
+            if (mapSubscript(node, map, key, valueType)) {
+                return map + ".get(" + key + ")";
+            }
+            if (TypeChecker::templateName(arrayType) == "vector" && !RuntimeLibrary::containerClass(arrayType).empty()) {
+                return operandToJava(arrayAccess->array, 100) + ".data[" + convertedToJava(arrayAccess->index, "int") + "]";
+            }
+            std::string base, offset;
+            if (pointerParts(arrayAccess->array, base, offset)) {
+                return base + "[" + offsetBy(offset, "+", arrayAccess->index) + "]";
+            }
+            return operandToJava(arrayAccess->array, 100) + "[" + expressionToJava(arrayAccess->index) + "]";
+        }
+
+        case NodeType::INITIALIZER_LIST: {
+            std::string elements;
+            for (const auto& element : std::static_pointer_cast<InitializerListNode>(node)->elements) {
+                if (!elements.empty()) elements += ", ";
+                elements += expressionToJava(element);
+            }
+            return "{" + elements + "}";
+        }
+
+        case NodeType::FUNCTION_CALL: {
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
+            auto access = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName);
+            if (access && access->object->type == NodeType::IDENTIFIER &&
+                stringBuilders.count(std::static_pointer_cast<IdentifierNode>(access->object)->name)) {
+                // size(), length() and empty() read the builder without copying it
+                std::string builder = std::static_pointer_cast<IdentifierNode>(access->object)->name;
+                return access->member == "empty" ? "(" + builder + ".length() == 0)" : builder + ".length()";
+            }
+            if (access && access->member == "size" && splitArrays.count(ASTUtils::rootVariable(access->object))) {
+                auto element = StructOfArraysAnalysis::elementStruct(typeOf(access->object), structs);
+                auto field = std::static_pointer_cast<VariableDeclarationNode>(element->fields.front());
+                return ASTUtils::rootVariable(access->object) + "$" + ASTUtils::rootVariable(field->identifier) + ".length";
+            }
+            if (access) {
+                std::string objectType = TypeChecker::normalizeType(typeOf(access->object));
+                if (!RuntimeLibrary::containerClass(objectType).empty()) return containerCallToJava(funcCall, access, objectType);
+                if (objectType == "string" && (access->member == "size" || access->member == "length")) {
+                    return operandToJava(access->object, 100) + ".length()";
+                }
+                if (objectType == "string" && access->member == "empty") return operandToJava(access->object, 100) + ".isEmpty()";
+                std::string task = taskCallToJava(access, objectType);
+                if (!task.empty()) return task;
+                std::string atomicType = TypeChecker::inferType(access->object, symbols);
+                if (!atomicClassOf(access->object).empty()) return atomicCallToJava(funcCall, access, atomicType);
+                std::string lock = lockCallToJava(access, objectType);
+                if (!lock.empty()) return lock;
+            }
+
+            const std::vector<std::string>* parameterTypes = nullptr;
+            if (funcCall->functionName->type == NodeType::IDENTIFIER) {
+                const std::string& name = std::static_pointer_cast<IdentifierNode>(funcCall->functionName)->name;
+                auto it = functionParameterTypes.find(name);
+                if (it != functionParameterTypes.end() && it->second.size() == funcCall->arguments.size()) {
+                    parameterTypes = &it->second;
+                }
+                // Functions defined in the program shadow the library ones
+                const Intrinsic* intrinsic = it == functionParameterTypes.end() ? Intrinsics::find(name) : nullptr;
+                if (intrinsic && intrinsic->arity == funcCall->arguments.size()) {
+                    std::string java = intrinsicToJava(funcCall, *intrinsic);
+                    if (!java.empty()) return java;
+                    ErrorHandler::reportWarning("Cannot map '" + funcCall->toString() + "' onto " + intrinsic->javaName +
+                                                "; emitted unchanged.");
+                    std::string args;
+                    for (const auto& arg : funcCall->arguments) {
+                        args += (args.empty() ? "" : ", ") + unmappedArgumentToJava(arg);
+                    }
+                    return name + "(" + args + ")";
+                }
+                if (name == "sizeof" && funcCall->arguments.size() == 1) {
+                    std::string size = sizeofToJava(funcCall->arguments[0]);
+                    if (!size.empty()) return size;
+                    ErrorHandler::reportWarning("Cannot fold '" + funcCall->toString() + "' from the declared type; emitted unchanged.");
+                } else if (name.rfind("std::", 0) == 0 && it == functionParameterTypes.end()) {
+                    ErrorHandler::reportWarning("'" + name + "' has no Java translation; emitted unchanged.");
+                }
+            }
+
+            std::string args;
+            for (size_t i = 0; i < funcCall->arguments.size(); ++i) {
+                std::string base, offset;
+                if (parameterTypes && TypeChecker::isPointerType((*parameterTypes)[i])) {
+                    // Pointer parameters take the array and the offset as two arguments
+                    if (!pointerParts(funcCall->arguments[i], base, offset)) {
+                        base = expressionToJava(funcCall->arguments[i]);
+                        offset = "0";
+                    }
+                    args += base + ", " + offset;
+                } else if (parameterTypes && !RuntimeLibrary::atomicClass((*parameterTypes)[i]).empty()) {
+                    args += atomicObjectToJava(funcCall->arguments[i]);  // Taken by reference
+                } else {
+                    args += parameterTypes ? convertedToJava(funcCall->arguments[i], (*parameterTypes)[i])
+                                           : expressionToJava(funcCall->arguments[i]);
+                }
+                if (i < funcCall->arguments.size() - 1) args += ", ";
+            }
+            if (offsetReturning.count(ASTUtils::calleeName(funcCall))) {
+                args += (args.empty() ? "" : ", ") + (offsetHolder.empty() ? "new int[1]" : offsetHolder);
+            }
+            return expressionToJava(funcCall->functionName) + "(" + args + ")";
+        }
+
+        default:
+            std::cerr << "Warning: Unsupported expression type " << ASTNode::nodeTypeToString(node->type) << ".\n";
+            return "";
+    }
+}
+
+void JavaEmitter::writeExpression(const ASTNodePtr& node, int parentPrecedence) const {
+    if (!node) return;
+
+    switch (node->type) {
+        case NodeType::IDENTIFIER: {
+            const std::string& name = std::static_pointer_cast<IdentifierNode>(node)->name;
+            if (isNullPointer(node) || !atomicClassOf(node).empty() || renamedLocals.count(name) ||
+                enumConstants.count(name) || stringBuilders.count(name)) {
+                break;
+            }
+            writer->append(name);
+            return;
+        }
+
+        case NodeType::NUMBER_LITERAL: {
+            const NumberNode& number = *std::static_pointer_cast<NumberNode>(node);
+            if (number.text.empty()) {
+                // As numberToJava prints a value made up by the passes
+                bool integer = std::floor(number.value) == number.value && std::fabs(number.value) < 2147483648.0;
+                if (integer) writer->append(static_cast<long long>(number.value));
+                else writer->append(number.value);
+                return;
+            }
+            // A short decimal literal is an int in both languages
+            bool decimal = number.text.size() <= 9 &&
+                           std::all_of(number.text.begin(), number.text.end(), [](char c) { return c >= '0' && c <= '9'; });
+            if (!decimal) break;
+            writer->append(number.text);
+            return;
+        }
+
+        case NodeType::STRING_LITERAL: {
+            const std::string& value = std::static_pointer_cast<StringNode>(node)->value;
+            bool plain = std::all_of(value.begin(), value.end(), [](char c) {
+                return c >= 0x20 && c < 0x7F && c != '"' && c != '\\';
+            });
+            if (!plain) break;
+            writer->append('"', value, '"');
+            return;
+        }
+
+        case NodeType::BINARY_EXPRESSION:
+            if (writeBinary(std::static_pointer_cast<BinaryExpressionNode>(node), parentPrecedence)) return;
+            break;
+
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            const std::string& op = unaryExpr->op;
+            const ASTNodePtr& operand = unaryExpr->operand;
+            bool step = op == "++" || op == "--";
+            std::string map, key, valueType;
+            if (step && (!atomicClassOf(operand).empty() || mapSubscript(operand, map, key, valueType) ||
+                         TypeChecker::isPointerType(typeOf(operand)))) {
+                break;
+            }
+            // An identifier or a parenthesized operand cannot run into a prefix sign
+            bool separate = operand->type == NodeType::IDENTIFIER || operand->type == NodeType::BINARY_EXPRESSION;
+            if (!step && (op == "*" || op == "&" || !unaryExpr->prefix || !separate)) break;
+
+            if (unaryExpr->prefix) writer->append(op);
+            if (op == "!") writeConverted(operand, "bool", 100);
+            else writeExpression(operand, 100);
+            if (!unaryExpr->prefix) writer->append(op);
+            return;
+        }
+
+        case NodeType::FUNCTION_CALL:
+            if (writeCall(std::static_pointer_cast<FunctionCallNode>(node))) return;
+            break;
+
+        default:
+            break;
+    }
+    writer->append(parentPrecedence < 0 ? expressionToJava(node) : operandToJava(node, parentPrecedence));
+}
+
+void JavaEmitter::writeConverted(const ASTNodePtr& node, const std::string& toType, int parentPrecedence,
+                                 bool assignmentContext) const {
+    // The cases in which convertedToJava leaves the operand as it is
+    std::string from = TypeChecker::normalizeType(typeOf(node));
+    std::string to = TypeChecker::normalizeType(toType);
+    bool retyped = isTextCharacter(node) && toJavaType(to) == "byte";
+    if (!retyped && (from.empty() || to.empty() || from == to || !TypeChecker::isArithmeticType(from) ||
+                     !TypeChecker::isArithmeticType(to))) {
+        writeExpression(node, parentPrecedence);
+        return;
+    }
+    writer->append(convertedToJava(node, toType, parentPrecedence, assignmentContext));
+}
+
+void JavaEmitter::writeCondition(const ASTNodePtr& node) const {
+    std::string type = TypeChecker::normalizeType(typeOf(node));
+    if (TypeChecker::isArithmeticType(type) && type != "bool") {
+        writeExpression(node, javaPrecedence("!="));
+        writer->append(" != 0");
+        return;
+    }
+    writeExpression(node);
+}
+
+// The forms of binaryToJava that only place operators between converted operands;
+// false, with nothing written, for the ones that rewrite the expression
+bool JavaEmitter::writeBinary(const std::shared_ptr<BinaryExpressionNode>& binExpr, int parentPrecedence) const {
+    const std::string& op = binExpr->op;
+    int precedence = javaPrecedence(op);
+    std::string leftType = TypeChecker::normalizeType(typeOf(binExpr->left));
+    std::string rightType = TypeChecker::normalizeType(typeOf(binExpr->right));
+    if (TypeChecker::isPointerType(typeOf(binExpr->left)) || isNullPointer(binExpr->left) ||
+        ((op == "+" || op == "-") && TypeChecker::isPointerType(typeOf(binExpr)))) {
+        return false;
+    }
+
+    std::string common = TypeChecker::arithmeticType(leftType, rightType);
+    std::function<void()> write;
+    if (isAssignment(op)) {
+        std::string map, key, valueType;
+        if (!atomicClassOf(binExpr->left).empty() || mapSubscript(binExpr->left, map, key, valueType) ||
+            isValueClass(leftType) || leftType == "string") {
+            return false;
+        }
+        std::string arithmeticOp = op.substr(0, op.size() - 1);
+        bool wideUnsigned = leftType == "unsigned int" || leftType == "unsigned long" || leftType == "unsigned long long";
+        if (wideUnsigned && (arithmeticOp == "/" || arithmeticOp == "%" || arithmeticOp == ">>")) return false;
+        common = TypeChecker::arithmeticType(leftType, typeOf(binExpr->right));
+        write = [&, arithmeticOp] {
+            writeExpression(binExpr->left);
+            writer->append(' ', op, ' ');
+            if (op == "=") writeConverted(binExpr->right, leftType, 0, true);
+            else if (arithmeticOp == "<<" || arithmeticOp == ">>" || common.empty()) writeExpression(binExpr->right);
+            else writeConverted(binExpr->right, common);
+        };
+    } else if (op == "&&" || op == "||") {
+        write = [&] {
+            writeConverted(binExpr->left, "bool", precedence - 1);
+            writer->append(' ', op, ' ');
+            writeConverted(binExpr->right, "bool", precedence);
+        };
+    } else if (leftType == "string" || rightType == "string") {
+        return false;
+    } else if ((op == "<<" || op == ">>") && TypeChecker::isIntegralType(leftType)) {
+        std::string resultType = TypeChecker::promote(leftType);
+        write = [&, resultType] {
+            writeConverted(binExpr->left, resultType, precedence - 1);
+            writer->append(' ', op == ">>" && TypeChecker::isUnsignedType(resultType) ? ">>>" : op, ' ');
+            writeExpression(binExpr->right, precedence);
+        };
+    } else if (common.empty() || op == "<<" || op == ">>" || (leftType == "bool" && rightType == "bool")) {
+        write = [&] {
+            writeExpression(binExpr->left, precedence - 1);
+            writer->append(' ', op, ' ');
+            writeExpression(binExpr->right, precedence);
+        };
+    } else if (TypeChecker::isUnsignedType(common) && (op == "/" || op == "%" || isRelational(op))) {
+        return false;
+    } else {
+        write = [&] {
+            writeConverted(binExpr->left, common, precedence - 1);
+            writer->append(' ', op, ' ');
+            writeConverted(binExpr->right, common, precedence);
+        };
+    }
+
+    bool parenthesized = parentPrecedence >= 0 && precedence <= parentPrecedence;
+    if (parenthesized) writer->append('(');
+    write();
+    if (parenthesized) writer->append(')');
+    return true;
+}
+
+// A call to a function of the program whose parameters are all values
+bool JavaEmitter::writeCall(const std::shared_ptr<FunctionCallNode>& funcCall) const {
+    if (funcCall->functionName->type != NodeType::IDENTIFIER) return false;
+    auto it = functionParameterTypes.find(std::static_pointer_cast<IdentifierNode>(funcCall->functionName)->name);
+    if (it == functionParameterTypes.end() || it->second.size() != funcCall->arguments.size()) return false;
+    for (const auto& type : it->second) {
+        if (TypeChecker::isPointerType(type) || !RuntimeLibrary::atomicClass(type).empty()) return false;
+    }
+
+    writeExpression(funcCall->functionName);
+    writer->append('(');
+    for (size_t i = 0; i < funcCall->arguments.size(); ++i) {
+        if (i > 0) writer->append(", ");
+        writeConverted(funcCall->arguments[i], it->second[i]);
+    }
+    if (offsetReturning.count(it->first)) {
+        writer->append(funcCall->arguments.empty() ? "" : ", ", offsetHolder.empty() ? "new int[1]" : offsetHolder);
+    }
+    writer->append(')');
+    return true;
+}
+
+// Every element of an array initializer is bytecode in <clinit>, about seven
+// bytes for an int, so a table of a few thousand entries breaks the 64KB
+// method limit. A global one-dimensional table of at least resourceThreshold
+// constants is written big-endian to `Class$name.bin` instead, and read back
+// with one bulk read when the class initialises.
+bool JavaEmitter::emitResourceArray(const std::shared_ptr<VariableDeclarationNode>& varDecl, const std::string& type) {
+    auto list = std::dynamic_pointer_cast<InitializerListNode>(varDecl->initializer);
+    if (declarationModifiers.empty() || resourceThreshold <= 0 || !list || varDecl->arraySizes.size() != 1 ||
+        list->elements.size() < static_cast<size_t>(resourceThreshold)) {
+        return false;
+    }
+
+    static const std::unordered_map<std::string, std::pair<int, std::string>> loaders = {
+        {"byte", {1, "bytes"}}, {"boolean", {1, "booleans"}}, {"short", {2, "shorts"}}, {"char", {2, "chars"}},
+        {"int", {4, "ints"}}, {"float", {4, "floats"}}, {"long", {8, "longs"}}, {"double", {8, "doubles"}}
+    };
+    std::string element = TypeChecker::elementType(TypeChecker::normalizeType(type));
+    auto loader = loaders.find(toJavaType(element));
+    if (loader == loaders.end()) return false;
+    int width = loader->second.first;
+    bool floating = loader->first == "float" || loader->first == "double";
+
+    std::string bytes;
+    bytes.reserve(list->elements.size() * width);
+    for (const auto& value : list->elements) {
+        long long integer = 0;
+        double real = 0;
+        if (!literalValue(value, integer, real)) return false;
+        unsigned long long bits = static_cast<unsigned long long>(integer);
+        if (loader->first == "boolean") {
+            bits = integer != 0 || real != 0;
+        } else if (floating && width == 4) {
+            float single = static_cast<float>(real);
+            uint32_t raw;
+            std::memcpy(&raw, &single, sizeof raw);
+            bits = raw;
+        } else if (floating) {
+            std::memcpy(&bits, &real, sizeof bits);
+        }
+        for (int shift = (width - 1) * 8; shift >= 0; shift -= 8) bytes += static_cast<char>((bits >> shift) & 0xFF);
+    }
+
+    std::string name = ASTUtils::rootVariable(varDecl->identifier);
+    std::string resource = className + "$" + name + ".bin";
+    std::string length = varDecl->arraySizes[0] ? convertedToJava(varDecl->arraySizes[0], "int")
+                                                : std::to_string(list->elements.size());
+    resources[resource] = bytes;
+    runtimeClasses.insert("Resources");
+    symbols.addSymbol(name, type);
+    writer->writeLine(declarationModifiers, toJavaType(type), ' ', name, " = Resources.", loader->second.second,
+                     '(', className, ".class, \"", resource, "\", ", length, ");");
+    return true;
+}
+
+// Statements completing a global's initialisation run in a static initializer
+void JavaEmitter::beginFieldInitializer() {
+    if (!declarationModifiers.empty()) writer->write("static {");
+}
+
+void JavaEmitter::endFieldInitializer() {
+    if (!declarationModifiers.empty()) writer->write("}");
+}
+
+// Nothing extends the generated class, so every call on it binds statically
+void JavaEmitter::emitClassBegin(const std::string& className) {
+    this->className = className;
+    writer->writeLine("public final class ", className, " {");
+}
+
+// Vector kernels live in a nested class of their own: it is only loaded,
+// and its jdk.incubator.vector types only resolved, once a kernel runs
+void JavaEmitter::emitClassEnd() {
+    if (!vectorKernels.empty()) {
+        writer->write("static final class Vectorized {");
+        if (vectorElements.count("float")) {
+            writer->write("private static final jdk.incubator.vector.VectorSpecies<Float> FLOATS = "
+                         "jdk.incubator.vector.FloatVector.SPECIES_PREFERRED;");
+        }
+        if (vectorElements.count("double")) {
+            writer->write("private static final jdk.incubator.vector.VectorSpecies<Double> DOUBLES = "
+                         "jdk.incubator.vector.DoubleVector.SPECIES_PREFERRED;");
+        }
+        for (const auto& line : vectorKernels) writer->write(line);
+        writer->write("}");
+    }
+    writer->write("}");
+}
+
+void JavaEmitter::emitStatement(const ASTNodePtr& node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case NodeType::VARIABLE_DECLARATION:
+            emitVariableDeclaration(node);
+            break;
+        case NodeType::FUNCTION_DECLARATION:
+            emitFunction(node);
+            break;
+        case NodeType::STRUCT_DECLARATION:
+            emitStruct(node);
+            break;
+        case NodeType::RETURN_STATEMENT:
+            emitReturn(node);
+            break;
+        case NodeType::IF_STATEMENT:
+            emitIfStatement(node);
+            break;
+        case NodeType::WHILE_LOOP:
+            emitWhileLoop(node);
+            break;
+        case NodeType::FOR_LOOP:
+            emitForLoop(node);
+            break;
+        case NodeType::SWITCH_STATEMENT:
+            emitSwitch(node);
+            break;
+        case NodeType::ENUM_DECLARATION:
+            emitEnum(node);
+            break;
+        case NodeType::DELETE_STATEMENT:
+            emitDelete(node);
+            break;
+        case NodeType::BREAK_STATEMENT: {
+            const std::string& label = std::static_pointer_cast<BreakStatementNode>(node)->label;
+            if (label.empty()) writer->write("break;");
+            else writer->writeLine("break ", label, ';');
+            break;
+        }
+        case NodeType::CONTINUE_STATEMENT: {
+            const std::string& label = std::static_pointer_cast<ContinueStatementNode>(node)->label;
+            if (label.empty()) writer->write("continue;");
+            else writer->writeLine("continue ", label, ';');
+            break;
+        }
+        case NodeType::BLOCK:
+            writer->write("{");
+            emitBlock(node);
+            writer->write("}");
+            break;
+        default: {
+            // `m[k]++;` discards the old value, so the map update needs no adjustment
+            auto unaryExpr = std::dynamic_pointer_cast<UnaryExpressionNode>(node);
+            std::string map, key, valueType;
+            if (unaryExpr && !unaryExpr->prefix && mapSubscript(unaryExpr->operand, map, key, valueType)) {
+                writer->writeLine(map, ".add(", key, (unaryExpr->op == "++" ? ", 1);" : ", -1);"));
+                break;
+            }
+            if (!emitStringBuilderUpdate(node) && !emitPointerUpdate(node)) emitExpression(node);
+            break;
+        }
+    }
+}
+
+std::string JavaEmitter::appendArgument(const ASTNodePtr& node) const {
+    // Java appends a signed int or long in the digits std::to_string gives, without the String in between
+    auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node);
+    std::string callee = funcCall ? ASTUtils::calleeName(node) : "";
+    const Intrinsic* intrinsic = !functionParameterTypes.count(callee) ? Intrinsics::find(callee) : nullptr;
+    if (intrinsic && intrinsic->form == IntrinsicForm::TO_STRING && funcCall->arguments.size() == 1) {
+        std::string argumentType = TypeChecker::normalizeType(typeOf(funcCall->arguments[0]));
+        if (TypeChecker::isIntegralType(argumentType) && !TypeChecker::isUnsignedType(argumentType)) {
+            return convertedToJava(funcCall->arguments[0], TypeChecker::bitWidth(argumentType) == 64 ? "long long" : "int");
+        }
+    }
+
+    // C++ appends integral values as a single character; a char byte is read as Latin-1
+    std::string type = TypeChecker::normalizeType(typeOf(node));
+    if (isTextCharacter(node) || !TypeChecker::isIntegralType(type) || type == "bool") return expressionToJava(node);
+    if (toJavaType(type) == "byte") return "(char) (" + operandToJava(node, javaPrecedence("&")) + " & 0xFF)";
+    return convertedToJava(node, "unsigned short");
+}
+
+bool JavaEmitter::isTextCharacter(const ASTNodePtr& node) const {
+    if (node->type == NodeType::CHAR_LITERAL) return true;
+    auto access = std::dynamic_pointer_cast<ArrayAccessNode>(node);
+    return access && TypeChecker::normalizeType(typeOf(access->array)) == "string";
+}
+
+bool JavaEmitter::emitStringBuilderUpdate(const ASTNodePtr& node) {
+    if (node->type == NodeType::BINARY_EXPRESSION) {
+        auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+        std::string builder = binExpr->left->type == NodeType::IDENTIFIER
+                                  ? std::static_pointer_cast<IdentifierNode>(binExpr->left)->name : "";
+        if (!stringBuilders.count(builder)) return false;
+
+        if (binExpr->op == "+=") {
+            writer->writeLine(builder, ".append(", appendArgument(binExpr->right), ");");
+        } else {
+            // The new value is evaluated before replace() runs, so `s = s + x` stays correct
+            std::string value = appendArgument(binExpr->right);
+            if (TypeChecker::normalizeType(typeOf(binExpr->right)) != "string") value = "String.valueOf(" + value + ")";
+            writer->writeLine(builder, ".replace(0, ", builder, ".length(), ", value, ");");
+        }
+        return true;
+    }
+
+    if (node->type == NodeType::FUNCTION_CALL) {
+        auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
+        auto access = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName);
+        if (!access || access->object->type != NodeType::IDENTIFIER) return false;
+        std::string builder = std::static_pointer_cast<IdentifierNode>(access->object)->name;
+        if (!stringBuilders.count(builder) || !StringBuilderAnalysis::isMutator(access->member)) return false;
+
+        if (access->member == "clear") {
+            writer->writeLine(builder, ".setLength(0);");
+        } else if (access->member == "pop_back") {
+            writer->writeLine(builder, ".setLength(", builder, ".length() - 1);");
+        } else {
+            writer->writeLine(builder, ".append(", appendArgument(funcCall->arguments.front()), ");");
+        }
+        return true;
+    }
+    return false;
+}
+
+// A C++ pointer to one object is a one-element array at offset 0
+std::string JavaEmitter::newToJava(const std::shared_ptr<NewExpressionNode>& newExpr) const {
+    std::string element = TypeChecker::normalizeType(newExpr->typeName);
+    std::string javaElement = toJavaType(element);
+
+    if (newExpr->arraySize) {
+        std::string size = convertedToJava(newExpr->arraySize, "int");
+        if (newExpr->freeList) {
+            std::string pool = RuntimeLibrary::arrayPoolClass(element);
+            runtimeClasses.insert(pool);
+            return pool + ".take(" + size + ")";
+        }
+        if (!newExpr->reusedLocal.empty()) {
+            const std::string& buffer = newExpr->reusedLocal;
+            return "(" + buffer + ".length >= " + size + " ? " + buffer + " : (" + buffer + " = new " +
+                   javaElement + "[" + size + "]))";
+        }
+        if (structs.count(element)) {
+            return "java.util.stream.Stream.generate(" + element + "::new).limit(" + size + ").toArray(" +
+                   element + "[]::new)";
+        }
+        return "new " + javaElement + "[" + size + "]";
+    }
+
+    if (structs.count(element)) {
+        if (!newExpr->arguments.empty()) {
+            ErrorHandler::reportWarning("Constructor arguments of 'new " + element + "' are not translated");
+        }
+        return "new " + element + "[] {new " + element + "()}";
+    }
+    if (newExpr->arguments.size() == 1) {
+        return "new " + javaElement + "[] {" + convertedToJava(newExpr->arguments[0], element, 0, true) + "}";
+    }
+    return "new " + javaElement + "[1]";
+}
+
+bool JavaEmitter::emitPointerUpdate(const ASTNodePtr& node) {
+    auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node);
+    if (!binExpr || binExpr->op != "=" || binExpr->left->type != NodeType::IDENTIFIER) return false;
+
+    std::string type = TypeChecker::normalizeType(typeOf(binExpr->left));
+    if (type.empty() || type.back() != '*') return false;
+
+    std::string pointer = std::static_pointer_cast<IdentifierNode>(binExpr->left)->name;
+    std::string base, offset;
+    if (!pointerParts(binExpr->right, base, offset)) {
+        base = expressionToJava(binExpr->right);
+        offset = "0";
+    }
+    // `p = p + 1` only moves the offset
+    if (base != pointer) writer->writeLine(pointer, " = ", base, ';');
+    if (offset != offsetName(pointer)) writer->writeLine(offsetName(pointer), " = ", offset, ';');
+    return true;
+}
+
+std::string JavaEmitter::arrayInitializerToJava(const ASTNodePtr& initializer, const std::string& type,
+                                                const std::vector<ASTNodePtr>& sizes, size_t depth) const {
+    std::string element = TypeChecker::elementType(type);
+    auto sizeNode = depth < sizes.size() ? std::dynamic_pointer_cast<NumberNode>(sizes[depth]) : nullptr;
+    size_t declaredSize = sizeNode ? static_cast<size_t>(sizeNode->value) : 0;
+
+    // `char buf[N] = "text"` copies the UTF-8 bytes and zero-fills the rest
+    if (initializer->type == NodeType::STRING_LITERAL) {
+        const std::string& text = std::static_pointer_cast<StringNode>(initializer)->value;
+        std::string length = sizeNode ? expressionToJava(sizeNode) : std::to_string(text.size() + 1);
+        std::string characters = toJavaType(element) == "byte" ? ".getBytes(java.nio.charset.StandardCharsets.UTF_8)"
+                                                               : ".toCharArray()";
+        return "java.util.Arrays.copyOf(" + expressionToJava(initializer) + characters + ", " + length + ")";
+    }
+
+    auto list = std::dynamic_pointer_cast<InitializerListNode>(initializer);
+    if (!list) return convertedToJava(initializer, type, 0, true);
+
+    std::vector<std::string> elements;
+    for (const auto& item : list->elements) {
+        elements.push_back(TypeChecker::isPointerType(element) && item->type == NodeType::INITIALIZER_LIST
+                               ? arrayInitializerToJava(item, element, sizes, depth + 1)
+                               : convertedToJava(item, element, 0, true));
+    }
+
+    // Elements left out of a sized initializer are zero
+    std::string zero = TypeChecker::isPointerType(element) ? "new " + toJavaType(TypeChecker::elementType(element))
+                     : element == "bool" ? "false"
+                     : TypeChecker::isArithmeticType(element) ? "0"
+                     : element == "string" ? "\"\"" : "null";
+    if (TypeChecker::isPointerType(element)) {
+        bool sized = depth + 1 < sizes.size() && sizes[depth + 1];
+        zero = sized ? zero + "[" + convertedToJava(sizes[depth + 1], "int") + "]" : "null";
+        for (size_t level = depth + 2; sized && level < sizes.size(); ++level) zero += "[]";
+    }
+    while (elements.size() < declaredSize) elements.push_back(zero);
+
+    std::string result = "{";
+    for (size_t i = 0; i < elements.size(); ++i) {
+        result += (i ? ", " : "") + elements[i];
+    }
+    return result + "}";
+}
+
+void JavaEmitter::emitArrayDeclaration(const std::shared_ptr<VariableDeclarationNode>& varDecl, const std::string& type) {
+    if (emitResourceArray(varDecl, type)) return;
+    std::string name = ASTUtils::rootVariable(varDecl->identifier);
+    std::string value;
+    if (varDecl->initializer) {
+        value = arrayInitializerToJava(varDecl->initializer, type, varDecl->arraySizes, 0);
+    } else {
+        std::string element = type;
+        while (TypeChecker::isPointerType(element)) element = TypeChecker::elementType(element);
+
+        value = "new " + toJavaType(element);
+        for (const auto& size : varDecl->arraySizes) {
+            value += "[" + (size ? convertedToJava(size, "int") : "") + "]";
+        }
+    }
+    symbols.addSymbol(name, type);
+    writer->writeLine(declarationModifiers, toJavaType(type), ' ', name, " = ", value, ';');
+
+    // Java arrays of objects start out null; C++ constructs every element
+    std::string element = TypeChecker::elementType(TypeChecker::normalizeType(type));
+    if (structs.count(element) && varDecl->arraySizes.size() == 1 && !varDecl->initializer) {
+        beginFieldInitializer();
+        writer->writeLine("java.util.Arrays.setAll(", name, ", i$ -> new ", element, "());");
+        endFieldInitializer();
+    }
+}
+
+bool JavaEmitter::isValueClass(const std::string& cppType) const {
+    std::string type = TypeChecker::normalizeType(cppType);
+    return structs.count(type) || !RuntimeLibrary::containerClass(type).empty();
+}
+
+// C++ copies structs and containers on initialization and assignment; Java would share the object
+std::string JavaEmitter::copiedToJava(const ASTNodePtr& node, const std::string& type) const {
+    bool lvalue = node->type == NodeType::IDENTIFIER || node->type == NodeType::ARRAY_ACCESS ||
+                  node->type == NodeType::MEMBER_ACCESS;
+    if (!lvalue || TypeChecker::normalizeType(typeOf(node)) != TypeChecker::normalizeType(type)) {
+        return expressionToJava(node);
+    }
+    return operandToJava(node, 100) + ".copy()";
+}
+
+void JavaEmitter::emitStructDeclaration(const std::shared_ptr<VariableDeclarationNode>& varDecl, const std::string& type) {
+    std::string name = ASTUtils::rootVariable(varDecl->identifier);
+    std::string structName = TypeChecker::normalizeType(type);
+    auto list = std::dynamic_pointer_cast<InitializerListNode>(varDecl->initializer);
+    std::string value = varDecl->initializer && !list ? copiedToJava(varDecl->initializer, type)
+                                                      : "new " + structName + "()";
+    symbols.addSymbol(name, type);
+    writer->writeLine(declarationModifiers, toJavaType(type), ' ', name, " = ", value, ';');
+
+    // `Point p = {1, 2}` assigns the fields in declaration order
+    const auto& fields = structs.at(structName)->fields;
+    if (list && !list->elements.empty()) beginFieldInitializer();
+    for (size_t i = 0; list && i < list->elements.size() && i < fields.size(); ++i) {
+        auto field = std::static_pointer_cast<VariableDeclarationNode>(fields[i]);
+        writer->writeLine(name, '.', ASTUtils::rootVariable(field->identifier), " = ",
+                         convertedToJava(list->elements[i], field->type, 0, true), ';');
+    }
+    if (list && !list->elements.empty()) endFieldInitializer();
+}
+
+void JavaEmitter::emitSplitArrayDeclaration(const std::shared_ptr<VariableDeclarationNode>& varDecl, const std::string& type) {
+    std::string name = ASTUtils::rootVariable(varDecl->identifier);
+    auto element = StructOfArraysAnalysis::elementStruct(type, structs);
+    ASTNodePtr size = varDecl->arraySizes.empty() ? varDecl->constructorArguments.front() : varDecl->arraySizes.front();
+    std::string length = convertedToJava(size, "int");
+    if (size->type != NodeType::IDENTIFIER && size->type != NodeType::NUMBER_LITERAL) {
+        writer->writeLine("int ", name, "$length = ", length, ';');  // Evaluated once, as in C++
+        length = name + "$length";
+    }
+
+    for (const auto& field : element->fields) {
+        auto fieldDecl = std::static_pointer_cast<VariableDeclarationNode>(field);
+        std::string array = name + "$" + ASTUtils::rootVariable(fieldDecl->identifier);
+        std::string javaType = toJavaType(TypeChecker::normalizeType(fieldDecl->type));
+        writer->writeLine(javaType, "[] ", array, " = new ", javaType, '[', length, "];");
+        if (fieldDecl->initializer) {
+            writer->writeLine("java.util.Arrays.fill(", array, ", ",
+                             convertedToJava(fieldDecl->initializer, fieldDecl->type), ");");
+        }
+    }
+    symbols.addSymbol(name, type);
+}
+
+// Bytes to elements: `n * sizeof(int)` gives `n`, other byte counts are divided by the element size
+std::string JavaEmitter::elementCount(const ASTNodePtr& bytes, const std::string& element) const {
+    // A sizeof the declared types do not fix leaves the call unchanged
+    auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(bytes);
+    for (const auto& term : {bytes, binExpr ? binExpr->left : nullptr, binExpr ? binExpr->right : nullptr}) {
+        if (sizeofOperand(term) && sizeofToJava(sizeofOperand(term)).empty()) return "";
+    }
+    int size = TypeChecker::bitWidth(element) / 8;
+    if (size <= 1) return convertedToJava(bytes, "int");
+
+    // `sizeof(a)` of an array of the element type is its length
+    ASTNodePtr operand = sizeofOperand(bytes);
+    std::string operandType = operand ? TypeChecker::normalizeType(typeOf(operand)) : "";
+    if (operand && operand->type == NodeType::IDENTIFIER && TypeChecker::isPointerType(operandType) &&
+        operandType.back() == ']' && scalarSize(TypeChecker::elementType(operandType)) == size) {
+        return expressionToJava(operand) + ".length";
+    }
+
+    // Constant byte counts: literals and the sizeof of a scalar
+    auto constant = [this](const ASTNodePtr& node) -> long long {
+        if (auto number = std::dynamic_pointer_cast<NumberNode>(node)) return static_cast<long long>(number->value);
+        ASTNodePtr operand = sizeofOperand(node);
+        int bytes = operand ? scalarSize(TypeChecker::normalizeType(typeOf(operand))) : 0;
+        return bytes > 0 ? bytes : -1;
+    };
+    if (binExpr && binExpr->op == "*") {
+        if (constant(binExpr->right) == size) return convertedToJava(binExpr->left, "int");
+        if (constant(binExpr->left) == size) return convertedToJava(binExpr->right, "int");
+    }
+    if (constant(bytes) >= 0) return std::to_string(constant(bytes) / size);
+    return convertedToJava(bytes, "int", javaPrecedence("/") - 1) + " / " + std::to_string(size);
+}
+
+std::string JavaEmitter::sizeofToJava(const ASTNodePtr& operand) const {
+    std::string type = TypeChecker::normalizeType(typeOf(operand));
+    if (int bytes = scalarSize(type)) return std::to_string(bytes);
+
+    // A Java array knows its length; arrays of arrays and of structs do not have a fixed element size
+    int element = TypeChecker::isPointerType(type) ? scalarSize(TypeChecker::elementType(type)) : 0;
+    if (!element || operand->type != NodeType::IDENTIFIER) return "";
+    std::string length = expressionToJava(operand) + ".length";
+    return element == 1 ? length : "(" + length + " * " + std::to_string(element) + ")";
+}
+
+std::string JavaEmitter::unmappedArgumentToJava(const ASTNodePtr& node) const {
+    auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node);
+    if (binExpr && (binExpr->op == "+" || binExpr->op == "-") &&
+        TypeChecker::isPointerType(TypeChecker::normalizeType(typeOf(node)))) {
+        return unmappedArgumentToJava(binExpr->left) + " " + binExpr->op + " " +
+               operandToJava(binExpr->right, javaPrecedence(binExpr->op));
+    }
+    return expressionToJava(node);
+}
+
+std::string JavaEmitter::bitCopyToJava(const ASTNodePtr& dst, const ASTNodePtr& src) const {
+    auto dstAddress = std::dynamic_pointer_cast<UnaryExpressionNode>(dst);
+    auto srcAddress = std::dynamic_pointer_cast<UnaryExpressionNode>(src);
+    if (!dstAddress || !srcAddress || dstAddress->op != "&" || srcAddress->op != "&") return "";
+
+    std::string to = TypeChecker::normalizeType(typeOf(dstAddress->operand));
+    std::string from = TypeChecker::normalizeType(typeOf(srcAddress->operand));
+    if (!TypeChecker::isArithmeticType(to) || !TypeChecker::isArithmeticType(from) ||
+        TypeChecker::bitWidth(to) != TypeChecker::bitWidth(from) ||
+        TypeChecker::isFloatingType(to) == TypeChecker::isFloatingType(from)) {
+        return "";
+    }
+
+    static const std::unordered_map<std::string, std::string> methods = {
+        {"float", "Float.floatToRawIntBits("}, {"double", "Double.doubleToRawLongBits("},
+        {"int", "Float.intBitsToFloat("}, {"long", "Double.longBitsToDouble("}
+    };
+    std::string method = methods.at(toJavaType(from));
+    return expressionToJava(dstAddress->operand) + " = " + method + expressionToJava(srcAddress->operand) + ")";
+}
+
+std::string JavaEmitter::intrinsicToJava(const std::shared_ptr<FunctionCallNode>& funcCall,
+                                         const Intrinsic& intrinsic) const {
+    const auto& args = funcCall->arguments;
+    auto plus = [](const std::string& offset, const std::string& count) {
+        if (offset == "0") return count;
+        if (count == "0") return offset;
+        return offset + " + " + (count.find(' ') != std::string::npos && !isWrapped(count) ? "(" + count + ")" : count);
+    };
+    auto minus = [](const std::string& end, const std::string& start) {
+        if (start == "0") return end;
+        if (end.rfind(start + " + ", 0) == 0) return end.substr(start.size() + 3);  // `(p + n) - p`
+        return end + " - " + (start.find(' ') != std::string::npos && !isWrapped(start) ? "(" + start + ")" : start);
+    };
+
+    switch (intrinsic.form) {
+        case IntrinsicForm::CALL: {
+            std::string java;
+            for (size_t i = 0; i < args.size(); ++i) {
+                java += (i ? ", " : "") + (intrinsic.parameterType.empty() ? expressionToJava(args[i])
+                                                                          : convertedToJava(args[i], intrinsic.parameterType));
+            }
+            if (intrinsic.javaName.find("CRT.") != std::string::npos) runtimeClasses.insert("CRT");
+            return intrinsic.javaName + "(" + java + ")";
+        }
+
+        case IntrinsicForm::MIN_MAX: {
+            std::string common = TypeChecker::arithmeticType(typeOf(args[0]), typeOf(args[1]));
+            if (common.empty()) return intrinsic.javaName + "(" + expressionToJava(args[0]) + ", " + expressionToJava(args[1]) + ")";
+            if (TypeChecker::isUnsignedType(common)) {
+                // Flipping the sign bit maps unsigned order onto signed order
+                std::string flip = " ^ " + unsignedHelper(common) + ".MIN_VALUE";
+                int precedence = javaPrecedence("^");
+                return "(" + intrinsic.javaName + "(" + convertedToJava(args[0], common, precedence) + flip + ", " +
+                       convertedToJava(args[1], common, precedence) + flip + ")" + flip + ")";
+            }
+            return intrinsic.javaName + "(" + convertedToJava(args[0], common) + ", " + convertedToJava(args[1], common) + ")";
+        }
+
+        case IntrinsicForm::ARRAY_COPY: {
+            std::string bits = bitCopyToJava(args[0], args[1]);
+            if (!bits.empty()) return bits;
+
+            std::string dst, dstOffset, src, srcOffset;
+            std::string element = TypeChecker::elementType(TypeChecker::normalizeType(typeOf(args[0])));
+            std::string count = TypeChecker::isArithmeticType(element) ? elementCount(args[2], element) : "";
+            if (count.empty() || !pointerParts(args[0], dst, dstOffset) || !pointerParts(args[1], src, srcOffset)) {
+                return "";
+            }
+            return intrinsic.javaName + "(" + src + ", " + srcOffset + ", " + dst + ", " + dstOffset + ", " + count + ")";
+        }
+
+        case IntrinsicForm::RANGE_COPY: {
+            std::string first, firstOffset, last, lastOffset, out, outOffset;
+            if (!pointerParts(args[0], first, firstOffset) || !pointerParts(args[1], last, lastOffset) ||
+                !pointerParts(args[2], out, outOffset) || first != last) {
+                return "";
+            }
+            return intrinsic.javaName + "(" + first + ", " + firstOffset + ", " + out + ", " + outOffset + ", " +
+                   minus(lastOffset, firstOffset) + ")";
+        }
+
+        case IntrinsicForm::BYTE_FILL: {
+            std::string array, offset;
+            std::string element = TypeChecker::elementType(TypeChecker::normalizeType(typeOf(args[0])));
+            if (!TypeChecker::isArithmeticType(element) || !pointerParts(args[0], array, offset)) return "";
+
+            // memset writes bytes: wider elements get the byte repeated, which only a constant can give
+            std::string value;
+            int size = TypeChecker::bitWidth(element) / 8;
+            auto number = std::dynamic_pointer_cast<NumberNode>(args[1]);
+            auto negated = std::dynamic_pointer_cast<UnaryExpressionNode>(args[1]);
+            if (negated && negated->op == "-") number = std::dynamic_pointer_cast<NumberNode>(negated->operand);
+            if (size <= 1) {
+                value = convertedToJava(args[1], element);
+            } else if (number) {
+                long long constant = static_cast<long long>(number->value);
+                unsigned long long byte = static_cast<unsigned long long>(number != args[1] ? -constant : constant) & 0xFF;
+                if (byte == 0) {
+                    value = TypeChecker::isFloatingType(element) ? "0" : convertedToJava(std::make_shared<NumberNode>(0, "0"), element);
+                } else if (TypeChecker::isFloatingType(element)) {
+                    return "";
+                } else {
+                    unsigned long long pattern = 0;
+                    for (int i = 0; i < size; ++i) pattern = (pattern << 8) | byte;
+                    char text[32];
+                    std::snprintf(text, sizeof(text), "0x%llX%s", pattern, size == 8 ? "ULL" : "U");
+                    value = convertedToJava(std::make_shared<NumberNode>(static_cast<double>(pattern), text), element);
+                }
+            } else {
+                return "";
+            }
+            std::string count = elementCount(args[2], element);
+            if (count.empty()) return "";
+            return intrinsic.javaName + "(" + array + ", " + offset + ", " + plus(offset, count) + ", " + value + ")";
+        }
+
+        case IntrinsicForm::RANGE_FILL:
+        case IntrinsicForm::COUNT_FILL: {
+            std::string array, offset, last, end;
+            std::string element = TypeChecker::elementType(TypeChecker::normalizeType(typeOf(args[0])));
+            if (element.empty() || !pointerParts(args[0], array, offset)) return "";
+            if (intrinsic.form == IntrinsicForm::COUNT_FILL) {
+                end = plus(offset, convertedToJava(args[1], "int"));
+            } else if (!pointerParts(args[1], last, end) || last != array) {
+                return "";
+            }
+            return intrinsic.javaName + "(" + array + ", " + offset + ", " + end + ", " + convertedToJava(args[2], element) + ")";
+        }
+
+        case IntrinsicForm::RANGE_SORT: {
+            // Arrays.sort orders signed values; unsigned and boolean elements keep the C++ call
+            std::string array, offset, last, end;
+            std::string element = TypeChecker::elementType(TypeChecker::normalizeType(typeOf(args[0])));
+            if (!TypeChecker::isArithmeticType(element) || element == "bool" ||
+                (TypeChecker::isUnsignedType(element) && element != "unsigned short") ||
+                !pointerParts(args[0], array, offset) || !pointerParts(args[1], last, end) || last != array) {
+                return "";
+            }
+            return intrinsic.javaName + "(" + array + ", " + offset + ", " + end + ")";
+        }
+
+        case IntrinsicForm::TO_STRING: {
+            // bool and the narrow types print as the int they promote to
+            std::string type = TypeChecker::normalizeType(typeOf(args[0]));
+            if (TypeChecker::isFloatingType(type)) {
+                return "String.format(java.util.Locale.ROOT, \"%f\", " + convertedToJava(args[0], "double") + ")";
+            }
+            if (!TypeChecker::isArithmeticType(type)) return "";
+            if (TypeChecker::bitWidth(type) == 64) {
+                return (TypeChecker::isUnsignedType(type) ? "Long.toUnsignedString(" : intrinsic.javaName + "(") +
+                       expressionToJava(args[0]) + ")";
+            }
+            if (type == "unsigned int") return "Integer.toUnsignedString(" + expressionToJava(args[0]) + ")";
+            return intrinsic.javaName + "(" + convertedToJava(args[0], "int") + ")";
+        }
+    }
+    return "";
+}
+
+bool JavaEmitter::mapSubscript(const ASTNodePtr& node, std::string& map, std::string& key, std::string& valueType) const {
+    auto access = std::dynamic_pointer_cast<ArrayAccessNode>(node);
+    if (!access) return false;
+
+    std::string type = TypeChecker::normalizeType(typeOf(access->array));
+    if (TypeChecker::templateName(type) != "unordered_map" || RuntimeLibrary::containerClass(type).empty()) return false;
+
+    std::vector<std::string> arguments = TypeChecker::templateArguments(type);
+    map = operandToJava(access->array, 100);
+    key = convertedToJava(access->index, arguments[0]);
+    valueType = arguments[1];
+    return true;
+}
+
+std::string JavaEmitter::containerCallToJava(const std::shared_ptr<FunctionCallNode>& funcCall,
+                                             const std::shared_ptr<MemberAccessNode>& access,
+                                             const std::string& type) const {
+    bool isVector = TypeChecker::templateName(type) == "vector";
+    std::vector<std::string> arguments = TypeChecker::templateArguments(type);
+
+    static const std::unordered_map<std::string, std::string> renamed = {
+        {"push_back", "add"}, {"emplace_back", "add"}, {"insert", "add"}, {"emplace", "add"},
+        {"pop_back", "removeLast"}, {"empty", "isEmpty"}, {"erase", "remove"},
+        {"size", "size"}, {"clear", "clear"}, {"reserve", "reserve"}, {"resize", "resize"},
+        {"front", "front"}, {"back", "back"}, {"count", "count"}, {"contains", "contains"},
+        {"slots", "slots"}, {"full", "full"}, {"keyAt", "keyAt"}, {"valueAt", "valueAt"}
+    };
+    std::string member = access->member == "at" ? (isVector ? "get" : "at") : "";
+    auto it = renamed.find(access->member);
+    if (it != renamed.end()) member = it->second;
+    if (member.empty()) {
+        ErrorHandler::reportWarning("'" + access->member + "' has no equivalent in the " +
+                                    RuntimeLibrary::containerClass(type) + " runtime class; emitted unchanged.");
+        member = access->member;
+    }
+
+    // Vector indices and sizes are ints; hash containers take the key, then the mapped value
+    std::string args;
+    for (size_t i = 0; i < funcCall->arguments.size(); ++i) {
+        std::string parameterType = i < arguments.size() ? arguments[i] : "";
+        if (member == "full" || member == "keyAt" || member == "valueAt") parameterType = "int";  // Slot numbers
+        if (isVector) parameterType = (member == "add" || i == 1) ? arguments[0] : "int";
+        args += (i ? ", " : "") + convertedToJava(funcCall->arguments[i], parameterType);
+    }
+    return operandToJava(access->object, 100) + "." + member + "(" + args + ")";
+}
+
+void JavaEmitter::emitContainerDeclaration(const std::shared_ptr<VariableDeclarationNode>& varDecl,
+                                           const std::string& type, const std::string& container) {
+    std::string name = ASTUtils::rootVariable(varDecl->identifier);
+    std::string declaration = declarationModifiers + toJavaType(type) + " " + name + " = ";
+    std::vector<std::string> arguments = TypeChecker::templateArguments(TypeChecker::normalizeType(type));
+    bool isVector = TypeChecker::templateName(type) == "vector";
+    auto list = std::dynamic_pointer_cast<InitializerListNode>(varDecl->initializer);
+    runtimeClasses.insert(container);
+
+    std::string value = "new " + container + "()";
+    if (!varDecl->constructorArguments.empty()) {
+        // `std::vector<T> v(n, x)`; hash containers take a bucket count
+        std::string args;
+        for (size_t i = 0; i < varDecl->constructorArguments.size(); ++i) {
+            std::string parameterType = (isVector && i == 1) ? arguments[0] : "int";
+            args += (i ? ", " : "") + convertedToJava(varDecl->constructorArguments[i], parameterType);
+        }
+        value = "new " + container + "(" + args + ")";
+    } else if (list && !isVector && arguments.size() == 2) {
+        // Map initializers become one put() per `{key, value}` pair
+        writer->writeLine(declaration, value, ';');
+        symbols.addSymbol(name, type);
+        beginFieldInitializer();
+        for (const auto& element : list->elements) {
+            auto pair = std::dynamic_pointer_cast<InitializerListNode>(element);
+            if (!pair || pair->elements.size() != 2) continue;
+            writer->writeLine(name, ".put(", convertedToJava(pair->elements[0], arguments[0]), ", ",
+                             convertedToJava(pair->elements[1], arguments[1]), ");");
+        }
+        endFieldInitializer();
+        return;
+    } else if (list && !list->elements.empty()) {
+        std::string elements;
+        for (const auto& element : list->elements) {
+            elements += (elements.empty() ? "" : ", ") + convertedToJava(element, arguments[0]);
+        }
+        value = container + ".of(" + elements + ")";
+    } else if (varDecl->initializer && varDecl->initializer->type == NodeType::IDENTIFIER) {
+        value = expressionToJava(varDecl->initializer) + ".copy()";  // C++ copies on initialization
+    } else if (varDecl->initializer && !list) {
+        value = expressionToJava(varDecl->initializer);
+    }
+    symbols.addSymbol(name, type);
+    writer->writeLine(declaration, value, ';');
+}
+
+// `auto` takes the initializer's type so Java gets a concrete primitive rather than `var`
+std::string JavaEmitter::resolvedType(const std::shared_ptr<VariableDeclarationNode>& varDecl) const {
+    std::string declaredType = varDecl->type;
+    if (TypeChecker::normalizeType(declaredType) == "auto" && varDecl->initializer) {
+        std::string inferred = typeOf(varDecl->initializer);
+        if (!inferred.empty()) {
+            declaredType = (declaredType.rfind("const ", 0) == 0 ? "const " : "") + inferred;
+        }
+    }
+    return declaredType;
+}
 
 void JavaEmitter::emitVariableDeclaration(const ASTNodePtr& node) {
     if (!node) return;
@@ -12,11 +2060,87 @@ void JavaEmitter::emitVariableDeclaration(const ASTNodePtr& node) {
     auto identifierNode = std::dynamic_pointer_cast<IdentifierNode>(varDecl->identifier);
     if (!identifierNode) return;
 
-    std::string type = varDecl->type;
+    std::string declaredType = resolvedType(varDecl);
+    // C++ globals exist once per program: static fields, private when declared `static`
+    bool field = !currentFunction && !inStruct;
+    declarationModifiers = !field ? "" : varDecl->internalLinkage ? "private static " : "static ";
+
     std::string name = identifierNode->name;
-    std::string value = varDecl->initializer ? varDecl->initializer->toString() : "";
+    if (stringBuilders.count(name)) {
+        std::string initial = varDecl->initializer ? expressionToJava(varDecl->initializer) : "";
+        writer->writeLine("StringBuilder ", name, " = new StringBuilder(", initial, ");");
+        symbols.addSymbol(name, declaredType);
+        return;
+    }
 
-    writer.write(type + " " + name + (value.empty() ? ";" : " = " + value + ";"));
+    if (splitArrays.count(name)) {
+        emitSplitArrayDeclaration(varDecl, declaredType);
+        return;
+    }
+    if (emitTaskDeclaration(varDecl, declaredType)) return;
+    std::string atomic = RuntimeLibrary::atomicClass(declaredType);
+    if (!atomic.empty()) {
+        // `std::atomic<int> x(5)`, `x{5}` or `x = 5`; C++20 zero-initialises one declared without
+        auto list = std::dynamic_pointer_cast<InitializerListNode>(varDecl->initializer);
+        ASTNodePtr initial = list ? (list->elements.empty() ? nullptr : list->elements[0]) : varDecl->initializer;
+        if (!initial && !varDecl->constructorArguments.empty()) initial = varDecl->constructorArguments[0];
+        std::string value = TypeChecker::valueType(TypeChecker::normalizeType(declaredType));
+        std::string initialValue = initial ? convertedToJava(initial, value) : toJavaType(value) == "boolean" ? "false" : "0";
+        runtimeClasses.insert(atomic);
+        symbols.addSymbol(name, declaredType);
+        writer->writeLine(declarationModifiers, atomic, ' ', name, " = new ", atomic, '(', initialValue, ");");
+        return;
+    }
+    if (isMutexType(declaredType)) {
+        symbols.addSymbol(name, declaredType);
+        writer->writeLine(declarationModifiers, toJavaType(declaredType), ' ', name,
+                         " = new java.util.concurrent.locks.ReentrantLock();");
+        return;
+    }
+    if (!varDecl->arraySizes.empty()) {
+        emitArrayDeclaration(varDecl, declaredType);
+        return;
+    }
+    if (structs.count(TypeChecker::normalizeType(declaredType))) {
+        emitStructDeclaration(varDecl, declaredType);
+        return;
+    }
+    std::string container = RuntimeLibrary::containerClass(declaredType);
+    if (!container.empty() && !varDecl->reusedLocal.empty()) {
+        // C++ clear() keeps the capacity, so the storage of earlier iterations is reused
+        writer->writeLine(varDecl->reusedLocal, ".clear();");
+        writer->writeLine(toJavaType(declaredType), ' ', name, " = ", varDecl->reusedLocal, ';');
+        symbols.addSymbol(name, declaredType);
+        runtimeClasses.insert(container);
+        return;
+    }
+    if (!container.empty()) {
+        emitContainerDeclaration(varDecl, declaredType, container);
+        return;
+    }
+    if (isStandardContainer(declaredType)) {
+        ErrorHandler::reportWarning("'" + declaredType + "' has no primitive runtime class; emitted unchanged.");
+    }
+    std::string normalized = TypeChecker::normalizeType(declaredType);
+    if (!normalized.empty() && normalized.back() == '*') {
+        std::string base = "null", offset = "0";
+        if (varDecl->initializer && !pointerParts(varDecl->initializer, base, offset)) {
+            base = expressionToJava(varDecl->initializer);
+        }
+        symbols.addSymbol(name, declaredType);
+        writer->writeLine(declarationModifiers, toJavaType(declaredType), ' ', name, " = ", base, ';');
+        writer->writeLine(declarationModifiers, "int ", offsetName(name), " = ", offset, ';');
+        return;
+    }
+
+    // The initializer is read before the name is in scope, as in C++
+    writer->append(declarationModifiers, toJavaType(declaredType), ' ', name);
+    if (varDecl->initializer) {
+        writer->append(" = ");
+        writeConverted(varDecl->initializer, declaredType, 0, true);
+    }
+    writer->writeLine(';');
+    symbols.addSymbol(name, declaredType);
 }
 
 
@@ -26,32 +2150,213 @@ void JavaEmitter::emitFunction(const ASTNodePtr& node) {
     auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(node);
     if (!funcDecl) return;
 
-    std::string returnType = funcDecl->returnType;
+    std::string returnType = toJavaType(funcDecl->returnType);
+    useRuntimeClass(funcDecl->returnType);
     std::string functionName = std::dynamic_pointer_cast<IdentifierNode>(funcDecl->functionName)->name;
 
-    std::string params;
+    // Locals are scoped to the function; function signatures stay visible
+    SymbolTable enclosingSymbols = symbols;
+    std::string enclosingReturnType = currentReturnType;
+    std::unordered_set<std::string> enclosingBuilders = stringBuilders;
+    std::unordered_set<std::string> enclosingSplitArrays = splitArrays;
+    std::unordered_map<std::string, std::string> enclosingEnumConstants = enumConstants;
+    std::unordered_map<std::string, EnumValue> enclosingEnumValues = enumValues;
+    std::shared_ptr<FunctionDeclarationNode> enclosingFunction = currentFunction;
+    currentReturnType = funcDecl->returnType;
+    currentFunction = funcDecl;
+    // Generated names are numbered per function, so a function's text depends on nothing emitted before it
+    switchCount = 0;
+    parallelCount = 0;
+    vectorLoopCount = 0;
+    stringBuilders = StringBuilderAnalysis::builderVariables(funcDecl);
+    splitArrays = structOfArrays && !funcDecl->cold ? StructOfArraysAnalysis::splitArrays(funcDecl, structs)
+                                                    : std::unordered_set<std::string>();
+
+    // Free functions are static, so calls need no receiver and bind without a class-hierarchy check
+    const char* modifiers = funcDecl->splitFrom.empty() && !funcDecl->internalLinkage ? "static " : "private static ";
+    writer->append(modifiers, returnType, ' ', functionName, '(');
     for (size_t i = 0; i < funcDecl->parameters.size(); ++i) {
         auto param = std::dynamic_pointer_cast<IdentifierNode>(funcDecl->parameters[i]);
         if (param) {
-            params += "int " + param->name; // Default to `int`, improve later
-            if (i < funcDecl->parameters.size() - 1) params += ", ";
+            std::string paramType = i < funcDecl->parameterTypes.size() ? funcDecl->parameterTypes[i] : "int";
+            writer->append(toJavaType(paramType), ' ', param->name);
+            useRuntimeClass(paramType);
+            if (TypeChecker::isPointerType(paramType)) writer->append(", int ", offsetName(param->name));
+            symbols.addSymbol(param->name, paramType);
+            if (i < funcDecl->parameters.size() - 1) writer->append(", ");
         }
     }
+    if (offsetReturning.count(functionName)) writer->append(funcDecl->parameters.empty() ? "" : ", ", "int[] result$off");
+    writer->writeLine(") {");
 
-    writer.write(returnType + " " + functionName + "(" + params + ") {");
-
+    std::string enclosingHolder = offsetHolder;
+    emitPoolLocals(funcDecl->body);
+    emitOffsetHolder(funcDecl->body, "call$off");
+    for (size_t i = 0; i < funcDecl->copiedParameters.size() && i < funcDecl->parameterTypes.size(); ++i) {
+        if (!funcDecl->copiedParameters[i] || !isValueClass(funcDecl->parameterTypes[i])) continue;
+        std::string name = ASTUtils::rootVariable(funcDecl->parameters[i]);
+        writer->writeLine(name, " = ", name, ".copy();");  // Passed by value: the caller keeps its own object
+    }
     if (funcDecl->body) emitBlock(funcDecl->body);
 
-    writer.write("}");
+    writer->write("}");
+
+    symbols = enclosingSymbols;
+    currentReturnType = enclosingReturnType;
+    stringBuilders = enclosingBuilders;
+    splitArrays = enclosingSplitArrays;
+    enumConstants = enclosingEnumConstants;
+    enumValues = enclosingEnumValues;
+    currentFunction = enclosingFunction;
+    offsetHolder = enclosingHolder;
+}
+
+void JavaEmitter::emitStruct(const ASTNodePtr& node) {
+    auto structDecl = std::dynamic_pointer_cast<StructDeclarationNode>(node);
+    if (!structDecl) return;
+
+    SymbolTable enclosingSymbols = symbols;
+    const std::string& name = structDecl->name;
+    writer->writeLine("static final class ", name, " {");
+    inStruct = true;
+    for (const auto& field : structDecl->fields) {
+        emitVariableDeclaration(field);
+    }
+    inStruct = false;
+
+    // Value semantics: C++ copies the whole struct on assignment
+    writer->writeLine(name, " copy() {");
+    writer->writeLine(name, " copy$ = new ", name, "();");
+    for (const auto& field : structDecl->fields) {
+        auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(field);
+        std::string fieldName = ASTUtils::rootVariable(varDecl->identifier);
+        std::string value = fieldName;
+        if (!varDecl->arraySizes.empty()) value += ".clone()";
+        else if (isValueClass(varDecl->type)) value += ".copy()";
+        writer->writeLine("copy$.", fieldName, " = ", value, ';');
+    }
+    writer->write("return copy$;");
+    writer->write("}");
+    writer->write("}");
+    symbols = enclosingSymbols;
+}
+
+// Enumerators become `final` constants rather than a Java enum: C++ code uses
+// them as integers, and constants keep switches on them plain int switches
+void JavaEmitter::emitEnum(const ASTNodePtr& node) {
+    auto enumDecl = std::dynamic_pointer_cast<EnumDeclarationNode>(node);
+    if (!enumDecl) return;
+
+    declareEnum(node);
+    std::string modifiers = currentReturnType.empty() ? "static final " : "final ";
+    std::string javaType = toJavaType(enumDecl->underlyingType);
+    ASTNodePtr value = std::make_shared<NumberNode>(0);
+    for (size_t i = 0; i < enumDecl->enumerators.size(); ++i) {
+        // An enumerator without a value is one more than the previous one
+        if (enumDecl->values[i]) value = enumDecl->values[i];
+        else if (i > 0 && value->type == NodeType::NUMBER_LITERAL) {
+            value = std::make_shared<NumberNode>(std::static_pointer_cast<NumberNode>(value)->value + 1);
+        } else if (i > 0) {
+            auto previous = std::make_shared<IdentifierNode>(enumDecl->name + "::" + enumDecl->enumerators[i - 1]);
+            value = std::make_shared<BinaryExpressionNode>(previous, "+", std::make_shared<NumberNode>(1));
+        }
+        std::string name = expressionToJava(std::make_shared<IdentifierNode>(enumDecl->name + "::" + enumDecl->enumerators[i]));
+        writer->writeLine(modifiers, javaType, ' ', name, " = ",
+                         convertedToJava(value, enumDecl->underlyingType, 0, true), ';');
+    }
+
+    // Values past the int range are switched on through their index in this sorted table
+    auto first = enumValues.find(enumDecl->name + "::" + enumDecl->enumerators.front());
+    if (first == enumValues.end() || first->second.table.empty()) return;
+    std::string elements;
+    for (long long tableValue : enumTables[first->second.table]) {
+        for (const auto& enumerator : enumDecl->enumerators) {
+            std::string qualified = enumDecl->name + "::" + enumerator;
+            if (enumValues[qualified].value != tableValue) continue;
+            elements += (elements.empty() ? "" : ", ") + expressionToJava(std::make_shared<IdentifierNode>(qualified));
+            break;
+        }
+    }
+    writer->writeLine(modifiers, "long[] ", first->second.table, " = {", elements, "};");
+}
+
+// Memory goes back to the GC by dropping the reference, or to its pool
+void JavaEmitter::emitDelete(const ASTNodePtr& node) {
+    auto del = std::dynamic_pointer_cast<DeleteStatementNode>(node);
+    if (!del || del->operand->type != NodeType::IDENTIFIER) return;
+
+    std::string pointer = expressionToJava(del->operand);
+    if (del->pooled) {
+        std::string pool = RuntimeLibrary::arrayPoolClass(TypeChecker::elementType(typeOf(del->operand)));
+        runtimeClasses.insert(pool);
+        writer->writeLine(pool, ".give(", pointer, ");");
+        return;
+    }
+    writer->writeLine(pointer, " = null;");
+}
+
+void JavaEmitter::emitPoolLocals(const ASTNodePtr& body) {
+    std::function<void(ASTNodePtr&)> visit = [&](ASTNodePtr& node) {
+        if (!node) return;
+        auto newExpr = std::dynamic_pointer_cast<NewExpressionNode>(node);
+        if (newExpr && !newExpr->reusedLocal.empty()) {
+            std::string element = toJavaType(TypeChecker::normalizeType(newExpr->typeName));
+            writer->writeLine(element, "[] ", newExpr->reusedLocal, " = new ", element, "[0];");
+        }
+        auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(node);
+        std::string container = varDecl ? RuntimeLibrary::containerClass(varDecl->type) : "";
+        if (!container.empty() && !varDecl->reusedLocal.empty()) {
+            writer->writeLine(container, ' ', varDecl->reusedLocal, " = new ", container, "();");
+        }
+        ASTUtils::forEachChild(node, visit);
+    };
+    ASTNodePtr root = body;
+    visit(root);
+}
+
+void JavaEmitter::emitOffsetHolder(const ASTNodePtr& body, const std::string& name) {
+    bool returnsOffset = currentFunction && offsetReturning.count(ASTUtils::rootVariable(currentFunction->functionName));
+    offsetHolder = callsAnyOf(body, offsetReturning, returnsOffset) ? name : "";
+    if (!offsetHolder.empty()) writer->writeLine("final int[] ", name, " = new int[1];");
 }
 
 void JavaEmitter::emitReturn(const ASTNodePtr& node) {
     if (!node) return;
 
     auto returnStmt = std::dynamic_pointer_cast<ReturnStatementNode>(node);
-    if (!returnStmt || !returnStmt->expression) return;
+    if (!returnStmt) return;
 
-    writer.write("return " + returnStmt->expression->toString() + ";");
+    if (!returnStmt->expression) {
+        writer->write("return;");
+        return;
+    }
+    bool returnsOffset = currentFunction && offsetReturning.count(ASTUtils::rootVariable(currentFunction->functionName));
+    if (returnsOffset && offsetReturning.count(ASTUtils::calleeName(returnStmt->expression))) {
+        // The callee stores the offset straight into this function's caller's holder
+        std::string enclosingHolder = offsetHolder;
+        offsetHolder = "result$off";
+        writer->append("return ");
+        writeExpression(returnStmt->expression);
+        writer->writeLine(';');
+        offsetHolder = enclosingHolder;
+        return;
+    }
+    std::string base, offset;
+    if (TypeChecker::isPointerType(currentReturnType) && pointerParts(returnStmt->expression, base, offset)) {
+        if (returnsOffset) {
+            // A call in the array part runs before its offset is read
+            if (base.find('(') != std::string::npos) {
+                writer->writeLine("final ", toJavaType(currentReturnType), " result$ = ", base, ';');
+                base = "result$";
+            }
+            writer->writeLine("result$off[0] = ", offset, ';');
+        }
+        writer->writeLine("return ", base, ';');
+        return;
+    }
+    writer->append("return ");
+    writeConverted(returnStmt->expression, currentReturnType, 0, true);
+    writer->writeLine(';');
 }
 
 void JavaEmitter::emitBinaryExpression(const ASTNodePtr& node) {
@@ -60,17 +2365,14 @@ void JavaEmitter::emitBinaryExpression(const ASTNodePtr& node) {
     auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node);
     if (!binExpr) return;
 
-    std::string left = binExpr->left->toString();
-    std::string op = binExpr->op;
-    std::string right = binExpr->right->toString();
-
-    writer.write(left + " " + op + " " + right + ";");
+    writeExpression(binExpr);
+    writer->writeLine(';');
 }
 
 void JavaEmitter::emitExpression(const ASTNodePtr& node) {
     if (!node) return;
 
-    writer.write(node->toString() + ";");
+    writeStatement(node);
 }
 
 void JavaEmitter::emitFunctionCall(const ASTNodePtr& node) {
@@ -79,14 +2381,28 @@ void JavaEmitter::emitFunctionCall(const ASTNodePtr& node) {
     auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node);
     if (!funcCall) return;
 
-    std::string funcName = std::dynamic_pointer_cast<IdentifierNode>(funcCall->functionName)->name;
-    std::string args;
-    for (size_t i = 0; i < funcCall->arguments.size(); ++i) {
-        args += funcCall->arguments[i]->toString();
-        if (i < funcCall->arguments.size() - 1) args += ", ";
+    writeStatement(funcCall);
+}
+
+void JavaEmitter::writeStatement(const ASTNodePtr& node) const {
+    auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node);
+    auto access = funcCall ? std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName) : nullptr;
+    if (access && access->member.rfind("compare_exchange_", 0) == 0) {
+        writer->writeLine(statementToJava(node), ';');
+        return;
     }
+    writeExpression(node);
+    writer->writeLine(';');
+}
 
-    writer.write(funcName + "(" + args + ");");
+std::string JavaEmitter::statementToJava(const ASTNodePtr& node) const {
+    // A compare-exchange whose result is unused only updates `expected`; the comparison is not a Java statement
+    auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node);
+    auto access = funcCall ? std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName) : nullptr;
+    if (access && access->member.rfind("compare_exchange_", 0) == 0 && !atomicClassOf(access->object).empty()) {
+        return atomicCallToJava(funcCall, access, TypeChecker::inferType(access->object, symbols), false);
+    }
+    return expressionToJava(node);
 }
 
 void JavaEmitter::emitIfStatement(const ASTNodePtr& node) {
@@ -95,14 +2411,16 @@ void JavaEmitter::emitIfStatement(const ASTNodePtr& node) {
     auto ifStmt = std::dynamic_pointer_cast<IfStatementNode>(node);
     if (!ifStmt) return;
 
-    writer.write("if (" + ifStmt->condition->toString() + ") {");
+    writer->append("if (");
+    writeCondition(ifStmt->condition);
+    writer->writeLine(") {");
     emitBlock(ifStmt->thenBlock);
-    writer.write("}");
+    writer->write("}");
 
     if (ifStmt->elseBlock) {
-        writer.write("else {");
+        writer->write("else {");
         emitBlock(ifStmt->elseBlock);
-        writer.write("}");
+        writer->write("}");
     }
 }
 
@@ -112,9 +2430,807 @@ void JavaEmitter::emitWhileLoop(const ASTNodePtr& node) {
     auto whileLoop = std::dynamic_pointer_cast<WhileLoopNode>(node);
     if (!whileLoop) return;
 
-    writer.write("while (" + whileLoop->condition->toString() + ") {");
+    std::string label = whileLoop->label.empty() ? "" : whileLoop->label + ": ";
+    writer->append(label, "while (");
+    writeCondition(whileLoop->condition);
+    writer->writeLine(") {");
     emitBlock(whileLoop->body);
-    writer.write("}");
+    writer->write("}");
+}
+
+void JavaEmitter::emitForLoop(const ASTNodePtr& node) {
+    auto forLoop = std::dynamic_pointer_cast<ForLoopNode>(node);
+    if (!forLoop) return;
+    if (forLoop->parallel && emitParallelFor(forLoop)) return;
+
+    // The scalar loop stays as the fallback when the vector module is missing or arrays overlap
+    std::string vectorCondition, vectorCall;
+    bool vectorized = vectorize && !(currentFunction && currentFunction->cold) &&
+                      vectorLoopToJava(forLoop, vectorCondition, vectorCall);
+    if (vectorized) {
+        writer->writeLine("if (", vectorCondition, ") {");
+        writer->write(vectorCall);
+        writer->write("} else {");
+    }
+
+    // Variables declared in the header are scoped to the loop
+    SymbolTable enclosingSymbols = symbols;
+    std::string init;
+    bool wrapped = !forInitializerToJava(forLoop->initializers, init);
+    if (wrapped) {
+        // Pointers, containers and mixed types are declared in a block around the loop instead
+        writer->write("{");
+        for (const auto& stmt : forLoop->initializers) emitStatement(stmt);
+    }
+
+    std::string condition = forLoop->condition ? " " + conditionToJava(forLoop->condition) : "";
+    std::string increments;
+    for (const auto& increment : forLoop->increments) {
+        increments += (increments.empty() ? " " : ", ") + statementToJava(increment);
+    }
+    std::string label = forLoop->label.empty() ? "" : forLoop->label + ": ";
+    writer->writeLine(label, "for (", init, ';', condition, ';', increments, ") {");
+    emitBlock(forLoop->body);
+    writer->write("}");
+
+    if (wrapped) writer->write("}");
+    if (vectorized) writer->write("}");
+    symbols = enclosingSymbols;
+}
+
+// C++ and Java switches share fallthrough and `break`, so the clauses are
+// emitted as written and javac picks tableswitch or lookupswitch. Java only
+// switches on int-sized values; a 64-bit selector is narrowed first.
+void JavaEmitter::emitSwitch(const ASTNodePtr& node) {
+    auto switchStmt = std::dynamic_pointer_cast<SwitchStatementNode>(node);
+    if (!switchStmt) return;
+
+    std::string type = typeOf(switchStmt->expression);
+    if (!type.empty()) type = TypeChecker::promote(type);
+    std::vector<std::string> labels;
+    for (const auto& clause : switchStmt->cases) {
+        const ASTNodePtr& value = std::static_pointer_cast<CaseClauseNode>(clause)->value;
+        if (!value || type.empty()) {
+            labels.push_back(value ? expressionToJava(value) : "");
+        } else if (typeOf(value) == "unsigned char") {
+            // Byte.toUnsignedInt is not a constant expression, the mask is
+            labels.push_back(operandToJava(value, javaPrecedence("&")) + " & 0xFF");
+        } else {
+            labels.push_back(convertedToJava(value, type));
+        }
+    }
+
+    std::string selector = type.empty() ? expressionToJava(switchStmt->expression)
+                                        : convertedToJava(switchStmt->expression, type);
+    if (TypeChecker::bitWidth(type) == 64) {
+        // Label values known here: integer literals and enumerators with constant values
+        std::vector<long long> values(labels.size());
+        bool constantLabels = true, intLabels = true;
+        std::string table;
+        for (size_t i = 0; i < labels.size() && constantLabels; ++i) {
+            const ASTNodePtr& value = std::static_pointer_cast<CaseClauseNode>(switchStmt->cases[i])->value;
+            if (!value) continue;
+            auto number = std::dynamic_pointer_cast<NumberNode>(value);
+            auto identifier = std::dynamic_pointer_cast<IdentifierNode>(value);
+            auto enumerator = identifier ? enumValues.find(identifier->name) : enumValues.end();
+            if (number && std::floor(number->value) == number->value && std::fabs(number->value) <= 2147483647.0) {
+                values[i] = static_cast<long long>(number->value);
+                table = "-";  // A literal has no index in an enum's table
+            } else if (enumerator != enumValues.end()) {
+                values[i] = enumerator->second.value;
+                if (table.empty()) table = enumerator->second.table;
+                else if (table != enumerator->second.table) table = "-";
+            } else {
+                constantLabels = false;
+            }
+            intLabels = intLabels && values[i] == static_cast<int32_t>(values[i]);
+        }
+
+        if (constantLabels && intLabels) {
+            // Labels that fit an int keep their values: values outside the int range
+            // go to a sentinel no label uses
+            std::string temp = "sw$" + std::to_string(switchCount++);
+            writer->writeLine("final long ", temp, " = ", selector, ';');
+            std::set<long long> used(values.begin(), values.end());
+            long long sentinel = -2147483648LL;
+            while (used.count(sentinel)) sentinel++;
+            selector = "(int) " + temp + " == " + temp + " ? (int) " + temp + " : " +
+                       (sentinel == -2147483648LL ? "Integer.MIN_VALUE" : std::to_string(sentinel));
+            for (size_t i = 0; i < labels.size(); ++i) {
+                const ASTNodePtr& value = std::static_pointer_cast<CaseClauseNode>(switchStmt->cases[i])->value;
+                if (!value) continue;
+                // Enumerators stay named: a cast constant is still a constant expression
+                labels[i] = value->type == NodeType::NUMBER_LITERAL ? std::to_string(values[i]) : "(int) " + labels[i];
+            }
+        } else if (constantLabels && !table.empty() && table != "-") {
+            // Enumerators past the int range: the selector's index in the enum's sorted
+            // table, negative when absent, is the int to switch on
+            const std::vector<long long>& sorted = enumTables[table];
+            selector = "java.util.Arrays.binarySearch(" + table + ", " + selector + ")";
+            for (size_t i = 0; i < labels.size(); ++i) {
+                if (labels[i].empty()) continue;
+                labels[i] = std::to_string(std::lower_bound(sorted.begin(), sorted.end(), values[i]) - sorted.begin());
+            }
+        } else {
+            // Otherwise each label maps to its position
+            std::string temp = "sw$" + std::to_string(switchCount++);
+            writer->writeLine("final long ", temp, " = ", selector, ';');
+            selector.clear();
+            for (size_t i = 0; i < labels.size(); ++i) {
+                if (labels[i].empty()) continue;
+                selector += temp + " == " + labels[i] + " ? " + std::to_string(i) + " : ";
+                labels[i] = std::to_string(i);
+            }
+            selector += "-1";
+        }
+    }
+
+    writer->writeLine("switch (", selector, ") {");
+    for (size_t i = 0; i < switchStmt->cases.size(); ++i) {
+        if (labels[i].empty()) writer->write("default:");
+        else writer->writeLine("case ", labels[i], ':');
+        writer->indent();
+        emitBlock(std::static_pointer_cast<CaseClauseNode>(switchStmt->cases[i])->body);
+        writer->dedent();
+    }
+    writer->write("}");
+}
+
+// `for (int i = a; i < b; ++i)` becomes Parallel.forRange(a, b, (lo$N, hi$N) -> ...)
+// running the same loop over each chunk [lo, hi). A reduction variable gets a
+// private partial per chunk, initialised to the operator's identity; the
+// partials are combined and folded into the variable after the loop, as
+// OpenMP does. Locals the body reads but the function reassigns are copied
+// into finals first, since a lambda only captures effectively final locals.
+bool JavaEmitter::emitParallelFor(const std::shared_ptr<ForLoopNode>& forLoop) {
+    std::string functionName = currentFunction ? ASTUtils::rootVariable(currentFunction->functionName) : "";
+    auto serial = [&](const std::string& reason) {
+        ErrorHandler::reportWarning("Parallel loop in '" + functionName + "' emitted serially: " + reason + ".");
+        return false;
+    };
+    if (!currentFunction) return serial("not inside a function");
+
+    // Canonical OpenMP loop: one int induction variable counting up by one to an exclusive bound
+    auto induction = forLoop->initializers.size() == 1
+                         ? std::dynamic_pointer_cast<VariableDeclarationNode>(forLoop->initializers[0]) : nullptr;
+    auto condition = std::dynamic_pointer_cast<BinaryExpressionNode>(forLoop->condition);
+    std::string var = induction ? ASTUtils::rootVariable(induction->identifier) : "";
+    if (!induction || !induction->initializer || !induction->arraySizes.empty() ||
+        TypeChecker::normalizeType(resolvedType(induction)) != "int") {
+        return serial("the loop does not declare one int induction variable");
+    }
+    if (!condition || (condition->op != "<" && condition->op != "<=") || condition->left->type != NodeType::IDENTIFIER ||
+        std::static_pointer_cast<IdentifierNode>(condition->left)->name != var) {
+        return serial("the condition is not '" + var + " < bound'");
+    }
+    auto increment = forLoop->increments.size() == 1 ? forLoop->increments[0] : nullptr;
+    if (!isUnitStep(increment, var)) {
+        return serial("the increment is not '++" + var + "'");
+    }
+    if (!forLoop->label.empty() || leavesBody(forLoop->body, false)) {
+        return serial("the body can leave the loop");
+    }
+
+    std::unordered_set<std::string> bodyWrites, reassigned = reassignedLocals();
+    collectReassigned(forLoop->body, bodyWrites);
+    for (auto it = bodyWrites.begin(); it != bodyWrites.end();) {
+        it = atomicClassOf(std::make_shared<IdentifierNode>(*it)).empty() ? std::next(it) : bodyWrites.erase(it);
+    }
+    if (bodyWrites.count(var)) return serial("the body assigns '" + var + "'");
+
+    // At most one reduction variable, of an int, long or double type
+    std::string reductionVar, op, javaType;
+    for (const auto& reduction : forLoop->reductions) {
+        if (!reductionVar.empty() && reduction.second != reductionVar) return serial("it reduces more than one variable");
+        reductionVar = reduction.second;
+        op = reduction.first == "-" ? "+" : reduction.first;  // OpenMP combines `-` partials by adding them
+    }
+    std::string reductionType = reductionVar.empty() ? "" : TypeChecker::normalizeType(typeOf(
+        std::make_shared<IdentifierNode>(reductionVar)));
+    if (!reductionVar.empty()) {
+        javaType = toJavaType(reductionType);
+        static const std::unordered_set<std::string> integerOps = {"+", "*", "&", "|", "^", "min", "max"};
+        bool isDouble = javaType == "double";
+        if (javaType != "int" && javaType != "long" && !isDouble) {
+            return serial("'" + reductionVar + "' is not an int, long or double");
+        }
+        if (!integerOps.count(op) || (isDouble && (op == "&" || op == "|" || op == "^"))) {
+            return serial("'" + op + "' is not a reduction of " + javaType);
+        }
+        if ((op == "min" || op == "max") && reductionType.rfind("unsigned", 0) == 0) {
+            return serial("min and max of unsigned values have no Java counterpart");
+        }
+    }
+
+    // Captured locals: those the function reassigns are copied, unless the body writes them
+    std::unordered_set<std::string> locals, declared, captured;
+    for (const auto& param : currentFunction->parameters) locals.insert(ASTUtils::rootVariable(param));
+    ASTUtils::collectDeclarations(currentFunction->body, locals);
+    ASTUtils::collectDeclarations(forLoop->body, declared);
+    collectNames(forLoop->body, captured);
+    std::vector<std::string> copies;
+    for (const auto& name : captured) {
+        if (!locals.count(name) || declared.count(name) || name == var || name == reductionVar || !reassigned.count(name)) {
+            continue;
+        }
+        if (bodyWrites.count(name)) return serial("the body assigns the shared local '" + name + "'");
+        std::string type = TypeChecker::normalizeType(typeOf(std::make_shared<IdentifierNode>(name)));
+        if (!TypeChecker::isArithmeticType(type) || stringBuilders.count(name)) {
+            return serial("the body reads '" + name + "', which is reassigned");
+        }
+        copies.push_back(name);
+    }
+    std::sort(copies.begin(), copies.end());
+
+    std::unordered_map<std::string, std::string> enclosingRenamed = renamedLocals;
+    for (const auto& name : copies) {
+        std::string type = TypeChecker::normalizeType(typeOf(std::make_shared<IdentifierNode>(name)));
+        writer->writeLine("final ", toJavaType(type), ' ', name, "$final = ",
+                         expressionToJava(std::make_shared<IdentifierNode>(name)), ';');
+        renamedLocals[name] = name + "$final";
+    }
+
+    std::string id = std::to_string(parallelCount++);
+    std::string lo = "lo$" + id, hi = "hi$" + id;
+    std::string from = convertedToJava(induction->initializer, "int");
+    std::string to = condition->op == "<" ? convertedToJava(condition->right, "int")
+                                          : convertedToJava(condition->right, "int", javaPrecedence("+")) + " + 1";
+    runtimeClasses.insert("Parallel");
+
+    std::string identity, combine, partial = reductionVar + "$part", total = reductionVar + "$total";
+    if (!reductionVar.empty()) {
+        std::string boxed = boxedType(javaType);
+        std::string suffix = javaType == "long" ? "L" : javaType == "double" ? ".0" : "";
+        std::string limits = javaType == "double" ? "" : boxed;
+        if (op == "+" || op == "|" || op == "^") identity = "0" + suffix;
+        else if (op == "*") identity = "1" + suffix;
+        else if (op == "&") identity = "-1" + suffix;
+        else if (op == "min") identity = javaType == "double" ? "Double.POSITIVE_INFINITY" : limits + ".MAX_VALUE";
+        else identity = javaType == "double" ? "Double.NEGATIVE_INFINITY" : limits + ".MIN_VALUE";
+        combine = op == "+" ? boxed + "::sum" : (op == "min" || op == "max") ? "Math::" + op : "(x$, y$) -> x$ " + op + " y$";
+
+        std::string method = "reduce" + std::string(1, static_cast<char>(toupper(javaType[0]))) + javaType.substr(1);
+        writer->writeLine("final ", javaType, ' ', total, " = Parallel.", method, '(', from, ", ", to, ", ",
+                         identity, ", (", lo, ", ", hi, ") -> {");
+        writer->writeLine(javaType, ' ', partial, " = ", identity, ';');
+        renamedLocals[reductionVar] = partial;
+    } else {
+        writer->writeLine("Parallel.forRange(", from, ", ", to, ", (", lo, ", ", hi, ") -> {");
+    }
+
+    // Chunks run at once, so each needs its own holder for returned offsets
+    std::string enclosingHolder = offsetHolder;
+    emitOffsetHolder(forLoop->body, "call$off$" + id);
+    SymbolTable enclosingSymbols = symbols;
+    symbols.addSymbol(var, resolvedType(induction));
+    std::string increments = expressionToJava(increment);
+    writer->writeLine("for (int ", var, " = ", lo, "; ", var, " < ", hi, "; ", increments, ") {");
+    emitBlock(forLoop->body);
+    writer->write("}");
+    symbols = enclosingSymbols;
+    renamedLocals = enclosingRenamed;
+    offsetHolder = enclosingHolder;
+
+    if (reductionVar.empty()) {
+        writer->write("});");
+        return true;
+    }
+    writer->writeLine("return ", partial, ';');
+    writer->writeLine("}, ", combine, ");");
+    std::string target = expressionToJava(std::make_shared<IdentifierNode>(reductionVar));
+    if (op == "min" || op == "max") {
+        writer->writeLine(target, " = Math.", op, '(', target, ", ", total, ");");
+    } else {
+        writer->writeLine(target, ' ', op, "= ", total, ';');
+    }
+    return true;
+}
+
+std::unordered_set<std::string> JavaEmitter::reassignedLocals() const {
+    std::unordered_set<std::string> names;
+    if (currentFunction) collectReassigned(currentFunction->body, names);
+    // Stores to an atomic go through its object, which itself stays put
+    for (auto it = names.begin(); it != names.end();) {
+        it = atomicClassOf(std::make_shared<IdentifierNode>(*it)).empty() ? std::next(it) : names.erase(it);
+    }
+    return names;
+}
+
+// What the rendering of a loop being vectorised needs to know
+struct JavaEmitter::VectorLoop {
+    std::string var;          // Induction variable
+    std::string element;      // float or double
+    std::string vectorClass;  // jdk.incubator.vector.FloatVector or DoubleVector
+    std::string species;      // FLOATS or DOUBLES, constants of the Vectorized class
+    std::string reduction;    // Variable accumulated with `+=`, "" if none
+    std::unordered_map<std::string, std::string> offsets;  // Array -> its offset parameter in the kernel, "" if none
+};
+
+bool JavaEmitter::isLoopInvariant(const ASTNodePtr& node, const VectorLoop& loop) const {
+    if (!node) return false;
+    switch (node->type) {
+        case NodeType::NUMBER_LITERAL:
+            return true;
+        case NodeType::IDENTIFIER: {
+            const std::string& name = std::static_pointer_cast<IdentifierNode>(node)->name;
+            return name != loop.var && name != loop.reduction && !loop.offsets.count(name) &&
+                   TypeChecker::isArithmeticType(TypeChecker::normalizeType(typeOf(node)));
+        }
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+            bool arithmetic = binExpr->op == "+" || binExpr->op == "-" || binExpr->op == "*" || binExpr->op == "/";
+            return arithmetic && isLoopInvariant(binExpr->left, loop) && isLoopInvariant(binExpr->right, loop);
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            return unaryExpr->prefix && (unaryExpr->op == "-" || unaryExpr->op == "+") &&
+                   isLoopInvariant(unaryExpr->operand, loop);
+        }
+        case NodeType::FUNCTION_CALL: {
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
+            return !laneFunction(ASTUtils::calleeName(node)).empty() && funcCall->arguments.size() == 1 &&
+                   isLoopInvariant(funcCall->arguments[0], loop);
+        }
+        default:
+            return false;
+    }
+}
+
+std::string JavaEmitter::laneScalarToJava(const ASTNodePtr& node, const VectorLoop& loop) const {
+    std::string type = TypeChecker::normalizeType(typeOf(node));
+    if (type != loop.element && !TypeChecker::isIntegralType(type)) return "";
+    return convertedToJava(node, loop.element);
+}
+
+std::string JavaEmitter::lanesToJava(const ASTNodePtr& node, const VectorLoop& loop) const {
+    if (!node) return "";
+    if (isLoopInvariant(node, loop)) {
+        std::string value = laneScalarToJava(node, loop);
+        return value.empty() ? "" : loop.vectorClass + ".broadcast(" + loop.species + ", " + value + ")";
+    }
+
+    switch (node->type) {
+        case NodeType::ARRAY_ACCESS: {
+            auto access = std::static_pointer_cast<ArrayAccessNode>(node);
+            auto array = std::dynamic_pointer_cast<IdentifierNode>(access->array);
+            auto index = std::dynamic_pointer_cast<IdentifierNode>(access->index);
+            auto offset = array ? loop.offsets.find(array->name) : loop.offsets.end();
+            if (offset == loop.offsets.end() || !index || index->name != loop.var) return "";
+            std::string position = offset->second.empty() ? loop.var : offset->second + " + " + loop.var;
+            return loop.vectorClass + ".fromArray(" + loop.species + ", " + array->name + ", " + position + ")";
+        }
+        case NodeType::BINARY_EXPRESSION: {
+            static const std::unordered_map<std::string, std::string> methods = {
+                {"+", "add"}, {"-", "sub"}, {"*", "mul"}, {"/", "div"}
+            };
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+            auto method = methods.find(binExpr->op);
+            if (method == methods.end()) return "";
+            // An invariant operand is passed as a scalar when it is on the right, or the operator commutes
+            ASTNodePtr lanes = binExpr->left, operand = binExpr->right;
+            if ((binExpr->op == "+" || binExpr->op == "*") && isLoopInvariant(lanes, loop)) std::swap(lanes, operand);
+            std::string left = lanesToJava(lanes, loop);
+            std::string right = isLoopInvariant(operand, loop) ? laneScalarToJava(operand, loop) : lanesToJava(operand, loop);
+            if (left.empty() || right.empty()) return "";
+            return left + "." + method->second + "(" + right + ")";
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            if (!unaryExpr->prefix || (unaryExpr->op != "-" && unaryExpr->op != "+")) return "";
+            std::string operand = lanesToJava(unaryExpr->operand, loop);
+            return operand.empty() || unaryExpr->op == "+" ? operand : operand + ".neg()";
+        }
+        case NodeType::FUNCTION_CALL: {
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
+            std::string function = laneFunction(ASTUtils::calleeName(node));
+            if (function.empty() || funcCall->arguments.size() != 1) return "";
+            std::string argument = lanesToJava(funcCall->arguments[0], loop);
+            return argument.empty() ? "" : argument + function;
+        }
+        default:
+            return "";
+    }
+}
+
+// The kernel takes the iteration range and every variable the body reads as
+// parameters, pointers as array and offset. It runs whole vectors of
+// SPECIES_PREFERRED lanes, then the remaining iterations one by one. C++
+// pointers may overlap, so the kernel only runs when each array it stores to
+// is either a different array from the others or indexed at the same offset.
+bool JavaEmitter::vectorLoopToJava(const std::shared_ptr<ForLoopNode>& forLoop, std::string& condition, std::string& call) {
+    if (!currentFunction || !forLoop->label.empty()) return false;
+
+    // for (int i = from; i < bound; ++i), with bounds the body cannot change
+    VectorLoop loop;
+    auto induction = forLoop->initializers.size() == 1
+                         ? std::dynamic_pointer_cast<VariableDeclarationNode>(forLoop->initializers[0]) : nullptr;
+    auto test = std::dynamic_pointer_cast<BinaryExpressionNode>(forLoop->condition);
+    loop.var = induction ? ASTUtils::rootVariable(induction->identifier) : "";
+    if (!induction || !induction->initializer || !induction->arraySizes.empty() ||
+        TypeChecker::normalizeType(resolvedType(induction)) != "int" ||
+        !test || (test->op != "<" && test->op != "<=") || ASTUtils::rootVariable(test->left) != loop.var ||
+        test->left->type != NodeType::IDENTIFIER || forLoop->increments.size() != 1 ||
+        !isUnitStep(forLoop->increments[0], loop.var)) {
+        return false;
+    }
+
+    // Each statement stores to `a[i]`, or is the one `s += ...` reduction
+    std::vector<ASTNodePtr> statements;
+    if (auto block = std::dynamic_pointer_cast<BlockNode>(forLoop->body)) statements = block->statements;
+    else if (forLoop->body) statements.push_back(forLoop->body);
+    if (statements.empty()) return false;
+    std::vector<std::string> operands;
+    std::unordered_set<std::string> stored;
+    for (const auto& stmt : statements) {
+        auto assignment = std::dynamic_pointer_cast<BinaryExpressionNode>(stmt);
+        if (!assignment || (assignment->op != "=" && assignment->op != "+=" && assignment->op != "-=" &&
+                            assignment->op != "*=" && assignment->op != "/=")) {
+            return false;
+        }
+        if (assignment->left->type == NodeType::IDENTIFIER) {
+            if (assignment->op != "+=" || !loop.reduction.empty()) return false;
+            loop.reduction = std::static_pointer_cast<IdentifierNode>(assignment->left)->name;
+        } else if (assignment->left->type == NodeType::ARRAY_ACCESS) {
+            stored.insert(ASTUtils::rootVariable(assignment->left));
+        } else {
+            return false;
+        }
+        collectOperands(stmt, operands);
+    }
+
+    // All arrays share one element type, float or double
+    std::vector<std::string> arrays;
+    for (const auto& name : operands) {
+        std::string type = TypeChecker::normalizeType(typeOf(std::make_shared<IdentifierNode>(name)));
+        std::string container = RuntimeLibrary::containerClass(type);
+        std::string element = TypeChecker::isPointerType(type) ? TypeChecker::normalizeType(TypeChecker::elementType(type))
+                            : container == "FloatVector" ? "float" : container == "DoubleVector" ? "double" : "";
+        if (name == loop.var || name == loop.reduction || (element.empty() && container.empty())) continue;
+        if ((element != "float" && element != "double") || (!loop.element.empty() && element != loop.element)) return false;
+        loop.element = element;
+        loop.offsets[name] = type.back() == '*' ? offsetName(name) : "";
+        arrays.push_back(name);
+    }
+    if (loop.element.empty() || (!loop.reduction.empty() &&
+        TypeChecker::normalizeType(typeOf(std::make_shared<IdentifierNode>(loop.reduction))) != loop.element)) {
+        return false;
+    }
+    loop.vectorClass = loop.element == "float" ? "jdk.incubator.vector.FloatVector" : "jdk.incubator.vector.DoubleVector";
+    loop.species = loop.element == "float" ? "FLOATS" : "DOUBLES";
+
+    auto sizeCall = std::dynamic_pointer_cast<FunctionCallNode>(test->right);
+    auto size = sizeCall ? std::dynamic_pointer_cast<MemberAccessNode>(sizeCall->functionName) : nullptr;
+    bool containerSize = size && size->member == "size" && sizeCall->arguments.empty() &&
+                         loop.offsets.count(ASTUtils::rootVariable(size->object)) && size->object->type == NodeType::IDENTIFIER;
+    if (!isLoopInvariant(induction->initializer, loop) || (!containerSize && !isLoopInvariant(test->right, loop))) {
+        return false;
+    }
+    std::string from = convertedToJava(induction->initializer, "int");
+    std::string to = test->op == "<" ? convertedToJava(test->right, "int")
+                                     : convertedToJava(test->right, "int", javaPrecedence("+")) + " + 1";
+
+    // Call site: the arguments as the enclosing code names them
+    std::string parameters = "int lo$, int hi$", arguments = from + ", " + to;
+    std::unordered_map<std::string, std::pair<std::string, std::string>> storage;  // Array -> (base, offset)
+    for (const auto& name : operands) {
+        auto identifier = std::make_shared<IdentifierNode>(name);
+        std::string type = TypeChecker::normalizeType(typeOf(identifier));
+        if (name == loop.var || name == loop.reduction) continue;
+        auto offset = loop.offsets.find(name);
+        if (offset == loop.offsets.end()) {
+            parameters += ", " + toJavaType(type) + " " + name;
+            arguments += ", " + expressionToJava(identifier);
+            continue;
+        }
+        std::string base, start = "0";
+        if (!RuntimeLibrary::containerClass(type).empty()) base = operandToJava(identifier, 100) + ".data";
+        else if (!pointerParts(identifier, base, start)) return false;
+        storage[name] = {base, start};
+        parameters += ", " + toJavaType(loop.element) + "[] " + name;
+        arguments += ", " + base;
+        if (!offset->second.empty()) {
+            parameters += ", int " + offset->second;
+            arguments += ", " + start;
+        }
+    }
+    condition = "VectorSupport.ENABLED";
+    for (size_t a = 0; a < arrays.size(); ++a) {
+        for (size_t b = a + 1; b < arrays.size(); ++b) {
+            if (!stored.count(arrays[a]) && !stored.count(arrays[b])) continue;
+            const auto& first = storage[arrays[a]];
+            const auto& second = storage[arrays[b]];
+            if (first.second == "0" && second.second == "0") continue;  // Same element even if the same array
+            condition += " && (" + first.first + " != " + second.first + " || " + first.second + " == " + second.second + ")";
+        }
+    }
+
+    // Kernel body: within it, arrays are parameters and no local is renamed
+    SymbolTable enclosingSymbols = symbols;
+    std::unordered_map<std::string, std::string> enclosingRenamed = renamedLocals;
+    renamedLocals.clear();
+    for (const auto& array : arrays) symbols.addSymbol(array, loop.element + (loop.offsets[array].empty() ? "[]" : "*"));
+    symbols.addSymbol(loop.var, "int");
+    std::vector<std::string> lanes, tail;
+    for (const auto& stmt : statements) {
+        auto assignment = std::static_pointer_cast<BinaryExpressionNode>(stmt);
+        std::string value;
+        if (assignment->left->type == NodeType::IDENTIFIER) {
+            value = lanesToJava(assignment->right, loop);
+            if (!value.empty()) lanes.push_back(loop.reduction + "$lanes = " + loop.reduction + "$lanes.add(" + value + ");");
+        } else {
+            auto target = std::make_shared<BinaryExpressionNode>(assignment->left, assignment->op.substr(0, 1), assignment->right);
+            value = lanesToJava(assignment->op == "=" ? assignment->right : target, loop);
+            std::string array = ASTUtils::rootVariable(assignment->left);
+            std::string position = loop.offsets[array].empty() ? loop.var : loop.offsets[array] + " + " + loop.var;
+            if (!value.empty()) lanes.push_back(value + ".intoArray(" + array + ", " + position + ");");
+        }
+        if (value.empty()) break;
+        tail.push_back(expressionToJava(stmt) + ";");
+    }
+    std::string step = expressionToJava(forLoop->increments[0]);
+    symbols = enclosingSymbols;
+    renamedLocals = enclosingRenamed;
+    if (lanes.size() != statements.size()) return false;
+
+    std::string name = ASTUtils::rootVariable(currentFunction->functionName);
+    auto overload = overloads.find(currentFunction.get());
+    if (overload != overloads.end()) name += "$" + std::to_string(overload->second);
+    name += "$loop" + std::to_string(vectorLoopCount++);
+    std::string javaType = toJavaType(loop.element);
+    std::vector<std::string>& kernel = vectorKernels;
+    kernel.push_back("static " + (loop.reduction.empty() ? "void" : javaType) + " " + name + "(" + parameters + ") {");
+    if (!loop.reduction.empty()) {
+        kernel.push_back(loop.vectorClass + " " + loop.reduction + "$lanes = " + loop.vectorClass + ".zero(" + loop.species + ");");
+    }
+    kernel.push_back("int " + loop.var + " = lo$;");
+    kernel.push_back("for (int upper$ = lo$ + " + loop.species + ".loopBound(hi$ - lo$); " + loop.var + " < upper$; " +
+                     loop.var + " += " + loop.species + ".length()) {");
+    kernel.insert(kernel.end(), lanes.begin(), lanes.end());
+    kernel.push_back("}");
+    if (!loop.reduction.empty()) {
+        kernel.push_back(javaType + " " + loop.reduction + " = " + loop.reduction +
+                         "$lanes.reduceLanes(jdk.incubator.vector.VectorOperators.ADD);");
+    }
+    kernel.push_back("for (; " + loop.var + " < hi$; " + step + ") {");
+    kernel.insert(kernel.end(), tail.begin(), tail.end());
+    kernel.push_back("}");
+    if (!loop.reduction.empty()) kernel.push_back("return " + loop.reduction + ";");
+    kernel.push_back("}");
+
+    vectorElements.insert(loop.element);
+    runtimeClasses.insert("VectorSupport");
+    call = "Vectorized." + name + "(" + arguments + ");";
+    if (!loop.reduction.empty()) call = expressionToJava(std::make_shared<IdentifierNode>(loop.reduction)) + " += " + call;
+    return true;
+}
+
+bool JavaEmitter::emitTaskDeclaration(const std::shared_ptr<VariableDeclarationNode>& varDecl, const std::string& type) {
+    std::string normalized = TypeChecker::normalizeType(type);
+    bool isThread = normalized == "std::thread";
+    std::vector<ASTNodePtr> arguments;
+    if (isThread) {
+        arguments = varDecl->constructorArguments;
+    } else if (TypeChecker::templateName(normalized) == "future") {
+        auto call = std::dynamic_pointer_cast<FunctionCallNode>(varDecl->initializer);
+        std::string callee = call ? ASTUtils::calleeName(call) : "";
+        if (callee != "std::async" && callee != "async") return false;
+        arguments = call->arguments;
+        // The launch policy only decides when the task runs; every task goes to the executor
+        if (!arguments.empty() && arguments[0]->type == NodeType::IDENTIFIER &&
+            std::static_pointer_cast<IdentifierNode>(arguments[0])->name.find("launch::") != std::string::npos) {
+            arguments.erase(arguments.begin());
+        }
+    } else {
+        return false;
+    }
+
+    std::string name = ASTUtils::rootVariable(varDecl->identifier);
+    auto function = arguments.empty() ? nullptr : std::dynamic_pointer_cast<IdentifierNode>(arguments[0]);
+    auto parameters = function ? functionParameterTypes.find(function->name) : functionParameterTypes.end();
+    if (parameters == functionParameterTypes.end() || parameters->second.size() != arguments.size() - 1) {
+        ErrorHandler::reportWarning("Cannot start '" + varDecl->toString() +
+                                    "' as a task: the callable must be a function of the program.");
+        return false;
+    }
+
+    // C++ copies the arguments when the task starts; the lambda may only capture
+    // effectively final locals, so other arguments are evaluated into finals first
+    std::unordered_set<std::string> reassigned = reassignedLocals();
+    std::vector<ASTNodePtr> callArguments;
+    for (size_t i = 1; i < arguments.size(); ++i) {
+        const ASTNodePtr& argument = arguments[i];
+        std::string parameterType = TypeChecker::normalizeType(parameters->second[i - 1]);
+        bool literal = argument->type == NodeType::NUMBER_LITERAL || argument->type == NodeType::CHAR_LITERAL ||
+                       argument->type == NodeType::STRING_LITERAL;
+        bool stable = argument->type == NodeType::IDENTIFIER &&
+                      !reassigned.count(std::static_pointer_cast<IdentifierNode>(argument)->name);
+        if (literal || stable || !TypeChecker::isArithmeticType(parameterType)) {
+            callArguments.push_back(argument);
+            continue;
+        }
+        std::string temp = name + "$arg" + std::to_string(i - 1);
+        writer->writeLine("final ", toJavaType(parameterType), ' ', temp, " = ",
+                         convertedToJava(argument, parameterType), ';');
+        symbols.addSymbol(temp, parameterType);
+        callArguments.push_back(std::make_shared<IdentifierNode>(temp));
+    }
+    auto call = std::make_shared<FunctionCallNode>(function, callArguments);
+
+    runtimeClasses.insert("Parallel");
+    symbols.addSymbol(name, normalized);
+    std::string declaration = toJavaType(normalized) + " " + name + " = ";
+    if (isThread) {
+        writer->writeLine(declaration, "Parallel.start(() -> ", expressionToJava(call), ");");
+        return true;
+    }
+
+    std::vector<std::string> result = TypeChecker::templateArguments(normalized);
+    std::string returnType = TypeChecker::normalizeType(symbols.getType(function->name));
+    if (returnType == "void" || result.empty()) {
+        writer->writeLine(declaration, "java.util.concurrent.CompletableFuture.runAsync(() -> ",
+                         expressionToJava(call), ", Parallel.EXECUTOR);");
+        return true;
+    }
+    // The supplier's value must box to the future's type argument: widen it explicitly
+    std::string value = convertedToJava(call, result[0]);
+    if (value == expressionToJava(call) && toJavaType(result[0]) != toJavaType(returnType)) {
+        value = "(" + toJavaType(result[0]) + ") " + value;
+    }
+    writer->writeLine(declaration, "java.util.concurrent.CompletableFuture.supplyAsync(() -> ", value,
+                     ", Parallel.EXECUTOR);");
+    return true;
+}
+
+std::string JavaEmitter::atomicClassOf(const ASTNodePtr& node) const {
+    if (!node || (node->type != NodeType::IDENTIFIER && node->type != NodeType::MEMBER_ACCESS)) return "";
+    return RuntimeLibrary::atomicClass(TypeChecker::inferType(node, symbols));
+}
+
+// The object itself: the expression without the implicit get()
+std::string JavaEmitter::atomicObjectToJava(const ASTNodePtr& node) const {
+    std::string load = expressionToJava(node);
+    return load.size() > 6 && load.compare(load.size() - 6, 6, ".get()") == 0 ? load.substr(0, load.size() - 6) : load;
+}
+
+std::string JavaEmitter::atomicCallToJava(const std::shared_ptr<FunctionCallNode>& funcCall,
+                                          const std::shared_ptr<MemberAccessNode>& access,
+                                          const std::string& type, bool resultUsed) const {
+    std::string object = atomicObjectToJava(access->object);
+    std::string value = TypeChecker::valueType(type);
+    const std::vector<ASTNodePtr>& args = funcCall->arguments;
+    const std::string& member = access->member;
+
+    if (member == "load") return object + ".get" + accessMode(memoryOrder(args, 0), "load") + "()";
+    if (member == "store" && !args.empty()) {
+        return object + ".set" + accessMode(memoryOrder(args, 1), "store") + "(" + convertedToJava(args[0], value) + ")";
+    }
+    if (member == "exchange" && !args.empty()) {
+        return object + ".getAndSet" + accessMode(memoryOrder(args, 1), "update") + "(" +
+               convertedToJava(args[0], value) + ")";
+    }
+    static const std::unordered_map<std::string, std::string> fetches = {
+        {"fetch_add", "getAndAdd"}, {"fetch_sub", "getAndAdd"}, {"fetch_and", "getAndBitwiseAnd"},
+        {"fetch_or", "getAndBitwiseOr"}, {"fetch_xor", "getAndBitwiseXor"}
+    };
+    auto fetch = fetches.find(member);
+    if (fetch != fetches.end() && !args.empty()) {
+        std::string operand = member == "fetch_sub" ? "-" + convertedToJava(args[0], value, 100)
+                                                    : convertedToJava(args[0], value);
+        if (operand.rfind("--", 0) == 0) operand = "-(" + operand.substr(1) + ")";
+        return object + "." + fetch->second + accessMode(memoryOrder(args, 1), "update") + "(" + operand + ")";
+    }
+    if (member.rfind("compare_exchange_", 0) == 0 && args.size() >= 2) {
+        // C++ stores the current value into `expected` on failure, which is what assigning the witness does.
+        // The strong exchange also implements the weak one. A release exchange whose failure
+        // order still acquires needs the full volatile mode.
+        std::string mode = accessMode(memoryOrder(args, 2), "update");
+        std::string failure = args.size() >= 4 ? memoryOrder(args, 3) : "relaxed";
+        if (mode == "Release" && failure != "relaxed") mode = "";
+        std::string expected = expressionToJava(args[0]);
+        std::string exchange = expected + " = " + object + ".compareAndExchange" + mode + "(" + expected + ", " +
+                               convertedToJava(args[1], value) + ")";
+        return resultUsed ? "(" + expected + " == (" + exchange + "))" : exchange;
+    }
+    if (member == "is_lock_free") return "true";
+
+    ErrorHandler::reportWarning("'" + member + "' on " + type + " has no lock-free translation; emitted unchanged.");
+    return object + "." + member + "()";
+}
+
+std::string JavaEmitter::atomicUpdateToJava(const ASTNodePtr& target, const std::string& op, const ASTNodePtr& operand) const {
+    std::string object = atomicObjectToJava(target);
+    std::string value = TypeChecker::valueType(TypeChecker::inferType(target, symbols));
+    if (op == "=") return object + ".set(" + convertedToJava(operand, value) + ")";
+
+    static const std::unordered_map<std::string, std::string> updates = {
+        {"+=", "addAndGet"}, {"-=", "addAndGet"}, {"&=", "andAndGet"}, {"|=", "orAndGet"}, {"^=", "xorAndGet"}
+    };
+    auto update = updates.find(op);
+    if (update == updates.end()) {
+        ErrorHandler::reportWarning("std::atomic has no '" + op + "'; emitted as a load and a separate store.");
+        auto combined = std::make_shared<BinaryExpressionNode>(target, op.substr(0, op.size() - 1), operand);
+        return object + ".set(" + convertedToJava(combined, value) + ")";
+    }
+    std::string argument = op == "-=" ? "-" + convertedToJava(operand, value, 100) : convertedToJava(operand, value);
+    if (argument.rfind("--", 0) == 0) argument = "-(" + argument.substr(1) + ")";
+    return object + "." + update->second + "(" + argument + ")";
+}
+
+std::string JavaEmitter::lockCallToJava(const std::shared_ptr<MemberAccessNode>& access, const std::string& type) const {
+    std::string mutex;
+    if (isMutexType(type)) {
+        mutex = operandToJava(access->object, 100);
+    } else if (lockGuardKind(type) == "unique_lock") {
+        auto guard = lockGuards.find(ASTUtils::rootVariable(access->object));
+        if (guard == lockGuards.end()) return "";
+        mutex = guard->second;
+        if (access->member == "owns_lock") return mutex + ".isHeldByCurrentThread()";
+    } else {
+        return "";
+    }
+    if (access->member == "lock" || access->member == "unlock") return mutex + "." + access->member + "()";
+    if (access->member == "try_lock") return mutex + ".tryLock()";
+    return "";
+}
+
+std::string JavaEmitter::taskCallToJava(const std::shared_ptr<MemberAccessNode>& access, const std::string& type) const {
+    std::string object = operandToJava(access->object, 100);
+    if (type == "std::thread" && (access->member == "join" || access->member == "detach")) {
+        runtimeClasses.insert("Parallel");
+        return "Parallel." + access->member + "(" + object + ")";
+    }
+    if (TypeChecker::templateName(type) == "future") {
+        if (access->member == "get" || access->member == "wait") return object + ".join()";
+        if (access->member == "valid") return "(" + object + " != null)";
+    }
+    return "";
+}
+
+bool JavaEmitter::forInitializerToJava(const std::vector<ASTNodePtr>& initializers, std::string& init) {
+    std::string javaType;
+    for (const auto& node : initializers) {
+        auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(node);
+        if (!varDecl) {
+            if (!isHeaderExpression(node)) return false;
+            continue;
+        }
+        std::string type = resolvedType(varDecl);
+        if (!TypeChecker::isArithmeticType(TypeChecker::normalizeType(type)) || !varDecl->arraySizes.empty() ||
+            !varDecl->constructorArguments.empty()) {
+            return false;
+        }
+        if (!javaType.empty() && toJavaType(type) != javaType) return false;
+        javaType = toJavaType(type);
+    }
+
+    for (const auto& node : initializers) {
+        auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(node);
+        if (!varDecl) {
+            init += (init.empty() ? "" : ", ") + expressionToJava(node);
+            continue;
+        }
+        std::string type = resolvedType(varDecl);
+        std::string name = ASTUtils::rootVariable(varDecl->identifier);
+        std::string value = varDecl->initializer ? " = " + convertedToJava(varDecl->initializer, type, 0, true) : "";
+        init += (init.empty() ? javaType + " " : ", ") + name + value;
+        symbols.addSymbol(name, type);
+    }
+    return true;
+}
+
+// Pointer assignments and StringBuilder updates take statements of their own
+bool JavaEmitter::isHeaderExpression(const ASTNodePtr& node) const {
+    if (auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node)) {
+        if (!ASTUtils::isAssignmentOperator(binExpr->op)) return true;
+        std::string root = ASTUtils::rootVariable(binExpr->left);
+        return !stringBuilders.count(root) &&
+               !(binExpr->op == "=" && TypeChecker::isPointerType(TypeChecker::normalizeType(typeOf(binExpr->left))));
+    }
+    if (auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node)) {
+        auto access = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName);
+        return !access || !stringBuilders.count(ASTUtils::rootVariable(access->object));
+    }
+    return true;
 }
 
 void JavaEmitter::emitBlock(const ASTNodePtr& node) {
@@ -123,7 +3239,46 @@ void JavaEmitter::emitBlock(const ASTNodePtr& node) {
     auto block = std::dynamic_pointer_cast<BlockNode>(node);
     if (!block) return;
 
-    for (const auto& stmt : block->statements) {
-        emitExpression(stmt);
+    emitStatements(block->statements, 0);
+}
+
+// A lock guard holds its mutexes until the end of the enclosing block. The
+// rest of the block runs in a try whose finally releases them, so every exit
+// unlocks as the C++ destructor would, including return and exceptions.
+void JavaEmitter::emitStatements(const std::vector<ASTNodePtr>& statements, size_t first) {
+    for (size_t i = first; i < statements.size(); ++i) {
+        auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(statements[i]);
+        std::string kind = varDecl ? lockGuardKind(varDecl->type) : "";
+        if (kind.empty() || varDecl->constructorArguments.empty()) {
+            emitStatement(statements[i]);
+            continue;
+        }
+
+        std::vector<std::string> mutexes;
+        bool deferred = false;
+        for (const auto& argument : varDecl->constructorArguments) {
+            auto tag = std::dynamic_pointer_cast<IdentifierNode>(argument);
+            if (tag && tag->name.find("defer_lock") != std::string::npos) deferred = true;
+            else if (!tag || (tag->name.find("adopt_lock") == std::string::npos &&
+                              tag->name.find("try_to_lock") == std::string::npos)) {
+                mutexes.push_back(expressionToJava(argument));
+            }
+        }
+        if (kind == "unique_lock") lockGuards[ASTUtils::rootVariable(varDecl->identifier)] = mutexes.front();
+        symbols.addSymbol(ASTUtils::rootVariable(varDecl->identifier), varDecl->type);
+
+        for (const auto& mutex : mutexes) {
+            if (!deferred) writer->writeLine(mutex, ".lock();");
+        }
+        writer->write("try {");
+        emitStatements(statements, i + 1);
+        writer->write("} finally {");
+        for (auto mutex = mutexes.rbegin(); mutex != mutexes.rend(); ++mutex) {
+            // A unique_lock may have been unlocked early, or never locked
+            if (kind == "unique_lock") writer->writeLine("if (", *mutex, ".isHeldByCurrentThread()) ", *mutex, ".unlock();");
+            else writer->writeLine(*mutex, ".unlock();");
+        }
+        writer->write("}");
+        return;
     }
 }
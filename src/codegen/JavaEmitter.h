@@ -1,26 +1,224 @@
 #ifndef JAVAEMITTER_H
 #define JAVAEMITTER_H
 
+#include "../optimizer/StructOfArraysAnalysis.h"
 #include "../parser/ASTNode.h"
+#include "../parser/SymbolTable.h"
+#include "Intrinsics.h"
 #include "OutputWriter.h"
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 class JavaEmitter {
 public:
     explicit JavaEmitter(OutputWriter& writer);
+    // Continues from the declarations `state` has seen, writing to `writer` instead, and starts
+    // with none of the runtime classes, resources or kernels that `state` has used
+    JavaEmitter(const JavaEmitter& state, OutputWriter& writer);
 
+    // An empty in-memory writer that indents like this emitter's, for a fragment emitter to write to
+    std::unique_ptr<OutputWriter> fragmentWriter() const;
+    // Takes over what an emitter built from a fragmentWriter() emitted: its text, at the current
+    // position, and the runtime classes, resources and vector kernels it used
+    void merge(const JavaEmitter& fragment);
+
+    // Makes a function's signature known before any call to it is emitted. Declared in source order,
+    // so that overloads are numbered the same however the functions are later emitted.
+    void declareFunction(const std::shared_ptr<FunctionDeclarationNode>& funcDecl);
+
+    // Registers a struct's fields so member accesses get their types
+    void declareStruct(const ASTNodePtr& node);
+    // Registers an enum's enumerators as integer constants of its underlying type
+    void declareEnum(const ASTNodePtr& node);
+    // Opt-in: arrays of plain-data structs become one primitive array per field
+    void setStructOfArrays(bool enabled);
+    // Global arrays initialised with at least this many constants load from a resource file; 0 keeps all inline
+    void setResourceThreshold(int elements);
+    // Opt-in: counted loops over float or double arrays also get a jdk.incubator.vector kernel
+    void setVectorize(bool enabled);
+
+    void emitClassBegin(const std::string& className);
+    void emitClassEnd();
+    void emitStatement(const ASTNodePtr& node);
     void emitVariableDeclaration(const ASTNodePtr& node);
     void emitFunction(const ASTNodePtr& node);
+    void emitStruct(const ASTNodePtr& node);
+    void emitEnum(const ASTNodePtr& node);
     void emitReturn(const ASTNodePtr& node);
     void emitBinaryExpression(const ASTNodePtr& node);
     void emitExpression(const ASTNodePtr& node);
     void emitIfStatement(const ASTNodePtr& node);
     void emitWhileLoop(const ASTNodePtr& node);
+    void emitForLoop(const ASTNodePtr& node);
+    void emitSwitch(const ASTNodePtr& node);
+    void emitDelete(const ASTNodePtr& node);
     void emitFunctionCall(const ASTNodePtr& node);
 
+    // Renders an expression subtree as Java source, for the conversions and loop
+    // lowerings that inspect or combine the text; statements use writeExpression()
+    std::string expressionToJava(const ASTNodePtr& node) const;
+
+    // Maps a C++ type name onto the narrowest Java primitive (or class) that holds it
+    static std::string toJavaType(const std::string& cppType);
+
+    // Runtime classes (see RuntimeLibrary) the emitted code refers to
+    const std::set<std::string>& usedRuntimeClasses() const;
+    // Binary resource files the emitted code loads, by file name
+    const std::map<std::string, std::string>& resourceFiles() const;
+
 private:
     void emitBlock(const ASTNodePtr& node);
+    bool emitResourceArray(const std::shared_ptr<VariableDeclarationNode>& varDecl, const std::string& type);
+    void beginFieldInitializer();
+    void endFieldInitializer();
+    std::string operandToJava(const ASTNodePtr& node, int parentPrecedence) const;
+    std::string binaryToJava(const std::shared_ptr<BinaryExpressionNode>& binExpr) const;
+    std::string conditionToJava(const ASTNodePtr& node) const;
+
+    // Write the same text as operandToJava (expressionToJava for -1), convertedToJava and
+    // conditionToJava straight to the writer. Literals, identifiers, operators and calls to
+    // program functions go out piece by piece; any other subtree is rendered as a string.
+    void writeExpression(const ASTNodePtr& node, int parentPrecedence = -1) const;
+    void writeConverted(const ASTNodePtr& node, const std::string& toType, int parentPrecedence = 0,
+                        bool assignmentContext = false) const;
+    void writeCondition(const ASTNodePtr& node) const;
+    bool writeBinary(const std::shared_ptr<BinaryExpressionNode>& binExpr, int parentPrecedence) const;
+    bool writeCall(const std::shared_ptr<FunctionCallNode>& funcCall) const;
+    // An expression whose value is discarded, e.g. a statement or a for increment
+    std::string statementToJava(const ASTNodePtr& node) const;
+    void writeStatement(const ASTNodePtr& node) const;
+    std::string resolvedType(const std::shared_ptr<VariableDeclarationNode>& varDecl) const;
+
+    // A for header holds one declaration of a single Java type, or expressions; false for anything else
+    bool forInitializerToJava(const std::vector<ASTNodePtr>& initializers, std::string& init);
+    bool isHeaderExpression(const ASTNodePtr& node) const;
+
+    // Statements that update a std::string held in a StringBuilder; returns false for anything else
+    bool emitStringBuilderUpdate(const ASTNodePtr& node);
+    std::string appendArgument(const ASTNodePtr& node) const;
+    // Character literals and characters of a String are Java chars; every other C++ char is a byte
+    bool isTextCharacter(const ASTNodePtr& node) const;
+
+    // A C++ pointer is carried as a Java array plus an int offset (`p` and `p$off`).
+    // Splits a pointer-valued expression into those two parts; false if it is not one.
+    bool pointerParts(const ASTNodePtr& node, std::string& base, std::string& offset) const;
+    // A function that may return a pointer past the start of its array takes a trailing `int[] result$off`
+    // and stores the offset in it; each caller passes a one-element holder of its own, declared up front
+    void emitOffsetHolder(const ASTNodePtr& body, const std::string& name);
+    std::string offsetBy(const std::string& offset, const std::string& op, const ASTNodePtr& amount) const;
+    bool emitPointerUpdate(const ASTNodePtr& node);
+    std::string newToJava(const std::shared_ptr<NewExpressionNode>& newExpr) const;
+    // Function-level buffers and vectors that AllocationPooling reuses across loop iterations
+    void emitPoolLocals(const ASTNodePtr& body);
+    void emitArrayDeclaration(const std::shared_ptr<VariableDeclarationNode>& varDecl, const std::string& type);
+    std::string arrayInitializerToJava(const ASTNodePtr& initializer, const std::string& type,
+                                       const std::vector<ASTNodePtr>& sizes, size_t depth) const;
+
+    // Standard containers of primitives are emitted as RuntimeLibrary classes
+    void useRuntimeClass(const std::string& cppType);
+    void emitContainerDeclaration(const std::shared_ptr<VariableDeclarationNode>& varDecl, const std::string& type,
+                                  const std::string& container);
+    std::string containerCallToJava(const std::shared_ptr<FunctionCallNode>& funcCall,
+                                    const std::shared_ptr<MemberAccessNode>& access, const std::string& type) const;
+    // `m[k]` on a runtime map: the map and key as Java plus the C++ value type; false otherwise
+    bool mapSubscript(const ASTNodePtr& node, std::string& map, std::string& key, std::string& valueType) const;
+
+    // Structs are emitted as static nested classes with value semantics through copy()
+    bool isValueClass(const std::string& cppType) const;
+    std::string copiedToJava(const ASTNodePtr& node, const std::string& type) const;
+    void emitStructDeclaration(const std::shared_ptr<VariableDeclarationNode>& varDecl, const std::string& type);
+    void emitSplitArrayDeclaration(const std::shared_ptr<VariableDeclarationNode>& varDecl, const std::string& type);
+
+    // Calls found in the Intrinsics table; "" when the arguments cannot be adapted
+    std::string intrinsicToJava(const std::shared_ptr<FunctionCallNode>& funcCall, const Intrinsic& intrinsic) const;
+    // Bytes to elements; "" when the byte count holds a sizeof that cannot be folded
+    std::string elementCount(const ASTNodePtr& bytes, const std::string& element) const;
+    // `sizeof(x)` from the declared type of x: a constant, or `a.length * 4` for an int array; "" when unknown
+    std::string sizeofToJava(const ASTNodePtr& operand) const;
+    // An argument of a call left unchanged, with its pointer arithmetic as written
+    std::string unmappedArgumentToJava(const ASTNodePtr& node) const;
+    // memcpy between a float and an integer of the same width: the raw-bits methods; "" otherwise
+    std::string bitCopyToJava(const ASTNodePtr& dst, const ASTNodePtr& src) const;
+
+    // Threads and futures run as tasks on the shared executor of the Parallel runtime class.
+    // `std::thread t(f, args...)` and `auto r = std::async(f, args...)`; false for other declarations.
+    bool emitTaskDeclaration(const std::shared_ptr<VariableDeclarationNode>& varDecl, const std::string& type);
+    // join(), get()... on a thread or future; "" for other members and types
+    std::string taskCallToJava(const std::shared_ptr<MemberAccessNode>& access, const std::string& type) const;
+    // std::atomic<T> lvalues hold an IntAtomic... object; reading one is a
+    // sequentially consistent get(). Explicit memory orders pick the weakest
+    // VarHandle access mode that keeps them.
+    std::string atomicClassOf(const ASTNodePtr& node) const;
+    std::string atomicObjectToJava(const ASTNodePtr& node) const;
+    std::string atomicCallToJava(const std::shared_ptr<FunctionCallNode>& funcCall,
+                                 const std::shared_ptr<MemberAccessNode>& access, const std::string& type,
+                                 bool resultUsed = true) const;
+    std::string atomicUpdateToJava(const ASTNodePtr& target, const std::string& op, const ASTNodePtr& operand) const;
+    // std::mutex is a ReentrantLock; lock(), unlock() and try_lock() on it or on a unique_lock; "" otherwise
+    std::string lockCallToJava(const std::shared_ptr<MemberAccessNode>& access, const std::string& type) const;
+    // Statements of a block from `first` on; a lock guard wraps the rest of the block in try/finally
+    void emitStatements(const std::vector<ASTNodePtr>& statements, size_t first);
+    // `#pragma omp parallel for` as ForkJoin range splitting; false (with a warning) when the loop stays serial
+    bool emitParallelFor(const std::shared_ptr<ForLoopNode>& forLoop);
+    // Locals of the current function assigned after their declaration, which a Java lambda cannot capture
+    std::unordered_set<std::string> reassignedLocals() const;
+    // A counted loop whose body only stores to `a[i]` elements of float or double arrays, and
+    // accumulates at most one `s += ...`, is copied into a kernel of the nested Vectorized class:
+    // FloatVector or DoubleVector lanes, then a scalar tail. `call` runs the kernel in place of the
+    // loop when `condition` holds; false when the loop has no vector form.
+    bool vectorLoopToJava(const std::shared_ptr<ForLoopNode>& forLoop, std::string& condition, std::string& call);
+    struct VectorLoop;
+    bool isLoopInvariant(const ASTNodePtr& node, const VectorLoop& loop) const;
+    // Lane-wise rendering of a body expression, broadcasting invariant operands; "" when it has none
+    std::string lanesToJava(const ASTNodePtr& node, const VectorLoop& loop) const;
+    // An invariant operand as one lane value; "" when C++ would compute it in a wider type
+    std::string laneScalarToJava(const ASTNodePtr& node, const VectorLoop& loop) const;
+
+    // Renders `node` as a value of C++ type `toType`, inserting the casts,
+    // zero-extensions and boolean tests Java needs for C++'s implicit conversions
+    std::string convertedToJava(const ASTNodePtr& node, const std::string& toType,
+                                int parentPrecedence = 0, bool assignmentContext = false) const;
+    std::string typeOf(const ASTNodePtr& node) const;
 
-    OutputWriter& writer;
+    OutputWriter* writer;
+    SymbolTable symbols;  // Variables in scope and function return types
+    std::unordered_map<std::string, std::vector<std::string>> functionParameterTypes;
+    std::string currentReturnType;
+    std::unordered_set<std::string> offsetReturning;  // Pointer-returning functions that hand back an offset
+    std::string offsetHolder;  // The current function's or parallel chunk's holder for those offsets, or ""
+    std::unordered_set<std::string> stringBuilders;  // std::string locals of the current function emitted as StringBuilder
+    mutable std::set<std::string> runtimeClasses;  // Also filled while rendering expressions
+    StructOfArraysAnalysis::StructTable structs;
+    bool structOfArrays = false;
+    std::unordered_set<std::string> splitArrays;  // Struct arrays of the current function stored field by field
+    std::unordered_map<std::string, std::string> enumConstants;  // `Color::Red` -> `Color$Red`
+    struct EnumValue {
+        long long value;
+        std::string table;  // The enum's sorted `Name$values` table, for 64-bit enums with values past the int range
+    };
+    std::unordered_map<std::string, EnumValue> enumValues;  // Enumerators with a constant value, keyed as enumConstants
+    std::unordered_map<std::string, std::vector<long long>> enumTables;  // `Name$values` -> its distinct values, sorted
+    int switchCount = 0;  // Numbers the `sw$N` selector temporaries of 64-bit switches in the current function
+    std::shared_ptr<FunctionDeclarationNode> currentFunction;  // nullptr at class level
+    bool inStruct = false;
+    std::string className;
+    int resourceThreshold = 0;
+    std::map<std::string, std::string> resources;
+    std::string declarationModifiers;  // Of the declaration being emitted: `static` for globals
+    std::unordered_map<std::string, std::string> renamedLocals;  // Reduction variables and copies inside a parallel loop body
+    std::unordered_map<std::string, std::string> lockGuards;  // unique_lock variables -> their mutex
+    int parallelCount = 0;  // Numbers the `lo$N`, `hi$N` chunk bounds of the current function's parallel loops
+    bool vectorize = false;
+    std::vector<std::string> vectorKernels;  // Methods of the nested Vectorized class, emitted at the end
+    std::set<std::string> vectorElements;    // float and/or double: the species the kernels use
+    int vectorLoopCount = 0;  // Numbers the `f$loopN` kernels of the current function
+    std::unordered_map<std::string, int> overloadCounts;  // Functions declared so far, by name
+    std::unordered_map<const FunctionDeclarationNode*, int> overloads;  // Second and later overloads: `f$1$loopN`
 };
 
 #endif // JAVAEMITTER_H
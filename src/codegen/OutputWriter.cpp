@@ -1,38 +1,125 @@
 #include "OutputWriter.h"
-#include <iostream>
 #include <stdexcept>
 
-OutputWriter::OutputWriter(const std::string& filename) : outFile(filename) {
+OutputWriter::OutputWriter(const std::string& filename, bool keepContents)
+    : outFile(std::fopen(filename.c_str(), "wb")), keepContents(keepContents) {
     if (!outFile) {
         throw std::runtime_error("Failed to open output file: " + filename);
     }
+    // The buffer below already batches writes; a second one in stdio would only copy them again
+    std::setvbuf(outFile, nullptr, _IONBF, 0);
+    buffer.reserve(BUFFER_SIZE);
 }
 
+OutputWriter::OutputWriter() : outFile(nullptr), inMemory(true), keepContents(true) {}
+
 OutputWriter::~OutputWriter() {
-    close(); // Ensure the file is closed properly
+    try {
+        close(); // Ensure the file is closed properly
+    } catch (const std::exception&) {
+        // Destructors must not throw; call close() to see write errors
+    }
 }
 
 bool OutputWriter::isOpen() const {
-    // Implement actual logic if needed
-    return true;
+    return outFile != nullptr || inMemory;
 }
 
-
 void OutputWriter::write(const std::string& line) {
-    contents += line + "\n";  // Store an in-memory copy
-    if (outFile.is_open()) {
-        outFile << line << std::endl;
-    } else {
+    writeLine(line);
+}
+
+void OutputWriter::setIndentUnit(const std::string& unit) {
+    indentUnit = unit;
+}
+
+void OutputWriter::indent() {
+    depth++;
+}
+
+void OutputWriter::dedent() {
+    if (depth > 0) depth--;
+}
+
+std::unique_ptr<OutputWriter> OutputWriter::fragment() const {
+    std::unique_ptr<OutputWriter> fragment(new OutputWriter());
+    fragment->indentUnit = indentUnit;
+    fragment->depth = depth;
+    return fragment;
+}
+
+void OutputWriter::insert(const OutputWriter& fragment) {
+    put(fragment.contents.data(), fragment.contents.size());
+}
+
+void OutputWriter::appendPiece(std::string_view text) {
+    if (text.empty()) return;
+    if (!inLine) {
+        inLine = true;
+        if (text.front() == '}' && depth > 0) depth--;
+        for (int i = 0; !indentUnit.empty() && i < depth; i++) put(indentUnit.data(), indentUnit.size());
+    }
+    put(text.data(), text.size());
+    lastChar = text.back();
+}
+
+void OutputWriter::appendPiece(char c) {
+    appendPiece(std::string_view(&c, 1));
+}
+
+void OutputWriter::endLine() {
+    if (inLine && lastChar == '{') depth++;
+    inLine = false;
+    put("\n", 1);
+}
+
+void OutputWriter::put(const char* data, size_t size) {
+    if (inMemory) {
+        contents.append(data, size);
+        return;
+    }
+    if (!outFile) {
         throw std::runtime_error("Attempted to write to a closed file.");
     }
+    if (keepContents) contents.append(data, size);
+    if (buffer.size() + size > BUFFER_SIZE) flushBuffer();
+    // A piece longer than the buffer goes straight to the file
+    if (size > BUFFER_SIZE) {
+        if (std::fwrite(data, 1, size, outFile) != size) {
+            throw std::runtime_error("Failed to write to the output file.");
+        }
+        return;
+    }
+    buffer.append(data, size);
+}
+
+void OutputWriter::flushBuffer() {
+    if (buffer.empty()) return;
+    bool written = std::fwrite(buffer.data(), 1, buffer.size(), outFile) == buffer.size();
+    buffer.clear();
+    if (!written) {
+        throw std::runtime_error("Failed to write to the output file.");
+    }
 }
 
 std::string OutputWriter::getContents() const {
+    if (!keepContents) {
+        throw std::runtime_error("OutputWriter::getContents() needs a writer constructed with keepContents.");
+    }
     return contents;  // Return the stored Java code
 }
 
 void OutputWriter::close() {
-    if (outFile.is_open()) {
-        outFile.close();
+    if (!outFile) return;
+    bool written = true;
+    try {
+        flushBuffer();
+    } catch (const std::runtime_error&) {
+        written = false;
+    }
+    bool closed = std::fclose(outFile) == 0;
+    outFile = nullptr;
+    if (!written || !closed) {
+        throw std::runtime_error("Failed to write to the output file.");
     }
 }
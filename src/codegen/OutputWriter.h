@@ -1,22 +1,89 @@
 #ifndef OUTPUTWRITER_H
 #define OUTPUTWRITER_H
 
+#include <charconv>
+#include <cstdio>
+#include <memory>
 #include <string>
-#include <fstream>
+#include <string_view>
+#include <type_traits>
 
+// Writes generated source a line at a time. Lines collect in one reusable
+// buffer that goes to the file in blocks of BUFFER_SIZE bytes, so writing
+// costs no per-line flush or system call. A copy of the whole output is kept
+// in memory only for writers asked to keep it.
+//
+// writeLine() appends the pieces of a line, strings, characters and numbers,
+// straight to that buffer, so callers need not concatenate them first.
 class OutputWriter {
 private:
-    std::ofstream outFile;
-    std::string contents;   // ✅ Store generated code in memory
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    std::FILE* outFile;
+    bool inMemory = false;  // A fragment: no file, everything goes to `contents`
+    std::string buffer;     // Not yet written to the file
+    bool keepContents;
+    std::string contents;   // Everything written, when keepContents is set
+    std::string indentUnit;
+    int depth = 0;          // `{` still open at the end of the last line
+    bool inLine = false;    // Something was appended since the last line break
+    char lastChar = '\0';   // Of the current line
+
+    OutputWriter();
+
+    void put(const char* data, size_t size);
+    void flushBuffer();
+
+    void appendPiece(std::string_view text);
+    void appendPiece(char c);
+    // Integers, and floating-point values in their shortest round-trip form
+    template <typename Number, typename = std::enable_if_t<std::is_arithmetic_v<Number>>>
+    void appendPiece(Number value) {
+        char digits[32];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        appendPiece(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
 
 public:
-    OutputWriter(const std::string& filename);
+    // `keepContents` also keeps all output in memory for getContents()
+    explicit OutputWriter(const std::string& filename, bool keepContents = false);
     ~OutputWriter();
 
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    // Appends `line` and a newline
     void write(const std::string& line);
-    std::string getContents() const; // ✅ Method to retrieve generated Java code
+    // Appends the parts in order, then a newline
+    template <typename... Parts>
+    void writeLine(const Parts&... parts) {
+        (appendPiece(parts), ...);
+        endLine();
+    }
+    // Appends the parts to the current line; a later writeLine() or endLine() finishes it
+    template <typename... Parts>
+    void append(const Parts&... parts) {
+        (appendPiece(parts), ...);
+    }
+    void endLine();
+    // Starts each line with `unit` once per enclosing block: a line ending in `{` opens one and a
+    // line starting with `}` closes it. With "", the default, lines are written as they are.
+    void setIndentUnit(const std::string& unit);
+    // An extra level for statements that are not in braces, such as those under a `case` label
+    void indent();
+    void dedent();
+
+    // An empty writer that keeps its output in memory, indented as this writer would
+    // indent it from here, so that pieces of the output can be written concurrently
+    std::unique_ptr<OutputWriter> fragment() const;
+    // Appends everything written to `fragment`, which must end where it started:
+    // at the start of a line and at this writer's depth
+    void insert(const OutputWriter& fragment);
+
+    // Everything written so far; only for writers constructed with keepContents
+    std::string getContents() const;
 
-    bool isOpen() const; // Declare the function
+    bool isOpen() const;
     void close();
 };
 
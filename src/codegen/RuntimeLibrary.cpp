@@ -0,0 +1,941 @@
+#include "RuntimeLibrary.h"
+#include "JavaEmitter.h"
+#include "../parser/TypeChecker.h"
+#include <vector>
+
+namespace {
+
+// Growable array: `data` is public so `v[i]` compiles to a plain array access
+const char* const vectorTemplate = R"(import java.util.Arrays;
+
+/** std::vector<${T}> without boxing; elements [0, size()) of {@code data} are live. */
+public final class ${Class} {
+    public ${T}[] data;
+    private int size;
+
+    public ${Class}() {
+        data = new ${T}[8];
+    }
+
+    public ${Class}(int n) {
+        data = new ${T}[Math.max(n, 8)];
+        size = n;
+    }
+
+    public ${Class}(int n, ${T} value) {
+        this(n);
+        Arrays.fill(data, 0, n, value);
+    }
+
+    public static ${Class} of(${T}... values) {
+        ${Class} v = new ${Class}(values.length);
+        System.arraycopy(values, 0, v.data, 0, values.length);
+        return v;
+    }
+
+    public ${Class} copy() {
+        ${Class} v = new ${Class}(size);
+        System.arraycopy(data, 0, v.data, 0, size);
+        return v;
+    }
+
+    public int size() {
+        return size;
+    }
+
+    public boolean isEmpty() {
+        return size == 0;
+    }
+
+    /** Bounds-checked access, like std::vector::at. */
+    public ${T} get(int i) {
+        if (i < 0 || i >= size) throw new IndexOutOfBoundsException("index " + i + ", size " + size);
+        return data[i];
+    }
+
+    public ${T} front() {
+        return data[0];
+    }
+
+    public ${T} back() {
+        return data[size - 1];
+    }
+
+    public void add(${T} value) {
+        if (size == data.length) data = Arrays.copyOf(data, size * 2);
+        data[size++] = value;
+    }
+
+    public void removeLast() {
+        size--;
+    }
+
+    public void clear() {
+        size = 0;
+    }
+
+    public void reserve(int n) {
+        if (n > data.length) data = Arrays.copyOf(data, n);
+    }
+
+    public void resize(int n) {
+        resize(n, ${Zero});
+    }
+
+    public void resize(int n, ${T} value) {
+        reserve(n);
+        if (n > size) Arrays.fill(data, size, n, value);
+        size = n;
+    }
+}
+)";
+
+// Open addressing with linear probing; removal shifts the probe chain back instead of leaving tombstones
+const char* const mapTemplate = R"(import java.util.Arrays;
+
+/** std::unordered_map<${K}, ${V}> without boxing: open addressing with linear probing. */
+public final class ${Class} {
+    private ${K}[] keys;
+    private ${V}[] values;
+    private boolean[] used;
+    private int size;
+    private int mask;
+
+    public ${Class}() {
+        this(16);
+    }
+
+    public ${Class}(int expected) {
+        int capacity = 16;
+        while (capacity * 3 < expected * 4) capacity <<= 1;
+        allocate(capacity);
+    }
+
+    private void allocate(int capacity) {
+        keys = new ${K}[capacity];
+        values = new ${V}[capacity];
+        used = new boolean[capacity];
+        mask = capacity - 1;
+    }
+
+    private int slot(${K} key) {
+        ${Hash}
+    }
+
+    private int find(${K} key) {
+        for (int i = slot(key); used[i]; i = (i + 1) & mask) {
+            if (keys[i] == key) return i;
+        }
+        return -1;
+    }
+
+    public int size() {
+        return size;
+    }
+
+    public boolean isEmpty() {
+        return size == 0;
+    }
+
+    /** Slot iteration, for range-based for: the slots below slots() that are full() hold the elements. */
+    public int slots() {
+        return used.length;
+    }
+
+    public boolean full(int slot) {
+        return used[slot];
+    }
+
+    public ${K} keyAt(int slot) {
+        return keys[slot];
+    }
+
+    public ${V} valueAt(int slot) {
+        return values[slot];
+    }
+
+    public boolean contains(${K} key) {
+        return find(key) >= 0;
+    }
+
+    public int count(${K} key) {
+        return find(key) >= 0 ? 1 : 0;
+    }
+
+    /** Reads like operator[]: a missing key is inserted with value 0. */
+    public ${V} get(${K} key) {
+        int i = find(key);
+        if (i >= 0) return values[i];
+        put(key, 0);
+        return 0;
+    }
+
+    public ${V} at(${K} key) {
+        int i = find(key);
+        if (i < 0) throw new java.util.NoSuchElementException("key " + key);
+        return values[i];
+    }
+
+    public void put(${K} key, ${V} value) {
+        int i = slot(key);
+        while (used[i]) {
+            if (keys[i] == key) {
+                values[i] = value;
+                return;
+            }
+            i = (i + 1) & mask;
+        }
+        used[i] = true;
+        keys[i] = key;
+        values[i] = value;
+        if (++size * 4 > keys.length * 3) grow();
+    }
+
+    /** {@code m[key] += delta}; returns the new value. */
+    public ${V} add(${K} key, ${V} delta) {
+        int i = find(key);
+        if (i >= 0) return values[i] += delta;
+        put(key, delta);
+        return delta;
+    }
+
+    public int remove(${K} key) {
+        int gap = find(key);
+        if (gap < 0) return 0;
+        for (int j = (gap + 1) & mask; used[j]; j = (j + 1) & mask) {
+            // An entry may move back into the gap unless that would put it before its home slot
+            if (((j - slot(keys[j])) & mask) >= ((j - gap) & mask)) {
+                keys[gap] = keys[j];
+                values[gap] = values[j];
+                gap = j;
+            }
+        }
+        used[gap] = false;
+        size--;
+        return 1;
+    }
+
+    public void clear() {
+        Arrays.fill(used, false);
+        size = 0;
+    }
+
+    public ${Class} copy() {
+        ${Class} m = new ${Class}(0);
+        m.keys = keys.clone();
+        m.values = values.clone();
+        m.used = used.clone();
+        m.size = size;
+        m.mask = mask;
+        return m;
+    }
+
+    private void grow() {
+        ${K}[] oldKeys = keys;
+        ${V}[] oldValues = values;
+        boolean[] oldUsed = used;
+        allocate(keys.length * 2);
+        size = 0;
+        for (int i = 0; i < oldKeys.length; i++) {
+            if (oldUsed[i]) put(oldKeys[i], oldValues[i]);
+        }
+    }
+}
+)";
+
+const char* const setTemplate = R"(import java.util.Arrays;
+
+/** std::unordered_set<${K}> without boxing: open addressing with linear probing. */
+public final class ${Class} {
+    private ${K}[] keys;
+    private boolean[] used;
+    private int size;
+    private int mask;
+
+    public ${Class}() {
+        this(16);
+    }
+
+    public ${Class}(int expected) {
+        int capacity = 16;
+        while (capacity * 3 < expected * 4) capacity <<= 1;
+        allocate(capacity);
+    }
+
+    public static ${Class} of(${K}... values) {
+        ${Class} s = new ${Class}(values.length);
+        for (${K} value : values) s.add(value);
+        return s;
+    }
+
+    private void allocate(int capacity) {
+        keys = new ${K}[capacity];
+        used = new boolean[capacity];
+        mask = capacity - 1;
+    }
+
+    private int slot(${K} key) {
+        ${Hash}
+    }
+
+    private int find(${K} key) {
+        for (int i = slot(key); used[i]; i = (i + 1) & mask) {
+            if (keys[i] == key) return i;
+        }
+        return -1;
+    }
+
+    public int size() {
+        return size;
+    }
+
+    public boolean isEmpty() {
+        return size == 0;
+    }
+
+    /** Slot iteration, for range-based for: the slots below slots() that are full() hold the elements. */
+    public int slots() {
+        return used.length;
+    }
+
+    public boolean full(int slot) {
+        return used[slot];
+    }
+
+    public ${K} keyAt(int slot) {
+        return keys[slot];
+    }
+
+    public boolean contains(${K} key) {
+        return find(key) >= 0;
+    }
+
+    public int count(${K} key) {
+        return find(key) >= 0 ? 1 : 0;
+    }
+
+    /** Returns false when the key was already present, like insert().second. */
+    public boolean add(${K} key) {
+        int i = slot(key);
+        while (used[i]) {
+            if (keys[i] == key) return false;
+            i = (i + 1) & mask;
+        }
+        used[i] = true;
+        keys[i] = key;
+        if (++size * 4 > keys.length * 3) grow();
+        return true;
+    }
+
+    public int remove(${K} key) {
+        int gap = find(key);
+        if (gap < 0) return 0;
+        for (int j = (gap + 1) & mask; used[j]; j = (j + 1) & mask) {
+            if (((j - slot(keys[j])) & mask) >= ((j - gap) & mask)) {
+                keys[gap] = keys[j];
+                gap = j;
+            }
+        }
+        used[gap] = false;
+        size--;
+        return 1;
+    }
+
+    public void clear() {
+        Arrays.fill(used, false);
+        size = 0;
+    }
+
+    public ${Class} copy() {
+        ${Class} s = new ${Class}(0);
+        s.keys = keys.clone();
+        s.used = used.clone();
+        s.size = size;
+        s.mask = mask;
+        return s;
+    }
+
+    private void grow() {
+        ${K}[] oldKeys = keys;
+        boolean[] oldUsed = used;
+        allocate(keys.length * 2);
+        size = 0;
+        for (int i = 0; i < oldKeys.length; i++) {
+            if (oldUsed[i]) add(oldKeys[i]);
+        }
+    }
+}
+)";
+
+// std::atomic<T> for the primitives VarHandle updates atomically. The C++
+// memory order picks the method, and each method is the VarHandle access mode
+// of the same name, so no operation is stronger than the order asks for.
+const char* const atomicTemplate = R"(import java.lang.invoke.MethodHandles;
+import java.lang.invoke.VarHandle;
+
+/**
+ * A std::atomic on one volatile ${T} field. Methods carry the VarHandle access mode in their name:
+ * plain get/set are sequentially consistent, Acquire/Release/Opaque are the weaker modes.
+ */
+public final class ${Class} {
+    private static final VarHandle VALUE;
+    static {
+        try {
+            VALUE = MethodHandles.lookup().findVarHandle(${Class}.class, "value", ${T}.class);
+        } catch (ReflectiveOperationException e) {
+            throw new ExceptionInInitializerError(e);
+        }
+    }
+
+    private volatile ${T} value;
+
+    public ${Class}(${T} value) {
+        this.value = value;
+    }
+
+    public ${T} get() {
+        return value;
+    }
+
+    public ${T} getAcquire() {
+        return (${T}) VALUE.getAcquire(this);
+    }
+
+    public ${T} getOpaque() {
+        return (${T}) VALUE.getOpaque(this);
+    }
+
+    public void set(${T} value) {
+        this.value = value;
+    }
+
+    public void setRelease(${T} value) {
+        VALUE.setRelease(this, value);
+    }
+
+    public void setOpaque(${T} value) {
+        VALUE.setOpaque(this, value);
+    }
+
+    public ${T} getAndSet(${T} value) {
+        return (${T}) VALUE.getAndSet(this, value);
+    }
+
+    public ${T} getAndSetAcquire(${T} value) {
+        return (${T}) VALUE.getAndSetAcquire(this, value);
+    }
+
+    public ${T} getAndSetRelease(${T} value) {
+        return (${T}) VALUE.getAndSetRelease(this, value);
+    }
+
+    public ${T} compareAndExchange(${T} expected, ${T} desired) {
+        return (${T}) VALUE.compareAndExchange(this, expected, desired);
+    }
+
+    public ${T} compareAndExchangeAcquire(${T} expected, ${T} desired) {
+        return (${T}) VALUE.compareAndExchangeAcquire(this, expected, desired);
+    }
+
+    public ${T} compareAndExchangeRelease(${T} expected, ${T} desired) {
+        return (${T}) VALUE.compareAndExchangeRelease(this, expected, desired);
+    }
+${Numeric}${Bitwise}}
+)";
+
+const char* const atomicNumeric = R"(
+    public ${T} getAndAdd(${T} delta) {
+        return (${T}) VALUE.getAndAdd(this, delta);
+    }
+
+    public ${T} getAndAddAcquire(${T} delta) {
+        return (${T}) VALUE.getAndAddAcquire(this, delta);
+    }
+
+    public ${T} getAndAddRelease(${T} delta) {
+        return (${T}) VALUE.getAndAddRelease(this, delta);
+    }
+
+    public ${T} addAndGet(${T} delta) {
+        return (${T}) VALUE.getAndAdd(this, delta) + delta;
+    }
+)";
+
+const char* const atomicBitwise = R"(
+    public ${T} getAndBitwiseAnd(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseAnd(this, mask);
+    }
+
+    public ${T} getAndBitwiseAndAcquire(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseAndAcquire(this, mask);
+    }
+
+    public ${T} getAndBitwiseAndRelease(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseAndRelease(this, mask);
+    }
+
+    public ${T} getAndBitwiseOr(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseOr(this, mask);
+    }
+
+    public ${T} getAndBitwiseOrAcquire(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseOrAcquire(this, mask);
+    }
+
+    public ${T} getAndBitwiseOrRelease(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseOrRelease(this, mask);
+    }
+
+    public ${T} getAndBitwiseXor(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseXor(this, mask);
+    }
+
+    public ${T} getAndBitwiseXorAcquire(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseXorAcquire(this, mask);
+    }
+
+    public ${T} getAndBitwiseXorRelease(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseXorRelease(this, mask);
+    }
+
+    public ${T} andAndGet(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseAnd(this, mask) & mask;
+    }
+
+    public ${T} orAndGet(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseOr(this, mask) | mask;
+    }
+
+    public ${T} xorAndGet(${T} mask) {
+        return (${T}) VALUE.getAndBitwiseXor(this, mask) ^ mask;
+    }
+)";
+
+// Per-thread free list behind `new T[n]` / `delete[]` pairs whose buffer never escapes
+const char* const arrayPoolTemplate = R"(import java.util.ArrayDeque;
+
+/** Free list of ${T}[] buffers, one per thread; contents of a taken buffer are unspecified, as after new[]. */
+public final class ${Class} {
+    private static final int MAX_FREE = 8;
+    private static final ThreadLocal<ArrayDeque<${T}[]>> FREE = ThreadLocal.withInitial(ArrayDeque::new);
+
+    private ${Class}() {}
+
+    public static ${T}[] take(int n) {
+        ${T}[] buffer = FREE.get().poll();
+        return buffer != null && buffer.length >= n ? buffer : new ${T}[n];
+    }
+
+    public static void give(${T}[] buffer) {
+        ArrayDeque<${T}[]> free = FREE.get();
+        if (free.size() < MAX_FREE) free.push(buffer);
+    }
+}
+)";
+
+// Tables too large for an array initializer: each is one bulk read of a
+// big-endian resource file, viewed through the matching NIO buffer
+const char* const resourcesSource = R"(/** Loads the constant tables written beside the translated class. */
+public final class Resources {
+    private Resources() {}
+
+    private static java.nio.ByteBuffer read(Class<?> owner, String name) {
+        try (java.io.InputStream in = owner.getResourceAsStream(name)) {
+            if (in == null) throw new IllegalStateException("Missing resource " + name + " for " + owner.getName());
+            return java.nio.ByteBuffer.wrap(in.readAllBytes());
+        } catch (java.io.IOException e) {
+            throw new java.io.UncheckedIOException(e);
+        }
+    }
+
+    public static byte[] bytes(Class<?> owner, String name, int length) {
+        java.nio.ByteBuffer buffer = read(owner, name);
+        byte[] values = new byte[length];
+        buffer.get(values, 0, Math.min(length, buffer.remaining()));
+        return values;
+    }
+
+    public static boolean[] booleans(Class<?> owner, String name, int length) {
+        byte[] bytes = bytes(owner, name, length);
+        boolean[] values = new boolean[length];
+        for (int i = 0; i < length; i++) values[i] = bytes[i] != 0;
+        return values;
+    }
+
+    public static short[] shorts(Class<?> owner, String name, int length) {
+        java.nio.ShortBuffer buffer = read(owner, name).asShortBuffer();
+        short[] values = new short[length];
+        buffer.get(values, 0, Math.min(length, buffer.remaining()));
+        return values;
+    }
+
+    public static char[] chars(Class<?> owner, String name, int length) {
+        java.nio.CharBuffer buffer = read(owner, name).asCharBuffer();
+        char[] values = new char[length];
+        buffer.get(values, 0, Math.min(length, buffer.remaining()));
+        return values;
+    }
+
+    public static int[] ints(Class<?> owner, String name, int length) {
+        java.nio.IntBuffer buffer = read(owner, name).asIntBuffer();
+        int[] values = new int[length];
+        buffer.get(values, 0, Math.min(length, buffer.remaining()));
+        return values;
+    }
+
+    public static long[] longs(Class<?> owner, String name, int length) {
+        java.nio.LongBuffer buffer = read(owner, name).asLongBuffer();
+        long[] values = new long[length];
+        buffer.get(values, 0, Math.min(length, buffer.remaining()));
+        return values;
+    }
+
+    public static float[] floats(Class<?> owner, String name, int length) {
+        java.nio.FloatBuffer buffer = read(owner, name).asFloatBuffer();
+        float[] values = new float[length];
+        buffer.get(values, 0, Math.min(length, buffer.remaining()));
+        return values;
+    }
+
+    public static double[] doubles(Class<?> owner, String name, int length) {
+        java.nio.DoubleBuffer buffer = read(owner, name).asDoubleBuffer();
+        double[] values = new double[length];
+        buffer.get(values, 0, Math.min(length, buffer.remaining()));
+        return values;
+    }
+}
+)";
+
+// The Vector API is an incubator module that is only resolved when asked
+// for, so whether the kernels can run is a property of the launch
+const char* const vectorSupportSource = R"(/** Whether the vector kernels of translated code can run. */
+public final class VectorSupport {
+    private VectorSupport() {}
+
+    /**
+     * True when the JVM was started with --add-modules jdk.incubator.vector. Otherwise every
+     * vectorised loop runs its scalar translation and the kernels are never loaded.
+     */
+    public static final boolean ENABLED = ModuleLayer.boot().findModule("jdk.incubator.vector").isPresent();
+}
+)";
+
+// C conversions the JDK has no single method for, each a few instructions
+// around Math.multiplyHigh or a plain cast
+const char* const crtSource = R"(/** C integer and floating-point semantics for translated code. */
+public final class CRT {
+    private CRT() {}
+
+    /** (double) of an unsigned 64-bit value. */
+    public static double unsignedToDouble(long value) {
+        if (value >= 0) return (double) value;
+        // Halving keeps the lowest bit sticky, so the result rounds as C rounds it
+        return (double) ((value >>> 1) | (value & 1)) * 2.0;
+    }
+
+    /** (float) of an unsigned 64-bit value. */
+    public static float unsignedToFloat(long value) {
+        if (value >= 0) return (float) value;
+        return (float) ((value >>> 1) | (value & 1)) * 2.0f;
+    }
+
+    /** (uint64_t) of a double; Java's (long) saturates at Long.MAX_VALUE instead. */
+    public static long doubleToUnsigned(double value) {
+        if (value < 0x1p63) return (long) value;
+        return (long) (value - 0x1p63) ^ Long.MIN_VALUE;
+    }
+
+    /** High 64 bits of the unsigned 128-bit product, as (unsigned __int128) x * y >> 64. */
+    public static long multiplyHighUnsigned(long x, long y) {
+        return Math.multiplyHigh(x, y) + ((x >> 63) & y) + ((y >> 63) & x);
+    }
+
+    /** round(): halfway cases away from zero, where Math.round rounds them up. */
+    public static double round(double x) {
+        double magnitude = Math.abs(x);
+        double whole = Math.floor(magnitude);
+        // Comparing the fraction avoids the carry of magnitude + 0.5 just below a half
+        if (magnitude - whole >= 0.5) whole += 1.0;
+        return Math.copySign(whole, x);
+    }
+
+    /** trunc(): rounds toward zero, keeping the sign of a zero result. */
+    public static double trunc(double x) {
+        return x < 0 ? Math.ceil(x) : Math.floor(x);
+    }
+
+    /** log2(): exact for powers of two, which Math.log(x) / Math.log(2) is not. */
+    public static double log2(double x) {
+        int exponent = Math.getExponent(x);
+        if (x > 0 && exponent >= Double.MIN_EXPONENT && x == Math.scalb(1.0, exponent)) return exponent;
+        return Math.log(x) / Math.log(2.0);
+    }
+}
+)";
+
+// std::thread, std::async and OpenMP parallel-for. Loop ranges are split in
+// halves on the common ForkJoinPool down to a grain of about four chunks per
+// worker; each leaf reduces its chunk into a partial of its own, and partials
+// are combined up the tree, so no two tasks write one variable.
+const char* const parallelSource = R"(import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.ForkJoinPool;
+import java.util.concurrent.Future;
+import java.util.concurrent.RecursiveAction;
+import java.util.concurrent.RecursiveTask;
+import java.util.function.DoubleBinaryOperator;
+import java.util.function.IntBinaryOperator;
+import java.util.function.LongBinaryOperator;
+
+/** Threads, futures and parallel loops for translated code. */
+public final class Parallel {
+    /** Runs std::thread and std::async bodies; daemon threads, so an unjoined thread never keeps the program alive. */
+    public static final ExecutorService EXECUTOR = Executors.newCachedThreadPool(task -> {
+        Thread thread = new Thread(task);
+        thread.setDaemon(true);
+        return thread;
+    });
+
+    /** Loop body over the iterations [lo, hi). */
+    public interface Range { void run(int lo, int hi); }
+    /** Loop body over [lo, hi) returning the partial reduction of those iterations. */
+    public interface IntRange { int apply(int lo, int hi); }
+    public interface LongRange { long apply(int lo, int hi); }
+    public interface DoubleRange { double apply(int lo, int hi); }
+
+    private Parallel() {}
+
+    public static Future<?> start(Runnable task) {
+        return EXECUTOR.submit(task);
+    }
+
+    /** std::thread::join: waits for the thread and rethrows what it threw. */
+    public static void join(Future<?> thread) {
+        try {
+            thread.get();
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+            throw new IllegalStateException(e);
+        } catch (ExecutionException e) {
+            Throwable cause = e.getCause();
+            if (cause instanceof RuntimeException) throw (RuntimeException) cause;
+            if (cause instanceof Error) throw (Error) cause;
+            throw new IllegalStateException(cause);
+        }
+    }
+
+    /** std::thread::detach: the executor owns the thread already. */
+    public static void detach(Future<?> thread) {}
+
+    public static void forRange(int from, int to, Range body) {
+        if (from < to) ForkJoinPool.commonPool().invoke(new RangeAction(from, to, grain(from, to), body));
+    }
+
+    public static int reduceInt(int from, int to, int identity, IntRange body, IntBinaryOperator combine) {
+        if (from >= to) return identity;
+        return ForkJoinPool.commonPool().invoke(new IntTask(from, to, grain(from, to), body, combine));
+    }
+
+    public static long reduceLong(int from, int to, long identity, LongRange body, LongBinaryOperator combine) {
+        if (from >= to) return identity;
+        return ForkJoinPool.commonPool().invoke(new LongTask(from, to, grain(from, to), body, combine));
+    }
+
+    public static double reduceDouble(int from, int to, double identity, DoubleRange body,
+                                      DoubleBinaryOperator combine) {
+        if (from >= to) return identity;
+        return ForkJoinPool.commonPool().invoke(new DoubleTask(from, to, grain(from, to), body, combine));
+    }
+
+    private static long grain(int from, int to) {
+        return Math.max(1, ((long) to - from) / (4L * ForkJoinPool.getCommonPoolParallelism()));
+    }
+
+    private static int middle(int lo, int hi) {
+        return (int) (((long) lo + hi) >>> 1);
+    }
+
+    private static final class RangeAction extends RecursiveAction {
+        private final int lo, hi;
+        private final long grain;
+        private final Range body;
+
+        RangeAction(int lo, int hi, long grain, Range body) {
+            this.lo = lo; this.hi = hi; this.grain = grain; this.body = body;
+        }
+
+        @Override protected void compute() {
+            if ((long) hi - lo <= grain) {
+                body.run(lo, hi);
+                return;
+            }
+            int mid = middle(lo, hi);
+            invokeAll(new RangeAction(lo, mid, grain, body), new RangeAction(mid, hi, grain, body));
+        }
+    }
+
+    private static final class IntTask extends RecursiveTask<Integer> {
+        private final int lo, hi;
+        private final long grain;
+        private final IntRange body;
+        private final IntBinaryOperator combine;
+
+        IntTask(int lo, int hi, long grain, IntRange body, IntBinaryOperator combine) {
+            this.lo = lo; this.hi = hi; this.grain = grain; this.body = body; this.combine = combine;
+        }
+
+        @Override protected Integer compute() {
+            if ((long) hi - lo <= grain) return body.apply(lo, hi);
+            int mid = middle(lo, hi);
+            IntTask left = new IntTask(lo, mid, grain, body, combine);
+            left.fork();
+            int right = new IntTask(mid, hi, grain, body, combine).compute();
+            return combine.applyAsInt(left.join(), right);
+        }
+    }
+
+    private static final class LongTask extends RecursiveTask<Long> {
+        private final int lo, hi;
+        private final long grain;
+        private final LongRange body;
+        private final LongBinaryOperator combine;
+
+        LongTask(int lo, int hi, long grain, LongRange body, LongBinaryOperator combine) {
+            this.lo = lo; this.hi = hi; this.grain = grain; this.body = body; this.combine = combine;
+        }
+
+        @Override protected Long compute() {
+            if ((long) hi - lo <= grain) return body.apply(lo, hi);
+            int mid = middle(lo, hi);
+            LongTask left = new LongTask(lo, mid, grain, body, combine);
+            left.fork();
+            long right = new LongTask(mid, hi, grain, body, combine).compute();
+            return combine.applyAsLong(left.join(), right);
+        }
+    }
+
+    private static final class DoubleTask extends RecursiveTask<Double> {
+        private final int lo, hi;
+        private final long grain;
+        private final DoubleRange body;
+        private final DoubleBinaryOperator combine;
+
+        DoubleTask(int lo, int hi, long grain, DoubleRange body, DoubleBinaryOperator combine) {
+            this.lo = lo; this.hi = hi; this.grain = grain; this.body = body; this.combine = combine;
+        }
+
+        @Override protected Double compute() {
+            if ((long) hi - lo <= grain) return body.apply(lo, hi);
+            int mid = middle(lo, hi);
+            DoubleTask left = new DoubleTask(lo, mid, grain, body, combine);
+            left.fork();
+            double right = new DoubleTask(mid, hi, grain, body, combine).compute();
+            return combine.applyAsDouble(left.join(), right);
+        }
+    }
+}
+)";
+
+// Fibonacci hashing spreads sequential keys across the table
+const char* const intHash = "int h = key * 0x9E3779B9;\n        return (h ^ (h >>> 16)) & mask;";
+const char* const longHash = "long h = key * 0x9E3779B97F4A7C15L;\n        return (int) (h ^ (h >>> 32)) & mask;";
+
+std::string capitalized(const std::string& javaType) {
+    std::string name = javaType;
+    if (!name.empty()) name[0] = static_cast<char>(name[0] - 'a' + 'A');
+    return name;
+}
+
+// Java primitive for a C++ element type, or "" when it is not a primitive
+std::string primitiveFor(const std::string& cppType) {
+    if (!TypeChecker::isArithmeticType(cppType)) return "";
+    return JavaEmitter::toJavaType(TypeChecker::normalizeType(cppType));
+}
+
+std::string substitute(std::string text, const std::string& placeholder, const std::string& value) {
+    for (size_t at = text.find(placeholder); at != std::string::npos; at = text.find(placeholder, at + value.size())) {
+        text.replace(at, placeholder.size(), value);
+    }
+    return text;
+}
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() > suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string uncapitalized(const std::string& name) {
+    std::string type = name;
+    if (!type.empty()) type[0] = static_cast<char>(type[0] - 'A' + 'a');
+    return type;
+}
+
+} // namespace
+
+std::string RuntimeLibrary::containerClass(const std::string& cppType) {
+    std::string container = TypeChecker::templateName(cppType);
+    std::vector<std::string> arguments = TypeChecker::templateArguments(cppType);
+    std::string normalized = TypeChecker::normalizeType(cppType);
+    if (normalized.empty() || normalized.back() != '>') return "";  // Pointers and arrays of containers
+
+    if (container == "vector" && arguments.size() == 1) {
+        std::string element = primitiveFor(arguments[0]);
+        return element.empty() ? "" : capitalized(element) + "Vector";
+    }
+
+    // Hash containers are specialised for int and long keys
+    std::string key = arguments.empty() ? "" : primitiveFor(arguments[0]);
+    if (key != "int" && key != "long") return "";
+    if (container == "unordered_set" && arguments.size() == 1) {
+        return capitalized(key) + "HashSet";
+    }
+    if (container == "unordered_map" && arguments.size() == 2) {
+        std::string value = primitiveFor(arguments[1]);
+        if (value != "int" && value != "long" && value != "double") return "";
+        return capitalized(key) + capitalized(value) + "Map";
+    }
+    return "";
+}
+
+std::string RuntimeLibrary::atomicClass(const std::string& cppType) {
+    if (!TypeChecker::isAtomicType(cppType)) return "";
+    std::string element = primitiveFor(TypeChecker::valueType(cppType));
+    if (element != "int" && element != "long" && element != "double" && element != "boolean") return "";
+    return capitalized(element) + "Atomic";
+}
+
+std::string RuntimeLibrary::arrayPoolClass(const std::string& elementType) {
+    std::string element = primitiveFor(elementType);
+    return element.empty() ? "" : capitalized(element) + "ArrayPool";
+}
+
+std::string RuntimeLibrary::source(const std::string& className) {
+    if (className == "CRT") return crtSource;
+    if (className == "Parallel") return parallelSource;
+    if (className == "Resources") return resourcesSource;
+    if (className == "VectorSupport") return vectorSupportSource;
+    if (endsWith(className, "Atomic")) {
+        std::string element = uncapitalized(className.substr(0, className.size() - 6));
+        std::string text = substitute(atomicTemplate, "${Numeric}", element != "boolean" ? atomicNumeric : "");
+        text = substitute(text, "${Bitwise}", element != "double" ? atomicBitwise : "");
+        return substitute(substitute(text, "${T}", element), "${Class}", className);
+    }
+
+    std::string text;
+    if (endsWith(className, "ArrayPool")) {
+        text = substitute(arrayPoolTemplate, "${T}", uncapitalized(className.substr(0, className.size() - 9)));
+    } else if (endsWith(className, "Vector")) {
+        std::string element = uncapitalized(className.substr(0, className.size() - 6));
+        text = substitute(vectorTemplate, "${T}", element);
+        bool narrow = element == "byte" || element == "short" || element == "char";
+        text = substitute(text, "${Zero}", element == "boolean" ? "false" : narrow ? "(" + element + ") 0" : "0");
+    } else {
+        std::string key = className.rfind("Long", 0) == 0 ? "long" : "int";
+        std::string rest = className.substr(key.size());
+        text = endsWith(className, "HashSet") ? setTemplate : mapTemplate;
+        text = substitute(text, "${V}", endsWith(rest, "Map") ? uncapitalized(rest.substr(0, rest.size() - 3)) : "");
+        text = substitute(text, "${K}", key);
+        text = substitute(text, "${Hash}", key == "long" ? longHash : intHash);
+    }
+    return substitute(text, "${Class}", className);
+}
@@ -0,0 +1,33 @@
+#ifndef RUNTIMELIBRARY_H
+#define RUNTIMELIBRARY_H
+
+#include <string>
+
+// Java sources bundled with the translator. Standard containers of primitives
+// are emitted as these classes instead of ArrayList<Integer> or
+// HashMap<Integer, Integer>, which would box every element: `std::vector<int>`
+// becomes IntVector, `std::unordered_map<int, long>` the open-addressing
+// IntLongMap and `std::unordered_set<long>` LongHashSet. CRT holds the C
+// conversions that take more than one JDK call, such as uint64_t -> double,
+// and Parallel the executor and ForkJoin loops behind std::thread, std::async
+// and `#pragma omp parallel for`. IntAtomic and its siblings wrap one
+// volatile field in a VarHandle so that each std::atomic operation can use
+// the access mode its memory order asks for. Resources loads the constant
+// tables that are written to binary files instead of array initializers, and
+// VectorSupport tells whether the Vector API kernels can run.
+class RuntimeLibrary {
+public:
+    // Runtime class for a C++ container type; "" when its element types have no specialisation
+    static std::string containerClass(const std::string& cppType);
+
+    // `std::atomic<T>` of an int, long, double or bool type: IntAtomic, ...; "" otherwise
+    static std::string atomicClass(const std::string& cppType);
+
+    // Per-thread free list for `new T[n]` buffers of a primitive element type, e.g. IntArrayPool; "" otherwise
+    static std::string arrayPoolClass(const std::string& elementType);
+
+    // Complete Java source of a class returned by containerClass(), atomicClass() or arrayPoolClass(), or of CRT, Parallel, Resources or VectorSupport
+    static std::string source(const std::string& className);
+};
+
+#endif // RUNTIMELIBRARY_H
@@ -6,10 +6,11 @@
 
 // Define a set of C++ keywords
 const std::unordered_set<std::string> Lexer::keywords = {
-    "int", "float", "double", "char", "void",
+    "int", "float", "double", "char", "void", "bool", "long",
+    "short", "unsigned", "signed", "const", "auto",
     "return", "if", "else", "while", "for",
     "break", "continue", "switch", "case", "default",
-    "class", "public", "private", "protected", "static"
+    "new", "delete", "class", "struct", "enum", "public", "private", "protected", "static"
 };
 
 Lexer::Lexer(const std::string& source)
@@ -48,42 +49,167 @@ Token Lexer::identifierOrKeyword() {
 
 Token Lexer::number() {
     std::string value;
-    while (isdigit(peek())) {
+    // Hexadecimal literal (e.g. 0xFF)
+    if (peek() == '0' && position + 1 < source.size() && (source[position + 1] == 'x' || source[position + 1] == 'X')) {
+        value += advance();
+        value += advance();
+        while (isxdigit(peek())) {
+            value += advance();
+        }
+    } else {
+        while (isdigit(peek())) {
+            value += advance();
+        }
+        // Fractional part (e.g. 1.5)
+        if (peek() == '.' && position + 1 < source.size() && isdigit(source[position + 1])) {
+            value += advance();
+            while (isdigit(peek())) {
+                value += advance();
+            }
+        }
+        // Exponent (e.g. 1e-9)
+        if ((peek() == 'e' || peek() == 'E') && position + 1 < source.size() &&
+            (isdigit(source[position + 1]) || source[position + 1] == '-' || source[position + 1] == '+')) {
+            value += advance();
+            if (peek() == '-' || peek() == '+') value += advance();
+            while (isdigit(peek())) {
+                value += advance();
+            }
+        }
+    }
+    // Suffixes (u, l, ll, ul, f)
+    while (peek() == 'u' || peek() == 'U' || peek() == 'l' || peek() == 'L' || peek() == 'f' || peek() == 'F') {
         value += advance();
     }
     return Token(TokenType::NUMBER, value, line, column - value.length());
 }
 
+// Decodes the escape after a backslash into the bytes it stands for;
+// universal character names (\u, \U) become UTF-8
+std::string Lexer::escapeSequence() {
+    char current = advance();
+    switch (current) {
+        case 'n': return "\n";
+        case 't': return "\t";
+        case 'r': return "\r";
+        case 'a': return "\a";
+        case 'b': return "\b";
+        case 'f': return "\f";
+        case 'v': return "\v";
+        case 'x': {
+            unsigned value = 0;
+            while (isxdigit(peek())) {
+                char digit = advance();
+                value = value * 16 + (isdigit(digit) ? digit - '0' : tolower(digit) - 'a' + 10);
+            }
+            return std::string(1, static_cast<char>(value));
+        }
+        case 'u':
+        case 'U': {
+            unsigned codePoint = 0;
+            for (int i = 0; i < (current == 'u' ? 4 : 8) && isxdigit(peek()); ++i) {
+                char digit = advance();
+                codePoint = codePoint * 16 + (isdigit(digit) ? digit - '0' : tolower(digit) - 'a' + 10);
+            }
+            std::string bytes;
+            if (codePoint < 0x80) {
+                bytes += static_cast<char>(codePoint);
+            } else if (codePoint < 0x800) {
+                bytes += static_cast<char>(0xC0 | (codePoint >> 6));
+                bytes += static_cast<char>(0x80 | (codePoint & 0x3F));
+            } else if (codePoint < 0x10000) {
+                bytes += static_cast<char>(0xE0 | (codePoint >> 12));
+                bytes += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                bytes += static_cast<char>(0x80 | (codePoint & 0x3F));
+            } else {
+                bytes += static_cast<char>(0xF0 | (codePoint >> 18));
+                bytes += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                bytes += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                bytes += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            return bytes;
+        }
+        default:
+            if (current >= '0' && current <= '7') {
+                unsigned value = current - '0';
+                for (int i = 0; i < 2 && peek() >= '0' && peek() <= '7'; ++i) {
+                    value = value * 8 + (advance() - '0');
+                }
+                return std::string(1, static_cast<char>(value));
+            }
+            return std::string(1, current);  // \\, \", \', \?
+    }
+}
+
 Token Lexer::stringLiteral() {
+    int startColumn = column;
     advance(); // Skip the opening quote
     std::string value;
     while (peek() != '"' && peek() != '\0') {
-        value += advance();
+        if (peek() == '\\') {
+            advance();
+            value += escapeSequence();
+        } else {
+            value += advance();
+        }
+    }
+    advance(); // Skip the closing quote
+    return Token(TokenType::STRING_LITERAL, value, line, startColumn);
+}
+
+Token Lexer::charLiteral() {
+    int startColumn = column;
+    advance(); // Skip the opening quote
+    std::string value;
+    while (peek() != '\'' && peek() != '\0') {
+        if (peek() == '\\') {
+            advance();
+            value += escapeSequence();
+        } else {
+            value += advance();
+        }
     }
     advance(); // Skip the closing quote
-    return Token(TokenType::STRING_LITERAL, value, line, column - value.length() - 2);
+    return Token(TokenType::CHAR_LITERAL, value, line, startColumn);
 }
 
 Token Lexer::handleOperator() {
     std::string value;
     char current = peek();
 
-    // Multi-character operators (==, !=, <=, >=, &&, ||)
+    // Multi-character operators (==, !=, <=, >=, <<, >>, <<=, >>=)
     if (current == '=' || current == '!' || current == '<' || current == '>') {
         value += advance();
+        if ((current == '<' || current == '>') && peek() == current) {
+            value += advance();
+        }
         if (peek() == '=') {
             value += advance();
         }
     }
     else if (current == '&' || current == '|') {
         value += advance();
-        if (peek() == current) { // Handles &&, ||
+        if (peek() == current || peek() == '=') { // Handles &&, ||, &=, |=
+            value += advance();
+        }
+    }
+    // Arithmetic operators (+, -, *, /, %) and their ++, --, ->, op= forms
+    else if (current == '+' || current == '-' || current == '*' || current == '/' || current == '%' || current == '^') {
+        value += advance();
+        if ((current == '+' || current == '-') && peek() == current) {
+            value += advance();
+        } else if (current == '-' && peek() == '>') {
+            value += advance();
+        } else if (peek() == '=') {
             value += advance();
         }
     }
-    // Arithmetic operators (+, -, *, /, %)
-    else if (current == '+' || current == '-' || current == '*' || current == '/' || current == '%') {
+    // Scope resolution (::)
+    else if (current == ':') {
         value += advance();
+        if (peek() == ':') {
+            value += advance();
+        }
     }
     // Single-character operators
     else {
@@ -117,6 +243,23 @@ Token Lexer::handleComment() {
     return Token(TokenType::COMMENT, value, line, column - value.length());
 }
 
+// `#include`, `#pragma`...: the whole line, backslash continuations joined, is one token
+Token Lexer::preprocessorDirective() {
+    int startLine = line, startColumn = column;
+    std::string value;
+    while (peek() != '\n' && peek() != '\0') {
+        if (peek() == '\\' && position + 1 < source.size() && source[position + 1] == '\n') {
+            advance();
+            advance();
+            value += ' ';
+            continue;
+        }
+        value += advance();
+    }
+    while (!value.empty() && isspace(static_cast<unsigned char>(value.back()))) value.pop_back();
+    return Token(TokenType::PREPROCESSOR_DIRECTIVE, value, startLine, startColumn);
+}
+
 Token Lexer::handleSeparator() {
     char current = advance();
     return Token(TokenType::SEPARATOR, std::string(1, current), line, column - 1);
@@ -128,6 +271,8 @@ Token Lexer::nextToken() {
     if (isalpha(peek()) || peek() == '_') return identifierOrKeyword();
     if (isdigit(peek())) return number();
     if (peek() == '"') return stringLiteral();
+    if (peek() == '\'') return charLiteral();
+    if (peek() == '#') return preprocessorDirective();
 
     if (ispunct(peek())) {
         if (peek() == '/') {
@@ -137,7 +282,7 @@ Token Lexer::nextToken() {
         }
 
         // Check for operators
-        std::string operators = "+-*/%=&|<>!";
+        std::string operators = "+-*/%=&|<>!^~.:?";
         if (operators.find(peek()) != std::string::npos) {
             return handleOperator();
         }
@@ -19,8 +19,11 @@ private:
     Token identifierOrKeyword();
     Token number();
     Token stringLiteral();
+    Token charLiteral();
+    std::string escapeSequence();
     Token handleOperator();
     Token handleComment();
+    Token preprocessorDirective();
     Token handleSeparator();  // Added missing declaration
     Token nextToken();
 
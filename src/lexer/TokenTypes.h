@@ -8,6 +8,7 @@ enum class TokenType {
     OPERATOR,
     SEPARATOR,
     STRING_LITERAL,
+    CHAR_LITERAL,
     COMMENT,
     UNKNOWN,
     PREPROCESSOR_DIRECTIVE,  // Add this line
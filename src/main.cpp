@@ -1,5 +1,6 @@
 #include <iostream>
 #include <fstream>
+#include <iterator>
 #include <vector>
 #include <string>
 #include "utils/FileReader.h"
@@ -11,7 +12,27 @@
 #include "codegen/OutputWriter.h" // ✅ Include OutputWriter
 
 void printUsage() {
-    std::cerr << "Usage: cpp2java <input.cpp> [-o output.java]" << std::endl;
+    std::cerr << "Usage: cpp2java <input.cpp> [-o output.java] [--optimize] [--soa] [--vectorize] [--emit-benchmarks] [--profile file] [--roots f,g] [--max-method-size bytes] [--resource-threshold n] [--jobs n] [--report file]" << std::endl;
+}
+
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        if (end > start) items.push_back(list.substr(start, end - start));
+        start = end + 1;
+    }
+    return items;
+}
+
+// The public class must be named after the .java file it lives in
+std::string classNameFor(const std::string& outputFile) {
+    size_t start = outputFile.find_last_of("/\\");
+    start = (start == std::string::npos) ? 0 : start + 1;
+    size_t end = outputFile.find('.', start);
+    return outputFile.substr(start, end == std::string::npos ? std::string::npos : end - start);
 }
 
 int main(int argc, char* argv[]) {
@@ -22,11 +43,53 @@ int main(int argc, char* argv[]) {
 
     std::string inputFile = argv[1];
     std::string outputFile = "output.java";
+    std::string reportFile;
+    CodeGenOptions options;
 
     for (int i = 2; i < argc; i++) {
-        if (std::string(argv[i]) == "-o" && i + 1 < argc) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
             outputFile = argv[i + 1];
             i++;
+        } else if (arg == "--optimize") {
+            options.hoistLoopInvariants = true;
+        } else if (arg == "--soa") {
+            options.structOfArrays = true;
+        } else if (arg == "--vectorize") {
+            options.vectorize = true;
+        } else if (arg == "--emit-benchmarks") {
+            options.emitBenchmarks = true;
+        } else if (arg == "--profile" && i + 1 < argc) {
+            options.profile = FileReader::readFileAsString(argv[++i]);
+            if (options.profile.empty()) {
+                Logger::logError("Failed to read profile: " + std::string(argv[i]));
+                return 1;
+            }
+        } else if (arg == "--roots" && i + 1 < argc) {
+            options.roots = splitList(argv[++i]);
+        } else if (arg == "--max-method-size" && i + 1 < argc) {
+            options.methodSizeLimit = std::stoi(argv[++i]);
+        } else if (arg == "--resource-threshold" && i + 1 < argc) {
+            options.resourceThreshold = std::stoi(argv[++i]);
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            options.codegenThreads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--report" && i + 1 < argc) {
+            reportFile = argv[++i];
+        }
+    }
+    options.className = classNameFor(outputFile);
+    size_t slash = outputFile.find_last_of("/\\");
+    options.runtimeDirectory = slash == std::string::npos ? "." : outputFile.substr(0, slash);
+    options.sourcePath = inputFile;
+    if (options.emitBenchmarks) {
+        // Benchmark parameters may come from a sidecar file: `kernels.bench` beside `kernels.cpp`
+        size_t dot = inputFile.find_last_of('.');
+        bool extension = dot != std::string::npos && dot > inputFile.find_last_of("/\\") + 1;
+        std::string sidecar = (extension ? inputFile.substr(0, dot) : inputFile) + ".bench";
+        std::ifstream parameters(sidecar);
+        if (parameters) {
+            options.benchmarkParameters.assign(std::istreambuf_iterator<char>(parameters), std::istreambuf_iterator<char>());
+            Logger::logInfo("Benchmark parameters read from: " + sidecar);
         }
     }
 
@@ -63,11 +126,20 @@ int main(int argc, char* argv[]) {
         Logger::logError("Failed to open output file: " + outputFile);
         return 1;
     }
+    writer.setIndentUnit("    ");
     JavaEmitter emitter(writer);
-    CodeGenerator codeGenerator(emitter);
+    CodeGenerator codeGenerator(emitter, options);
     codeGenerator.generateCode(ast);
     Logger::logInfo("Java code generation completed.");
 
+    if (!reportFile.empty()) {
+        std::ofstream report(reportFile);
+        for (const auto& line : codeGenerator.getReport()) report << line << "\n";
+        Logger::logInfo("Optimization report written to: " + reportFile);
+    } else {
+        for (const auto& line : codeGenerator.getReport()) Logger::logInfo(line);
+    }
+
     writer.close();
     Logger::logInfo("Java code written to: " + outputFile);
     return 0;
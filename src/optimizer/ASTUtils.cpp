@@ -0,0 +1,213 @@
+#include "ASTUtils.h"
+
+void ASTUtils::forEachChild(const ASTNodePtr& node, const std::function<void(ASTNodePtr&)>& visit) {
+    if (!node) return;
+
+    switch (node->type) {
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+            visit(binExpr->left);
+            visit(binExpr->right);
+            break;
+        }
+        case NodeType::UNARY_EXPRESSION:
+            visit(std::static_pointer_cast<UnaryExpressionNode>(node)->operand);
+            break;
+        case NodeType::MEMBER_ACCESS:
+            visit(std::static_pointer_cast<MemberAccessNode>(node)->object);
+            break;
+        case NodeType::ARRAY_ACCESS: {
+            auto arrayAccess = std::static_pointer_cast<ArrayAccessNode>(node);
+            visit(arrayAccess->array);
+            visit(arrayAccess->index);
+            break;
+        }
+        case NodeType::INITIALIZER_LIST:
+            for (auto& element : std::static_pointer_cast<InitializerListNode>(node)->elements) visit(element);
+            break;
+        case NodeType::FUNCTION_CALL: {
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
+            visit(funcCall->functionName);
+            for (auto& arg : funcCall->arguments) visit(arg);
+            break;
+        }
+        case NodeType::VARIABLE_DECLARATION: {
+            auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(node);
+            visit(varDecl->identifier);
+            for (auto& size : varDecl->arraySizes) {
+                if (size) visit(size);
+            }
+            for (auto& arg : varDecl->constructorArguments) visit(arg);
+            if (varDecl->initializer) visit(varDecl->initializer);
+            break;
+        }
+        case NodeType::FUNCTION_DECLARATION: {
+            auto funcDecl = std::static_pointer_cast<FunctionDeclarationNode>(node);
+            visit(funcDecl->functionName);
+            for (auto& param : funcDecl->parameters) visit(param);
+            if (funcDecl->body) visit(funcDecl->body);
+            break;
+        }
+        case NodeType::RETURN_STATEMENT: {
+            auto returnStmt = std::static_pointer_cast<ReturnStatementNode>(node);
+            if (returnStmt->expression) visit(returnStmt->expression);
+            break;
+        }
+        case NodeType::IF_STATEMENT: {
+            auto ifStmt = std::static_pointer_cast<IfStatementNode>(node);
+            visit(ifStmt->condition);
+            visit(ifStmt->thenBlock);
+            if (ifStmt->elseBlock) visit(ifStmt->elseBlock);
+            break;
+        }
+        case NodeType::WHILE_LOOP: {
+            auto whileLoop = std::static_pointer_cast<WhileLoopNode>(node);
+            visit(whileLoop->condition);
+            visit(whileLoop->body);
+            break;
+        }
+        case NodeType::FOR_LOOP: {
+            auto forLoop = std::static_pointer_cast<ForLoopNode>(node);
+            for (auto& init : forLoop->initializers) visit(init);
+            if (forLoop->range) visit(forLoop->range);
+            if (forLoop->condition) visit(forLoop->condition);
+            for (auto& increment : forLoop->increments) visit(increment);
+            visit(forLoop->body);
+            break;
+        }
+        case NodeType::BLOCK:
+            for (auto& stmt : std::static_pointer_cast<BlockNode>(node)->statements) visit(stmt);
+            break;
+        case NodeType::STRUCT_DECLARATION:
+            for (auto& field : std::static_pointer_cast<StructDeclarationNode>(node)->fields) visit(field);
+            break;
+        case NodeType::SWITCH_STATEMENT: {
+            auto switchStmt = std::static_pointer_cast<SwitchStatementNode>(node);
+            visit(switchStmt->expression);
+            for (auto& clause : switchStmt->cases) visit(clause);
+            break;
+        }
+        case NodeType::CASE_CLAUSE: {
+            auto clause = std::static_pointer_cast<CaseClauseNode>(node);
+            if (clause->value) visit(clause->value);
+            visit(clause->body);
+            break;
+        }
+        case NodeType::NEW_EXPRESSION: {
+            auto newExpr = std::static_pointer_cast<NewExpressionNode>(node);
+            if (newExpr->arraySize) visit(newExpr->arraySize);
+            for (auto& arg : newExpr->arguments) visit(arg);
+            break;
+        }
+        case NodeType::DELETE_STATEMENT:
+            visit(std::static_pointer_cast<DeleteStatementNode>(node)->operand);
+            break;
+        case NodeType::ENUM_DECLARATION:
+            for (auto& value : std::static_pointer_cast<EnumDeclarationNode>(node)->values) {
+                if (value) visit(value);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+namespace {
+
+template <typename T>
+ASTNodePtr copyOf(const ASTNodePtr& node) {
+    return std::make_shared<T>(*std::static_pointer_cast<T>(node));
+}
+
+} // namespace
+
+ASTNodePtr ASTUtils::clone(const ASTNodePtr& node) {
+    if (!node) return nullptr;
+
+    ASTNodePtr copy;
+    switch (node->type) {
+        case NodeType::IDENTIFIER: copy = copyOf<IdentifierNode>(node); break;
+        case NodeType::NUMBER_LITERAL: copy = copyOf<NumberNode>(node); break;
+        case NodeType::STRING_LITERAL: copy = copyOf<StringNode>(node); break;
+        case NodeType::CHAR_LITERAL: copy = copyOf<CharNode>(node); break;
+        case NodeType::BINARY_EXPRESSION: copy = copyOf<BinaryExpressionNode>(node); break;
+        case NodeType::UNARY_EXPRESSION: copy = copyOf<UnaryExpressionNode>(node); break;
+        case NodeType::MEMBER_ACCESS: copy = copyOf<MemberAccessNode>(node); break;
+        case NodeType::ARRAY_ACCESS: copy = copyOf<ArrayAccessNode>(node); break;
+        case NodeType::INITIALIZER_LIST: copy = copyOf<InitializerListNode>(node); break;
+        case NodeType::FUNCTION_CALL: copy = copyOf<FunctionCallNode>(node); break;
+        case NodeType::VARIABLE_DECLARATION: copy = copyOf<VariableDeclarationNode>(node); break;
+        case NodeType::FUNCTION_DECLARATION: copy = copyOf<FunctionDeclarationNode>(node); break;
+        case NodeType::RETURN_STATEMENT: copy = copyOf<ReturnStatementNode>(node); break;
+        case NodeType::IF_STATEMENT: copy = copyOf<IfStatementNode>(node); break;
+        case NodeType::WHILE_LOOP: copy = copyOf<WhileLoopNode>(node); break;
+        case NodeType::FOR_LOOP: copy = copyOf<ForLoopNode>(node); break;
+        case NodeType::BREAK_STATEMENT: copy = copyOf<BreakStatementNode>(node); break;
+        case NodeType::CONTINUE_STATEMENT: copy = copyOf<ContinueStatementNode>(node); break;
+        case NodeType::BLOCK: copy = copyOf<BlockNode>(node); break;
+        case NodeType::STRUCT_DECLARATION: copy = copyOf<StructDeclarationNode>(node); break;
+        case NodeType::SWITCH_STATEMENT: copy = copyOf<SwitchStatementNode>(node); break;
+        case NodeType::CASE_CLAUSE: copy = copyOf<CaseClauseNode>(node); break;
+        case NodeType::ENUM_DECLARATION: copy = copyOf<EnumDeclarationNode>(node); break;
+        case NodeType::NEW_EXPRESSION: copy = copyOf<NewExpressionNode>(node); break;
+        case NodeType::DELETE_STATEMENT: copy = copyOf<DeleteStatementNode>(node); break;
+        default: return node;
+    }
+    // The member-wise copy still shares its children
+    forEachChild(copy, [](ASTNodePtr& child) { child = clone(child); });
+    return copy;
+}
+
+bool ASTUtils::isAssignmentOperator(const std::string& op) {
+    return op == "=" || (op.size() >= 2 && op.back() == '=' &&
+                         op != "==" && op != "!=" && op != "<=" && op != ">=");
+}
+
+std::string ASTUtils::calleeName(const ASTNodePtr& node) {
+    auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node);
+    if (!funcCall) return "";
+    auto name = std::dynamic_pointer_cast<IdentifierNode>(funcCall->functionName);
+    return name ? name->name : "";
+}
+
+void ASTUtils::collectDeclarations(const ASTNodePtr& node, std::unordered_set<std::string>& names) {
+    if (!node) return;
+    if (node->type == NodeType::VARIABLE_DECLARATION) {
+        names.insert(rootVariable(std::static_pointer_cast<VariableDeclarationNode>(node)->identifier));
+    }
+    forEachChild(node, [&](ASTNodePtr& child) { collectDeclarations(child, names); });
+}
+
+std::string ASTUtils::rootVariable(const ASTNodePtr& node) {
+    if (!node) return "";
+
+    switch (node->type) {
+        case NodeType::IDENTIFIER:
+            return std::static_pointer_cast<IdentifierNode>(node)->name;
+        case NodeType::MEMBER_ACCESS:
+            return rootVariable(std::static_pointer_cast<MemberAccessNode>(node)->object);
+        case NodeType::ARRAY_ACCESS:
+            return rootVariable(std::static_pointer_cast<ArrayAccessNode>(node)->array);
+        case NodeType::UNARY_EXPRESSION:
+            return rootVariable(std::static_pointer_cast<UnaryExpressionNode>(node)->operand);
+        default:
+            return "";
+    }
+}
+
+bool ASTUtils::isMemoryAccess(const ASTNodePtr& node) {
+    if (!node) return false;
+
+    switch (node->type) {
+        case NodeType::ARRAY_ACCESS:
+            return true;
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            return unaryExpr->op == "*" || isMemoryAccess(unaryExpr->operand);
+        }
+        case NodeType::MEMBER_ACCESS:
+            return isMemoryAccess(std::static_pointer_cast<MemberAccessNode>(node)->object);
+        default:
+            return false;
+    }
+}
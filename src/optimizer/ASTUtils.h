@@ -0,0 +1,33 @@
+#ifndef ASTUTILS_H
+#define ASTUTILS_H
+
+#include "../parser/ASTNode.h"
+#include <functional>
+#include <string>
+#include <unordered_set>
+
+class ASTUtils {
+public:
+    // Calls `visit` on every direct child slot of `node`; slots may be reassigned
+    static void forEachChild(const ASTNodePtr& node, const std::function<void(ASTNodePtr&)>& visit);
+
+    // Deep copy of a subtree, annotations included
+    static ASTNodePtr clone(const ASTNodePtr& node);
+
+    // Returns true for =, +=, -=, ... (assignments are parsed as binary expressions)
+    static bool isAssignmentOperator(const std::string& op);
+
+    // Name of a called free function, or "" for member calls
+    static std::string calleeName(const ASTNodePtr& node);
+
+    // Collects the names of all variables declared inside `node`
+    static void collectDeclarations(const ASTNodePtr& node, std::unordered_set<std::string>& names);
+
+    // Variable an lvalue expression ultimately refers to (`p` for `p.x`), or ""
+    static std::string rootVariable(const ASTNodePtr& node);
+
+    // True for lvalues reached through a subscript or `*`, which may alias other variables
+    static bool isMemoryAccess(const ASTNodePtr& node);
+};
+
+#endif // ASTUTILS_H
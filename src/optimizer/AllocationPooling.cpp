@@ -0,0 +1,237 @@
+#include "AllocationPooling.h"
+#include "ASTUtils.h"
+#include "../parser/TypeChecker.h"
+
+namespace {
+
+bool isVariable(const ASTNodePtr& node, const std::string& var) {
+    return node && node->type == NodeType::IDENTIFIER && std::static_pointer_cast<IdentifierNode>(node)->name == var;
+}
+
+// Library calls that only access their pointer arguments while they run
+bool isBufferCall(const std::string& callee) {
+    static const std::unordered_set<std::string> calls = {
+        "memcpy", "memmove", "memset", "memcmp", "copy", "fill", "fill_n", "sort"
+    };
+    return calls.count(callee.rfind("std::", 0) == 0 ? callee.substr(5) : callee) > 0;
+}
+
+// Vector members that neither hand out the storage nor take another vector's
+bool isContainedMember(const std::string& member) {
+    static const std::unordered_set<std::string> members = {
+        "size", "empty", "clear", "reserve", "resize", "push_back", "emplace_back", "pop_back", "back", "front", "at"
+    };
+    return members.count(member) > 0;
+}
+
+// True when `node` uses `var` in any way other than the contained ones above:
+// copies, reassignments, arguments to other functions, pointer arithmetic...
+bool escapes(const ASTNodePtr& node, const std::string& var) {
+    if (!node) return false;
+
+    switch (node->type) {
+        case NodeType::IDENTIFIER:
+            return isVariable(node, var);
+        case NodeType::ARRAY_ACCESS: {
+            auto arrayAccess = std::static_pointer_cast<ArrayAccessNode>(node);
+            if (isVariable(arrayAccess->array, var)) return escapes(arrayAccess->index, var);
+            break;
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            if (unaryExpr->op == "*" && isVariable(unaryExpr->operand, var)) return false;
+            break;
+        }
+        case NodeType::DELETE_STATEMENT:
+            if (isVariable(std::static_pointer_cast<DeleteStatementNode>(node)->operand, var)) return false;
+            break;
+        case NodeType::FUNCTION_CALL: {
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
+            auto member = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName);
+            if (member && isVariable(member->object, var)) {
+                if (!isContainedMember(member->member)) return true;
+                for (const auto& arg : funcCall->arguments) {
+                    if (escapes(arg, var)) return true;
+                }
+                return false;
+            }
+            if (!isBufferCall(ASTUtils::calleeName(node))) break;
+            for (const auto& arg : funcCall->arguments) {
+                // `p` and `p + k` are only read for the duration of the call
+                auto offset = std::dynamic_pointer_cast<BinaryExpressionNode>(arg);
+                if (isVariable(arg, var)) continue;
+                if (offset && (offset->op == "+" || offset->op == "-") && isVariable(offset->left, var)) {
+                    if (escapes(offset->right, var)) return true;
+                    continue;
+                }
+                if (escapes(arg, var)) return true;
+            }
+            return false;
+        }
+        default:
+            break;
+    }
+
+    bool found = false;
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) {
+        if (!found && escapes(child, var)) found = true;
+    });
+    return found;
+}
+
+int countDeletes(const ASTNodePtr& node, const std::string& var) {
+    if (!node) return 0;
+    if (node->type == NodeType::DELETE_STATEMENT &&
+        isVariable(std::static_pointer_cast<DeleteStatementNode>(node)->operand, var)) {
+        return 1;
+    }
+    int count = 0;
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { count += countDeletes(child, var); });
+    return count;
+}
+
+} // namespace
+
+AllocationPooling::AllocationPooling(const SideEffectAnalysis& analysis) : analysis(analysis) {}
+
+std::vector<std::string> AllocationPooling::run(const ASTNodePtr& program) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return {};
+
+    SideEffectAnalysis analysis(program);
+    AllocationPooling pass(analysis);
+
+    for (const auto& stmt : block->statements) {
+        auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+        if (!funcDecl || !funcDecl->body || funcDecl->cold) continue;
+
+        pass.functionName = ASTUtils::rootVariable(funcDecl->functionName);
+        pass.names.clear();
+        for (const auto& param : funcDecl->parameters) pass.names.insert(ASTUtils::rootVariable(param));
+        ASTUtils::collectDeclarations(funcDecl->body, pass.names);
+        pass.processBlock(funcDecl->body, false);
+    }
+    return pass.report;
+}
+
+void AllocationPooling::processStatement(const ASTNodePtr& stmt, bool inLoop) {
+    if (!stmt) return;
+
+    switch (stmt->type) {
+        case NodeType::IF_STATEMENT: {
+            auto ifStmt = std::static_pointer_cast<IfStatementNode>(stmt);
+            processBlock(ifStmt->thenBlock, inLoop);
+            processBlock(ifStmt->elseBlock, inLoop);
+            break;
+        }
+        case NodeType::WHILE_LOOP:
+            processBlock(std::static_pointer_cast<WhileLoopNode>(stmt)->body, !inParallelLoop);
+            break;
+        case NodeType::FOR_LOOP: {
+            // Iterations of a parallel loop run at once: one shared buffer would
+            // race, the per-thread free lists do not
+            auto forLoop = std::static_pointer_cast<ForLoopNode>(stmt);
+            bool enclosingParallel = inParallelLoop;
+            inParallelLoop = inParallelLoop || forLoop->parallel;
+            processBlock(forLoop->body, !inParallelLoop);
+            inParallelLoop = enclosingParallel;
+            break;
+        }
+        case NodeType::SWITCH_STATEMENT:
+            for (const auto& clause : std::static_pointer_cast<SwitchStatementNode>(stmt)->cases) {
+                processBlock(std::static_pointer_cast<CaseClauseNode>(clause)->body, inLoop);
+            }
+            break;
+        case NodeType::BLOCK:
+            processBlock(stmt, inLoop);
+            break;
+        default:
+            break;
+    }
+}
+
+void AllocationPooling::processBlock(const ASTNodePtr& node, bool inLoop) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(node);
+    if (!block) return;
+
+    for (size_t i = 0; i < block->statements.size(); ++i) {
+        processStatement(block->statements[i], inLoop);
+
+        auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(block->statements[i]);
+        if (!varDecl || !varDecl->arraySizes.empty()) continue;
+        auto newExpr = std::dynamic_pointer_cast<NewExpressionNode>(varDecl->initializer);
+        if (newExpr && newExpr->arraySize) {
+            poolArray(block, i, inLoop);
+        } else if (inLoop && !varDecl->initializer && varDecl->constructorArguments.empty()) {
+            poolVector(block, i);
+        }
+    }
+}
+
+// `T* p = new T[n];` followed in the same block by `delete[] p;`
+void AllocationPooling::poolArray(const std::shared_ptr<BlockNode>& block, size_t index, bool inLoop) {
+    auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(block->statements[index]);
+    auto newExpr = std::static_pointer_cast<NewExpressionNode>(varDecl->initializer);
+    std::string element = TypeChecker::normalizeType(newExpr->typeName);
+    if (!TypeChecker::isArithmeticType(element)) return;
+
+    std::string var = ASTUtils::rootVariable(varDecl->identifier);
+    std::string site = "'new " + element + "[]' for '" + var + "' in '" + functionName + "'";
+
+    std::shared_ptr<DeleteStatementNode> freed;
+    int deletes = 0;
+    bool escaped = false;
+    for (size_t i = index + 1; i < block->statements.size(); ++i) {
+        const ASTNodePtr& stmt = block->statements[i];
+        deletes += countDeletes(stmt, var);
+        escaped = escaped || escapes(stmt, var);
+        auto del = std::dynamic_pointer_cast<DeleteStatementNode>(stmt);
+        if (del && del->array && isVariable(del->operand, var)) freed = del;
+    }
+
+    if (!freed || deletes != 1) {
+        report.push_back("Kept " + site + ": not freed by one delete[] in the same block");
+    } else if (escaped) {
+        report.push_back("Kept " + site + ": the pointer escapes");
+    } else if (newExpr->valueInitialized) {
+        report.push_back("Kept " + site + ": a reused buffer would need zeroing");
+    } else if (inLoop && !analysis.isPure(newExpr->arraySize)) {
+        report.push_back("Kept " + site + ": the size has side effects");
+    } else if (inLoop) {
+        newExpr->reusedLocal = poolName(var);
+        report.push_back("Pooled " + site + ": one buffer '" + newExpr->reusedLocal + "' reused across iterations");
+    } else {
+        newExpr->freeList = true;
+        freed->pooled = true;
+        report.push_back("Pooled " + site + ": per-thread free list");
+    }
+}
+
+// `std::vector<T> v;` in a loop body is cleared instead of reallocated
+void AllocationPooling::poolVector(const std::shared_ptr<BlockNode>& block, size_t index) {
+    auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(block->statements[index]);
+    std::string type = TypeChecker::normalizeType(varDecl->type);
+    std::vector<std::string> arguments = TypeChecker::templateArguments(type);
+    if (TypeChecker::templateName(type) != "vector" || arguments.size() != 1 ||
+        !TypeChecker::isArithmeticType(arguments[0])) {
+        return;
+    }
+
+    std::string var = ASTUtils::rootVariable(varDecl->identifier);
+    std::string site = "'" + type + " " + var + "' in '" + functionName + "'";
+    for (size_t i = index + 1; i < block->statements.size(); ++i) {
+        if (escapes(block->statements[i], var)) {
+            report.push_back("Kept " + site + ": the vector escapes");
+            return;
+        }
+    }
+    varDecl->reusedLocal = poolName(var);
+    report.push_back("Pooled " + site + ": cleared into '" + varDecl->reusedLocal + "' each iteration");
+}
+
+std::string AllocationPooling::poolName(const std::string& variable) {
+    std::string name = variable + "$pool";
+    for (int i = 1; names.count(name); ++i) name = variable + "$pool" + std::to_string(i);
+    names.insert(name);
+    return name;
+}
@@ -0,0 +1,45 @@
+#ifndef ALLOCATIONPOOLING_H
+#define ALLOCATIONPOOLING_H
+
+#include "../parser/ASTNode.h"
+#include "SideEffectAnalysis.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Escape analysis for heap allocations that die with the block making them,
+// so that translated hot loops stop churning the young generation:
+//
+//  - `T* p = new T[n]; ... delete[] p;` inside a loop reuses one buffer per
+//    call, reallocated only when `n` outgrows it.
+//  - The same pair outside a loop takes its buffer from a per-thread free
+//    list (IntArrayPool, ...) and gives it back at the `delete[]`.
+//  - A `std::vector` of primitives declared in a loop body is cleared into
+//    one container per call instead of being rebuilt every iteration.
+//
+// The pointer or vector must not escape: it is only subscripted,
+// dereferenced, used through members that do not expose its storage or
+// passed to memcpy-like library calls, and never reassigned. Single objects
+// (`new Point`) are left to the JIT, which scalar-replaces them itself.
+class AllocationPooling {
+public:
+    // Annotates the program in place; returns one report line per allocation site examined
+    static std::vector<std::string> run(const ASTNodePtr& program);
+
+private:
+    explicit AllocationPooling(const SideEffectAnalysis& analysis);
+
+    void processStatement(const ASTNodePtr& stmt, bool inLoop);
+    void processBlock(const ASTNodePtr& node, bool inLoop);
+    void poolArray(const std::shared_ptr<BlockNode>& block, size_t index, bool inLoop);
+    void poolVector(const std::shared_ptr<BlockNode>& block, size_t index);
+    std::string poolName(const std::string& variable);
+
+    const SideEffectAnalysis& analysis;
+    std::string functionName;
+    bool inParallelLoop = false;  // Inside the body of an OpenMP parallel for
+    std::unordered_set<std::string> names;  // Locals of the current function, including chosen pool names
+    std::vector<std::string> report;
+};
+
+#endif // ALLOCATIONPOOLING_H
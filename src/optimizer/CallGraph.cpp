@@ -0,0 +1,58 @@
+#include "CallGraph.h"
+#include "ASTUtils.h"
+#include <unordered_set>
+
+namespace {
+
+void collectCallees(const ASTNodePtr& node, std::set<std::string>& callees) {
+    if (!node) return;
+    if (node->type == NodeType::FUNCTION_CALL) {
+        std::string callee = ASTUtils::calleeName(node);
+        if (!callee.empty()) callees.insert(callee);
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectCallees(child, callees); });
+}
+
+} // namespace
+
+CallGraph::CallGraph(const ASTNodePtr& program) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return;
+
+    for (const auto& stmt : block->statements) {
+        auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+        if (!funcDecl) continue;
+
+        std::string name = ASTUtils::rootVariable(funcDecl->functionName);
+        if (!edges.count(name)) order.push_back(name);
+        collectCallees(funcDecl->body, edges[name]);
+    }
+}
+
+const std::vector<std::string>& CallGraph::functions() const {
+    return order;
+}
+
+bool CallGraph::isDefined(const std::string& name) const {
+    return edges.count(name) > 0;
+}
+
+const std::set<std::string>& CallGraph::callees(const std::string& name) const {
+    static const std::set<std::string> none;
+    auto it = edges.find(name);
+    return it != edges.end() ? it->second : none;
+}
+
+bool CallGraph::reaches(const std::string& from, const std::string& to) const {
+    std::unordered_set<std::string> visited;
+    std::vector<std::string> worklist(callees(from).begin(), callees(from).end());
+
+    while (!worklist.empty()) {
+        std::string current = worklist.back();
+        worklist.pop_back();
+        if (current == to) return true;
+        if (!visited.insert(current).second) continue;
+        for (const auto& callee : callees(current)) worklist.push_back(callee);
+    }
+    return false;
+}
@@ -0,0 +1,31 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include "../parser/ASTNode.h"
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Caller -> callee edges between the free functions of a translation unit,
+// built from the FunctionCallNodes in each function body.
+class CallGraph {
+public:
+    explicit CallGraph(const ASTNodePtr& program);
+
+    // Functions defined in the program, in source order
+    const std::vector<std::string>& functions() const;
+    bool isDefined(const std::string& name) const;
+
+    // Everything `name` calls directly (including functions defined elsewhere)
+    const std::set<std::string>& callees(const std::string& name) const;
+
+    // True when `to` can be reached from `from` through one or more calls
+    bool reaches(const std::string& from, const std::string& to) const;
+
+private:
+    std::vector<std::string> order;
+    std::unordered_map<std::string, std::set<std::string>> edges;
+};
+
+#endif // CALLGRAPH_H
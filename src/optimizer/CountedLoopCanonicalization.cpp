@@ -0,0 +1,362 @@
+#include "CountedLoopCanonicalization.h"
+#include "ASTUtils.h"
+#include "LoopInvariantMotion.h"
+#include "../parser/TypeChecker.h"
+#include <climits>
+#include <unordered_map>
+
+namespace {
+
+bool isVariable(const ASTNodePtr& node, const std::string& var) {
+    return node && node->type == NodeType::IDENTIFIER && std::static_pointer_cast<IdentifierNode>(node)->name == var;
+}
+
+// Value of an integer literal, including a negated one
+bool integerLiteral(const ASTNodePtr& node, long long& value) {
+    if (auto unaryExpr = std::dynamic_pointer_cast<UnaryExpressionNode>(node)) {
+        if (unaryExpr->op != "-" || !integerLiteral(unaryExpr->operand, value)) return false;
+        value = -value;
+        return true;
+    }
+    auto number = std::dynamic_pointer_cast<NumberNode>(node);
+    if (!number || !TypeChecker::isIntegralType(TypeChecker::literalType(number->text))) return false;
+    if (number->value > static_cast<double>(LLONG_MAX)) return false;
+    value = static_cast<long long>(number->value);
+    return true;
+}
+
+// `++i`, `i--`, `i += 4`, `i -= 2`
+bool constantStride(const ASTNodePtr& increment, std::string& var, long long& stride) {
+    if (auto unaryExpr = std::dynamic_pointer_cast<UnaryExpressionNode>(increment)) {
+        if ((unaryExpr->op != "++" && unaryExpr->op != "--") || unaryExpr->operand->type != NodeType::IDENTIFIER) {
+            return false;
+        }
+        var = std::static_pointer_cast<IdentifierNode>(unaryExpr->operand)->name;
+        stride = unaryExpr->op == "++" ? 1 : -1;
+        return true;
+    }
+    auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(increment);
+    if (!binExpr || (binExpr->op != "+=" && binExpr->op != "-=") || binExpr->left->type != NodeType::IDENTIFIER ||
+        !integerLiteral(binExpr->right, stride) || stride == 0) {
+        return false;
+    }
+    var = std::static_pointer_cast<IdentifierNode>(binExpr->left)->name;
+    if (binExpr->op == "-=") stride = -stride;
+    return true;
+}
+
+std::string mirrored(const std::string& op) {
+    if (op == "<") return ">";
+    if (op == ">") return "<";
+    if (op == "<=") return ">=";
+    if (op == ">=") return "<=";
+    return op;
+}
+
+bool isArithmeticOperator(const std::string& op) {
+    return op == "+" || op == "-" || op == "*" || op == "/" || op == "%" ||
+           op == "<<" || op == ">>" || op == "&" || op == "|" || op == "^";
+}
+
+// The low 32 bits of the result depend only on the low 32 bits of the operands
+bool isModularOperator(const std::string& op) {
+    return op == "+" || op == "-" || op == "*" || op == "<<" || op == "&" || op == "|" || op == "^";
+}
+
+// `i / k`, `i % k`, `i >> k` and `i & k` cannot leave the range of a non-negative int `i`
+bool isExactOperator(const std::string& op) {
+    return op == "/" || op == "%" || op == ">>" || op == "&";
+}
+
+// True when the type of `node` follows the type of `var`, as in `i * 2`
+bool followsType(const ASTNodePtr& node, const std::string& var) {
+    if (!node) return false;
+    switch (node->type) {
+        case NodeType::IDENTIFIER:
+            return isVariable(node, var);
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+            if (isArithmeticOperator(binExpr->op)) return followsType(binExpr->left, var) || followsType(binExpr->right, var);
+            return ASTUtils::isAssignmentOperator(binExpr->op) && followsType(binExpr->left, var);
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            return unaryExpr->op != "!" && followsType(unaryExpr->operand, var);
+        }
+        default:
+            return false;
+    }
+}
+
+bool sameAtEitherWidth(const ASTNodePtr& node, const std::string& var);
+
+// Subscripts are converted to int anyway, so wrapping arithmetic on the variable is harmless there
+bool sameAsIndex(const ASTNodePtr& node, const std::string& var) {
+    auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node);
+    if (binExpr && isModularOperator(binExpr->op)) {
+        return sameAsIndex(binExpr->left, var) && sameAsIndex(binExpr->right, var);
+    }
+    return sameAtEitherWidth(node, var);
+}
+
+// True when every use of `var` under `node` yields the same value whether the
+// variable keeps its declared type or is an int holding the same value
+bool sameAtEitherWidth(const ASTNodePtr& node, const std::string& var) {
+    if (!node) return true;
+
+    switch (node->type) {
+        case NodeType::ARRAY_ACCESS: {
+            auto access = std::static_pointer_cast<ArrayAccessNode>(node);
+            return sameAtEitherWidth(access->array, var) && sameAsIndex(access->index, var);
+        }
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+            if (isArithmeticOperator(binExpr->op)) {
+                bool exact = isExactOperator(binExpr->op) && isVariable(binExpr->left, var) &&
+                             !followsType(binExpr->right, var);
+                if (!exact && (followsType(binExpr->left, var) || followsType(binExpr->right, var))) return false;
+            }
+            return sameAtEitherWidth(binExpr->left, var) && sameAtEitherWidth(binExpr->right, var);
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            // Negation can overflow, and `&i` would change the pointee type
+            if (unaryExpr->op != "!" && followsType(unaryExpr->operand, var)) return false;
+            if (unaryExpr->op == "&" && ASTUtils::rootVariable(unaryExpr->operand) == var) return false;
+            return sameAtEitherWidth(unaryExpr->operand, var);
+        }
+        default: {
+            bool same = true;
+            ASTUtils::forEachChild(node, [&](ASTNodePtr& child) {
+                if (same) same = sameAtEitherWidth(child, var);
+            });
+            return same;
+        }
+    }
+}
+
+// Declared types of a function's variables; a name declared with two different types is left out
+void collectTypes(const ASTNodePtr& node, SymbolTable& types, std::unordered_map<std::string, std::string>& seen) {
+    if (!node) return;
+    if (auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(node)) {
+        std::string name = ASTUtils::rootVariable(varDecl->identifier);
+        auto it = seen.find(name);
+        if (it == seen.end()) {
+            seen[name] = varDecl->type;
+            types.addSymbol(name, varDecl->type);
+        } else if (it->second != varDecl->type) {
+            types.removeSymbol(name);
+        }
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectTypes(child, types, seen); });
+}
+
+} // namespace
+
+CountedLoopCanonicalization::CountedLoopCanonicalization(const SideEffectAnalysis& analysis)
+    : analysis(analysis), changedCount(0), boundCount(0) {}
+
+int CountedLoopCanonicalization::run(const ASTNodePtr& program) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return 0;
+
+    SideEffectAnalysis analysis(program);
+    CountedLoopCanonicalization pass(analysis);
+
+    SymbolTable globals;
+    for (const auto& stmt : block->statements) {
+        if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt)) {
+            globals.addSymbol(ASTUtils::rootVariable(funcDecl->functionName), funcDecl->returnType);
+        } else if (auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(stmt)) {
+            globals.addSymbol(ASTUtils::rootVariable(varDecl->identifier), varDecl->type);
+        }
+    }
+
+    for (const auto& stmt : block->statements) {
+        auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+        if (!funcDecl || !funcDecl->body || funcDecl->cold) continue;
+
+        pass.functionLocals.clear();
+        pass.types = globals;
+        std::unordered_map<std::string, std::string> seen;
+        for (size_t i = 0; i < funcDecl->parameters.size(); ++i) {
+            std::string name = ASTUtils::rootVariable(funcDecl->parameters[i]);
+            pass.functionLocals.insert(name);
+            if (i < funcDecl->parameterTypes.size()) {
+                seen[name] = funcDecl->parameterTypes[i];
+                pass.types.addSymbol(name, funcDecl->parameterTypes[i]);
+            }
+        }
+        ASTUtils::collectDeclarations(funcDecl->body, pass.functionLocals);
+        collectTypes(funcDecl->body, pass.types, seen);
+
+        pass.processBlock(funcDecl->body);
+    }
+    return pass.changedCount;
+}
+
+void CountedLoopCanonicalization::processStatement(const ASTNodePtr& stmt) {
+    if (!stmt) return;
+
+    switch (stmt->type) {
+        case NodeType::IF_STATEMENT: {
+            auto ifStmt = std::static_pointer_cast<IfStatementNode>(stmt);
+            processStatement(ifStmt->thenBlock);
+            processStatement(ifStmt->elseBlock);
+            break;
+        }
+        case NodeType::WHILE_LOOP:
+            processStatement(std::static_pointer_cast<WhileLoopNode>(stmt)->body);
+            break;
+        case NodeType::FOR_LOOP:
+            processStatement(std::static_pointer_cast<ForLoopNode>(stmt)->body);
+            break;
+        case NodeType::SWITCH_STATEMENT:
+            for (const auto& clause : std::static_pointer_cast<SwitchStatementNode>(stmt)->cases) {
+                processBlock(std::static_pointer_cast<CaseClauseNode>(clause)->body);
+            }
+            break;
+        case NodeType::BLOCK:
+            processBlock(stmt);
+            break;
+        default:
+            break;
+    }
+}
+
+void CountedLoopCanonicalization::processBlock(const ASTNodePtr& node) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(node);
+    if (!block) return;
+
+    for (size_t i = 0; i < block->statements.size(); ++i) {
+        ASTNodePtr stmt = block->statements[i];
+        processStatement(stmt);  // Inner loops first
+
+        if (stmt->type != NodeType::FOR_LOOP) continue;
+        if (ASTNodePtr bound = canonicalize(std::static_pointer_cast<ForLoopNode>(stmt))) {
+            block->statements.insert(block->statements.begin() + i, bound);
+            i++;
+        }
+    }
+}
+
+ASTNodePtr CountedLoopCanonicalization::canonicalize(const std::shared_ptr<ForLoopNode>& loop) {
+    auto condition = std::dynamic_pointer_cast<BinaryExpressionNode>(loop->condition);
+    std::string var;
+    long long stride = 0;
+    if (!condition || loop->increments.size() != 1 || !constantStride(loop->increments[0], var, stride)) return nullptr;
+
+    // `n > i` is `i < n`
+    if (isVariable(condition->right, var) && !isVariable(condition->left, var)) {
+        std::swap(condition->left, condition->right);
+        condition->op = mirrored(condition->op);
+    }
+    const std::string& op = condition->op;
+    bool counts = ((op == "<" || op == "<=") && stride > 0) || ((op == ">" || op == ">=") && stride < 0) ||
+                  (op == "!=" && (stride == 1 || stride == -1));
+    if (!counts || !isVariable(condition->left, var)) return nullptr;
+
+    // The increment must be the only write to the induction variable
+    std::unordered_set<std::string> written;
+    analysis.collectWrites(loop->body, written);
+    analysis.collectWrites(condition->right, written);
+    if (written.count(var)) return nullptr;
+
+    bool changed = false;
+    auto induction = loop->initializers.size() == 1
+        ? std::dynamic_pointer_cast<VariableDeclarationNode>(loop->initializers[0]) : nullptr;
+    if (induction && ASTUtils::rootVariable(induction->identifier) == var && induction->initializer &&
+        induction->arraySizes.empty() && narrow(loop, induction, op, condition->right, stride)) {
+        types.addSymbol(var, induction->type);
+        changed = true;
+    }
+
+    // Literals and locals are already loop-invariant values the JIT can see
+    ASTNodePtr& bound = condition->right;
+    bool simple = bound->type == NodeType::NUMBER_LITERAL ||
+                  (bound->type == NodeType::IDENTIFIER && functionLocals.count(ASTUtils::rootVariable(bound)));
+    std::string inductionType = TypeChecker::normalizeType(types.getType(var));
+    ASTNodePtr hoisted;
+    if (!simple && TypeChecker::isIntegralType(inductionType) &&
+        LoopInvariantMotion::isLoopInvariant(bound, loop, analysis, functionLocals)) {
+        // The comparison converts both sides to their common type; the local holds the bound in that type
+        std::string boundType = TypeChecker::inferType(bound, types);
+        std::string type = TypeChecker::isArithmeticType(boundType) ? TypeChecker::arithmeticType(inductionType, boundType)
+                                                                    : inductionType;
+        std::string name = "end$" + std::to_string(boundCount++);
+        hoisted = std::make_shared<VariableDeclarationNode>("const " + type, std::make_shared<IdentifierNode>(name), bound);
+        bound = std::make_shared<IdentifierNode>(name);
+        functionLocals.insert(name);
+        types.addSymbol(name, "const " + type);
+        changed = true;
+    }
+
+    if (changed) changedCount++;
+    return hoisted;
+}
+
+bool CountedLoopCanonicalization::narrow(const std::shared_ptr<ForLoopNode>& loop,
+                                         const std::shared_ptr<VariableDeclarationNode>& induction,
+                                         const std::string& op, const ASTNodePtr& bound, long long stride) {
+    std::string type = TypeChecker::normalizeType(induction->type);
+    if (induction->type.rfind("const", 0) == 0 || !TypeChecker::isIntegralType(type) || type == "int" ||
+        TypeChecker::bitWidth(type) < 32) {
+        return false;
+    }
+
+    // The start and every value the variable takes until the loop exits must fit
+    // in an int, or the int would wrap where the original type did not
+    bool isUnsigned = TypeChecker::isUnsignedType(type);
+    if (!fitsInt(induction->initializer, isUnsigned)) return false;
+
+    long long limit = 0;
+    bool literal = integerLiteral(bound, limit);
+    bool fits = false;
+    if (op == "<") {
+        fits = fitsInt(bound, isUnsigned) && (stride == 1 || (literal && limit - 1 + stride <= INT_MAX));
+    } else if (op == "<=") {
+        fits = literal && fitsInt(bound, isUnsigned) && limit + stride <= INT_MAX;
+    } else if (op == ">") {
+        // An unsigned variable stepping past zero wraps around in C++
+        fits = fitsInt(bound, isUnsigned) &&
+               (stride == -1 || (!isUnsigned && literal && limit + 1 + stride >= INT_MIN));
+    } else if (op == ">=") {
+        fits = !isUnsigned && literal && fitsInt(bound, false) && limit + stride >= INT_MIN;
+    }
+
+    std::string var = ASTUtils::rootVariable(induction->identifier);
+    if (!fits || !sameAtEitherWidth(loop->body, var)) return false;
+
+    induction->type = "int";
+    return true;
+}
+
+// True when `expr` is provably within int range, and non-negative if requested
+bool CountedLoopCanonicalization::fitsInt(const ASTNodePtr& expr, bool nonNegative) const {
+    long long value = 0;
+    if (integerLiteral(expr, value)) return value <= INT_MAX && value >= (nonNegative ? 0 : INT_MIN);
+
+    switch (expr->type) {
+        case NodeType::IDENTIFIER: {
+            std::string type = TypeChecker::normalizeType(types.getType(ASTUtils::rootVariable(expr)));
+            if (!TypeChecker::isIntegralType(type) || type == "bool") return false;
+            int bits = TypeChecker::bitWidth(type);
+            if (nonNegative) return TypeChecker::isUnsignedType(type) && bits < 32;
+            return bits < 32 || (bits == 32 && !TypeChecker::isUnsignedType(type));
+        }
+        case NodeType::FUNCTION_CALL: {
+            // Translated containers and strings count their elements in an int
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(expr);
+            auto member = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName);
+            return member && funcCall->arguments.empty() && (member->member == "size" || member->member == "length");
+        }
+        case NodeType::BINARY_EXPRESSION: {
+            // Arithmetic on int operands is carried out in int
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(expr);
+            return !nonNegative && isArithmeticOperator(binExpr->op) &&
+                   fitsInt(binExpr->left, false) && fitsInt(binExpr->right, false);
+        }
+        default:
+            return false;
+    }
+}
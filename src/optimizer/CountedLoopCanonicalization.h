@@ -0,0 +1,44 @@
+#ifndef COUNTEDLOOPCANONICALIZATION_H
+#define COUNTEDLOOPCANONICALIZATION_H
+
+#include "../parser/ASTNode.h"
+#include "../parser/SymbolTable.h"
+#include "SideEffectAnalysis.h"
+#include <string>
+#include <unordered_set>
+
+// Brings for loops into the shape HotSpot's C2 recognises as a counted loop,
+// `for (int i = start; i < limit; i += STRIDE)`: an int induction variable, a
+// loop-invariant limit held in a local and a constant stride. Only counted
+// loops get range-check elimination, unrolling and superword vectorisation.
+//
+//  - A computed bound (`v.size()`, `n * 2`) is evaluated once into a
+//    `const` local `end$N` placed right before the loop.
+//  - `size_t`, `unsigned` and `long` induction variables become `int` when
+//    the start and bound provably fit in an int and every use of the
+//    variable yields the same value at either width.
+class CountedLoopCanonicalization {
+public:
+    // Rewrites the program in place; returns the number of loops changed
+    static int run(const ASTNodePtr& program);
+
+private:
+    explicit CountedLoopCanonicalization(const SideEffectAnalysis& analysis);
+
+    void processStatement(const ASTNodePtr& stmt);
+    void processBlock(const ASTNodePtr& node);
+
+    // Returns the declaration of a hoisted bound, or nullptr
+    ASTNodePtr canonicalize(const std::shared_ptr<ForLoopNode>& loop);
+    bool narrow(const std::shared_ptr<ForLoopNode>& loop, const std::shared_ptr<VariableDeclarationNode>& induction,
+                const std::string& op, const ASTNodePtr& bound, long long stride);
+    bool fitsInt(const ASTNodePtr& expr, bool nonNegative) const;
+
+    const SideEffectAnalysis& analysis;
+    std::unordered_set<std::string> functionLocals;  // Parameters and locals of the current function
+    SymbolTable types;                               // Their declared types, where unambiguous
+    int changedCount;
+    int boundCount;
+};
+
+#endif // COUNTEDLOOPCANONICALIZATION_H
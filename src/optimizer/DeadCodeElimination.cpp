@@ -0,0 +1,103 @@
+#include "DeadCodeElimination.h"
+#include "ASTUtils.h"
+#include "SideEffectAnalysis.h"
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+void collectReferences(const ASTNodePtr& node, std::set<std::string>& names) {
+    if (!node) return;
+    if (node->type == NodeType::IDENTIFIER) {
+        names.insert(std::static_pointer_cast<IdentifierNode>(node)->name);
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectReferences(child, names); });
+}
+
+std::string joinNames(const std::vector<std::string>& names) {
+    std::string result;
+    for (size_t i = 0; i < names.size(); ++i) {
+        result += (i ? ", " : "") + names[i];
+    }
+    return result;
+}
+
+} // namespace
+
+std::vector<std::string> DeadCodeElimination::run(const ASTNodePtr& program, const std::vector<std::string>& roots) {
+    std::vector<std::string> report;
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return report;
+
+    // Name -> referenced names, for every top-level declaration
+    std::unordered_map<std::string, std::set<std::string>> references;
+    std::unordered_set<std::string> functions;
+    std::vector<std::string> worklist;
+    SideEffectAnalysis analysis(program);
+
+    for (const auto& stmt : block->statements) {
+        std::string name;
+        if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt)) {
+            name = ASTUtils::rootVariable(funcDecl->functionName);
+            functions.insert(name);
+            collectReferences(funcDecl->body, references[name]);
+        } else if (auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(stmt)) {
+            name = ASTUtils::rootVariable(varDecl->identifier);
+            collectReferences(varDecl->initializer, references[name]);
+            if (!analysis.isPure(varDecl->initializer)) worklist.push_back(name);  // Initializer has effects
+        } else {
+            std::set<std::string> used;
+            collectReferences(stmt, used);
+            worklist.insert(worklist.end(), used.begin(), used.end());
+        }
+    }
+
+    bool hasRoot = false;
+    for (const auto& root : roots) {
+        if (functions.count(root)) {
+            hasRoot = true;
+            worklist.push_back(root);
+        }
+    }
+    if (!hasRoot) return report;  // Nothing to anchor reachability; keep everything
+
+    std::unordered_set<std::string> reachable;
+    while (!worklist.empty()) {
+        std::string name = worklist.back();
+        worklist.pop_back();
+        if (!references.count(name) || !reachable.insert(name).second) continue;
+        for (const auto& used : references[name]) worklist.push_back(used);
+    }
+
+    auto& statements = block->statements;
+    std::vector<ASTNodePtr> kept;
+    for (const auto& stmt : statements) {
+        std::string name;
+        std::string kind;
+        if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt)) {
+            name = ASTUtils::rootVariable(funcDecl->functionName);
+            kind = "function";
+        } else if (auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(stmt)) {
+            name = ASTUtils::rootVariable(varDecl->identifier);
+            kind = "global";
+        }
+        if (name.empty() || reachable.count(name)) {
+            kept.push_back(stmt);
+            continue;
+        }
+
+        std::vector<std::string> users;
+        for (const auto& entry : references) {
+            if (entry.first != name && entry.second.count(name)) users.push_back(entry.first);
+        }
+        std::sort(users.begin(), users.end());
+        report.push_back("Removed " + kind + " '" + name + "': " +
+                         (users.empty() ? std::string("never referenced")
+                                        : "only referenced from unreachable code (" + joinNames(users) + ")") +
+                         "; roots: " + joinNames(roots) + ".");
+    }
+    statements = kept;
+    return report;
+}
@@ -0,0 +1,19 @@
+#ifndef DEADCODEELIMINATION_H
+#define DEADCODEELIMINATION_H
+
+#include "../parser/ASTNode.h"
+#include <string>
+#include <vector>
+
+// Whole-program removal of functions and globals that cannot be reached from
+// the configured roots (e.g. `main` or exported entry points). Top-level
+// statements and globals with side-effecting initializers are always kept
+// and count as roots too.
+class DeadCodeElimination {
+public:
+    // Rewrites the program in place; returns one report line per removed
+    // declaration saying what was removed and why
+    static std::vector<std::string> run(const ASTNodePtr& program, const std::vector<std::string>& roots);
+};
+
+#endif // DEADCODEELIMINATION_H
@@ -0,0 +1,187 @@
+#include "HotnessProfile.h"
+#include "ASTUtils.h"
+#include "CallGraph.h"
+#include "Monomorphization.h"
+#include "../utils/ErrorHandler.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <unordered_set>
+
+namespace {
+
+std::string trimmed(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\r");
+    size_t end = text.find_last_not_of(" \t\r");
+    return start == std::string::npos ? "" : text.substr(start, end - start + 1);
+}
+
+// The whole of `text` as a number; false if it is anything else
+bool parseNumber(const std::string& text, double& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+// Position of the last `separator` outside template arguments; npos if none
+size_t lastAtTopLevel(const std::string& text, const std::string& separator) {
+    size_t found = std::string::npos;
+    int depth = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '<') depth++;
+        else if (text[i] == '>') depth--;
+        else if (depth == 0 && text.compare(i, separator.size(), separator) == 0) found = i;
+    }
+    return found;
+}
+
+// `double ns::maxOf<double>(double, double) [clone .isra.0]` -> `maxOf_double`
+std::string functionName(std::string symbol) {
+    symbol = trimmed(symbol.substr(0, symbol.find(" [")));
+    int depth = 0;
+    for (size_t i = 0; i < symbol.size(); i++) {
+        if (symbol[i] == '<') depth++;
+        else if (symbol[i] == '>') depth--;
+        // Parameters, or the `.isra.0` of a symbol perf could not demangle
+        else if (depth == 0 && (symbol[i] == '(' || (symbol[i] == '.' && i + 1 < symbol.size() &&
+                                                     isalpha(static_cast<unsigned char>(symbol[i + 1]))))) {
+            symbol = trimmed(symbol.substr(0, i));
+            break;
+        }
+    }
+    size_t space = lastAtTopLevel(symbol, " ");
+    if (space != std::string::npos) symbol = symbol.substr(space + 1);
+    size_t scope = lastAtTopLevel(symbol, "::");
+    if (scope != std::string::npos) symbol = symbol.substr(scope + 2);
+
+    size_t open = symbol.find('<');
+    if (open == std::string::npos || symbol.back() != '>') return symbol;
+    std::vector<std::string> arguments;
+    std::string argument;
+    depth = 0;
+    for (size_t i = open + 1; i + 1 < symbol.size(); i++) {
+        if (symbol[i] == '<') depth++;
+        if (symbol[i] == '>') depth--;
+        if (depth == 0 && symbol[i] == ',') {
+            arguments.push_back(trimmed(argument));
+            argument.clear();
+        } else {
+            argument += symbol[i];
+        }
+    }
+    arguments.push_back(trimmed(argument));
+    return Monomorphization::mangledName(symbol.substr(0, open), arguments);
+}
+
+std::string percentOf(double weight, double total) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(1) << 100.0 * weight / total << "%";
+    return text.str();
+}
+
+} // namespace
+
+std::unordered_map<std::string, double> HotnessProfile::parse(const std::string& text) {
+    std::unordered_map<std::string, double> weights;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        line = trimmed(line);
+        if (line.empty() || line[0] == '#') continue;
+        double weight = 0;
+
+        // perf report: `  45.20%  app  app  [.] saxpy`; with --children, the last percentage is the function's own
+        size_t marker = line.find("] ");
+        if (marker != std::string::npos && marker >= 2 && line[marker - 2] == '[') {
+            std::istringstream columns(line.substr(0, marker - 2));
+            std::string column;
+            bool found = false;
+            while (columns >> column) {
+                if (column.back() == '%' && parseNumber(column.substr(0, column.size() - 1), weight)) found = true;
+            }
+            if (found) weights[functionName(line.substr(marker + 2))] += weight;
+            continue;
+        }
+
+        // CSV: `saxpy,45.2`
+        size_t comma = line.rfind(',');
+        if (comma != std::string::npos && parseNumber(trimmed(line.substr(comma + 1)), weight)) {
+            std::string name = trimmed(line.substr(0, comma));
+            if (!name.empty()) weights[functionName(name)] += weight;
+            continue;
+        }
+
+        // gprof flat profile: `45.20  0.52  0.52  1000  0.52  0.52  saxpy`, where the calls columns may be empty;
+        // the first column is the percentage of time
+        std::istringstream columns(line);
+        std::string column;
+        std::vector<double> numbers;
+        double number = 0;
+        std::streampos name = 0;
+        while (columns >> column && parseNumber(column, number)) {
+            numbers.push_back(number);
+            name = columns.tellg();
+        }
+        if (numbers.size() >= 3 && !columns.fail()) {
+            weights[functionName(line.substr(static_cast<size_t>(name)))] += numbers[0];
+        }
+    }
+    return weights;
+}
+
+std::vector<std::string> HotnessProfile::run(const ASTNodePtr& program, const std::unordered_map<std::string, double>& weights,
+                                             double coverage) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return {};
+
+    CallGraph callGraph(program);
+    std::vector<std::string> profiled;
+    double total = 0;
+    for (const auto& name : callGraph.functions()) {
+        auto weight = weights.find(name);
+        if (weight == weights.end() || weight->second <= 0) continue;
+        profiled.push_back(name);
+        total += weight->second;
+    }
+    if (profiled.empty()) {
+        ErrorHandler::reportWarning("The profile names none of the program's functions; all of them are translated as hot.");
+        return {};
+    }
+
+    // Heaviest first, until the hot set covers the requested share of the time
+    std::stable_sort(profiled.begin(), profiled.end(),
+                     [&](const std::string& a, const std::string& b) { return weights.at(a) > weights.at(b); });
+    std::unordered_set<std::string> hot;
+    double covered = 0;
+    for (const auto& name : profiled) {
+        if (covered >= coverage * total) break;
+        hot.insert(name);
+        covered += weights.at(name);
+    }
+    std::vector<std::string> worklist(hot.begin(), hot.end());
+    while (!worklist.empty()) {
+        std::string caller = worklist.back();
+        worklist.pop_back();
+        for (const auto& callee : callGraph.callees(caller)) {
+            if (callGraph.isDefined(callee) && !weights.count(callee) && hot.insert(callee).second) {
+                worklist.push_back(callee);
+            }
+        }
+    }
+
+    std::vector<std::string> report;
+    for (const auto& stmt : block->statements) {
+        auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+        if (!funcDecl) continue;
+        std::string name = ASTUtils::rootVariable(funcDecl->functionName);
+        funcDecl->cold = !hot.count(name);
+        auto weight = weights.find(name);
+        std::string reason = weight == weights.end() ? (funcDecl->cold ? "not in the profile" : "called from hot code, not in the profile")
+                                                     : percentOf(weight->second, total) + " of the profiled time";
+        report.push_back(std::string(funcDecl->cold ? "Cold: " : "Hot: ") + name + " (" + reason + ")");
+    }
+    return report;
+}
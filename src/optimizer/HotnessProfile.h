@@ -0,0 +1,36 @@
+#ifndef HOTNESSPROFILE_H
+#define HOTNESSPROFILE_H
+
+#include "../parser/ASTNode.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Profile-guided translation. A profile of the C++ program names the
+// functions that take the time; the smallest set of them that covers
+// `coverage` of the profile's weight is hot, as is anything they call
+// that the profile does not list (most likely inlined into them). Every
+// other function is marked cold. Cold functions skip loop-invariant motion,
+// loop canonicalization, allocation pooling, vectorization and the
+// struct-of-arrays layout, and are split only when javac would otherwise
+// reject them.
+//
+// The profile may be `perf report` output, a gprof flat profile or
+// `function,weight` CSV lines; lines of any other shape are ignored.
+// Names are matched without their parameter lists, qualifiers or
+// `[clone .isra.0]` suffixes, and `maxOf<double>` matches the
+// instantiation `maxOf_double`.
+class HotnessProfile {
+public:
+    // Function name -> weight, summed over the lines that name it
+    static std::unordered_map<std::string, double> parse(const std::string& text);
+
+    // Marks the cold functions of the program; returns one report line per function
+    static std::vector<std::string> run(const ASTNodePtr& program, const std::unordered_map<std::string, double>& weights,
+                                        double coverage = 0.9);
+
+private:
+    HotnessProfile() = default;
+};
+
+#endif // HOTNESSPROFILE_H
@@ -0,0 +1,414 @@
+#include "LoopInvariantMotion.h"
+#include "ASTUtils.h"
+
+namespace {
+
+bool containsNonLiteral(const ASTNodePtr& expr) {
+    if (!expr) return false;
+    if (expr->type == NodeType::NUMBER_LITERAL || expr->type == NodeType::STRING_LITERAL ||
+        expr->type == NodeType::CHAR_LITERAL) {
+        return false;
+    }
+    if (expr->type != NodeType::BINARY_EXPRESSION && expr->type != NodeType::UNARY_EXPRESSION) return true;
+
+    bool found = false;
+    ASTUtils::forEachChild(expr, [&](ASTNodePtr& child) {
+        if (!found) found = containsNonLiteral(child);
+    });
+    return found;
+}
+
+// Statements that may end the iteration before the ones after them run
+bool leavesEarly(const ASTNodePtr& stmt) {
+    switch (stmt->type) {
+        case NodeType::IF_STATEMENT:
+        case NodeType::WHILE_LOOP:
+        case NodeType::FOR_LOOP:
+        case NodeType::SWITCH_STATEMENT:
+        case NodeType::BLOCK:
+        case NodeType::RETURN_STATEMENT:
+        case NodeType::BREAK_STATEMENT:
+        case NodeType::CONTINUE_STATEMENT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+LoopInvariantMotion::LoopInvariantMotion(const SideEffectAnalysis& analysis)
+    : analysis(analysis), hoistedCount(0) {}
+
+int LoopInvariantMotion::run(const ASTNodePtr& program) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return 0;
+
+    SideEffectAnalysis analysis(program);
+    LoopInvariantMotion pass(analysis);
+
+    // A function is safe once everything its body calls is; recursion never is
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const auto& stmt : block->statements) {
+            auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+            if (!funcDecl || !funcDecl->body) continue;
+            std::string name = ASTUtils::rootVariable(funcDecl->functionName);
+            if (!pass.safeFunctions.count(name) && !pass.mayFault(funcDecl->body)) {
+                pass.safeFunctions.insert(name);
+                changed = true;
+            }
+        }
+    }
+
+    for (const auto& stmt : block->statements) {
+        auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+        if (!funcDecl || !funcDecl->body || funcDecl->cold) continue;
+
+        pass.functionLocals.clear();
+        for (const auto& param : funcDecl->parameters) pass.functionLocals.insert(ASTUtils::rootVariable(param));
+        ASTUtils::collectDeclarations(funcDecl->body, pass.functionLocals);
+
+        pass.processBlock(funcDecl->body);
+    }
+    return pass.hoistedCount;
+}
+
+bool LoopInvariantMotion::isLoopInvariant(const ASTNodePtr& expr, const ASTNodePtr& loop,
+                                          const SideEffectAnalysis& analysis,
+                                          const std::unordered_set<std::string>& functionLocals) {
+    LoopInvariantMotion pass(analysis);
+    pass.functionLocals = functionLocals;
+    return pass.isInvariant(expr, contextFor(loop, analysis));
+}
+
+LoopInvariantMotion::LoopContext LoopInvariantMotion::contextFor(const ASTNodePtr& loop,
+                                                                 const SideEffectAnalysis& analysis) {
+    LoopContext context;
+    analysis.collectWrites(loop, context.written);
+    context.hasImpureCalls = analysis.containsImpureCall(loop);
+    return context;
+}
+
+void LoopInvariantMotion::processBlock(const ASTNodePtr& node) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(node);
+    if (!block) return;
+
+    for (size_t i = 0; i < block->statements.size(); ++i) {
+        ASTNodePtr stmt = block->statements[i];
+
+        // Inner loops first, so their preheaders can be hoisted further out
+        switch (stmt->type) {
+            case NodeType::IF_STATEMENT: {
+                auto ifStmt = std::static_pointer_cast<IfStatementNode>(stmt);
+                processBlock(ifStmt->thenBlock);
+                processBlock(ifStmt->elseBlock);
+                break;
+            }
+            case NodeType::WHILE_LOOP:
+                processBlock(std::static_pointer_cast<WhileLoopNode>(stmt)->body);
+                break;
+            case NodeType::FOR_LOOP:
+                processBlock(std::static_pointer_cast<ForLoopNode>(stmt)->body);
+                break;
+            case NodeType::SWITCH_STATEMENT:
+                for (const auto& clause : std::static_pointer_cast<SwitchStatementNode>(stmt)->cases) {
+                    processBlock(std::static_pointer_cast<CaseClauseNode>(clause)->body);
+                }
+                break;
+            case NodeType::BLOCK:
+                processBlock(stmt);
+                break;
+            default:
+                break;
+        }
+
+        if (stmt->type == NodeType::WHILE_LOOP || stmt->type == NodeType::FOR_LOOP) {
+            std::vector<ASTNodePtr> preheader = hoistFrom(stmt);
+            block->statements.insert(block->statements.begin() + i, preheader.begin(), preheader.end());
+            i += preheader.size();
+        }
+    }
+}
+
+std::vector<ASTNodePtr> LoopInvariantMotion::hoistFrom(const ASTNodePtr& loop) {
+    LoopContext context = contextFor(loop, analysis);
+
+    // A for loop's initializers run once already. Only the condition is sure to run; the
+    // body and the increments do not when it fails the first time.
+    if (auto forLoop = std::dynamic_pointer_cast<ForLoopNode>(loop)) {
+        visitExpression(forLoop->condition, context);
+        context.guarded = true;
+        for (auto& increment : forLoop->increments) visitChildren(increment, context);
+        visitStatement(forLoop->body, context);
+        return context.hoisted;
+    }
+    auto whileLoop = std::static_pointer_cast<WhileLoopNode>(loop);
+    visitExpression(whileLoop->condition, context);
+    context.guarded = true;
+    visitStatement(whileLoop->body, context);
+    return context.hoisted;
+}
+
+void LoopInvariantMotion::visitStatement(ASTNodePtr& stmt, LoopContext& loop) {
+    if (!stmt) return;
+
+    switch (stmt->type) {
+        case NodeType::VARIABLE_DECLARATION: {
+            auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(stmt);
+            if (varDecl->initializer) visitExpression(varDecl->initializer, loop);
+            break;
+        }
+        case NodeType::RETURN_STATEMENT: {
+            auto returnStmt = std::static_pointer_cast<ReturnStatementNode>(stmt);
+            if (returnStmt->expression) visitExpression(returnStmt->expression, loop);
+            break;
+        }
+        case NodeType::IF_STATEMENT: {
+            auto ifStmt = std::static_pointer_cast<IfStatementNode>(stmt);
+            visitExpression(ifStmt->condition, loop);
+            visitGuarded(ifStmt->thenBlock, loop);
+            visitGuarded(ifStmt->elseBlock, loop);
+            break;
+        }
+        case NodeType::WHILE_LOOP: {
+            auto whileLoop = std::static_pointer_cast<WhileLoopNode>(stmt);
+            visitExpression(whileLoop->condition, loop);
+            visitGuarded(whileLoop->body, loop);
+            break;
+        }
+        case NodeType::FOR_LOOP: {
+            auto forLoop = std::static_pointer_cast<ForLoopNode>(stmt);
+            for (auto& init : forLoop->initializers) visitStatement(init, loop);
+            visitExpression(forLoop->condition, loop);
+            bool guarded = loop.guarded;
+            loop.guarded = true;
+            for (auto& increment : forLoop->increments) visitChildren(increment, loop);
+            loop.guarded = guarded;
+            visitGuarded(forLoop->body, loop);
+            break;
+        }
+        case NodeType::SWITCH_STATEMENT: {
+            auto switchStmt = std::static_pointer_cast<SwitchStatementNode>(stmt);
+            visitExpression(switchStmt->expression, loop);
+            for (auto& clause : switchStmt->cases) {
+                visitGuarded(std::static_pointer_cast<CaseClauseNode>(clause)->body, loop);
+            }
+            break;
+        }
+        case NodeType::BLOCK: {
+            // A statement that may leave the iteration early guards everything after it
+            bool guarded = loop.guarded;
+            auto& statements = std::static_pointer_cast<BlockNode>(stmt)->statements;
+            for (size_t i = 0; i < statements.size(); ++i) {
+                size_t hoisted = loop.hoisted.size();
+                visitStatement(statements[i], loop);
+                if (leavesEarly(statements[i])) loop.guarded = true;
+
+                // `const auto inv$3 = inv$6;` after an inner loop's hoisted declaration moved
+                // out whole: the declaration takes the inner name instead
+                auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(statements[i]);
+                auto moved = varDecl ? std::dynamic_pointer_cast<IdentifierNode>(varDecl->initializer) : nullptr;
+                std::string name = varDecl ? ASTUtils::rootVariable(varDecl->identifier) : "";
+                if (!moved || name.rfind("inv$", 0) != 0 || loop.hoisted.size() != hoisted + 1) continue;
+                auto declaration = std::static_pointer_cast<VariableDeclarationNode>(loop.hoisted.back());
+                if (ASTUtils::rootVariable(declaration->identifier) != moved->name) continue;
+                declaration->identifier = std::make_shared<IdentifierNode>(name);
+                loop.hoistedNames[declaration->initializer->toString()] = name;
+                hoistedCount--;
+                statements.erase(statements.begin() + i--);
+            }
+            loop.guarded = guarded;
+            break;
+        }
+        case NodeType::FUNCTION_DECLARATION:
+            break;
+        default:
+            // Expression statement: its value is discarded, only operands can move
+            visitChildren(stmt, loop);
+            break;
+    }
+}
+
+void LoopInvariantMotion::visitGuarded(ASTNodePtr& stmt, LoopContext& loop) {
+    bool guarded = loop.guarded;
+    loop.guarded = true;
+    visitStatement(stmt, loop);
+    loop.guarded = guarded;
+}
+
+void LoopInvariantMotion::visitExpression(ASTNodePtr& expr, LoopContext& loop) {
+    if (!expr) return;
+
+    if (!isInvariant(expr, loop) || !isWorthHoisting(expr) || (loop.guarded && mayFault(expr))) {
+        visitChildren(expr, loop);
+        return;
+    }
+
+    std::string key = expr->toString();
+    auto it = loop.hoistedNames.find(key);
+    if (it == loop.hoistedNames.end()) {
+        std::string name = "inv$" + std::to_string(hoistedCount++);
+        it = loop.hoistedNames.emplace(key, name).first;
+        loop.hoisted.push_back(std::make_shared<VariableDeclarationNode>(
+            "const auto", std::make_shared<IdentifierNode>(name), expr));
+    }
+    expr = std::make_shared<IdentifierNode>(it->second);
+}
+
+void LoopInvariantMotion::visitChildren(const ASTNodePtr& expr, LoopContext& loop) {
+    switch (expr->type) {
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(expr);
+            // Assignment targets stay in place
+            if (!ASTUtils::isAssignmentOperator(binExpr->op)) visitExpression(binExpr->left, loop);
+            if (binExpr->op != "&&" && binExpr->op != "||") {
+                visitExpression(binExpr->right, loop);
+                break;
+            }
+            bool guarded = loop.guarded;
+            loop.guarded = true;  // Runs only when the left operand does not decide the result
+            visitExpression(binExpr->right, loop);
+            loop.guarded = guarded;
+            break;
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(expr);
+            if (unaryExpr->op != "++" && unaryExpr->op != "--") visitExpression(unaryExpr->operand, loop);
+            break;
+        }
+        case NodeType::MEMBER_ACCESS:
+            visitExpression(std::static_pointer_cast<MemberAccessNode>(expr)->object, loop);
+            break;
+        case NodeType::FUNCTION_CALL: {
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(expr);
+            auto member = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName);
+            if (member && SideEffectAnalysis::isConstMember(member->member)) visitExpression(member->object, loop);
+            for (auto& arg : funcCall->arguments) visitExpression(arg, loop);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+bool LoopInvariantMotion::isInvariant(const ASTNodePtr& expr, const LoopContext& loop) const {
+    if (!expr) return false;
+
+    switch (expr->type) {
+        case NodeType::NUMBER_LITERAL:
+        case NodeType::STRING_LITERAL:
+        case NodeType::CHAR_LITERAL:
+            return true;
+
+        case NodeType::IDENTIFIER: {
+            const std::string& name = std::static_pointer_cast<IdentifierNode>(expr)->name;
+            if (loop.written.count(name) || SideEffectAnalysis::isStream(name)) return false;
+            // An impure call in the loop may write any non-local variable
+            return !loop.hasImpureCalls || functionLocals.count(name);
+        }
+
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(expr);
+            if (ASTUtils::isAssignmentOperator(binExpr->op)) return false;
+            if (binExpr->op == "/" || binExpr->op == "%") {
+                // Never introduce a division the loop might not have executed:
+                // in Java an integer division by zero throws
+                auto divisor = std::dynamic_pointer_cast<NumberNode>(binExpr->right);
+                if (!divisor || divisor->value == 0) return false;
+            }
+            return isInvariant(binExpr->left, loop) && isInvariant(binExpr->right, loop);
+        }
+
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(expr);
+            // Loads through `*` may alias any store in the loop
+            return unaryExpr->op != "++" && unaryExpr->op != "--" && unaryExpr->op != "*" &&
+                   isInvariant(unaryExpr->operand, loop);
+        }
+
+        case NodeType::MEMBER_ACCESS:
+            // Field loads may alias anything an impure call writes
+            return !loop.hasImpureCalls && isInvariant(std::static_pointer_cast<MemberAccessNode>(expr)->object, loop);
+
+        case NodeType::FUNCTION_CALL: {
+            if (!analysis.isPure(expr)) return false;
+
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(expr);
+            for (const auto& arg : funcCall->arguments) {
+                if (!isInvariant(arg, loop)) return false;
+            }
+            if (auto member = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName)) {
+                return !loop.hasImpureCalls && isInvariant(member->object, loop);
+            }
+
+            const auto& reads = analysis.globalReads(ASTUtils::calleeName(expr));
+            if (!reads.empty() && loop.hasImpureCalls) return false;
+            for (const auto& read : reads) {
+                if (loop.written.count(read)) return false;
+            }
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+bool LoopInvariantMotion::mayFault(const ASTNodePtr& expr) const {
+    if (!expr) return false;
+    switch (expr->type) {
+        case NodeType::MEMBER_ACCESS: {
+            // `p->x` loads `p[p$off].x`; a struct value or container reference is never null
+            auto memberAccess = std::static_pointer_cast<MemberAccessNode>(expr);
+            return memberAccess->arrow || mayFault(memberAccess->object);
+        }
+        case NodeType::ARRAY_ACCESS:
+        case NodeType::NEW_EXPRESSION:
+            return true;
+        case NodeType::UNARY_EXPRESSION:
+            if (std::static_pointer_cast<UnaryExpressionNode>(expr)->op == "*") return true;
+            break;
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(expr);
+            if (binExpr->op == "/" || binExpr->op == "%" || binExpr->op == "/=" || binExpr->op == "%=") {
+                auto divisor = std::dynamic_pointer_cast<NumberNode>(binExpr->right);
+                if (!divisor || divisor->value == 0) return true;
+            }
+            break;
+        }
+        case NodeType::FUNCTION_CALL: {
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(expr);
+            auto member = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName);
+            static const std::unordered_set<std::string> safeMembers = {"size", "length", "empty", "capacity"};
+            if (member) {
+                if (!safeMembers.count(member->member) || mayFault(member->object)) return true;
+                break;
+            }
+            std::string callee = ASTUtils::calleeName(expr);
+            if (!SideEffectAnalysis::isPureLibraryFunction(callee) && !safeFunctions.count(callee)) return true;
+            break;
+        }
+        default:
+            break;
+    }
+    bool found = false;
+    ASTUtils::forEachChild(expr, [&](ASTNodePtr& child) {
+        if (!found) found = mayFault(child);
+    });
+    return found;
+}
+
+bool LoopInvariantMotion::isWorthHoisting(const ASTNodePtr& expr) {
+    switch (expr->type) {
+        case NodeType::MEMBER_ACCESS:
+        case NodeType::FUNCTION_CALL:
+            return true;
+        case NodeType::UNARY_EXPRESSION:
+            return isWorthHoisting(std::static_pointer_cast<UnaryExpressionNode>(expr)->operand);
+        case NodeType::BINARY_EXPRESSION:
+            return containsNonLiteral(expr);
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef LOOPINVARIANTMOTION_H
+#define LOOPINVARIANTMOTION_H
+
+#include "../parser/ASTNode.h"
+#include "SideEffectAnalysis.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Loop-invariant code motion over while and for loops. Pure computations whose
+// operands are not written inside the loop (`v.size()`, `a * b`, `p.x`,
+// calls to pure functions) are evaluated once into a `const auto` local
+// placed right before the loop, and every occurrence in the loop is
+// replaced by that local.
+//
+// Hoisting runs an expression even when the iteration would not have.
+// So code that may not run on every iteration only gives up expressions
+// that cannot throw. That is the whole body, which runs zero times when
+// the condition fails at once; only the condition is sure to run. Loads
+// through pointers and calls to functions of the program that may throw
+// stay in the body. Declarations that an inner loop hoisted move out
+// whole instead of being copied.
+class LoopInvariantMotion {
+public:
+    // Rewrites the program in place; returns the number of hoisted expressions
+    static int run(const ASTNodePtr& program);
+
+    // True when `expr` evaluates to the same value on every iteration of
+    // `loop`; `functionLocals` are the parameters and locals of the function
+    static bool isLoopInvariant(const ASTNodePtr& expr, const ASTNodePtr& loop, const SideEffectAnalysis& analysis,
+                                const std::unordered_set<std::string>& functionLocals);
+
+private:
+    struct LoopContext {
+        std::unordered_set<std::string> written;
+        bool hasImpureCalls = false;
+        std::unordered_map<std::string, std::string> hoistedNames;  // expression key -> local
+        std::vector<ASTNodePtr> hoisted;                            // declarations, in order
+        bool guarded = false;  // Visiting code that may not run on every iteration
+    };
+
+    explicit LoopInvariantMotion(const SideEffectAnalysis& analysis);
+
+    void processBlock(const ASTNodePtr& node);
+    std::vector<ASTNodePtr> hoistFrom(const ASTNodePtr& loop);
+    static LoopContext contextFor(const ASTNodePtr& loop, const SideEffectAnalysis& analysis);
+
+    void visitStatement(ASTNodePtr& stmt, LoopContext& loop);
+    void visitExpression(ASTNodePtr& expr, LoopContext& loop);
+    void visitChildren(const ASTNodePtr& expr, LoopContext& loop);
+
+    bool isInvariant(const ASTNodePtr& expr, const LoopContext& loop) const;
+    static bool isWorthHoisting(const ASTNodePtr& expr);
+    // Whether evaluating `expr` may throw in Java: a load through a pointer, a subscript, a division by a
+    // variable, or a call to a function of the program whose body may throw
+    bool mayFault(const ASTNodePtr& expr) const;
+    void visitGuarded(ASTNodePtr& stmt, LoopContext& loop);
+
+    const SideEffectAnalysis& analysis;
+    std::unordered_set<std::string> functionLocals;  // Parameters and locals of the current function
+    std::unordered_set<std::string> safeFunctions;   // Functions of the program whose bodies cannot throw
+    int hoistedCount;
+};
+
+#endif // LOOPINVARIANTMOTION_H
@@ -0,0 +1,257 @@
+#include "MethodSplitting.h"
+#include "ASTUtils.h"
+#include "StringBuilderAnalysis.h"
+#include "../parser/TypeChecker.h"
+#include "../utils/ErrorHandler.h"
+#include <algorithm>
+
+namespace {
+
+const int JAVAC_LIMIT = 65535;
+
+void collectNames(const ASTNodePtr& node, std::unordered_set<std::string>& names) {
+    if (!node) return;
+    if (node->type == NodeType::IDENTIFIER) names.insert(std::static_pointer_cast<IdentifierNode>(node)->name);
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectNames(child, names); });
+}
+
+int childrenSize(const ASTNodePtr& node, const std::unordered_set<std::string>& locals) {
+    int size = 0;
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) {
+        size += MethodSplitting::estimateBytecodeSize(child, locals);
+    });
+    return size;
+}
+
+// JVM argument slots: `this`, two per long or double, two per pointer (array and offset)
+int slots(const std::string& type) {
+    std::string normalized = TypeChecker::normalizeType(type);
+    if (TypeChecker::isPointerType(normalized)) return 2;
+    return normalized == "long" || normalized == "long long" || normalized == "double" ||
+           normalized == "unsigned long" || normalized == "unsigned long long" ? 2 : 1;
+}
+
+bool isLockGuard(const std::string& type) {
+    std::string name = TypeChecker::templateName(TypeChecker::normalizeType(type));
+    return name == "lock_guard" || name == "unique_lock" || name == "scoped_lock";
+}
+
+} // namespace
+
+MethodSplitting::MethodSplitting(const ASTNodePtr& program, int limit) : limit(limit) {
+    auto block = std::static_pointer_cast<BlockNode>(program);
+    for (const auto& stmt : block->statements) {
+        if (auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(stmt)) {
+            globals.addSymbol(ASTUtils::rootVariable(varDecl->identifier), varDecl->type);
+        } else if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt)) {
+            globals.addSymbol(ASTUtils::rootVariable(funcDecl->functionName), funcDecl->returnType);
+        } else if (auto structDecl = std::dynamic_pointer_cast<StructDeclarationNode>(stmt)) {
+            structs[structDecl->name] = structDecl;
+        }
+    }
+}
+
+std::vector<std::string> MethodSplitting::run(const ASTNodePtr& program, int limit) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block || limit <= 0) return {};
+
+    MethodSplitting pass(program, limit);
+    std::vector<std::string> report;
+    std::vector<ASTNodePtr> statements;
+    for (const auto& stmt : block->statements) {
+        statements.push_back(stmt);
+        auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+        if (!funcDecl || !std::dynamic_pointer_cast<BlockNode>(funcDecl->body)) continue;
+
+        // Helpers follow the function they continue
+        std::string line = pass.split(funcDecl, statements);
+        if (!line.empty()) report.push_back(line);
+    }
+    block->statements = statements;
+    return report;
+}
+
+// Counts opcodes and operands the way javac lays them out: a local load is
+// one or two bytes, a field access four (`aload_0; getfield #n`), a call
+// four plus its arguments and a conditional branch three. Pointer offsets
+// and unsigned helpers make the emitted code somewhat larger, which the
+// margin left below the limit when splitting absorbs.
+int MethodSplitting::estimateBytecodeSize(const ASTNodePtr& node, const std::unordered_set<std::string>& locals) {
+    if (!node) return 0;
+
+    switch (node->type) {
+        case NodeType::IDENTIFIER:
+            return locals.count(std::static_pointer_cast<IdentifierNode>(node)->name) ? 2 : 4;
+        case NodeType::NUMBER_LITERAL:
+        case NodeType::CHAR_LITERAL:
+            return 2;
+        case NodeType::STRING_LITERAL:
+            return 3;
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+            const std::string& op = binExpr->op;
+            int operands = estimateBytecodeSize(binExpr->left, locals) + estimateBytecodeSize(binExpr->right, locals);
+            if (op == "=") return operands;  // The store mirrors the load counted for the target
+            if (ASTUtils::isAssignmentOperator(op)) return operands + estimateBytecodeSize(binExpr->left, locals) + 1;
+            static const std::unordered_set<std::string> branches = {"==", "!=", "<", "<=", ">", ">=", "&&", "||"};
+            return operands + (branches.count(op) ? 3 : 1);
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            bool increment = unaryExpr->op == "++" || unaryExpr->op == "--";
+            if (increment && unaryExpr->operand->type == NodeType::IDENTIFIER &&
+                locals.count(std::static_pointer_cast<IdentifierNode>(unaryExpr->operand)->name)) {
+                return 3;  // iinc
+            }
+            int operand = estimateBytecodeSize(unaryExpr->operand, locals);
+            if (increment) return 2 * operand + 2;
+            return operand + (unaryExpr->op == "*" ? 3 : 1);
+        }
+        case NodeType::ARRAY_ACCESS:
+        case NodeType::MEMBER_ACCESS:
+            return childrenSize(node, locals) + 3;
+        case NodeType::FUNCTION_CALL:
+            return childrenSize(node, locals) + 4;
+        case NodeType::VARIABLE_DECLARATION: {
+            auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(node);
+            int size = 2 + estimateBytecodeSize(varDecl->initializer, locals);
+            for (const auto& dimension : varDecl->arraySizes) size += 3 + estimateBytecodeSize(dimension, locals);
+            for (const auto& argument : varDecl->constructorArguments) size += estimateBytecodeSize(argument, locals);
+            return varDecl->initializer || !varDecl->constructorArguments.empty() ? size : size + 1;
+        }
+        case NodeType::IF_STATEMENT: {
+            auto ifStmt = std::static_pointer_cast<IfStatementNode>(node);
+            return childrenSize(node, locals) + 3 + (ifStmt->elseBlock ? 3 : 0);
+        }
+        case NodeType::WHILE_LOOP:
+        case NodeType::FOR_LOOP:
+            return childrenSize(node, locals) + 6;
+        case NodeType::SWITCH_STATEMENT:
+            return childrenSize(node, locals) + 16 +
+                   8 * static_cast<int>(std::static_pointer_cast<SwitchStatementNode>(node)->cases.size());
+        case NodeType::BREAK_STATEMENT:
+        case NodeType::CONTINUE_STATEMENT:
+            return 3;
+        case NodeType::RETURN_STATEMENT:
+        default:
+            return childrenSize(node, locals) + 1;
+    }
+}
+
+std::string MethodSplitting::split(const std::shared_ptr<FunctionDeclarationNode>& function,
+                                   std::vector<ASTNodePtr>& helpers) {
+    auto body = std::static_pointer_cast<BlockNode>(function->body);
+    std::string name = ASTUtils::rootVariable(function->functionName);
+
+    std::unordered_set<std::string> locals;
+    for (const auto& param : function->parameters) locals.insert(ASTUtils::rootVariable(param));
+    ASTUtils::collectDeclarations(body, locals);
+    int size = estimateBytecodeSize(body, locals);
+    // Cold code can stay interpreted, so it is only split with room left below javac's limit for what the estimate misses
+    int limit = function->cold ? std::max(this->limit, JAVAC_LIMIT / 2) : this->limit;
+    if (size <= limit) return "";
+
+    // StringBuilder and struct-of-arrays locals only exist in the function that declares them
+    std::unordered_set<std::string> pinned = StringBuilderAnalysis::builderVariables(function);
+    for (const auto& array : StructOfArraysAnalysis::splitArrays(function, structs)) pinned.insert(array);
+
+    // Cut greedily, leaving a quarter of the limit for the call and what the estimate misses
+    int budget = limit * 3 / 4;
+    std::vector<size_t> cuts;
+    std::vector<Locals> liveAtCuts;
+    std::vector<int> sizes = {0};
+    for (size_t i = 0; i < body->statements.size(); ++i) {
+        int statement = estimateBytecodeSize(body->statements[i], locals);
+        Locals live;
+        if (sizes.back() > 0 && sizes.back() + statement > budget && liveLocals(function, i, pinned, live)) {
+            cuts.push_back(i);
+            liveAtCuts.push_back(live);
+            sizes.push_back(0);
+        }
+        sizes.back() += statement;
+    }
+
+    std::string estimate = "'" + name + "' (~" + std::to_string(size) + " bytes of bytecode)";
+    if (cuts.empty()) {
+        if (size > JAVAC_LIMIT) {
+            ErrorHandler::reportWarning("Function " + estimate + " exceeds javac's 64KB method limit and cannot be split: no "
+                                        "top-level statement boundary where its live locals can be passed on.");
+        }
+        return "Kept " + estimate + " whole: no top-level statement boundary where its live locals can be passed on";
+    }
+
+    // Each part ends by handing the rest of the function to the next one, so they are built back to front
+    std::vector<ASTNodePtr> parts;
+    ASTNodePtr next;
+    for (size_t part = cuts.size(); part-- > 0;) {
+        size_t end = part + 1 < cuts.size() ? cuts[part + 1] : body->statements.size();
+        std::vector<ASTNodePtr> rest(body->statements.begin() + cuts[part], body->statements.begin() + end);
+        if (next) rest.push_back(next);
+        std::string helperName = name + "$part" + std::to_string(part + 1);
+
+        std::vector<ASTNodePtr> params, arguments;
+        std::vector<std::string> paramTypes;
+        for (const auto& local : liveAtCuts[part]) {
+            params.push_back(std::make_shared<IdentifierNode>(local.first));
+            arguments.push_back(std::make_shared<IdentifierNode>(local.first));
+            paramTypes.push_back(local.second);
+        }
+        auto helper = std::make_shared<FunctionDeclarationNode>(function->returnType,
+                                                                std::make_shared<IdentifierNode>(helperName),
+                                                                params, std::make_shared<BlockNode>(rest));
+        helper->parameterTypes = paramTypes;
+        helper->splitFrom = name;
+        parts.insert(parts.begin(), helper);
+
+        next = std::make_shared<FunctionCallNode>(std::make_shared<IdentifierNode>(helperName), arguments);
+        if (TypeChecker::normalizeType(function->returnType) != "void") next = std::make_shared<ReturnStatementNode>(next);
+    }
+    body->statements.erase(body->statements.begin() + cuts[0], body->statements.end());
+    body->statements.push_back(next);
+    helpers.insert(helpers.end(), parts.begin(), parts.end());
+
+    std::string line = "Split " + estimate + " into " + name + " (~" + std::to_string(sizes[0]) + ")";
+    for (size_t part = 1; part < sizes.size(); ++part) {
+        line += ", " + name + "$part" + std::to_string(part) + " (~" + std::to_string(sizes[part]) + ")";
+    }
+    if (*std::max_element(sizes.begin(), sizes.end()) > limit) line += "; a single statement keeps one part over the limit";
+    return line;
+}
+
+bool MethodSplitting::liveLocals(const std::shared_ptr<FunctionDeclarationNode>& function, size_t index,
+                                 const std::unordered_set<std::string>& pinned, Locals& live) const {
+    auto body = std::static_pointer_cast<BlockNode>(function->body);
+    std::unordered_set<std::string> used;
+    for (size_t i = index; i < body->statements.size(); ++i) collectNames(body->statements[i], used);
+
+    SymbolTable scope = globals;
+    Locals candidates;
+    for (size_t i = 0; i < function->parameters.size(); ++i) {
+        std::string type = i < function->parameterTypes.size() ? function->parameterTypes[i] : "int";
+        candidates.emplace_back(ASTUtils::rootVariable(function->parameters[i]), type);
+        scope.addSymbol(candidates.back().first, type);
+    }
+    for (size_t i = 0; i < index; ++i) {
+        auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(body->statements[i]);
+        if (!varDecl) continue;
+        std::string type = varDecl->type;
+        if (type == "auto" || type == "const auto") type = TypeChecker::inferType(varDecl->initializer, scope);
+        if (type.empty()) type = "auto";
+        if (varDecl->arraySizes.size() > 1) type = "auto";  // Multidimensional arrays have no pointer form
+        candidates.emplace_back(ASTUtils::rootVariable(varDecl->identifier), type);
+        scope.addSymbol(candidates.back().first, type);
+    }
+
+    int argumentSlots = 1;
+    live.clear();
+    for (const auto& candidate : candidates) {
+        if (!used.count(candidate.first)) continue;
+        if (pinned.count(candidate.first) || candidate.second.find("auto") != std::string::npos ||
+            isLockGuard(candidate.second)) {
+            return false;
+        }
+        argumentSlots += slots(candidate.second);
+        live.push_back(candidate);
+    }
+    return argumentSlots <= 255;
+}
@@ -0,0 +1,48 @@
+#ifndef METHODSPLITTING_H
+#define METHODSPLITTING_H
+
+#include "../parser/ASTNode.h"
+#include "../parser/SymbolTable.h"
+#include "StructOfArraysAnalysis.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// HotSpot does not JIT-compile a method over 8000 bytes of bytecode
+// (-XX:+DontCompileHugeMethods) and javac rejects one over 64KB, so a
+// generated function with thousands of statements would run interpreted
+// or not compile at all.
+//
+// Functions whose estimated bytecode exceeds the limit are cut at top-level
+// statement boundaries. Everything after a cut moves into a private helper
+// `f$part1`, which the function tail-calls with the locals still live at the
+// cut as arguments. The helper owns the rest of the function, so no value
+// has to flow back and `return` keeps its meaning in every part. Cold
+// functions (see HotnessProfile) are split only when javac needs it.
+class MethodSplitting {
+public:
+    static constexpr int HOTSPOT_LIMIT = 8000;
+
+    // Rewrites the program in place; returns one report line per function over `limit`
+    static std::vector<std::string> run(const ASTNodePtr& program, int limit = HOTSPOT_LIMIT);
+
+    // Rough size in bytes of the bytecode javac produces for `node`
+    static int estimateBytecodeSize(const ASTNodePtr& node, const std::unordered_set<std::string>& locals);
+
+private:
+    MethodSplitting(const ASTNodePtr& program, int limit);
+
+    using Locals = std::vector<std::pair<std::string, std::string>>;  // (name, type)
+
+    // Returns the report line, or "" when the function is small enough; appends the helpers made
+    std::string split(const std::shared_ptr<FunctionDeclarationNode>& function, std::vector<ASTNodePtr>& helpers);
+    // Locals still used after a cut before `statements[index]`; false when one of them cannot be passed on
+    bool liveLocals(const std::shared_ptr<FunctionDeclarationNode>& function, size_t index,
+                    const std::unordered_set<std::string>& pinned, Locals& live) const;
+
+    int limit;
+    SymbolTable globals;  // Global variables and function return types, for `auto` locals
+    StructOfArraysAnalysis::StructTable structs;
+};
+
+#endif // METHODSPLITTING_H
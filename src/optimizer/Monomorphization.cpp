@@ -0,0 +1,409 @@
+#include "Monomorphization.h"
+#include "ASTUtils.h"
+#include "../parser/TypeChecker.h"
+#include <cctype>
+#include <stdexcept>
+
+namespace {
+
+bool isIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isValueArgument(const std::string& argument) {
+    return !argument.empty() && (std::isdigit(static_cast<unsigned char>(argument[0])) || argument[0] == '-');
+}
+
+std::string trim(const std::string& text) {
+    size_t start = text.find_first_not_of(' ');
+    if (start == std::string::npos) return "";
+    return text.substr(start, text.find_last_not_of(' ') - start + 1);
+}
+
+std::string stripConst(std::string type) {
+    type = trim(type);
+    if (type.compare(0, 6, "const ") == 0) type = trim(type.substr(6));
+    return type;
+}
+
+// Splits `int, Box<long, short>` at its top-level commas
+std::vector<std::string> splitArguments(const std::string& text) {
+    std::vector<std::string> arguments;
+    int depth = 0;
+    std::string current;
+    for (char c : text) {
+        if (c == '<') depth++;
+        else if (c == '>') depth--;
+        if (c == ',' && depth == 0) {
+            arguments.push_back(trim(current));
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    if (!trim(current).empty()) arguments.push_back(trim(current));
+    return arguments;
+}
+
+// Index of the `>` closing the `<` at `open`
+size_t closingBracket(const std::string& text, size_t open) {
+    int depth = 0;
+    for (size_t i = open; i < text.size(); i++) {
+        if (text[i] == '<') depth++;
+        else if (text[i] == '>' && --depth == 0) return i;
+    }
+    return std::string::npos;
+}
+
+std::string joinArguments(const std::vector<std::string>& arguments) {
+    std::string joined;
+    for (size_t i = 0; i < arguments.size(); i++) joined += (i ? ", " : "") + arguments[i];
+    return joined;
+}
+
+// Replaces whole-word occurrences of the parameters in a type string
+std::string substituteType(const std::string& type, const std::unordered_map<std::string, std::string>& bindings) {
+    std::string result;
+    size_t i = 0;
+    while (i < type.size()) {
+        if (!isIdentifierChar(type[i])) {
+            result += type[i++];
+            continue;
+        }
+        size_t end = i;
+        while (end < type.size() && isIdentifierChar(type[end])) end++;
+        std::string word = type.substr(i, end - i);
+        bool qualified = i >= 2 && type.compare(i - 2, 2, "::") == 0;
+        auto binding = bindings.find(word);
+        result += binding != bindings.end() && !qualified ? binding->second : word;
+        i = end;
+    }
+    return result;
+}
+
+// Copies the template's parameters into a clone of its body: types are
+// rewritten word by word, value parameters become literals and `sizeof(T)`
+// is folded the way the parser folds it for a concrete type
+void substitute(ASTNodePtr& node, const std::unordered_map<std::string, std::string>& bindings) {
+    if (!node) return;
+    switch (node->type) {
+        case NodeType::IDENTIFIER: {
+            auto identifier = std::static_pointer_cast<IdentifierNode>(node);
+            auto binding = bindings.find(identifier->name);
+            if (binding != bindings.end() && isValueArgument(binding->second)) {
+                node = std::make_shared<NumberNode>(std::stod(binding->second), binding->second);
+            } else if (identifier->name.find('<') != std::string::npos) {
+                identifier->name = substituteType(identifier->name, bindings);  // `maxOf<T>` inside another template
+            }
+            return;
+        }
+        case NodeType::FUNCTION_CALL: {
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
+            auto argument = funcCall->arguments.size() == 1
+                ? std::dynamic_pointer_cast<IdentifierNode>(funcCall->arguments[0]) : nullptr;
+            if (ASTUtils::calleeName(node) == "sizeof" && argument && bindings.count(argument->name)) {
+                std::string type = bindings.at(argument->name);
+                int bits = TypeChecker::isPointerType(type) ? 64 : TypeChecker::bitWidth(type);
+                if (bits > 0) {
+                    int bytes = bits < 8 ? 1 : bits / 8;
+                    node = std::make_shared<NumberNode>(bytes, std::to_string(bytes) + "UL");
+                    return;
+                }
+            }
+            break;
+        }
+        case NodeType::VARIABLE_DECLARATION: {
+            auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(node);
+            varDecl->type = substituteType(varDecl->type, bindings);
+            break;
+        }
+        case NodeType::FUNCTION_DECLARATION: {
+            auto funcDecl = std::static_pointer_cast<FunctionDeclarationNode>(node);
+            funcDecl->returnType = substituteType(funcDecl->returnType, bindings);
+            for (auto& paramType : funcDecl->parameterTypes) paramType = substituteType(paramType, bindings);
+            break;
+        }
+        case NodeType::NEW_EXPRESSION: {
+            auto newExpr = std::static_pointer_cast<NewExpressionNode>(node);
+            newExpr->typeName = substituteType(newExpr->typeName, bindings);
+            break;
+        }
+        default:
+            break;
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { substitute(child, bindings); });
+}
+
+} // namespace
+
+std::vector<std::string> Monomorphization::run(const ASTNodePtr& program) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return {};
+
+    Monomorphization pass;
+    for (const auto& stmt : block->statements) {
+        if (auto structDecl = std::dynamic_pointer_cast<StructDeclarationNode>(stmt)) {
+            if (!structDecl->templateParameters.empty()) pass.structTemplates[structDecl->name] = structDecl;
+        } else if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt)) {
+            if (!funcDecl->templateParameters.empty()) {
+                pass.functionTemplates[ASTUtils::rootVariable(funcDecl->functionName)] = funcDecl;
+            }
+        }
+    }
+    if (pass.structTemplates.empty() && pass.functionTemplates.empty()) return {};
+
+    // Signatures first, so that calls to functions defined further down have a type
+    for (const auto& stmt : block->statements) {
+        if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt)) {
+            if (!funcDecl->templateParameters.empty()) continue;
+            funcDecl->returnType = pass.resolveType(funcDecl->returnType);
+            pass.globals.addSymbol(ASTUtils::rootVariable(funcDecl->functionName), funcDecl->returnType);
+        } else if (auto structDecl = std::dynamic_pointer_cast<StructDeclarationNode>(stmt)) {
+            if (structDecl->templateParameters.empty()) pass.resolveStruct(structDecl);
+        }
+    }
+    for (auto& stmt : block->statements) {
+        if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt)) {
+            if (funcDecl->templateParameters.empty()) pass.resolveFunction(funcDecl);
+        } else if (stmt->type != NodeType::STRUCT_DECLARATION) {
+            pass.resolve(stmt, pass.globals);
+        }
+    }
+
+    // Each template is replaced by its instantiations; unused ones disappear
+    std::vector<ASTNodePtr> statements;
+    for (const auto& stmt : block->statements) {
+        std::string name;
+        if (auto structDecl = std::dynamic_pointer_cast<StructDeclarationNode>(stmt)) {
+            if (!structDecl->templateParameters.empty()) name = structDecl->name;
+        } else if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt)) {
+            if (!funcDecl->templateParameters.empty()) name = ASTUtils::rootVariable(funcDecl->functionName);
+        }
+        if (name.empty()) {
+            statements.push_back(stmt);
+            continue;
+        }
+        const auto& instantiations = pass.declarations[name];
+        statements.insert(statements.end(), instantiations.begin(), instantiations.end());
+    }
+    block->statements = statements;
+    return pass.report;
+}
+
+// `Pair<int, Box<double>>` -> `Pair_int_Box_double`, `Grid<float*, 4>` -> `Grid_float_ptr_4`
+std::string Monomorphization::mangledName(const std::string& name, const std::vector<std::string>& arguments) {
+    std::string mangled = name;
+    for (const auto& argument : arguments) {
+        std::string spelled = TypeChecker::normalizeType(argument);
+        if (spelled.compare(0, 5, "std::") == 0) spelled = spelled.substr(5);
+        std::string part;
+        for (size_t i = 0; i < spelled.size(); i++) {
+            if (spelled.compare(i, 5, "std::") == 0) i += 5;
+            if (i >= spelled.size()) break;
+            char c = spelled[i];
+            if (isIdentifierChar(c)) part += c;
+            else if (c == '*') part += "_ptr";
+            else if (c == '-') part += "m";
+            else if (c == '[') part += "_array";
+            else if (!part.empty() && part.back() != '_') part += '_';
+        }
+        while (!part.empty() && part.back() == '_') part.pop_back();
+        mangled += "_" + part;
+    }
+    return mangled;
+}
+
+// Replaces every `Name<args>` of a struct template in a type by its instantiation
+std::string Monomorphization::resolveType(const std::string& type) {
+    std::string result;
+    size_t i = 0;
+    while (i < type.size()) {
+        if (!isIdentifierChar(type[i])) {
+            result += type[i++];
+            continue;
+        }
+        size_t end = i;
+        while (end < type.size() && isIdentifierChar(type[end])) end++;
+        std::string word = type.substr(i, end - i);
+        size_t close = end < type.size() && type[end] == '<' ? closingBracket(type, end) : std::string::npos;
+        if (!structTemplates.count(word) || close == std::string::npos) {
+            result += word;
+            i = end;
+            continue;
+        }
+        std::vector<std::string> arguments;
+        for (const auto& argument : splitArguments(type.substr(end + 1, close - end - 1))) {
+            arguments.push_back(isValueArgument(argument) ? argument : TypeChecker::normalizeType(resolveType(argument)));
+        }
+        result += instantiateStruct(word, arguments);
+        i = close + 1;
+    }
+    return result;
+}
+
+void Monomorphization::resolve(ASTNodePtr& node, SymbolTable& scope) {
+    if (!node) return;
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { resolve(child, scope); });
+
+    switch (node->type) {
+        case NodeType::VARIABLE_DECLARATION: {
+            auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(node);
+            varDecl->type = resolveType(varDecl->type);
+            std::string type = varDecl->type;
+            if (stripConst(type) == "auto" && varDecl->initializer) {
+                type = TypeChecker::inferType(varDecl->initializer, scope);
+            }
+            scope.addSymbol(ASTUtils::rootVariable(varDecl->identifier), type);
+            break;
+        }
+        case NodeType::NEW_EXPRESSION: {
+            auto newExpr = std::static_pointer_cast<NewExpressionNode>(node);
+            newExpr->typeName = resolveType(newExpr->typeName);
+            break;
+        }
+        case NodeType::FUNCTION_CALL: {
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
+            auto callee = std::dynamic_pointer_cast<IdentifierNode>(funcCall->functionName);
+            if (!callee) break;
+            size_t open = callee->name.find('<');
+            std::string name = callee->name.substr(0, open);
+            if (!functionTemplates.count(name)) break;
+
+            std::vector<std::string> arguments;
+            if (open != std::string::npos) {
+                for (const auto& argument : splitArguments(callee->name.substr(open + 1, callee->name.size() - open - 2))) {
+                    arguments.push_back(isValueArgument(argument) ? argument : TypeChecker::normalizeType(resolveType(argument)));
+                }
+            }
+            callee->name = instantiateFunction(name, arguments, funcCall->arguments, scope);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void Monomorphization::resolveStruct(const std::shared_ptr<StructDeclarationNode>& structDecl) {
+    SymbolTable fields;
+    for (auto& field : structDecl->fields) {
+        resolve(field, fields);
+        auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(field);
+        declareGlobal(structDecl->name + "::" + ASTUtils::rootVariable(varDecl->identifier), varDecl->type);
+    }
+}
+
+void Monomorphization::declareGlobal(const std::string& name, const std::string& type) {
+    globals.addSymbol(name, type);
+    for (SymbolTable* scope : openScopes) scope->addSymbol(name, type);
+}
+
+void Monomorphization::resolveFunction(const std::shared_ptr<FunctionDeclarationNode>& function) {
+    SymbolTable scope = globals;
+    for (size_t i = 0; i < function->parameterTypes.size(); i++) {
+        function->parameterTypes[i] = resolveType(function->parameterTypes[i]);
+        if (i < function->parameters.size()) {
+            scope.addSymbol(ASTUtils::rootVariable(function->parameters[i]), function->parameterTypes[i]);
+        }
+    }
+    openScopes.push_back(&scope);
+    resolve(function->body, scope);
+    openScopes.pop_back();
+}
+
+std::string Monomorphization::instantiateStruct(const std::string& name, const std::vector<std::string>& arguments) {
+    auto templateDecl = structTemplates.at(name);
+    if (arguments.size() != templateDecl->templateParameters.size()) {
+        throw std::runtime_error("Template Error: '" + name + "' takes " +
+                                 std::to_string(templateDecl->templateParameters.size()) + " argument(s), got " +
+                                 std::to_string(arguments.size()));
+    }
+    std::string mangled = mangledName(name, arguments);
+    if (instances.count(mangled)) return mangled;
+    instances[mangled] = {name, arguments};  // Before the fields, which may point back at it
+
+    Bindings bindings;
+    for (size_t i = 0; i < arguments.size(); i++) bindings[templateDecl->templateParameters[i]] = arguments[i];
+    ASTNodePtr copy = ASTUtils::clone(templateDecl);
+    substitute(copy, bindings);
+    auto structDecl = std::static_pointer_cast<StructDeclarationNode>(copy);
+    structDecl->name = mangled;
+    structDecl->templateParameters.clear();
+    resolveStruct(structDecl);
+
+    declarations[name].push_back(structDecl);
+    report.push_back("Instantiated " + name + "<" + joinArguments(arguments) + "> as " + mangled);
+    return mangled;
+}
+
+std::string Monomorphization::instantiateFunction(const std::string& name, std::vector<std::string> arguments,
+                                                  const std::vector<ASTNodePtr>& callArguments, const SymbolTable& scope) {
+    auto templateDecl = functionTemplates.at(name);
+    const auto& parameters = templateDecl->templateParameters;
+    if (arguments.size() > parameters.size()) {
+        throw std::runtime_error("Template Error: Too many template arguments in call to '" + name + "'");
+    }
+
+    Bindings bindings;
+    for (size_t i = 0; i < arguments.size(); i++) bindings[parameters[i]] = arguments[i];
+    for (size_t i = 0; i < callArguments.size() && i < templateDecl->parameterTypes.size(); i++) {
+        std::string actual = TypeChecker::inferType(callArguments[i], scope);
+        if (!actual.empty()) deduce(templateDecl->parameterTypes[i], actual, parameters, bindings);
+    }
+    arguments.clear();
+    for (const auto& parameter : parameters) {
+        if (!bindings.count(parameter)) {
+            throw std::runtime_error("Template Error: Cannot deduce '" + parameter + "' in call to '" + name + "'");
+        }
+        arguments.push_back(bindings[parameter]);
+    }
+
+    std::string mangled = mangledName(name, arguments);
+    if (instances.count(mangled)) return mangled;
+    instances[mangled] = {name, arguments};
+
+    ASTNodePtr copy = ASTUtils::clone(templateDecl);
+    substitute(copy, bindings);
+    auto funcDecl = std::static_pointer_cast<FunctionDeclarationNode>(copy);
+    funcDecl->functionName = std::make_shared<IdentifierNode>(mangled);
+    funcDecl->templateParameters.clear();
+    funcDecl->returnType = resolveType(funcDecl->returnType);
+    declareGlobal(mangled, funcDecl->returnType);  // Before the body, which may recurse
+    resolveFunction(funcDecl);
+
+    declarations[name].push_back(funcDecl);
+    report.push_back("Instantiated " + name + "<" + joinArguments(arguments) + "> as " + mangled);
+    return mangled;
+}
+
+// Matches a parameter type such as `T`, `const T*` or `Box<T>` against the
+// argument's type, binding the parameters it mentions that are still unbound
+void Monomorphization::deduce(const std::string& pattern, const std::string& actual,
+                              const std::vector<std::string>& parameters, Bindings& bindings) const {
+    std::string expected = stripConst(pattern);
+    std::string given = TypeChecker::normalizeType(stripConst(actual));
+    if (given.empty()) return;
+
+    for (const auto& parameter : parameters) {
+        if (expected != parameter) continue;
+        if (!bindings.count(parameter)) bindings[parameter] = given;
+        return;
+    }
+    if (TypeChecker::isPointerType(expected) && TypeChecker::isPointerType(given)) {
+        deduce(TypeChecker::elementType(expected), TypeChecker::elementType(given), parameters, bindings);
+        return;
+    }
+
+    std::string templateName = TypeChecker::templateName(expected);
+    if (templateName.empty()) return;
+    std::vector<std::string> givenArguments;
+    auto instance = instances.find(given);
+    if (instance != instances.end() && instance->second.first == templateName) {
+        givenArguments = instance->second.second;
+    } else if (TypeChecker::templateName(given) == templateName) {
+        givenArguments = TypeChecker::templateArguments(given);
+    }
+    std::vector<std::string> expectedArguments = TypeChecker::templateArguments(expected);
+    for (size_t i = 0; i < expectedArguments.size() && i < givenArguments.size(); i++) {
+        deduce(expectedArguments[i], givenArguments[i], parameters, bindings);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef MONOMORPHIZATION_H
+#define MONOMORPHIZATION_H
+
+#include "../parser/ASTNode.h"
+#include "../parser/SymbolTable.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Java generics erase to Object, so a `RingBuffer<int>` translated as
+// `RingBuffer<Integer>` would box every element. Instead each template is
+// copied once per set of arguments the program uses, with the parameters
+// substituted: `RingBuffer<int>` becomes the struct `RingBuffer_int` with an
+// `int[]` field, and `maxOf(a, b)` on doubles calls `maxOf_double`.
+// Function template arguments are deduced from the argument types, or taken
+// from an explicit `maxOf<long>(...)`. Instantiations are shared across the
+// program and take the place of the template they come from.
+class Monomorphization {
+public:
+    // Rewrites the program in place; returns one report line per instantiation
+    static std::vector<std::string> run(const ASTNodePtr& program);
+
+    // Identifier-safe name of an instantiation: `Matrix_double_4` for Matrix<double, 4>
+    static std::string mangledName(const std::string& name, const std::vector<std::string>& arguments);
+
+private:
+    Monomorphization() = default;
+
+    using Bindings = std::unordered_map<std::string, std::string>;  // Template parameter -> argument
+
+    std::string resolveType(const std::string& type);
+    void resolve(ASTNodePtr& node, SymbolTable& scope);
+    void resolveStruct(const std::shared_ptr<StructDeclarationNode>& structDecl);
+    void resolveFunction(const std::shared_ptr<FunctionDeclarationNode>& function);
+    // Adds to the globals and to the scopes of the bodies being resolved, which copied them earlier
+    void declareGlobal(const std::string& name, const std::string& type);
+    std::string instantiateStruct(const std::string& name, const std::vector<std::string>& arguments);
+    std::string instantiateFunction(const std::string& name, std::vector<std::string> arguments,
+                                    const std::vector<ASTNodePtr>& callArguments, const SymbolTable& scope);
+    void deduce(const std::string& pattern, const std::string& actual, const std::vector<std::string>& parameters,
+                Bindings& bindings) const;
+
+    std::unordered_map<std::string, std::shared_ptr<StructDeclarationNode>> structTemplates;
+    std::unordered_map<std::string, std::shared_ptr<FunctionDeclarationNode>> functionTemplates;
+    // Mangled name -> template and arguments, for deducing from instantiated types
+    std::unordered_map<std::string, std::pair<std::string, std::vector<std::string>>> instances;
+    std::unordered_map<std::string, std::vector<ASTNodePtr>> declarations;  // Template name -> its instantiations
+    SymbolTable globals;  // Global variables, function return types and `Struct::field` types
+    std::vector<SymbolTable*> openScopes;  // Function bodies being resolved, innermost last
+    std::vector<std::string> report;
+};
+
+#endif // MONOMORPHIZATION_H
@@ -0,0 +1,198 @@
+#include "RangeForLowering.h"
+#include "ASTUtils.h"
+#include "../parser/TypeChecker.h"
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+std::string translationError(const std::string& message) {
+    return "Translation Error: " + message;
+}
+
+ASTNodePtr memberCall(const ASTNodePtr& object, const std::string& member, std::vector<ASTNodePtr> arguments) {
+    return std::make_shared<FunctionCallNode>(std::make_shared<MemberAccessNode>(ASTUtils::clone(object), member, false),
+                                              std::move(arguments));
+}
+
+// Replaces the uses of variable `name` in `node` by `replacement(written)`, where `written`
+// tells an assigned or stepped use from a read; declarations and callees are not uses
+void replaceUses(ASTNodePtr& node, const std::string& name, const std::function<ASTNodePtr(bool)>& replacement,
+                 bool written = false) {
+    if (!node) return;
+    if (node->type == NodeType::IDENTIFIER) {
+        if (std::static_pointer_cast<IdentifierNode>(node)->name == name) node = replacement(written);
+        return;
+    }
+    if (auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node)) {
+        replaceUses(binExpr->left, name, replacement, ASTUtils::isAssignmentOperator(binExpr->op));
+        replaceUses(binExpr->right, name, replacement);
+        return;
+    }
+    if (auto unaryExpr = std::dynamic_pointer_cast<UnaryExpressionNode>(node)) {
+        bool step = unaryExpr->op == "++" || unaryExpr->op == "--" || unaryExpr->op == "&";
+        replaceUses(unaryExpr->operand, name, replacement, step);
+        return;
+    }
+    if (auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(node)) {
+        for (auto& size : varDecl->arraySizes) replaceUses(size, name, replacement);
+        for (auto& argument : varDecl->constructorArguments) replaceUses(argument, name, replacement);
+        replaceUses(varDecl->initializer, name, replacement);
+        return;
+    }
+    if (auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node)) {
+        if (funcCall->functionName->type != NodeType::IDENTIFIER) replaceUses(funcCall->functionName, name, replacement);
+        for (auto& argument : funcCall->arguments) replaceUses(argument, name, replacement);
+        return;
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { replaceUses(child, name, replacement); });
+}
+
+// `p.first` -> `p$first` and `p.second` -> `p$second`; false when `p` is used any other way
+bool splitPair(ASTNodePtr& node, const std::string& name) {
+    if (!node) return true;
+    if (auto member = std::dynamic_pointer_cast<MemberAccessNode>(node)) {
+        auto object = std::dynamic_pointer_cast<IdentifierNode>(member->object);
+        if (object && object->name == name && (member->member == "first" || member->member == "second")) {
+            node = std::make_shared<IdentifierNode>(name + "$" + member->member);
+            return true;
+        }
+    }
+    if (auto identifier = std::dynamic_pointer_cast<IdentifierNode>(node)) return identifier->name != name;
+    bool split = true;
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { split = splitPair(child, name) && split; });
+    return split;
+}
+
+} // namespace
+
+int RangeForLowering::run(const ASTNodePtr& program) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return 0;
+
+    RangeForLowering pass;
+    Scope globals;
+    for (const auto& stmt : block->statements) {
+        auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(stmt);
+        if (!varDecl) continue;
+        declare(globals, varDecl);
+    }
+    for (auto& stmt : block->statements) {
+        auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+        if (!funcDecl) continue;
+        Scope scope = globals;
+        for (size_t i = 0; i < funcDecl->parameters.size() && i < funcDecl->parameterTypes.size(); i++) {
+            scope[ASTUtils::rootVariable(funcDecl->parameters[i])] = {funcDecl->parameterTypes[i], nullptr};
+        }
+        pass.lowerIn(funcDecl->body, scope);
+    }
+    return pass.lowered;
+}
+
+void RangeForLowering::declare(Scope& scope, const std::shared_ptr<VariableDeclarationNode>& varDecl) {
+    ASTNodePtr length = varDecl->arraySizes.empty() ? nullptr : varDecl->arraySizes.front();
+    auto list = std::dynamic_pointer_cast<InitializerListNode>(varDecl->initializer);
+    if (!varDecl->arraySizes.empty() && !length && list) length = std::make_shared<NumberNode>(list->elements.size());
+    scope[ASTUtils::rootVariable(varDecl->identifier)] = {varDecl->type, length};
+}
+
+void RangeForLowering::lowerIn(ASTNodePtr& node, Scope scope) {
+    if (!node) return;
+    if (auto block = std::dynamic_pointer_cast<BlockNode>(node)) {
+        // Declarations are visible to the statements after them
+        for (auto& stmt : block->statements) {
+            lowerIn(stmt, scope);
+            if (auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(stmt)) declare(scope, varDecl);
+        }
+        return;
+    }
+    if (auto forLoop = std::dynamic_pointer_cast<ForLoopNode>(node)) {
+        if (forLoop->range) lower(forLoop, scope);
+        for (const auto& init : forLoop->initializers) {
+            if (auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(init)) declare(scope, varDecl);
+        }
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { lowerIn(child, scope); });
+}
+
+void RangeForLowering::lower(const std::shared_ptr<ForLoopNode>& forLoop, const Scope& scope) {
+    auto element = std::static_pointer_cast<VariableDeclarationNode>(forLoop->initializers.front());
+    ASTNodePtr range = forLoop->range;
+    std::string name = ASTUtils::rootVariable(element->identifier);
+    auto declared = range->type == NodeType::IDENTIFIER ? scope.find(ASTUtils::rootVariable(range)) : scope.end();
+    std::string type = declared == scope.end() ? "" : TypeChecker::normalizeType(declared->second.type);
+    std::string container = TypeChecker::templateName(type);
+    std::vector<std::string> arguments = TypeChecker::templateArguments(type);
+    bool array = !type.empty() && type.back() == ']' && declared->second.length;
+    if (!array && container != "vector" && container != "unordered_map" && container != "unordered_set" && type != "string") {
+        throw std::runtime_error(translationError("the range-based for loop over '" + name + "' must iterate a "
+                                                  "declared array, string, vector, unordered_map or unordered_set"));
+    }
+    if (!forLoop->bindings.empty() && (container != "unordered_map" || forLoop->bindings.size() != 2)) {
+        throw std::runtime_error(translationError("a structured binding in a range-based for must name the key and "
+                                                  "value of an unordered_map"));
+    }
+
+    std::string index = name + "$i";
+    auto counter = [&] { return std::make_shared<IdentifierNode>(index); };
+    auto autoTyped = [](const std::string& declaredType, const std::string& elementType) {
+        return TypeChecker::normalizeType(declaredType) == "auto" ? elementType : declaredType;
+    };
+    ASTNodePtr bound;
+    std::vector<ASTNodePtr> prefix;
+    std::shared_ptr<BlockNode> body = std::dynamic_pointer_cast<BlockNode>(forLoop->body);
+    if (!body) body = std::make_shared<BlockNode>(std::vector<ASTNodePtr>{forLoop->body});
+
+    if (container == "unordered_map" || container == "unordered_set") {
+        bound = memberCall(range, "slots", {});
+        auto key = [&] { return memberCall(range, "keyAt", {counter()}); };
+        if (container == "unordered_set") {
+            // Set elements are constant, so even a reference element is a copy
+            element->type = autoTyped(element->type, arguments[0]);
+            element->initializer = key();
+            element->reference = false;
+            prefix.push_back(element);
+        } else {
+            std::string keyName = forLoop->bindings.empty() ? name + "$first" : forLoop->bindings[0];
+            std::string valueName = forLoop->bindings.empty() ? name + "$second" : forLoop->bindings[1];
+            ASTNodePtr statements = body;
+            if (forLoop->bindings.empty() && !splitPair(statements, name)) {
+                throw std::runtime_error(translationError("the map element '" + name + "' can only be used through "
+                                                          "'" + name + ".first' and '" + name + ".second'"));
+            }
+            if (element->reference) {
+                // The key cannot change; a written value is stored back under it
+                replaceUses(statements, keyName, [&](bool) { return key(); });
+                replaceUses(statements, valueName, [&](bool written) -> ASTNodePtr {
+                    if (written) return std::make_shared<ArrayAccessNode>(ASTUtils::clone(range), key());
+                    return memberCall(range, "valueAt", {counter()});
+                });
+            } else {
+                prefix.push_back(std::make_shared<VariableDeclarationNode>(
+                    arguments[0], std::make_shared<IdentifierNode>(keyName), key()));
+                prefix.push_back(std::make_shared<VariableDeclarationNode>(
+                    arguments[1], std::make_shared<IdentifierNode>(valueName), memberCall(range, "valueAt", {counter()})));
+            }
+        }
+    } else {
+        std::string elementType = array ? TypeChecker::elementType(type) : container == "vector" ? arguments[0] : "char";
+        bound = array ? ASTUtils::clone(declared->second.length) : memberCall(range, "size", {});
+        element->type = autoTyped(element->type, elementType);
+        element->initializer = std::make_shared<ArrayAccessNode>(ASTUtils::clone(range), counter());
+        prefix.push_back(element);
+    }
+
+    body->statements.insert(body->statements.begin(), prefix.begin(), prefix.end());
+    if (container == "unordered_map" || container == "unordered_set") {
+        // Empty slots are skipped
+        ASTNodePtr full = memberCall(range, "full", {counter()});
+        body = std::make_shared<BlockNode>(std::vector<ASTNodePtr>{std::make_shared<IfStatementNode>(full, body, nullptr)});
+    }
+    forLoop->initializers = {std::make_shared<VariableDeclarationNode>("int", counter(), std::make_shared<NumberNode>(0))};
+    forLoop->condition = std::make_shared<BinaryExpressionNode>(counter(), "<", bound);
+    forLoop->increments = {std::make_shared<UnaryExpressionNode>("++", counter(), false)};
+    forLoop->body = body;
+    forLoop->range = nullptr;
+    forLoop->bindings.clear();
+    lowered++;
+}
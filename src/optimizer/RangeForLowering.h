@@ -0,0 +1,38 @@
+#ifndef RANGEFORLOWERING_H
+#define RANGEFORLOWERING_H
+
+#include "../parser/ASTNode.h"
+#include <string>
+#include <unordered_map>
+
+// Range-based for loops become counted loops before any other pass sees them,
+// so the passes and the emitter only know `for (init; condition; step)`:
+// - Over a vector, string or array, `for (auto x : v)` counts `x$i` up to
+//   `v.size()` or the declared length and starts the body with `T x = v[x$i]`.
+//   `auto` takes the element type, and a reference element stays a reference
+//   declaration, which ReferenceLowering turns into an alias for `v[x$i]`.
+// - Over an unordered_map or unordered_set, the loop walks the slots of the
+//   runtime hash table and skips the empty ones. `p.first` and `p.second`, or
+//   the names of `auto& [key, value]`, read the slot's key and value. Through a
+//   reference element, a write to the value goes to `m[key]`.
+// The range must be a variable declared in view; anything else is a Translation Error.
+class RangeForLowering {
+public:
+    // Rewrites the program in place; returns the number of loops lowered
+    static int run(const ASTNodePtr& program);
+
+private:
+    struct Range {
+        std::string type;
+        ASTNodePtr length;  // Of a declared array
+    };
+    using Scope = std::unordered_map<std::string, Range>;
+
+    static void declare(Scope& scope, const std::shared_ptr<VariableDeclarationNode>& varDecl);
+    void lowerIn(ASTNodePtr& node, Scope scope);
+    void lower(const std::shared_ptr<ForLoopNode>& forLoop, const Scope& scope);
+
+    int lowered = 0;
+};
+
+#endif // RANGEFORLOWERING_H
@@ -0,0 +1,432 @@
+#include "ReferenceLowering.h"
+#include "ASTUtils.h"
+#include "SideEffectAnalysis.h"
+#include "../parser/TypeChecker.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+// Replaces the uses of variable `name` in `node` by `replacement()`; declarations and callees are not uses
+void substitute(ASTNodePtr& node, const std::string& name, const std::function<ASTNodePtr()>& replacement) {
+    if (!node) return;
+    if (node->type == NodeType::IDENTIFIER) {
+        if (std::static_pointer_cast<IdentifierNode>(node)->name == name) node = replacement();
+        return;
+    }
+    auto visit = [&](ASTNodePtr& child) {
+        if (child && child->type == NodeType::IDENTIFIER && node->type == NodeType::VARIABLE_DECLARATION &&
+            child == std::static_pointer_cast<VariableDeclarationNode>(node)->identifier) {
+            return;
+        }
+        if (child && child->type == NodeType::IDENTIFIER && node->type == NodeType::FUNCTION_CALL &&
+            child == std::static_pointer_cast<FunctionCallNode>(node)->functionName) {
+            return;
+        }
+        substitute(child, name, replacement);
+    };
+    ASTUtils::forEachChild(node, visit);
+}
+
+// Variables assigned or stepped as a whole in `node`, or whose address it takes
+void collectReassigned(const ASTNodePtr& node, std::unordered_set<std::string>& names) {
+    if (!node) return;
+    if (auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node)) {
+        if (ASTUtils::isAssignmentOperator(binExpr->op) && binExpr->left->type == NodeType::IDENTIFIER) {
+            names.insert(std::static_pointer_cast<IdentifierNode>(binExpr->left)->name);
+        }
+    } else if (auto unaryExpr = std::dynamic_pointer_cast<UnaryExpressionNode>(node)) {
+        if ((unaryExpr->op == "++" || unaryExpr->op == "--" || unaryExpr->op == "&") &&
+            unaryExpr->operand->type == NodeType::IDENTIFIER) {
+            names.insert(std::static_pointer_cast<IdentifierNode>(unaryExpr->operand)->name);
+        }
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectReassigned(child, names); });
+}
+
+// Variable whose object an lvalue or a member call on it reaches (`v` for `v.at(i)` and `s.a[i]`), or ""
+std::string objectRoot(const ASTNodePtr& node) {
+    if (node && node->type == NodeType::FUNCTION_CALL) {
+        auto member = std::dynamic_pointer_cast<MemberAccessNode>(std::static_pointer_cast<FunctionCallNode>(node)->functionName);
+        return member ? objectRoot(member->object) : "";
+    }
+    if (auto element = std::dynamic_pointer_cast<ArrayAccessNode>(node)) return objectRoot(element->array);
+    if (auto member = std::dynamic_pointer_cast<MemberAccessNode>(node)) return objectRoot(member->object);
+    if (auto unaryExpr = std::dynamic_pointer_cast<UnaryExpressionNode>(node)) return objectRoot(unaryExpr->operand);
+    return ASTUtils::rootVariable(node);
+}
+
+void collectNames(const ASTNodePtr& node, std::unordered_set<std::string>& names) {
+    if (!node) return;
+    if (node->type == NodeType::IDENTIFIER) names.insert(std::static_pointer_cast<IdentifierNode>(node)->name);
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectNames(child, names); });
+}
+
+// No call, assignment or step anywhere in `node`
+bool isSideEffectFree(const ASTNodePtr& node) {
+    if (!node) return true;
+    if (node->type == NodeType::FUNCTION_CALL) return false;
+    if (auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node)) {
+        if (ASTUtils::isAssignmentOperator(binExpr->op)) return false;
+    }
+    if (auto unaryExpr = std::dynamic_pointer_cast<UnaryExpressionNode>(node)) {
+        if (unaryExpr->op == "++" || unaryExpr->op == "--") return false;
+    }
+    bool free = true;
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { free = free && isSideEffectFree(child); });
+    return free;
+}
+
+// `x`, `a[i]`, `s.f`, `p->f` or `*p`: an lvalue that names the same place each time it is evaluated
+bool isPlace(const ASTNodePtr& node) {
+    if (!node) return false;
+    switch (node->type) {
+        case NodeType::IDENTIFIER:
+            return true;
+        case NodeType::ARRAY_ACCESS: {
+            auto element = std::static_pointer_cast<ArrayAccessNode>(node);
+            return isPlace(element->array) && isSideEffectFree(element->index);
+        }
+        case NodeType::MEMBER_ACCESS:
+            return isPlace(std::static_pointer_cast<MemberAccessNode>(node)->object);
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            return unaryExpr->op == "*" && isPlace(unaryExpr->operand);
+        }
+        default:
+            return false;
+    }
+}
+
+std::shared_ptr<VariableDeclarationNode> findDeclaration(const ASTNodePtr& node, const std::string& name) {
+    if (!node) return nullptr;
+    auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(node);
+    if (varDecl && ASTUtils::rootVariable(varDecl->identifier) == name) return varDecl;
+    std::shared_ptr<VariableDeclarationNode> found;
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) {
+        if (!found) found = findDeclaration(child, name);
+    });
+    return found;
+}
+
+std::string translationError(const std::string& message) {
+    return "Translation Error: " + message;
+}
+
+} // namespace
+
+int ReferenceLowering::run(const ASTNodePtr& program) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return 0;
+
+    ReferenceLowering pass(block);
+    std::vector<std::shared_ptr<FunctionDeclarationNode>> functions;
+    for (auto& stmt : block->statements) {
+        auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+        if (!funcDecl) continue;
+        std::string name = ASTUtils::rootVariable(funcDecl->functionName);
+        if (funcDecl->returnsReference && !pass.isObjectType(funcDecl->returnType)) {
+            throw std::runtime_error(translationError("'" + name + "' returns a reference to a '" + funcDecl->returnType +
+                                                      "', which Java cannot return; return a pointer instead"));
+        }
+        pass.lowerLocalReferences(funcDecl->body);
+        functions.push_back(funcDecl);
+    }
+    // Callers' reference parameters tell which arguments a call may modify, so they are read before any is lowered
+    for (const auto& funcDecl : functions) pass.markCopiedParameters(funcDecl);
+    for (const auto& funcDecl : functions) pass.lowerParameters(funcDecl);
+    for (auto& stmt : block->statements) {
+        auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(stmt);
+        if (varDecl && varDecl->reference && !pass.isObjectType(varDecl->type)) {
+            throw std::runtime_error(translationError("the global reference '" + ASTUtils::rootVariable(varDecl->identifier) +
+                                                      "' is not supported"));
+        }
+        pass.passAddresses(stmt);
+        pass.collectAddressTaken(stmt, std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt));
+    }
+    // Boxing a global rewrites every function, so all are found first
+    auto addressTaken = pass.addressTaken;
+    for (const auto& variable : addressTaken) pass.box(variable.first, variable.second);
+    return pass.rewritten;
+}
+
+ReferenceLowering::ReferenceLowering(const std::shared_ptr<BlockNode>& program) : program(program) {
+    for (const auto& stmt : program->statements) {
+        if (auto structDecl = std::dynamic_pointer_cast<StructDeclarationNode>(stmt)) structs.insert(structDecl->name);
+        if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt)) {
+            functions[ASTUtils::rootVariable(funcDecl->functionName)].push_back(funcDecl);
+        }
+    }
+}
+
+// Structs and library classes are Java objects, which every copy of the reference shares
+bool ReferenceLowering::isObjectType(const std::string& type) const {
+    std::string normalized = TypeChecker::normalizeType(type);
+    if (TypeChecker::isPointerType(normalized)) return false;
+    return structs.count(normalized) || normalized.rfind("std::", 0) == 0;
+}
+
+void ReferenceLowering::lowerLocalReferences(ASTNodePtr& node) {
+    if (!node) return;
+    if (auto block = std::dynamic_pointer_cast<BlockNode>(node)) {
+        for (size_t i = 0; i < block->statements.size(); i++) {
+            auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(block->statements[i]);
+            if (varDecl && varDecl->reference) {
+                std::vector<ASTNodePtr*> scope;
+                for (size_t j = i + 1; j < block->statements.size(); j++) scope.push_back(&block->statements[j]);
+                if (lowerLocalReference(varDecl, scope)) {
+                    block->statements.erase(block->statements.begin() + i--);
+                    continue;
+                }
+            }
+            lowerLocalReferences(block->statements[i]);
+        }
+        return;
+    }
+    if (auto forLoop = std::dynamic_pointer_cast<ForLoopNode>(node)) {
+        for (size_t i = 0; i < forLoop->initializers.size(); i++) {
+            auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(forLoop->initializers[i]);
+            if (!varDecl || !varDecl->reference) continue;
+            std::vector<ASTNodePtr*> scope = {&forLoop->condition, &forLoop->body};
+            for (auto& increment : forLoop->increments) scope.push_back(&increment);
+            for (size_t j = i + 1; j < forLoop->initializers.size(); j++) scope.push_back(&forLoop->initializers[j]);
+            if (lowerLocalReference(varDecl, scope)) forLoop->initializers.erase(forLoop->initializers.begin() + i--);
+        }
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { lowerLocalReferences(child); });
+}
+
+// Returns true when the declaration became an alias and can go
+bool ReferenceLowering::lowerLocalReference(const std::shared_ptr<VariableDeclarationNode>& varDecl,
+                                            std::vector<ASTNodePtr*> scope) {
+    std::string name = ASTUtils::rootVariable(varDecl->identifier);
+    varDecl->reference = false;
+    rewritten++;
+
+    std::unordered_set<std::string> reassigned, depends;
+    for (ASTNodePtr* stmt : scope) collectReassigned(*stmt, reassigned);
+    collectNames(varDecl->initializer, depends);
+    // `int& r = x` aliases `x` even as `x` changes; `a[i]` stops naming the same element when `i` or `a` does
+    bool fixed = isPlace(varDecl->initializer);
+    if (fixed && varDecl->initializer->type != NodeType::IDENTIFIER) {
+        for (const auto& dependency : depends) fixed = fixed && !reassigned.count(dependency);
+    }
+    if (fixed) {
+        for (ASTNodePtr* stmt : scope) {
+            substitute(*stmt, name, [&] { return ASTUtils::clone(varDecl->initializer); });
+        }
+        return true;
+    }
+
+    if (isObjectType(varDecl->type)) return false;
+    std::string type = TypeChecker::normalizeType(varDecl->type);
+    if (type == "auto") {
+        throw std::runtime_error(translationError("the reference '" + name + "' needs its type spelled out to be "
+                                                  "translated as a pointer"));
+    }
+    if (TypeChecker::isPointerType(type)) {
+        throw std::runtime_error(translationError("the reference '" + name + "' to a pointer is not supported"));
+    }
+    varDecl->type += "*";
+    varDecl->initializer = std::make_shared<UnaryExpressionNode>("&", varDecl->initializer, true);
+    for (ASTNodePtr* stmt : scope) {
+        substitute(*stmt, name, [&] {
+            return std::make_shared<UnaryExpressionNode>("*", std::make_shared<IdentifierNode>(name), true);
+        });
+    }
+    return false;
+}
+
+// Objects `node` may modify: assigned or stepped through, called with a mutating member,
+// address taken, or passed to a reference parameter or a library function with effects
+void ReferenceLowering::collectModifiedObjects(const ASTNodePtr& node, std::unordered_set<std::string>& names) const {
+    if (!node) return;
+    if (auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node)) {
+        if (ASTUtils::isAssignmentOperator(binExpr->op)) names.insert(objectRoot(binExpr->left));
+    } else if (auto unaryExpr = std::dynamic_pointer_cast<UnaryExpressionNode>(node)) {
+        if (unaryExpr->op == "++" || unaryExpr->op == "--" || unaryExpr->op == "&") names.insert(objectRoot(unaryExpr->operand));
+    } else if (auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node)) {
+        auto member = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName);
+        if (member && (!SideEffectAnalysis::isConstMember(member->member) || member->member == "data")) {
+            names.insert(objectRoot(member->object));
+        }
+        std::string callee = ASTUtils::calleeName(node);
+        auto overloads = functions.find(callee);
+        for (size_t i = 0; !callee.empty() && i < funcCall->arguments.size(); i++) {
+            bool byReference = overloads == functions.end() && !SideEffectAnalysis::isPureLibraryFunction(callee);
+            if (overloads != functions.end()) {
+                for (const auto& overload : overloads->second) {
+                    byReference = byReference || (i < overload->referenceParameters.size() && overload->referenceParameters[i]);
+                }
+            }
+            if (byReference) names.insert(objectRoot(funcCall->arguments[i]));
+        }
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectModifiedObjects(child, names); });
+}
+
+// C++ copies an object passed by value, while Java passes the caller's; a parameter the
+// callee may modify is copied on entry so the caller's object stays as it was
+void ReferenceLowering::markCopiedParameters(const std::shared_ptr<FunctionDeclarationNode>& function) const {
+    std::unordered_set<std::string> modified;
+    collectModifiedObjects(function->body, modified);
+    function->copiedParameters.assign(function->parameters.size(), false);
+    for (size_t i = 0; i < function->parameters.size() && i < function->parameterTypes.size(); i++) {
+        bool reference = i < function->referenceParameters.size() && function->referenceParameters[i];
+        function->copiedParameters[i] = !reference && isObjectType(function->parameterTypes[i]) &&
+                                        modified.count(ASTUtils::rootVariable(function->parameters[i]));
+    }
+}
+
+void ReferenceLowering::lowerParameters(const std::shared_ptr<FunctionDeclarationNode>& function) {
+    std::unordered_set<std::string> reassigned;
+    collectReassigned(function->body, reassigned);
+    std::string functionName = ASTUtils::rootVariable(function->functionName);
+    std::vector<bool> pointers(function->parameters.size(), false);
+    for (size_t i = 0; i < function->referenceParameters.size() && i < function->parameters.size(); i++) {
+        if (!function->referenceParameters[i]) continue;
+        std::string name = ASTUtils::rootVariable(function->parameters[i]);
+        std::string& type = function->parameterTypes[i];
+        if (isObjectType(type) && !reassigned.count(name)) continue;
+        if (TypeChecker::isPointerType(TypeChecker::normalizeType(type))) {
+            throw std::runtime_error(translationError("parameter '" + name + "' of '" + functionName +
+                                                      "' is a reference to a pointer, which is not supported"));
+        }
+        type += "*";
+        pointers[i] = true;
+        substitute(function->body, name, [&] {
+            return std::make_shared<UnaryExpressionNode>("*", std::make_shared<IdentifierNode>(name), true);
+        });
+        rewritten++;
+    }
+    function->referenceParameters.clear();
+    if (std::find(pointers.begin(), pointers.end(), true) != pointers.end()) pointerParameters[function.get()] = pointers;
+}
+
+// Arguments bound to a parameter that became a pointer are passed by address
+void ReferenceLowering::passAddresses(ASTNodePtr& node) {
+    if (!node) return;
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { passAddresses(child); });
+
+    auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node);
+    auto overloads = funcCall ? functions.find(ASTUtils::calleeName(funcCall)) : functions.end();
+    if (overloads == functions.end()) return;
+    for (const auto& overload : overloads->second) {
+        auto pointers = pointerParameters.find(overload.get());
+        if (pointers == pointerParameters.end() || overload->parameters.size() != funcCall->arguments.size()) continue;
+        for (size_t i = 0; i < funcCall->arguments.size(); i++) {
+            if (!pointers->second[i]) continue;
+            ASTNodePtr& argument = funcCall->arguments[i];
+            if (argument->type == NodeType::MEMBER_ACCESS) {
+                throw std::runtime_error(translationError(
+                    "the field '" + std::static_pointer_cast<MemberAccessNode>(argument)->member + "' is passed to '" +
+                    ASTUtils::rootVariable(overload->parameters[i]) + "' of '" + overloads->first +
+                    "' by reference, but a Java field cannot be pointed to; copy it to a local and back"));
+            }
+            if (argument->type == NodeType::IDENTIFIER) passedObjects.insert(std::static_pointer_cast<IdentifierNode>(argument)->name);
+            argument = std::make_shared<UnaryExpressionNode>("&", argument, true);
+        }
+        return;
+    }
+}
+
+// `&x` of a variable, recorded with the function whose parameter or local it is, or nullptr for a global
+void ReferenceLowering::collectAddressTaken(const ASTNodePtr& node, const std::shared_ptr<FunctionDeclarationNode>& function) {
+    if (!node) return;
+    // `memcpy(&i, &f, 4)` reinterprets bits, which the emitter turns into an assignment
+    auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node);
+    std::string callee = ASTUtils::calleeName(node);
+    if ((callee == "memcpy" || callee == "memmove") && funcCall->arguments.size() == 3) {
+        auto dst = std::dynamic_pointer_cast<UnaryExpressionNode>(funcCall->arguments[0]);
+        auto src = std::dynamic_pointer_cast<UnaryExpressionNode>(funcCall->arguments[1]);
+        if (dst && src && dst->op == "&" && src->op == "&" && dst->operand->type == NodeType::IDENTIFIER &&
+            src->operand->type == NodeType::IDENTIFIER) {
+            return;
+        }
+    }
+    auto unaryExpr = std::dynamic_pointer_cast<UnaryExpressionNode>(node);
+    if (unaryExpr && unaryExpr->op == "&" && unaryExpr->operand->type == NodeType::IDENTIFIER) {
+        std::string name = std::static_pointer_cast<IdentifierNode>(unaryExpr->operand)->name;
+        bool local = false;
+        if (function) {
+            for (const auto& param : function->parameters) local = local || ASTUtils::rootVariable(param) == name;
+            local = local || findDeclaration(function->body, name);
+        }
+        auto variable = std::make_pair(name, local ? function : nullptr);
+        if (std::find(addressTaken.begin(), addressTaken.end(), variable) == addressTaken.end()) {
+            addressTaken.push_back(variable);
+        }
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectAddressTaken(child, function); });
+}
+
+void ReferenceLowering::box(const std::string& name, const std::shared_ptr<FunctionDeclarationNode>& function) {
+    std::shared_ptr<VariableDeclarationNode> varDecl;
+    std::string type;
+    size_t parameter = function ? function->parameters.size() : 0;
+    if (function) {
+        for (size_t i = 0; i < function->parameters.size(); i++) {
+            if (ASTUtils::rootVariable(function->parameters[i]) == name) parameter = i;
+        }
+        if (parameter < function->parameters.size()) type = function->parameterTypes[parameter];
+        else varDecl = findDeclaration(function->body, name);
+    } else {
+        for (const auto& stmt : program->statements) {
+            auto global = std::dynamic_pointer_cast<VariableDeclarationNode>(stmt);
+            if (global && ASTUtils::rootVariable(global->identifier) == name) varDecl = global;
+        }
+        if (!varDecl) return;  // A function or an enumerator
+    }
+    if (varDecl) {
+        if (!varDecl->arraySizes.empty()) return;  // Already an array
+        type = varDecl->type;
+    }
+
+    // Pointers to pointers keep the emitter's one-element copy; objects are shared unless assigned as a whole
+    std::string normalized = TypeChecker::normalizeType(type);
+    if (TypeChecker::isPointerType(normalized) || (isObjectType(type) && !passedObjects.count(name))) return;
+    if (normalized == "auto") {
+        throw std::runtime_error(translationError("the address of '" + name + "' is taken, so it must be declared "
+                                                  "with its type to be boxed"));
+    }
+    if (varDecl && !varDecl->constructorArguments.empty()) {
+        throw std::runtime_error(translationError("the address of '" + name + "' is taken, but a constructed "
+                                                  "variable cannot be boxed"));
+    }
+    rewritten++;
+
+    std::string boxName = varDecl ? name : name + "$box";
+    auto element = [&] {
+        return std::make_shared<ArrayAccessNode>(std::make_shared<IdentifierNode>(boxName), std::make_shared<NumberNode>(0, "0"));
+    };
+    if (!varDecl) {
+        // A parameter is copied into its box on entry
+        substitute(function->body, name, element);
+        varDecl = std::make_shared<VariableDeclarationNode>(type, std::make_shared<IdentifierNode>(boxName),
+                                                            std::make_shared<IdentifierNode>(name));
+        if (auto body = std::dynamic_pointer_cast<BlockNode>(function->body)) body->statements.insert(body->statements.begin(), varDecl);
+    } else if (function) {
+        substitute(function->body, name, element);
+    } else {
+        for (auto& stmt : program->statements) {
+            auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+            bool shadowed = false;
+            for (const auto& param : funcDecl ? funcDecl->parameters : std::vector<ASTNodePtr>()) {
+                shadowed = shadowed || ASTUtils::rootVariable(param) == name;
+            }
+            if (funcDecl && !shadowed && !findDeclaration(funcDecl->body, name)) substitute(funcDecl->body, name, element);
+            else if (!funcDecl && stmt != varDecl) substitute(stmt, name, element);
+        }
+    }
+
+    // `int x = 1` -> `int x[1] = {1}`; `int x{1}` already has its braces
+    ASTNodePtr initializer = varDecl->initializer;
+    auto list = std::dynamic_pointer_cast<InitializerListNode>(initializer);
+    if (initializer && !(list && !isObjectType(type))) {
+        initializer = std::make_shared<InitializerListNode>(std::vector<ASTNodePtr>{initializer});
+    }
+    varDecl->type += "[]";
+    varDecl->arraySizes = {std::make_shared<NumberNode>(1, "1")};
+    varDecl->initializer = initializer;
+}
@@ -0,0 +1,56 @@
+#ifndef REFERENCELOWERING_H
+#define REFERENCELOWERING_H
+
+#include "../parser/ASTNode.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Java passes everything by value and cannot take the address of a variable,
+// so references and `&x` are rewritten onto the array-and-offset pointer model
+// before any other pass sees them:
+// - A local `T& r = e` whose `e` names a fixed place (`x`, `a[i]`, `s.f`, with
+//   nothing it depends on reassigned later) is an alias, and its uses become `e`.
+//   Any other one becomes a pointer to `e`.
+// - A non-const reference parameter becomes a pointer (`int& x` -> `int* x`,
+//   uses `*x`) and its callers pass `&arg`. References to structs and library
+//   objects stay as they are, since Java shares the object, unless the function
+//   assigns the parameter as a whole.
+// - A variable whose address is taken is boxed as a one-element array
+//   (`int x[1] = {0}`) and its uses become `x[0]`, so writes through the
+//   pointer reach it.
+// - A struct or container parameter passed by value that the function may
+//   modify is flagged in `copiedParameters`, and the emitter copies it on entry.
+// Whatever would still bind to a copy, such as a struct field passed by
+// reference, a reference to a pointer or a returned reference to a scalar, is
+// a Translation Error instead of a silent change of meaning.
+class ReferenceLowering {
+public:
+    // Rewrites the program in place; returns the number of references and variables rewritten
+    static int run(const ASTNodePtr& program);
+
+private:
+    explicit ReferenceLowering(const std::shared_ptr<BlockNode>& program);
+
+    bool isObjectType(const std::string& type) const;
+    void lowerLocalReferences(ASTNodePtr& node);
+    bool lowerLocalReference(const std::shared_ptr<VariableDeclarationNode>& varDecl, std::vector<ASTNodePtr*> scope);
+    void collectModifiedObjects(const ASTNodePtr& node, std::unordered_set<std::string>& names) const;
+    void markCopiedParameters(const std::shared_ptr<FunctionDeclarationNode>& function) const;
+    void lowerParameters(const std::shared_ptr<FunctionDeclarationNode>& function);
+    void passAddresses(ASTNodePtr& node);
+    void collectAddressTaken(const ASTNodePtr& node, const std::shared_ptr<FunctionDeclarationNode>& function);
+    void box(const std::string& name, const std::shared_ptr<FunctionDeclarationNode>& function);
+
+    std::shared_ptr<BlockNode> program;
+    std::unordered_set<std::string> structs;
+    std::unordered_map<std::string, std::vector<std::shared_ptr<FunctionDeclarationNode>>> functions;  // By name
+    // Function -> its parameters that became pointers; callers pass their addresses
+    std::unordered_map<const FunctionDeclarationNode*, std::vector<bool>> pointerParameters;
+    std::unordered_set<std::string> passedObjects;  // Struct and library objects passed to such a parameter
+    std::vector<std::pair<std::string, std::shared_ptr<FunctionDeclarationNode>>> addressTaken;  // nullptr: global
+    int rewritten = 0;
+};
+
+#endif // REFERENCELOWERING_H
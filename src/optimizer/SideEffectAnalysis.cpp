@@ -0,0 +1,295 @@
+#include "SideEffectAnalysis.h"
+#include "ASTUtils.h"
+#include "../parser/TypeChecker.h"
+#include <vector>
+
+namespace {
+
+struct FunctionSummary {
+    bool directlyImpure = false;
+    std::unordered_set<std::string> callees;
+    std::unordered_set<std::string> reads;
+};
+
+void collectShared(const ASTNodePtr& node, std::unordered_set<std::string>& names) {
+    if (!node) return;
+    if (auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(node)) {
+        if (SideEffectAnalysis::isSynchronizationType(varDecl->type)) names.insert(ASTUtils::rootVariable(varDecl->identifier));
+    } else if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(node)) {
+        for (size_t i = 0; i < funcDecl->parameters.size() && i < funcDecl->parameterTypes.size(); ++i) {
+            if (SideEffectAnalysis::isSynchronizationType(funcDecl->parameterTypes[i])) {
+                names.insert(ASTUtils::rootVariable(funcDecl->parameters[i]));
+            }
+        }
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectShared(child, names); });
+}
+
+void summarize(const ASTNodePtr& node, const std::unordered_set<std::string>& locals,
+               const std::unordered_set<std::string>& shared, FunctionSummary& summary) {
+    if (!node) return;
+
+    auto writesNonLocal = [&](const ASTNodePtr& target) {
+        std::string root = ASTUtils::rootVariable(target);
+        return root.empty() || !locals.count(root) || ASTUtils::isMemoryAccess(target);
+    };
+
+    switch (node->type) {
+        case NodeType::IDENTIFIER: {
+            const std::string& name = std::static_pointer_cast<IdentifierNode>(node)->name;
+            if (SideEffectAnalysis::isStream(name) || shared.count(name)) summary.directlyImpure = true;
+            else if (!locals.count(name)) summary.reads.insert(name);
+            return;
+        }
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+            if (ASTUtils::isAssignmentOperator(binExpr->op) && writesNonLocal(binExpr->left)) {
+                summary.directlyImpure = true;
+            }
+            break;
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            if ((unaryExpr->op == "++" || unaryExpr->op == "--") && writesNonLocal(unaryExpr->operand)) {
+                summary.directlyImpure = true;
+            }
+            if (unaryExpr->op == "*") summary.reads.insert(SideEffectAnalysis::memoryLocation());
+            break;
+        }
+        case NodeType::ARRAY_ACCESS:
+            summary.reads.insert(SideEffectAnalysis::memoryLocation());
+            break;
+        case NodeType::FUNCTION_CALL: {
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
+            if (auto member = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName)) {
+                if (!SideEffectAnalysis::isConstMember(member->member) && writesNonLocal(member->object)) {
+                    summary.directlyImpure = true;
+                }
+                summarize(member->object, locals, shared, summary);
+            } else {
+                std::string callee = ASTUtils::calleeName(node);
+                if (!SideEffectAnalysis::isPureLibraryFunction(callee)) summary.callees.insert(callee);
+            }
+            for (const auto& arg : funcCall->arguments) summarize(arg, locals, shared, summary);
+            return;
+        }
+        default:
+            break;
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { summarize(child, locals, shared, summary); });
+}
+
+} // namespace
+
+SideEffectAnalysis::SideEffectAnalysis(const ASTNodePtr& program) {
+    std::unordered_map<std::string, FunctionSummary> summaries;
+
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return;
+    collectShared(program, sharedVariables);
+
+    for (const auto& stmt : block->statements) {
+        auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+        if (!funcDecl) continue;
+
+        std::unordered_set<std::string> locals;
+        for (const auto& param : funcDecl->parameters) locals.insert(ASTUtils::rootVariable(param));
+        ASTUtils::collectDeclarations(funcDecl->body, locals);
+
+        std::string name = ASTUtils::rootVariable(funcDecl->functionName);
+        summarize(funcDecl->body, locals, sharedVariables, summaries[name]);
+    }
+
+    // Optimistically assume every function is pure, then drop the ones that
+    // call something impure until nothing changes (handles recursion)
+    for (const auto& entry : summaries) {
+        if (!entry.second.directlyImpure) pureFunctions.insert(entry.first);
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto& entry : summaries) {
+            if (!pureFunctions.count(entry.first)) continue;
+            for (const auto& callee : entry.second.callees) {
+                if (!pureFunctions.count(callee)) {
+                    pureFunctions.erase(entry.first);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Reads of pure functions include the reads of everything they call
+    for (const auto& name : pureFunctions) {
+        for (const auto& read : summaries[name].reads) {
+            if (!summaries.count(read)) functionGlobalReads[name].insert(read);
+        }
+    }
+    changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto& name : pureFunctions) {
+            for (const auto& callee : summaries[name].callees) {
+                for (const auto& read : functionGlobalReads[callee]) {
+                    changed |= functionGlobalReads[name].insert(read).second;
+                }
+            }
+        }
+    }
+}
+
+bool SideEffectAnalysis::isPureLibraryFunction(const std::string& name) {
+    static const std::unordered_set<std::string> pureLibrary = {
+        "abs", "fabs", "sqrt", "cbrt", "pow", "exp", "log", "log2", "log10",
+        "sin", "cos", "tan", "asin", "acos", "atan", "atan2", "sinh", "cosh", "tanh",
+        "floor", "ceil", "round", "trunc", "hypot", "fmin", "fmax", "min", "max",
+        "labs", "llabs", "__builtin_popcount", "__builtin_popcountl", "__builtin_popcountll",
+        "__builtin_clz", "__builtin_clzl", "__builtin_clzll", "__builtin_ctz", "__builtin_ctzl",
+        "__builtin_ctzll", "__builtin_bswap32", "__builtin_bswap64"
+    };
+    std::string unqualified = name.rfind("std::", 0) == 0 ? name.substr(5) : name;
+    return pureLibrary.count(unqualified) > 0;
+}
+
+bool SideEffectAnalysis::isConstMember(const std::string& member) {
+    static const std::unordered_set<std::string> constMembers = {
+        "size", "length", "empty", "capacity", "front", "back", "at",
+        "find", "count", "contains", "substr", "compare", "c_str", "data",
+        "slots", "full", "keyAt", "valueAt"
+    };
+    return constMembers.count(member) > 0;
+}
+
+bool SideEffectAnalysis::isStream(const std::string& name) {
+    return name == "cout" || name == "cerr" || name == "cin" || name == "clog" ||
+           name == "std::cout" || name == "std::cerr" || name == "std::cin" || name == "std::clog";
+}
+
+bool SideEffectAnalysis::isSynchronizationType(const std::string& type) {
+    std::string normalized = TypeChecker::normalizeType(type);
+    std::string name = TypeChecker::templateName(normalized);
+    if (name.empty()) name = normalized.rfind("std::", 0) == 0 ? normalized.substr(5) : normalized;  // `std::lock_guard g(m)`
+    return name == "atomic" || name == "mutex" || name == "recursive_mutex" || name == "lock_guard" ||
+           name == "unique_lock" || name == "scoped_lock";
+}
+
+bool SideEffectAnalysis::isPureFunction(const std::string& name) const {
+    return pureFunctions.count(name) > 0 || isPureLibraryFunction(name);
+}
+
+const std::unordered_set<std::string>& SideEffectAnalysis::globalReads(const std::string& name) const {
+    static const std::unordered_set<std::string> none;
+    auto it = functionGlobalReads.find(name);
+    return it != functionGlobalReads.end() ? it->second : none;
+}
+
+bool SideEffectAnalysis::isPureCall(const ASTNodePtr& node) const {
+    auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
+    if (auto member = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName)) {
+        return isConstMember(member->member) && isPure(member->object);
+    }
+    return isPureFunction(ASTUtils::calleeName(node));
+}
+
+bool SideEffectAnalysis::isPure(const ASTNodePtr& expr) const {
+    if (!expr) return true;
+
+    switch (expr->type) {
+        case NodeType::NUMBER_LITERAL:
+        case NodeType::STRING_LITERAL:
+        case NodeType::CHAR_LITERAL:
+            return true;
+        case NodeType::IDENTIFIER: {
+            const std::string& name = std::static_pointer_cast<IdentifierNode>(expr)->name;
+            return !isStream(name) && !sharedVariables.count(name);
+        }
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(expr);
+            return !ASTUtils::isAssignmentOperator(binExpr->op) && isPure(binExpr->left) && isPure(binExpr->right);
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(expr);
+            return unaryExpr->op != "++" && unaryExpr->op != "--" && isPure(unaryExpr->operand);
+        }
+        case NodeType::MEMBER_ACCESS:
+            return isPure(std::static_pointer_cast<MemberAccessNode>(expr)->object);
+        case NodeType::ARRAY_ACCESS: {
+            auto arrayAccess = std::static_pointer_cast<ArrayAccessNode>(expr);
+            return isPure(arrayAccess->array) && isPure(arrayAccess->index);
+        }
+        case NodeType::FUNCTION_CALL: {
+            if (!isPureCall(expr)) return false;
+            for (const auto& arg : std::static_pointer_cast<FunctionCallNode>(expr)->arguments) {
+                if (!isPure(arg)) return false;
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool SideEffectAnalysis::containsImpureCall(const ASTNodePtr& node) const {
+    if (!node) return false;
+
+    if (node->type == NodeType::FUNCTION_CALL && !isPureCall(node)) return true;
+    if (node->type == NodeType::IDENTIFIER && (isStream(std::static_pointer_cast<IdentifierNode>(node)->name) ||
+                                               sharedVariables.count(std::static_pointer_cast<IdentifierNode>(node)->name))) {
+        return true;
+    }
+
+    bool found = false;
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) {
+        if (!found) found = containsImpureCall(child);
+    });
+    return found;
+}
+
+void SideEffectAnalysis::collectWrites(const ASTNodePtr& node, std::unordered_set<std::string>& written) const {
+    if (!node) return;
+
+    auto addRoot = [&](const ASTNodePtr& target) {
+        std::string root = ASTUtils::rootVariable(target);
+        if (!root.empty()) written.insert(root);
+        if (ASTUtils::isMemoryAccess(target)) written.insert(memoryLocation());
+    };
+
+    switch (node->type) {
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+            if (ASTUtils::isAssignmentOperator(binExpr->op)) addRoot(binExpr->left);
+            break;
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            if (unaryExpr->op == "++" || unaryExpr->op == "--") addRoot(unaryExpr->operand);
+            break;
+        }
+        case NodeType::FUNCTION_CALL: {
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
+            auto member = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName);
+            if (member && !isConstMember(member->member)) addRoot(member->object);
+            if (!isPureCall(node)) {
+                for (const auto& arg : funcCall->arguments) addRoot(arg);
+            }
+            break;
+        }
+        case NodeType::VARIABLE_DECLARATION:
+            addRoot(std::static_pointer_cast<VariableDeclarationNode>(node)->identifier);
+            break;
+        case NodeType::DELETE_STATEMENT:
+            // Freeing ends the pointee's lifetime: treat it as a store through the pointer
+            addRoot(std::static_pointer_cast<DeleteStatementNode>(node)->operand);
+            written.insert(memoryLocation());
+            break;
+        default:
+            break;
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { collectWrites(child, written); });
+}
+
+const std::string& SideEffectAnalysis::memoryLocation() {
+    static const std::string location = "*memory";
+    return location;
+}
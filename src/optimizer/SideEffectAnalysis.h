@@ -0,0 +1,53 @@
+#ifndef SIDEEFFECTANALYSIS_H
+#define SIDEEFFECTANALYSIS_H
+
+#include "../parser/ASTNode.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Whole-program purity information for the functions of a translation unit.
+// A function is pure when it writes no state outside its own locals, performs
+// no I/O and only calls pure functions. Library functions such as `sqrt` and
+// read-only members such as `size()` are pure by definition.
+class SideEffectAnalysis {
+public:
+    explicit SideEffectAnalysis(const ASTNodePtr& program);
+
+    bool isPureFunction(const std::string& name) const;
+
+    // Non-local variables a pure function reads, directly or through callees;
+    // memoryLocation() stands for anything read through a pointer or subscript
+    const std::unordered_set<std::string>& globalReads(const std::string& name) const;
+
+    // True when evaluating `expr` has no observable side effects
+    bool isPure(const ASTNodePtr& expr) const;
+
+    // True when the subtree calls a function that is not known to be pure
+    bool containsImpureCall(const ASTNodePtr& node) const;
+
+    // Collects every variable the subtree may write: assignment targets,
+    // ++/-- operands, objects of mutating member calls, locals it declares and
+    // arguments handed to impure calls (they may be taken by reference)
+    void collectWrites(const ASTNodePtr& node, std::unordered_set<std::string>& written) const;
+
+    static bool isPureLibraryFunction(const std::string& name);
+    static bool isConstMember(const std::string& member);
+    static bool isStream(const std::string& name);
+
+    // Atomics, mutexes and locks: other threads change them, so no read of one is invariant
+    static bool isSynchronizationType(const std::string& type);
+
+    // Pseudo-variable for array and pointee contents; it is "written" by any
+    // store through a subscript or `*`, since such stores may alias
+    static const std::string& memoryLocation();
+
+private:
+    bool isPureCall(const ASTNodePtr& node) const;
+
+    std::unordered_set<std::string> sharedVariables;  // Declared with a synchronization type
+    std::unordered_set<std::string> pureFunctions;
+    std::unordered_map<std::string, std::unordered_set<std::string>> functionGlobalReads;
+};
+
+#endif // SIDEEFFECTANALYSIS_H
@@ -0,0 +1,120 @@
+#include "StringBuilderAnalysis.h"
+#include "ASTUtils.h"
+#include "../parser/TypeChecker.h"
+#include <unordered_map>
+
+namespace {
+
+struct Usage {
+    int declarations = 0;
+    bool appended = false;
+    bool unsupported = false;  // Used in a way StringBuilder cannot express
+};
+
+using UsageMap = std::unordered_map<std::string, Usage>;
+
+bool isStringType(const std::string& type) {
+    return type.rfind("const ", 0) != 0 && TypeChecker::normalizeType(type) == "string";
+}
+
+// Name of the variable a member call like `s.append(x)` is made on, or ""
+std::string memberCallObject(const std::shared_ptr<FunctionCallNode>& call, std::string& member) {
+    auto access = std::dynamic_pointer_cast<MemberAccessNode>(call->functionName);
+    if (!access || access->arrow || access->object->type != NodeType::IDENTIFIER) return "";
+    member = access->member;
+    return std::static_pointer_cast<IdentifierNode>(access->object)->name;
+}
+
+void scan(const ASTNodePtr& node, bool statement, UsageMap& usages) {
+    if (!node) return;
+
+    switch (node->type) {
+        case NodeType::VARIABLE_DECLARATION: {
+            auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(node);
+            std::string name = ASTUtils::rootVariable(varDecl->identifier);
+            Usage& usage = usages[name];
+            usage.declarations++;
+            if (!isStringType(varDecl->type)) usage.unsupported = true;
+            scan(varDecl->initializer, false, usages);
+            return;
+        }
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+            if (ASTUtils::isAssignmentOperator(binExpr->op) && binExpr->left->type == NodeType::IDENTIFIER) {
+                Usage& usage = usages[std::static_pointer_cast<IdentifierNode>(binExpr->left)->name];
+                if (!statement || (binExpr->op != "=" && binExpr->op != "+=")) usage.unsupported = true;
+                if (binExpr->op == "+=") usage.appended = true;
+                scan(binExpr->right, false, usages);
+                return;
+            }
+            break;
+        }
+        case NodeType::FUNCTION_CALL: {
+            auto call = std::static_pointer_cast<FunctionCallNode>(node);
+            std::string member;
+            std::string object = memberCallObject(call, member);
+            if (!object.empty()) {
+                Usage& usage = usages[object];
+                bool appends = member == "push_back" || member == "append";
+                if (statement && StringBuilderAnalysis::isMutator(member) &&
+                    call->arguments.size() == (appends ? 1u : 0u)) {
+                    if (appends) usage.appended = true;
+                } else if (!StringBuilderAnalysis::isQuery(member)) {
+                    usage.unsupported = true;
+                }
+                for (const auto& arg : call->arguments) scan(arg, false, usages);
+                return;
+            }
+            break;
+        }
+        case NodeType::MEMBER_ACCESS:
+        case NodeType::ARRAY_ACCESS:
+        case NodeType::UNARY_EXPRESSION: {
+            // Fields, subscripts and ++/-- have no StringBuilder equivalent
+            std::string root = ASTUtils::rootVariable(node);
+            if (!root.empty()) usages[root].unsupported = true;
+            break;
+        }
+        case NodeType::BLOCK:
+            for (const auto& stmt : std::static_pointer_cast<BlockNode>(node)->statements) {
+                scan(stmt, true, usages);
+            }
+            return;
+        default:
+            break;
+    }
+
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) {
+        scan(child, child && child->type == NodeType::BLOCK, usages);
+    });
+}
+
+} // namespace
+
+std::unordered_set<std::string> StringBuilderAnalysis::builderVariables(
+    const std::shared_ptr<FunctionDeclarationNode>& function) {
+    std::unordered_set<std::string> builders;
+    if (!function || !function->body) return builders;
+
+    UsageMap usages;
+    for (const auto& param : function->parameters) {
+        usages[ASTUtils::rootVariable(param)].unsupported = true;  // Callers see a String
+    }
+    scan(function->body, true, usages);
+
+    for (const auto& entry : usages) {
+        const Usage& usage = entry.second;
+        if (usage.declarations == 1 && usage.appended && !usage.unsupported) {
+            builders.insert(entry.first);
+        }
+    }
+    return builders;
+}
+
+bool StringBuilderAnalysis::isMutator(const std::string& member) {
+    return member == "push_back" || member == "append" || member == "clear" || member == "pop_back";
+}
+
+bool StringBuilderAnalysis::isQuery(const std::string& member) {
+    return member == "size" || member == "length" || member == "empty";
+}
@@ -0,0 +1,21 @@
+#ifndef STRINGBUILDERANALYSIS_H
+#define STRINGBUILDERANALYSIS_H
+
+#include "../parser/ASTNode.h"
+#include <string>
+#include <unordered_set>
+
+// Finds the std::string locals of a function that are built up in place
+// (`s += x`, `s.push_back(c)`, `s.append(x)`). Java's immutable String would
+// copy the whole value on every append, so these are emitted as StringBuilder
+// and only converted with toString() where the value is read.
+class StringBuilderAnalysis {
+public:
+    static std::unordered_set<std::string> builderVariables(const std::shared_ptr<FunctionDeclarationNode>& function);
+
+    // Member calls with a direct StringBuilder equivalent
+    static bool isMutator(const std::string& member);  // push_back, append, clear, pop_back
+    static bool isQuery(const std::string& member);    // size, length, empty
+};
+
+#endif // STRINGBUILDERANALYSIS_H
@@ -0,0 +1,109 @@
+#include "StructOfArraysAnalysis.h"
+#include "ASTUtils.h"
+#include "../parser/TypeChecker.h"
+
+namespace {
+
+struct Usage {
+    int declarations = 0;
+    bool splittable = false;  // Declared with a size and no initializer
+    bool escapes = false;     // Used other than through `a[i].field` or `a.size()`
+};
+
+using UsageMap = std::unordered_map<std::string, Usage>;
+
+std::string identifierName(const ASTNodePtr& node) {
+    return node && node->type == NodeType::IDENTIFIER ? std::static_pointer_cast<IdentifierNode>(node)->name : "";
+}
+
+void scan(const ASTNodePtr& node, const StructOfArraysAnalysis::StructTable& structs, UsageMap& usages) {
+    if (!node) return;
+
+    switch (node->type) {
+        case NodeType::VARIABLE_DECLARATION: {
+            auto varDecl = std::static_pointer_cast<VariableDeclarationNode>(node);
+            Usage& usage = usages[ASTUtils::rootVariable(varDecl->identifier)];
+            usage.declarations++;
+
+            auto element = StructOfArraysAnalysis::elementStruct(varDecl->type, structs);
+            bool sized = (varDecl->arraySizes.size() == 1 && varDecl->arraySizes[0]) ||
+                         (varDecl->arraySizes.empty() && varDecl->constructorArguments.size() == 1);
+            usage.splittable = element && StructOfArraysAnalysis::isPlainData(element) && sized && !varDecl->initializer;
+
+            for (const auto& size : varDecl->arraySizes) scan(size, structs, usages);
+            for (const auto& arg : varDecl->constructorArguments) scan(arg, structs, usages);
+            scan(varDecl->initializer, structs, usages);
+            return;
+        }
+        case NodeType::MEMBER_ACCESS: {
+            // `a[i].field` reads or writes one field of one element
+            auto access = std::static_pointer_cast<MemberAccessNode>(node);
+            auto element = std::dynamic_pointer_cast<ArrayAccessNode>(access->object);
+            if (!access->arrow && element && !identifierName(element->array).empty()) {
+                scan(element->index, structs, usages);
+                return;
+            }
+            break;
+        }
+        case NodeType::FUNCTION_CALL: {
+            auto call = std::static_pointer_cast<FunctionCallNode>(node);
+            auto access = std::dynamic_pointer_cast<MemberAccessNode>(call->functionName);
+            if (access && access->member == "size" && call->arguments.empty() && !identifierName(access->object).empty()) {
+                return;
+            }
+            break;
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            // `&a[i].x` hands out a reference into an element
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            if (unaryExpr->op == "&") usages[ASTUtils::rootVariable(unaryExpr->operand)].escapes = true;
+            break;
+        }
+        case NodeType::IDENTIFIER:
+            usages[identifierName(node)].escapes = true;
+            return;
+        default:
+            break;
+    }
+    ASTUtils::forEachChild(node, [&](ASTNodePtr& child) { scan(child, structs, usages); });
+}
+
+} // namespace
+
+std::unordered_set<std::string> StructOfArraysAnalysis::splitArrays(const std::shared_ptr<FunctionDeclarationNode>& function,
+                                                                    const StructTable& structs) {
+    std::unordered_set<std::string> arrays;
+    if (!function || !function->body || structs.empty()) return arrays;
+
+    UsageMap usages;
+    for (const auto& param : function->parameters) usages[identifierName(param)].declarations++;
+    scan(function->body, structs, usages);
+
+    for (const auto& entry : usages) {
+        const Usage& usage = entry.second;
+        if (usage.declarations == 1 && usage.splittable && !usage.escapes) arrays.insert(entry.first);
+    }
+    return arrays;
+}
+
+std::shared_ptr<StructDeclarationNode> StructOfArraysAnalysis::elementStruct(const std::string& type,
+                                                                             const StructTable& structs) {
+    std::string normalized = TypeChecker::normalizeType(type);
+    std::string element;
+    if (normalized.size() > 2 && normalized.compare(normalized.size() - 2, 2, "[]") == 0) {
+        element = TypeChecker::elementType(normalized);
+    } else if (TypeChecker::templateName(normalized) == "vector") {
+        std::vector<std::string> arguments = TypeChecker::templateArguments(normalized);
+        if (arguments.size() == 1) element = arguments[0];
+    }
+    auto it = structs.find(element);
+    return it != structs.end() ? it->second : nullptr;
+}
+
+bool StructOfArraysAnalysis::isPlainData(const std::shared_ptr<StructDeclarationNode>& structDecl) {
+    for (const auto& field : structDecl->fields) {
+        auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(field);
+        if (!varDecl || !varDecl->arraySizes.empty() || !TypeChecker::isArithmeticType(varDecl->type)) return false;
+    }
+    return !structDecl->fields.empty();
+}
@@ -0,0 +1,28 @@
+#ifndef STRUCTOFARRAYSANALYSIS_H
+#define STRUCTOFARRAYSANALYSIS_H
+
+#include "../parser/ASTNode.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Finds the arrays of plain-data structs (`Point pts[N]`, `std::vector<Point> pts(n)`)
+// that a function only ever touches as `pts[i].field` or `pts.size()`. No reference
+// to an element escapes, so each field can live in its own primitive array
+// (`double[] pts$x, pts$y, pts$z`) instead of an array of separate heap objects.
+class StructOfArraysAnalysis {
+public:
+    using StructTable = std::unordered_map<std::string, std::shared_ptr<StructDeclarationNode>>;
+
+    static std::unordered_set<std::string> splitArrays(const std::shared_ptr<FunctionDeclarationNode>& function,
+                                                       const StructTable& structs);
+
+    // Element struct of a one-dimensional array or std::vector type; nullptr for anything else
+    static std::shared_ptr<StructDeclarationNode> elementStruct(const std::string& type, const StructTable& structs);
+
+    // Every field is a scalar of arithmetic type
+    static bool isPlainData(const std::shared_ptr<StructDeclarationNode>& structDecl);
+};
+
+#endif // STRUCTOFARRAYSANALYSIS_H
@@ -0,0 +1,187 @@
+#include "TailCallElimination.h"
+#include "ASTUtils.h"
+#include "CallGraph.h"
+#include "../utils/ErrorHandler.h"
+#include <set>
+#include <utility>
+
+namespace {
+
+const char* const kLoopLabel = "tailcall";
+
+bool isBareReturn(const ASTNodePtr& stmt) {
+    auto returnStmt = std::dynamic_pointer_cast<ReturnStatementNode>(stmt);
+    return returnStmt && !returnStmt->expression;
+}
+
+// Mirrors Java's "cannot complete normally" rule, so that no unreachable
+// statement is emitted after a rewritten tail call
+bool endsWithJump(const ASTNodePtr& stmt) {
+    if (!stmt) return false;
+
+    switch (stmt->type) {
+        case NodeType::RETURN_STATEMENT:
+        case NodeType::BREAK_STATEMENT:
+        case NodeType::CONTINUE_STATEMENT:
+            return true;
+        case NodeType::BLOCK: {
+            const auto& statements = std::static_pointer_cast<BlockNode>(stmt)->statements;
+            return !statements.empty() && endsWithJump(statements.back());
+        }
+        case NodeType::IF_STATEMENT: {
+            auto ifStmt = std::static_pointer_cast<IfStatementNode>(stmt);
+            return ifStmt->elseBlock && endsWithJump(ifStmt->thenBlock) && endsWithJump(ifStmt->elseBlock);
+        }
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+int TailCallElimination::run(const ASTNodePtr& program) {
+    auto block = std::dynamic_pointer_cast<BlockNode>(program);
+    if (!block) return 0;
+
+    CallGraph callGraph(program);
+    std::set<std::pair<std::string, std::string>> reported;
+    int converted = 0;
+
+    for (const auto& stmt : block->statements) {
+        auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(stmt);
+        if (!funcDecl || !funcDecl->body) continue;
+
+        FunctionContext context;
+        context.function = funcDecl;
+        context.name = ASTUtils::rootVariable(funcDecl->functionName);
+        rewriteStatement(funcDecl->body, true, context);
+
+        for (const auto& callee : context.otherTailCalls) {
+            if (!callGraph.reaches(callee, context.name)) continue;
+            auto pair = std::minmax(context.name, callee);
+            if (!reported.insert(pair).second) continue;
+            ErrorHandler::reportWarning("Functions '" + pair.first + "' and '" + pair.second +
+                                        "' are mutually recursive; their tail calls are not converted to a loop "
+                                        "and deep recursion may throw StackOverflowError.");
+        }
+
+        if (context.selfTailCalls == 0) continue;
+
+        // The original body becomes the loop body; void functions must leave
+        // the loop where they used to fall off the end
+        auto loopBody = std::static_pointer_cast<BlockNode>(funcDecl->body);
+        if (funcDecl->returnType == "void" && !endsWithJump(loopBody)) {
+            loopBody->statements.push_back(std::make_shared<ReturnStatementNode>(nullptr));
+        }
+        auto loop = std::make_shared<WhileLoopNode>(std::make_shared<IdentifierNode>("true"), loopBody);
+        loop->label = kLoopLabel;
+        funcDecl->body = std::make_shared<BlockNode>(std::vector<ASTNodePtr>{loop});
+        converted++;
+    }
+    return converted;
+}
+
+bool TailCallElimination::isSelfCall(const ASTNodePtr& expr, const FunctionContext& context) {
+    auto call = std::dynamic_pointer_cast<FunctionCallNode>(expr);
+    return call && ASTUtils::calleeName(call) == context.name &&
+           call->arguments.size() == context.function->parameters.size();
+}
+
+void TailCallElimination::rewriteStatement(ASTNodePtr& stmt, bool inTailPosition, FunctionContext& context) {
+    if (!stmt) return;
+
+    switch (stmt->type) {
+        case NodeType::RETURN_STATEMENT: {
+            auto returnStmt = std::static_pointer_cast<ReturnStatementNode>(stmt);
+            if (isSelfCall(returnStmt->expression, context)) {
+                stmt = makeParameterUpdate(std::static_pointer_cast<FunctionCallNode>(returnStmt->expression), context);
+                context.selfTailCalls++;
+            } else if (returnStmt->expression && returnStmt->expression->type == NodeType::FUNCTION_CALL) {
+                std::string callee = ASTUtils::calleeName(returnStmt->expression);
+                if (!callee.empty()) context.otherTailCalls.push_back(callee);
+            }
+            break;
+        }
+        case NodeType::FUNCTION_CALL:
+            // `f(x);` as the last thing a void function does
+            if (inTailPosition && context.function->returnType == "void") {
+                if (isSelfCall(stmt, context)) {
+                    stmt = makeParameterUpdate(std::static_pointer_cast<FunctionCallNode>(stmt), context);
+                    context.selfTailCalls++;
+                } else if (!ASTUtils::calleeName(stmt).empty()) {
+                    context.otherTailCalls.push_back(ASTUtils::calleeName(stmt));
+                }
+            }
+            break;
+        case NodeType::IF_STATEMENT: {
+            auto ifStmt = std::static_pointer_cast<IfStatementNode>(stmt);
+            rewriteStatement(ifStmt->thenBlock, inTailPosition, context);
+            rewriteStatement(ifStmt->elseBlock, inTailPosition, context);
+            break;
+        }
+        case NodeType::WHILE_LOOP:
+            // Only `return f(...)` is a tail call inside a loop body
+            rewriteStatement(std::static_pointer_cast<WhileLoopNode>(stmt)->body, false, context);
+            break;
+        case NodeType::FOR_LOOP:
+            rewriteStatement(std::static_pointer_cast<ForLoopNode>(stmt)->body, false, context);
+            break;
+        case NodeType::SWITCH_STATEMENT:
+            // A clause may fall through into the next one, so none of them ends the function
+            for (auto& clause : std::static_pointer_cast<SwitchStatementNode>(stmt)->cases) {
+                rewriteStatement(std::static_pointer_cast<CaseClauseNode>(clause)->body, false, context);
+            }
+            break;
+        case NodeType::BLOCK: {
+            auto& statements = std::static_pointer_cast<BlockNode>(stmt)->statements;
+            for (size_t i = 0; i < statements.size(); ++i) {
+                bool last = i + 1 == statements.size();
+                bool tail = (inTailPosition && last) || (!last && isBareReturn(statements[i + 1]));
+                rewriteStatement(statements[i], tail, context);
+                if (!last && isBareReturn(statements[i + 1]) && endsWithJump(statements[i])) {
+                    statements.erase(statements.begin() + i + 1);  // Now unreachable
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Evaluates every new argument before any parameter is overwritten, then
+// restarts the loop: `{ int a$next = b; int b$next = a % b; a = a$next; b = b$next; continue tailcall; }`
+ASTNodePtr TailCallElimination::makeParameterUpdate(const std::shared_ptr<FunctionCallNode>& call,
+                                                    const FunctionContext& context) {
+    const auto& parameters = context.function->parameters;
+    const auto& parameterTypes = context.function->parameterTypes;
+
+    std::vector<size_t> changed;
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        if (ASTUtils::rootVariable(parameters[i]) != ASTUtils::rootVariable(call->arguments[i]) ||
+            call->arguments[i]->type != NodeType::IDENTIFIER) {
+            changed.push_back(i);
+        }
+    }
+
+    std::vector<ASTNodePtr> statements;
+    if (changed.size() == 1) {
+        size_t i = changed.front();
+        statements.push_back(std::make_shared<BinaryExpressionNode>(
+            std::make_shared<IdentifierNode>(ASTUtils::rootVariable(parameters[i])), "=", call->arguments[i]));
+    } else {
+        for (size_t i : changed) {
+            std::string next = ASTUtils::rootVariable(parameters[i]) + "$next";
+            std::string type = i < parameterTypes.size() ? parameterTypes[i] : "auto";
+            statements.push_back(std::make_shared<VariableDeclarationNode>(
+                type, std::make_shared<IdentifierNode>(next), call->arguments[i]));
+        }
+        for (size_t i : changed) {
+            std::string param = ASTUtils::rootVariable(parameters[i]);
+            statements.push_back(std::make_shared<BinaryExpressionNode>(
+                std::make_shared<IdentifierNode>(param), "=", std::make_shared<IdentifierNode>(param + "$next")));
+        }
+    }
+    statements.push_back(std::make_shared<ContinueStatementNode>(kLoopLabel));
+    return std::make_shared<BlockNode>(statements);
+}
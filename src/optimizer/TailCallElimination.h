@@ -0,0 +1,31 @@
+#ifndef TAILCALLELIMINATION_H
+#define TAILCALLELIMINATION_H
+
+#include "../parser/ASTNode.h"
+#include <string>
+#include <vector>
+
+// The JVM does not eliminate tail calls, so a function that returns a call
+// to itself is rewritten into a `tailcall: while (true)` loop: the tail call
+// assigns the new argument values to the parameters and continues the loop.
+// Tail calls between mutually recursive functions cannot be converted and
+// are reported as warnings.
+class TailCallElimination {
+public:
+    // Rewrites the program in place; returns the number of converted functions
+    static int run(const ASTNodePtr& program);
+
+private:
+    struct FunctionContext {
+        std::shared_ptr<FunctionDeclarationNode> function;
+        std::string name;
+        int selfTailCalls = 0;
+        std::vector<std::string> otherTailCalls;  // Callees of tail calls to other functions
+    };
+
+    static void rewriteStatement(ASTNodePtr& stmt, bool inTailPosition, FunctionContext& context);
+    static ASTNodePtr makeParameterUpdate(const std::shared_ptr<FunctionCallNode>& call, const FunctionContext& context);
+    static bool isSelfCall(const ASTNodePtr& expr, const FunctionContext& context);
+};
+
+#endif // TAILCALLELIMINATION_H
@@ -11,14 +11,28 @@ std::string ASTNode::nodeTypeToString(NodeType type) {
         case NodeType::FUNCTION_DECLARATION: return "FUNCTION_DECLARATION";
         case NodeType::VARIABLE_DECLARATION: return "VARIABLE_DECLARATION";
         case NodeType::BINARY_EXPRESSION: return "BINARY_EXPRESSION";
+        case NodeType::UNARY_EXPRESSION: return "UNARY_EXPRESSION";
+        case NodeType::MEMBER_ACCESS: return "MEMBER_ACCESS";
+        case NodeType::ARRAY_ACCESS: return "ARRAY_ACCESS";
+        case NodeType::INITIALIZER_LIST: return "INITIALIZER_LIST";
         case NodeType::IDENTIFIER: return "IDENTIFIER";
         case NodeType::NUMBER_LITERAL: return "NUMBER_LITERAL";
         case NodeType::STRING_LITERAL: return "STRING_LITERAL";
+        case NodeType::CHAR_LITERAL: return "CHAR_LITERAL";
         case NodeType::RETURN_STATEMENT: return "RETURN_STATEMENT";
         case NodeType::FUNCTION_CALL: return "FUNCTION_CALL";
         case NodeType::IF_STATEMENT: return "IF_STATEMENT";
         case NodeType::WHILE_LOOP: return "WHILE_LOOP";
+        case NodeType::FOR_LOOP: return "FOR_LOOP";
+        case NodeType::BREAK_STATEMENT: return "BREAK_STATEMENT";
+        case NodeType::CONTINUE_STATEMENT: return "CONTINUE_STATEMENT";
         case NodeType::BLOCK: return "BLOCK";
+        case NodeType::STRUCT_DECLARATION: return "STRUCT_DECLARATION";
+        case NodeType::SWITCH_STATEMENT: return "SWITCH_STATEMENT";
+        case NodeType::CASE_CLAUSE: return "CASE_CLAUSE";
+        case NodeType::ENUM_DECLARATION: return "ENUM_DECLARATION";
+        case NodeType::NEW_EXPRESSION: return "NEW_EXPRESSION";
+        case NodeType::DELETE_STATEMENT: return "DELETE_STATEMENT";
         default: return "UNKNOWN";
     }
 }
@@ -36,8 +50,8 @@ std::string IdentifierNode::toString() const {
 // ---------------------------------
 // NumberNode Implementation
 // ---------------------------------
-NumberNode::NumberNode(double value)
-    : ASTNode(NodeType::NUMBER_LITERAL), value(value) {}
+NumberNode::NumberNode(double value, const std::string& text)
+    : ASTNode(NodeType::NUMBER_LITERAL), value(value), text(text) {}
 
 std::string NumberNode::toString() const {
     return "Number(" + std::to_string(value) + ")";
@@ -53,6 +67,16 @@ std::string StringNode::toString() const {
     return "String(\"" + value + "\")";
 }
 
+// ---------------------------------
+// CharNode Implementation
+// ---------------------------------
+CharNode::CharNode(const std::string& value)
+    : ASTNode(NodeType::CHAR_LITERAL), value(value) {}
+
+std::string CharNode::toString() const {
+    return "Char('" + value + "')";
+}
+
 // ---------------------------------
 // BinaryExpressionNode Implementation
 // ---------------------------------
@@ -63,6 +87,27 @@ std::string BinaryExpressionNode::toString() const {
     return "BinaryExpression(" + left->toString() + " " + op + " " + right->toString() + ")";
 }
 
+// ---------------------------------
+// UnaryExpressionNode Implementation
+// ---------------------------------
+UnaryExpressionNode::UnaryExpressionNode(const std::string& op, std::shared_ptr<ASTNode> operand, bool prefix)
+    : ASTNode(NodeType::UNARY_EXPRESSION), op(op), operand(std::move(operand)), prefix(prefix) {}
+
+std::string UnaryExpressionNode::toString() const {
+    return prefix ? "UnaryExpression(" + op + operand->toString() + ")"
+                  : "UnaryExpression(" + operand->toString() + op + ")";
+}
+
+// ---------------------------------
+// MemberAccessNode Implementation
+// ---------------------------------
+MemberAccessNode::MemberAccessNode(std::shared_ptr<ASTNode> object, const std::string& member, bool arrow)
+    : ASTNode(NodeType::MEMBER_ACCESS), object(std::move(object)), member(member), arrow(arrow) {}
+
+std::string MemberAccessNode::toString() const {
+    return "MemberAccess(" + object->toString() + (arrow ? "->" : ".") + member + ")";
+}
+
 // ---------------------------------
 // FunctionCallNode Implementation
 // ---------------------------------
@@ -80,6 +125,31 @@ std::string FunctionCallNode::toString() const {
     return result;
 }
 
+// ---------------------------------
+// ArrayAccessNode Implementation
+// ---------------------------------
+ArrayAccessNode::ArrayAccessNode(std::shared_ptr<ASTNode> array, std::shared_ptr<ASTNode> index)
+    : ASTNode(NodeType::ARRAY_ACCESS), array(std::move(array)), index(std::move(index)) {}
+
+std::string ArrayAccessNode::toString() const {
+    return "ArrayAccess(" + array->toString() + "[" + index->toString() + "])";
+}
+
+// ---------------------------------
+// InitializerListNode Implementation
+// ---------------------------------
+InitializerListNode::InitializerListNode(std::vector<std::shared_ptr<ASTNode>> elements)
+    : ASTNode(NodeType::INITIALIZER_LIST), elements(std::move(elements)) {}
+
+std::string InitializerListNode::toString() const {
+    std::string result = "InitializerList(";
+    for (size_t i = 0; i < elements.size(); ++i) {
+        result += elements[i]->toString();
+        if (i < elements.size() - 1) result += ", ";
+    }
+    return result + ")";
+}
+
 // ---------------------------------
 // VariableDeclarationNode Implementation
 // ---------------------------------
@@ -135,7 +205,47 @@ WhileLoopNode::WhileLoopNode(std::shared_ptr<ASTNode> condition, std::shared_ptr
     : ASTNode(NodeType::WHILE_LOOP), condition(std::move(condition)), body(std::move(body)) {}
 
 std::string WhileLoopNode::toString() const {
-    return "While(" + condition->toString() + " " + body->toString() + ")";
+    return "While(" + (label.empty() ? "" : label + ": ") + condition->toString() + " " + body->toString() + ")";
+}
+
+// ---------------------------------
+// ForLoopNode Implementation
+// ---------------------------------
+ForLoopNode::ForLoopNode(std::vector<std::shared_ptr<ASTNode>> initializers, std::shared_ptr<ASTNode> condition,
+                         std::vector<std::shared_ptr<ASTNode>> increments, std::shared_ptr<ASTNode> body)
+    : ASTNode(NodeType::FOR_LOOP), initializers(std::move(initializers)), condition(std::move(condition)),
+      increments(std::move(increments)), body(std::move(body)) {}
+
+std::string ForLoopNode::toString() const {
+    auto join = [](const std::vector<std::shared_ptr<ASTNode>>& nodes) {
+        std::string text;
+        for (const auto& node : nodes) text += (text.empty() ? "" : ", ") + node->toString();
+        return text;
+    };
+    std::string prefix = std::string(parallel ? "ParallelFor(" : "For(") + (label.empty() ? "" : label + ": ");
+    if (range) return prefix + join(initializers) + " : " + range->toString() + " " + body->toString() + ")";
+    return prefix + join(initializers) + "; " + (condition ? condition->toString() : "") + "; " + join(increments) + " " +
+           body->toString() + ")";
+}
+
+// ---------------------------------
+// BreakStatementNode Implementation
+// ---------------------------------
+BreakStatementNode::BreakStatementNode(const std::string& label)
+    : ASTNode(NodeType::BREAK_STATEMENT), label(label) {}
+
+std::string BreakStatementNode::toString() const {
+    return "Break(" + label + ")";
+}
+
+// ---------------------------------
+// ContinueStatementNode Implementation
+// ---------------------------------
+ContinueStatementNode::ContinueStatementNode(const std::string& label)
+    : ASTNode(NodeType::CONTINUE_STATEMENT), label(label) {}
+
+std::string ContinueStatementNode::toString() const {
+    return "Continue(" + label + ")";
 }
 
 // ---------------------------------
@@ -154,3 +264,84 @@ std::string BlockNode::toString() const {
     result += " })";
     return result;
 }
+
+// ---------------------------------
+// StructDeclarationNode Implementation
+// ---------------------------------
+StructDeclarationNode::StructDeclarationNode(const std::string& name, std::vector<std::shared_ptr<ASTNode>> fields)
+    : ASTNode(NodeType::STRUCT_DECLARATION), name(name), fields(std::move(fields)) {}
+
+std::string StructDeclarationNode::toString() const {
+    std::string result = "Struct(" + name + " { ";
+    for (size_t i = 0; i < fields.size(); ++i) {
+        result += fields[i]->toString();
+        if (i < fields.size() - 1) result += "; ";
+    }
+    return result + " })";
+}
+
+// ---------------------------------
+// SwitchStatementNode Implementation
+// ---------------------------------
+SwitchStatementNode::SwitchStatementNode(std::shared_ptr<ASTNode> expression, std::vector<std::shared_ptr<ASTNode>> cases)
+    : ASTNode(NodeType::SWITCH_STATEMENT), expression(std::move(expression)), cases(std::move(cases)) {}
+
+std::string SwitchStatementNode::toString() const {
+    std::string result = "Switch(" + expression->toString() + " {";
+    for (const auto& clause : cases) result += " " + clause->toString();
+    return result + " })";
+}
+
+// ---------------------------------
+// CaseClauseNode Implementation
+// ---------------------------------
+CaseClauseNode::CaseClauseNode(std::shared_ptr<ASTNode> value, std::shared_ptr<ASTNode> body)
+    : ASTNode(NodeType::CASE_CLAUSE), value(std::move(value)), body(std::move(body)) {}
+
+std::string CaseClauseNode::toString() const {
+    return (value ? "Case(" + value->toString() : "Default(") + ": " + body->toString() + ")";
+}
+
+// ---------------------------------
+// EnumDeclarationNode Implementation
+// ---------------------------------
+EnumDeclarationNode::EnumDeclarationNode(const std::string& name, bool scoped, const std::string& underlyingType,
+                                         std::vector<std::string> enumerators, std::vector<std::shared_ptr<ASTNode>> values)
+    : ASTNode(NodeType::ENUM_DECLARATION), name(name), scoped(scoped), underlyingType(underlyingType),
+      enumerators(std::move(enumerators)), values(std::move(values)) {}
+
+std::string EnumDeclarationNode::toString() const {
+    std::string result = std::string(scoped ? "EnumClass(" : "Enum(") + name + " : " + underlyingType + " { ";
+    for (size_t i = 0; i < enumerators.size(); ++i) {
+        result += enumerators[i] + (values[i] ? " = " + values[i]->toString() : "");
+        if (i < enumerators.size() - 1) result += ", ";
+    }
+    return result + " })";
+}
+
+// ---------------------------------
+// NewExpressionNode Implementation
+// ---------------------------------
+NewExpressionNode::NewExpressionNode(const std::string& typeName, std::vector<std::shared_ptr<ASTNode>> arguments,
+                                     std::shared_ptr<ASTNode> arraySize, bool valueInitialized)
+    : ASTNode(NodeType::NEW_EXPRESSION), typeName(typeName), arguments(std::move(arguments)),
+      arraySize(std::move(arraySize)), valueInitialized(valueInitialized) {}
+
+std::string NewExpressionNode::toString() const {
+    if (arraySize) return "New(" + typeName + "[" + arraySize->toString() + "]" + (valueInitialized ? "()" : "") + ")";
+    std::string args;
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        args += (i ? ", " : "") + arguments[i]->toString();
+    }
+    return "New(" + typeName + "(" + args + "))";
+}
+
+// ---------------------------------
+// DeleteStatementNode Implementation
+// ---------------------------------
+DeleteStatementNode::DeleteStatementNode(std::shared_ptr<ASTNode> operand, bool array)
+    : ASTNode(NodeType::DELETE_STATEMENT), operand(std::move(operand)), array(array) {}
+
+std::string DeleteStatementNode::toString() const {
+    return std::string(array ? "Delete[](" : "Delete(") + operand->toString() + ")";
+}
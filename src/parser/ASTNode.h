@@ -4,6 +4,7 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <utility>
 
 // Enum for node types
 enum class NodeType {
@@ -11,14 +12,28 @@ enum class NodeType {
     FUNCTION_DECLARATION,
     VARIABLE_DECLARATION,
     BINARY_EXPRESSION,  // Ensure this is defined
+    UNARY_EXPRESSION,
+    MEMBER_ACCESS,
+    ARRAY_ACCESS,
+    INITIALIZER_LIST,
     IDENTIFIER,
     NUMBER_LITERAL,  // Ensure this is defined
     STRING_LITERAL,
+    CHAR_LITERAL,
     RETURN_STATEMENT,
     FUNCTION_CALL,
     IF_STATEMENT,
     WHILE_LOOP,
-    BLOCK
+    FOR_LOOP,
+    BREAK_STATEMENT,
+    CONTINUE_STATEMENT,
+    BLOCK,
+    STRUCT_DECLARATION,
+    SWITCH_STATEMENT,
+    CASE_CLAUSE,
+    ENUM_DECLARATION,
+    NEW_EXPRESSION,
+    DELETE_STATEMENT
 };
 
 // Abstract base class for all AST nodes
@@ -46,7 +61,8 @@ public:
 class NumberNode : public ASTNode {
 public:
     double value;
-    explicit NumberNode(double value);
+    std::string text;  // Literal as written in the source, if known
+    explicit NumberNode(double value, const std::string& text = "");
 
     std::string toString() const override;
 };
@@ -60,6 +76,15 @@ public:
     std::string toString() const override;
 };
 
+// Node for character literals; `value` holds the decoded bytes
+class CharNode : public ASTNode {
+public:
+    std::string value;
+    explicit CharNode(const std::string& value);
+
+    std::string toString() const override;
+};
+
 // Node for binary expressions (e.g., a + b)
 class BinaryExpressionNode : public ASTNode {
 public:
@@ -71,6 +96,47 @@ public:
     std::string toString() const override;
 };
 
+// Node for unary expressions (e.g., -a, !done, ++i, i++)
+class UnaryExpressionNode : public ASTNode {
+public:
+    std::string op;
+    std::shared_ptr<ASTNode> operand;
+    bool prefix;
+
+    UnaryExpressionNode(const std::string& op, std::shared_ptr<ASTNode> operand, bool prefix);
+    std::string toString() const override;
+};
+
+// Node for member access (e.g., v.size, p->x)
+class MemberAccessNode : public ASTNode {
+public:
+    std::shared_ptr<ASTNode> object;
+    std::string member;
+    bool arrow;
+
+    MemberAccessNode(std::shared_ptr<ASTNode> object, const std::string& member, bool arrow);
+    std::string toString() const override;
+};
+
+// Node for subscripts (e.g., buf[i], p[k])
+class ArrayAccessNode : public ASTNode {
+public:
+    std::shared_ptr<ASTNode> array;
+    std::shared_ptr<ASTNode> index;
+
+    ArrayAccessNode(std::shared_ptr<ASTNode> array, std::shared_ptr<ASTNode> index);
+    std::string toString() const override;
+};
+
+// Node for brace initializers (e.g., {1, 2, 3})
+class InitializerListNode : public ASTNode {
+public:
+    std::vector<std::shared_ptr<ASTNode>> elements;
+
+    explicit InitializerListNode(std::vector<std::shared_ptr<ASTNode>> elements);
+    std::string toString() const override;
+};
+
 // Node for function calls (e.g., foo(1, "test"))
 class FunctionCallNode : public ASTNode {
 public:
@@ -87,6 +153,11 @@ public:
     std::string type;
     std::shared_ptr<ASTNode> identifier;
     std::shared_ptr<ASTNode> initializer;
+    std::vector<std::shared_ptr<ASTNode>> arraySizes;  // One per `[]` in `type`; null when left to the initializer
+    std::vector<std::shared_ptr<ASTNode>> constructorArguments;  // `T x(a, b);`
+    std::string reusedLocal;  // Set by AllocationPooling: function-level container this one is cleared into
+    bool internalLinkage = false;  // Declared `static` at file scope
+    bool reference = false;  // `T& name = x`; ReferenceLowering aliases or points it at its initializer
 
     VariableDeclarationNode(const std::string& type, std::shared_ptr<ASTNode> identifier, std::shared_ptr<ASTNode> initializer);
     std::string toString() const override;
@@ -98,7 +169,16 @@ public:
     std::string returnType;
     std::shared_ptr<ASTNode> functionName;
     std::vector<std::shared_ptr<ASTNode>> parameters;
+    std::vector<std::string> parameterTypes;
     std::shared_ptr<ASTNode> body;
+    std::string splitFrom;  // Set by MethodSplitting: the function this private helper continues
+    bool internalLinkage = false;  // Declared `static` at file scope
+    std::vector<std::string> templateParameters;  // `template <typename T, int N>`; instantiated by Monomorphization
+    bool benchmark = false;  // Marked `// @benchmark` or `[[benchmark]]`: gets a harness under --emit-benchmarks
+    bool cold = false;  // Outside the hot set of a --profile: skips the optimization passes (see HotnessProfile)
+    std::vector<bool> referenceParameters;  // Non-const `T&` parameters, one flag per parameter (see ReferenceLowering)
+    bool returnsReference = false;  // Declared `T& f(...)`
+    std::vector<bool> copiedParameters;  // By-value object parameters the body may modify; copied on entry (see ReferenceLowering)
 
     FunctionDeclarationNode(const std::string& returnType, std::shared_ptr<ASTNode> functionName,
                             std::vector<std::shared_ptr<ASTNode>> parameters, std::shared_ptr<ASTNode> body);
@@ -130,11 +210,49 @@ class WhileLoopNode : public ASTNode {
 public:
     std::shared_ptr<ASTNode> condition;
     std::shared_ptr<ASTNode> body;
+    std::string label;  // Target of labeled break/continue, empty if none
 
     WhileLoopNode(std::shared_ptr<ASTNode> condition, std::shared_ptr<ASTNode> body);
     std::string toString() const override;
 };
 
+// Node for C-style for loops; every header clause may be empty
+class ForLoopNode : public ASTNode {
+public:
+    std::vector<std::shared_ptr<ASTNode>> initializers;  // Declarations or expressions, in order
+    std::shared_ptr<ASTNode> condition;                  // nullptr loops until a jump
+    std::vector<std::shared_ptr<ASTNode>> increments;
+    std::shared_ptr<ASTNode> body;
+    std::string label;  // Target of labeled break/continue, empty if none
+    bool parallel = false;  // Preceded by `#pragma omp parallel for`
+    std::vector<std::pair<std::string, std::string>> reductions;  // `reduction(op: var)` clauses as (op, var)
+    // `for (decl : range)`, with the element declaration as the only initializer (see RangeForLowering)
+    std::shared_ptr<ASTNode> range;
+    std::vector<std::string> bindings;  // Names of a structured binding element, `auto& [key, value]`
+
+    ForLoopNode(std::vector<std::shared_ptr<ASTNode>> initializers, std::shared_ptr<ASTNode> condition,
+                std::vector<std::shared_ptr<ASTNode>> increments, std::shared_ptr<ASTNode> body);
+    std::string toString() const override;
+};
+
+// Node for break statements
+class BreakStatementNode : public ASTNode {
+public:
+    std::string label;
+
+    explicit BreakStatementNode(const std::string& label = "");
+    std::string toString() const override;
+};
+
+// Node for continue statements
+class ContinueStatementNode : public ASTNode {
+public:
+    std::string label;
+
+    explicit ContinueStatementNode(const std::string& label = "");
+    std::string toString() const override;
+};
+
 // Node for block statements { ... }
 class BlockNode : public ASTNode {
 public:
@@ -144,6 +262,77 @@ public:
     std::string toString() const override;
 };
 
+// Node for struct/class definitions with data members only
+class StructDeclarationNode : public ASTNode {
+public:
+    std::string name;
+    std::vector<std::shared_ptr<ASTNode>> fields;  // VariableDeclarationNodes
+    std::vector<std::string> templateParameters;  // `template <typename T, int N>`; instantiated by Monomorphization
+
+    StructDeclarationNode(const std::string& name, std::vector<std::shared_ptr<ASTNode>> fields);
+    std::string toString() const override;
+};
+
+// Node for switch statements; fallthrough runs on into the next clause as in C++
+class SwitchStatementNode : public ASTNode {
+public:
+    std::shared_ptr<ASTNode> expression;
+    std::vector<std::shared_ptr<ASTNode>> cases;  // CaseClauseNodes, in source order
+
+    SwitchStatementNode(std::shared_ptr<ASTNode> expression, std::vector<std::shared_ptr<ASTNode>> cases);
+    std::string toString() const override;
+};
+
+// One `case` or `default` label and the statements up to the next label
+class CaseClauseNode : public ASTNode {
+public:
+    std::shared_ptr<ASTNode> value;  // nullptr for `default`
+    std::shared_ptr<ASTNode> body;   // BlockNode; it does not open a scope of its own
+
+    CaseClauseNode(std::shared_ptr<ASTNode> value, std::shared_ptr<ASTNode> body);
+    std::string toString() const override;
+};
+
+// Node for `enum` and `enum class` declarations
+class EnumDeclarationNode : public ASTNode {
+public:
+    std::string name;  // Empty for an anonymous enum
+    bool scoped;       // `enum class`: enumerators are only reachable as `Name::A`
+    std::string underlyingType;
+    std::vector<std::string> enumerators;
+    std::vector<std::shared_ptr<ASTNode>> values;  // Explicit value per enumerator, nullptr if implicit
+
+    EnumDeclarationNode(const std::string& name, bool scoped, const std::string& underlyingType,
+                        std::vector<std::string> enumerators, std::vector<std::shared_ptr<ASTNode>> values);
+    std::string toString() const override;
+};
+
+// Node for `new T`, `new T(args)` and `new T[n]`; its value is a `T*`
+class NewExpressionNode : public ASTNode {
+public:
+    std::string typeName;
+    std::vector<std::shared_ptr<ASTNode>> arguments;  // Constructor arguments
+    std::shared_ptr<ASTNode> arraySize;              // nullptr unless `new T[n]`
+    bool valueInitialized;                            // `new T()`, `new T[n]()`: zero-filled
+    std::string reusedLocal;  // Set by AllocationPooling: function-level buffer reused across iterations
+    bool freeList = false;    // Set by AllocationPooling: taken from the per-thread free list
+
+    NewExpressionNode(const std::string& typeName, std::vector<std::shared_ptr<ASTNode>> arguments,
+                      std::shared_ptr<ASTNode> arraySize, bool valueInitialized);
+    std::string toString() const override;
+};
+
+// Node for `delete p` and `delete[] p`
+class DeleteStatementNode : public ASTNode {
+public:
+    std::shared_ptr<ASTNode> operand;
+    bool array;
+    bool pooled = false;  // Set by AllocationPooling: the buffer goes back to its pool
+
+    DeleteStatementNode(std::shared_ptr<ASTNode> operand, bool array);
+    std::string toString() const override;
+};
+
 using ASTNodePtr = std::shared_ptr<ASTNode>;
 
 #endif // ASTNODE_H
@@ -27,6 +27,32 @@ void ASTPrinter::print(const std::shared_ptr<ASTNode>& node, int indent) {
             print(binaryExpr->right, indent + 4);
             break;
         }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            printIndent(indent + 2);
+            std::cout << "Operator: " << unaryExpr->op << (unaryExpr->prefix ? " (prefix)" : " (postfix)") << std::endl;
+            print(unaryExpr->operand, indent + 4);
+            break;
+        }
+        case NodeType::MEMBER_ACCESS: {
+            auto memberAccess = std::static_pointer_cast<MemberAccessNode>(node);
+            print(memberAccess->object, indent + 4);
+            printIndent(indent + 2);
+            std::cout << "Member: " << memberAccess->member << std::endl;
+            break;
+        }
+        case NodeType::ARRAY_ACCESS: {
+            auto arrayAccess = std::static_pointer_cast<ArrayAccessNode>(node);
+            print(arrayAccess->array, indent + 4);
+            print(arrayAccess->index, indent + 8);
+            break;
+        }
+        case NodeType::INITIALIZER_LIST: {
+            for (const auto& element : std::static_pointer_cast<InitializerListNode>(node)->elements) {
+                print(element, indent + 4);
+            }
+            break;
+        }
         case NodeType::FUNCTION_CALL: {
             auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
             print(funcCall->functionName, indent + 4);
@@ -40,6 +66,9 @@ void ASTPrinter::print(const std::shared_ptr<ASTNode>& node, int indent) {
             printIndent(indent + 4);
             std::cout << "Type: " << varDecl->type << std::endl;
             print(varDecl->identifier, indent + 4);
+            for (const auto& arg : varDecl->constructorArguments) {
+                print(arg, indent + 8);
+            }
             if (varDecl->initializer) {
                 print(varDecl->initializer, indent + 4);
             }
@@ -76,6 +105,61 @@ void ASTPrinter::print(const std::shared_ptr<ASTNode>& node, int indent) {
             print(whileLoop->body, indent + 4);
             break;
         }
+        case NodeType::FOR_LOOP: {
+            auto forLoop = std::static_pointer_cast<ForLoopNode>(node);
+            for (const auto& init : forLoop->initializers) print(init, indent + 4);
+            if (forLoop->range) print(forLoop->range, indent + 4);
+            if (forLoop->condition) print(forLoop->condition, indent + 4);
+            for (const auto& increment : forLoop->increments) print(increment, indent + 4);
+            print(forLoop->body, indent + 4);
+            break;
+        }
+        case NodeType::BREAK_STATEMENT:
+        case NodeType::CONTINUE_STATEMENT:
+            break;
+        case NodeType::STRUCT_DECLARATION: {
+            auto structDecl = std::static_pointer_cast<StructDeclarationNode>(node);
+            printIndent(indent + 4);
+            std::cout << "Name: " << structDecl->name << std::endl;
+            for (const auto& field : structDecl->fields) {
+                print(field, indent + 8);
+            }
+            break;
+        }
+        case NodeType::SWITCH_STATEMENT: {
+            auto switchStmt = std::static_pointer_cast<SwitchStatementNode>(node);
+            print(switchStmt->expression, indent + 4);
+            for (const auto& clause : switchStmt->cases) print(clause, indent + 4);
+            break;
+        }
+        case NodeType::CASE_CLAUSE: {
+            auto clause = std::static_pointer_cast<CaseClauseNode>(node);
+            if (clause->value) print(clause->value, indent + 4);
+            print(clause->body, indent + 4);
+            break;
+        }
+        case NodeType::NEW_EXPRESSION: {
+            auto newExpr = std::static_pointer_cast<NewExpressionNode>(node);
+            printIndent(indent + 4);
+            std::cout << "Type: " << newExpr->typeName << std::endl;
+            if (newExpr->arraySize) print(newExpr->arraySize, indent + 4);
+            for (const auto& arg : newExpr->arguments) print(arg, indent + 4);
+            break;
+        }
+        case NodeType::DELETE_STATEMENT:
+            print(std::static_pointer_cast<DeleteStatementNode>(node)->operand, indent + 4);
+            break;
+        case NodeType::ENUM_DECLARATION: {
+            auto enumDecl = std::static_pointer_cast<EnumDeclarationNode>(node);
+            printIndent(indent + 4);
+            std::cout << "Name: " << enumDecl->name << " : " << enumDecl->underlyingType << std::endl;
+            for (size_t i = 0; i < enumDecl->enumerators.size(); ++i) {
+                printIndent(indent + 8);
+                std::cout << enumDecl->enumerators[i] << std::endl;
+                if (enumDecl->values[i]) print(enumDecl->values[i], indent + 12);
+            }
+            break;
+        }
         case NodeType::BLOCK: {
             auto block = std::static_pointer_cast<BlockNode>(node);
             for (const auto& stmt : block->statements) {
@@ -101,6 +185,12 @@ void ASTPrinter::print(const std::shared_ptr<ASTNode>& node, int indent) {
             std::cout << "String: \"" << strNode->value << "\"" << std::endl;
             break;
         }
+        case NodeType::CHAR_LITERAL: {
+            auto charNode = std::static_pointer_cast<CharNode>(node);
+            printIndent(indent + 4);
+            std::cout << "Char: '" << charNode->value << "'" << std::endl;
+            break;
+        }
         default:
             printIndent(indent + 4);
             std::cout << "(Unknown node type)" << std::endl;
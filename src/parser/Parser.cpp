@@ -1,15 +1,67 @@
 #include "Parser.h"
+#include "TypeChecker.h"
 #include <iostream>
 #include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 #include "../lexer/TokenTypes.h"
 
+namespace {
+
+std::vector<std::string> words(const std::string& text) {
+    std::vector<std::string> result;
+    std::string word;
+    for (char c : text) {
+        if (isspace(static_cast<unsigned char>(c))) {
+            if (!word.empty()) result.push_back(word);
+            word.clear();
+        } else {
+            word += c;
+        }
+    }
+    if (!word.empty()) result.push_back(word);
+    return result;
+}
+
+// `#pragma omp parallel for ...`; `# pragma` with a space is the same directive
+bool isParallelForPragma(const std::string& directive) {
+    std::vector<std::string> tokens = words(directive.substr(1));
+    return tokens.size() >= 4 && tokens[0] == "pragma" && tokens[1] == "omp" && tokens[2] == "parallel" &&
+           tokens[3] == "for";
+}
+
+std::string trimmed(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t");
+    size_t end = text.find_last_not_of(" \t");
+    return start == std::string::npos ? "" : text.substr(start, end - start + 1);
+}
+
+} // namespace
+
 // Constructor
-Parser::Parser(std::vector<Token> tokens) : tokens(tokens), currentTokenIndex(0) {}
+Parser::Parser(std::vector<Token> tokens) : currentTokenIndex(0), blockDepth(0) {
+    // Comments carry no meaning for the AST, except a `@benchmark` marker on the declaration that follows
+    bool marked = false;
+    for (auto& token : tokens) {
+        if (token.type == TokenType::COMMENT) {
+            marked = marked || token.value.find("@benchmark") != std::string::npos;
+            continue;
+        }
+        if (marked) benchmarkMarkers.insert(this->tokens.size());
+        marked = false;
+        this->tokens.push_back(std::move(token));
+    }
+}
 
 Token Parser::peek() {
     return currentTokenIndex < tokens.size() ? tokens[currentTokenIndex] : Token(TokenType::END_OF_FILE, "EOF", 0, 0);
 }
 
+Token Parser::peekAhead(size_t offset) {
+    size_t index = currentTokenIndex + offset;
+    return index < tokens.size() ? tokens[index] : Token(TokenType::END_OF_FILE, "EOF", 0, 0);
+}
+
 Token Parser::advance() {
     return currentTokenIndex < tokens.size() ? tokens[currentTokenIndex++] : Token(TokenType::END_OF_FILE, "EOF", 0, 0);
 }
@@ -22,40 +74,292 @@ bool Parser::match(TokenType type) {
     return false;
 }
 
+bool Parser::check(TokenType type, const std::string& value) {
+    Token current = peek();
+    return current.type == type && current.value == value;
+}
+
 void Parser::expect(TokenType type, const std::string& errorMessage) {
     if (!match(type)) {
         throw std::runtime_error("Parsing Error: " + errorMessage + " at line " + std::to_string(peek().line));
     }
 }
 
+void Parser::expect(TokenType type, const std::string& value, const std::string& errorMessage) {
+    if (!check(type, value)) {
+        throw std::runtime_error("Parsing Error: " + errorMessage + " at line " + std::to_string(peek().line));
+    }
+    advance();
+}
+
+// ===============================
+// 🛠️ Type Parsing
+// ===============================
+
+bool Parser::isTypeKeyword(const Token& token) const {
+    static const std::unordered_set<std::string> typeKeywords = {
+        "int", "float", "double", "char", "void", "bool", "long",
+        "short", "unsigned", "signed", "const", "auto"
+    };
+    return token.type == TokenType::KEYWORD && typeKeywords.count(token.value);
+}
+
+// A declaration starts with a type keyword, or with a (possibly qualified)
+// type name followed by the declared name, e.g. `std::string s`, `Node* next`.
+bool Parser::isDeclarationStart() {
+    if (isTypeKeyword(peek())) return true;
+    if (peek().type != TokenType::IDENTIFIER) return false;
+
+    size_t offset = 1;
+    while (peekAhead(offset).type == TokenType::OPERATOR && peekAhead(offset).value == "::" &&
+           peekAhead(offset + 1).type == TokenType::IDENTIFIER) {
+        offset += 2;
+    }
+    if (peekAhead(offset).type == TokenType::OPERATOR && peekAhead(offset).value == "<") {
+        // Template arguments, e.g. `std::unordered_map<int, std::vector<long>> m`
+        int depth = 0;
+        do {
+            const Token token = peekAhead(offset++);
+            if (token.type == TokenType::OPERATOR && token.value == "<") depth++;
+            else if (token.type == TokenType::OPERATOR && token.value == ">") depth--;
+            else if (token.type == TokenType::OPERATOR && token.value == ">>") depth -= 2;
+            else if (token.type != TokenType::IDENTIFIER && token.type != TokenType::KEYWORD &&
+                     token.type != TokenType::NUMBER && !(token.type == TokenType::SEPARATOR && token.value == ",") &&
+                     !(token.type == TokenType::OPERATOR && (token.value == "::" || token.value == "*" || token.value == "&"))) {
+                return false;
+            }
+        } while (depth > 0);
+        if (depth < 0) return false;
+    }
+    while (peekAhead(offset).type == TokenType::OPERATOR &&
+           (peekAhead(offset).value == "*" || peekAhead(offset).value == "&")) {
+        offset++;
+    }
+    return peekAhead(offset).type == TokenType::IDENTIFIER;
+}
+
+std::string Parser::parseType(bool* reference) {
+    std::string type;
+    while (isTypeKeyword(peek())) {
+        if (!type.empty()) type += " ";
+        type += advance().value;
+    }
+    if (type.empty() || (type == "const" && peek().type == TokenType::IDENTIFIER)) {
+        if (!type.empty()) type += " ";
+        size_t nameStart = type.size();
+        expect(TokenType::IDENTIFIER, "Expected type name");
+        type += tokens[currentTokenIndex - 1].value;
+        while (check(TokenType::OPERATOR, "::")) {
+            advance();
+            expect(TokenType::IDENTIFIER, "Expected name after '::'");
+            type += "::" + tokens[currentTokenIndex - 1].value;
+        }
+        if (check(TokenType::OPERATOR, "<")) type += parseTemplateArguments();
+
+        // Enums are carried as their underlying integer type
+        auto enumType = enumTypes.find(type.substr(nameStart));
+        if (enumType != enumTypes.end()) type = type.substr(0, nameStart) + enumType->second;
+    }
+
+    // Declarators: `*` adds a pointer level and `* const` changes nothing in the translation. A reference
+    // is not part of the type: a const one reads like a copy, and the caller records any other.
+    bool constant = type.rfind("const ", 0) == 0;
+    while (check(TokenType::OPERATOR, "*") || check(TokenType::OPERATOR, "&") || check(TokenType::KEYWORD, "const")) {
+        std::string token = advance().value;
+        if (token == "*") type += "*";
+        constant = constant || token == "const";
+        if (token == "&" && !constant && reference) *reference = true;
+    }
+    return type;
+}
+
+// Parses `<T, U>` after a template name and returns it as written, e.g. `<int, long>`
+std::string Parser::parseTemplateArguments() {
+    expect(TokenType::OPERATOR, "<", "Expected '<' to start template arguments");
+
+    std::string arguments = "<";
+    while (true) {
+        if (peek().type == TokenType::NUMBER) arguments += advance().value;
+        else arguments += parseType();
+
+        if (check(TokenType::SEPARATOR, ",")) {
+            advance();
+            arguments += ", ";
+            continue;
+        }
+        if (check(TokenType::OPERATOR, ">>")) {
+            // `>>` closes two argument lists: consume one `>` and leave the other
+            tokens[currentTokenIndex].value = ">";
+            return arguments + ">";
+        }
+        expect(TokenType::OPERATOR, ">", "Expected '>' after template arguments");
+        return arguments + ">";
+    }
+}
+
 // ===============================
 // 🛠️ Expression Parsing
 // ===============================
 
 ASTNodePtr Parser::parseExpression() {
-    return parseBinaryExpression(0);
+    static const std::unordered_set<std::string> assignmentOperators = {
+        "=", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<=", ">>="
+    };
+
+    ASTNodePtr left = parseBinaryExpression(1);
+    if (peek().type == TokenType::OPERATOR && assignmentOperators.count(peek().value)) {
+        std::string op = advance().value;
+        ASTNodePtr right = parseExpression();  // Assignment is right-associative
+        return std::make_shared<BinaryExpressionNode>(left, op, right);
+    }
+    return left;
 }
 
 ASTNodePtr Parser::parsePrimary() {
     if (match(TokenType::NUMBER)) {
-        return std::make_shared<NumberNode>(std::stod(tokens[currentTokenIndex - 1].value));
+        const std::string& text = tokens[currentTokenIndex - 1].value;
+        return std::make_shared<NumberNode>(std::stod(text), text);
     }
     if (match(TokenType::STRING_LITERAL)) {
         return std::make_shared<StringNode>(tokens[currentTokenIndex - 1].value);
     }
+    if (match(TokenType::CHAR_LITERAL)) {
+        return std::make_shared<CharNode>(tokens[currentTokenIndex - 1].value);
+    }
+    if (check(TokenType::IDENTIFIER, "sizeof") && peekAhead(1).type == TokenType::SEPARATOR &&
+        peekAhead(1).value == "(") {
+        // sizeof of an arithmetic or pointer type is a constant; anything else stays a call
+        size_t start = currentTokenIndex;
+        advance();
+        advance();
+        if (isTypeKeyword(peek()) || peek().type == TokenType::IDENTIFIER) {
+            std::string type = parseType();
+            int bits = TypeChecker::isPointerType(type) ? 64 : TypeChecker::bitWidth(type);
+            if (bits > 0 && check(TokenType::SEPARATOR, ")")) {
+                advance();
+                int bytes = bits < 8 ? 1 : bits / 8;
+                return std::make_shared<NumberNode>(bytes, std::to_string(bytes) + "UL");
+            }
+        }
+        currentTokenIndex = start;
+    }
+    if (check(TokenType::KEYWORD, "new")) {
+        advance();
+        return parseNew();
+    }
     if (match(TokenType::IDENTIFIER)) {
-        return std::make_shared<IdentifierNode>(tokens[currentTokenIndex - 1].value);
+        std::string name = tokens[currentTokenIndex - 1].value;
+        while (check(TokenType::OPERATOR, "::")) {
+            advance();
+            expect(TokenType::IDENTIFIER, "Expected name after '::'");
+            name += "::" + tokens[currentTokenIndex - 1].value;
+        }
+        // The arguments stay part of the name until Monomorphization resolves the call
+        if (templateFunctions.count(name) && check(TokenType::OPERATOR, "<")) name += parseTemplateArguments();
+        return std::make_shared<IdentifierNode>(name);
+    }
+    if (check(TokenType::SEPARATOR, "(")) {
+        advance();
+        ASTNodePtr expr = parseExpression();
+        expect(TokenType::SEPARATOR, ")", "Expected ')' after expression");
+        return expr;
     }
 
     throw std::runtime_error("Parsing Error: Expected primary expression at line " + std::to_string(peek().line));
 }
 
+// `new T`, `new T(args)`, `new T{args}`, `new T[n]` and `new T[n]()`
+ASTNodePtr Parser::parseNew() {
+    std::string type = parseType();
+
+    if (check(TokenType::SEPARATOR, "[")) {
+        advance();
+        ASTNodePtr size = parseExpression();
+        expect(TokenType::SEPARATOR, "]", "Expected ']' after array size");
+        bool valueInitialized = false;
+        if (check(TokenType::SEPARATOR, "(") || check(TokenType::SEPARATOR, "{")) {
+            std::string close = advance().value == "(" ? ")" : "}";
+            expect(TokenType::SEPARATOR, close, "Only empty initializers are supported after new[]");
+            valueInitialized = true;
+        }
+        return std::make_shared<NewExpressionNode>(type, std::vector<ASTNodePtr>(), size, valueInitialized);
+    }
+
+    std::vector<ASTNodePtr> arguments;
+    bool valueInitialized = false;
+    if (check(TokenType::SEPARATOR, "(") || check(TokenType::SEPARATOR, "{")) {
+        std::string close = advance().value == "(" ? ")" : "}";
+        valueInitialized = true;
+        while (!check(TokenType::SEPARATOR, close)) {
+            arguments.push_back(parseExpression());
+            if (!check(TokenType::SEPARATOR, ",")) break;
+            advance();
+        }
+        expect(TokenType::SEPARATOR, close, "Expected '" + close + "' after new initializer");
+    }
+    return std::make_shared<NewExpressionNode>(type, arguments, nullptr, valueInitialized);
+}
+
+ASTNodePtr Parser::parsePostfix() {
+    ASTNodePtr expr = parsePrimary();
+
+    while (true) {
+        if (check(TokenType::SEPARATOR, "(")) {
+            advance();
+            std::vector<ASTNodePtr> arguments;
+            while (!check(TokenType::SEPARATOR, ")")) {
+                arguments.push_back(parseExpression());
+                if (!check(TokenType::SEPARATOR, ",")) break;
+                advance();
+            }
+            expect(TokenType::SEPARATOR, ")", "Expected ')' after arguments");
+            expr = std::make_shared<FunctionCallNode>(expr, arguments);
+        } else if (check(TokenType::SEPARATOR, "[")) {
+            advance();
+            ASTNodePtr index = parseExpression();
+            expect(TokenType::SEPARATOR, "]", "Expected ']' after subscript");
+            expr = std::make_shared<ArrayAccessNode>(expr, index);
+        } else if (check(TokenType::OPERATOR, ".") || check(TokenType::OPERATOR, "->")) {
+            bool arrow = advance().value == "->";
+            expect(TokenType::IDENTIFIER, "Expected member name");
+            expr = std::make_shared<MemberAccessNode>(expr, tokens[currentTokenIndex - 1].value, arrow);
+        } else if (check(TokenType::OPERATOR, "++") || check(TokenType::OPERATOR, "--")) {
+            expr = std::make_shared<UnaryExpressionNode>(advance().value, expr, false);
+        } else {
+            return expr;
+        }
+    }
+}
+
+ASTNodePtr Parser::parseUnary() {
+    static const std::unordered_set<std::string> prefixOperators = {"-", "+", "!", "~", "++", "--", "*", "&"};
+
+    if (peek().type == TokenType::OPERATOR && prefixOperators.count(peek().value)) {
+        std::string op = advance().value;
+        return std::make_shared<UnaryExpressionNode>(op, parseUnary(), true);
+    }
+    return parsePostfix();
+}
+
+// Precedence climbing: `precedence` is the lowest binding power accepted
 ASTNodePtr Parser::parseBinaryExpression(int precedence) {
-    ASTNodePtr left = parsePrimary();
+    static const std::unordered_map<std::string, int> binaryPrecedence = {
+        {"||", 1}, {"&&", 2}, {"|", 3}, {"^", 4}, {"&", 5},
+        {"==", 6}, {"!=", 6},
+        {"<", 7}, {">", 7}, {"<=", 7}, {">=", 7},
+        {"<<", 8}, {">>", 8},
+        {"+", 9}, {"-", 9},
+        {"*", 10}, {"/", 10}, {"%", 10}
+    };
+
+    ASTNodePtr left = parseUnary();
 
     while (peek().type == TokenType::OPERATOR) {
+        auto it = binaryPrecedence.find(peek().value);
+        if (it == binaryPrecedence.end() || it->second < precedence) break;
+
         std::string op = advance().value;
-        ASTNodePtr right = parsePrimary();
+        ASTNodePtr right = parseBinaryExpression(it->second + 1);
         left = std::make_shared<BinaryExpressionNode>(left, op, right);
     }
     return left;
@@ -71,6 +375,7 @@ ASTNodePtr Parser::parseStatement() {
 
     // **Handle preprocessor directives like #include**
     if (current.type == TokenType::PREPROCESSOR_DIRECTIVE) {
+        if (isParallelForPragma(current.value)) return parseParallelFor();
         std::cout << "[INFO] Skipping preprocessor directive: " << current.value << std::endl;
         while (peek().type != TokenType::END_OF_FILE && peek().line == current.line) {
             advance();  // Skip everything on the preprocessor directive line
@@ -78,38 +383,174 @@ ASTNodePtr Parser::parseStatement() {
         return nullptr; // Ignore and continue parsing
     }
 
-    // **Function Declaration Handling First**
-    if (match(TokenType::KEYWORD)) {
-        std::string keyword = tokens[currentTokenIndex - 1].value;
-        Token nextToken = peek();
-        if (nextToken.type == TokenType::IDENTIFIER) {
-            Token identifier = advance();
-            if (peek().type == TokenType::SEPARATOR && peek().value == "(") {
-                return parseFunctionDeclaration();  // Correctly parse function
-            } else {
-                return parseVariableDeclaration(keyword);  // Otherwise, parse as a variable
+    // **Nested block**
+    if (check(TokenType::SEPARATOR, "{")) {
+        return parseBlock();
+    }
+
+    // **Empty statement**
+    if (check(TokenType::SEPARATOR, ";")) {
+        advance();
+        return nullptr;
+    }
+
+    // **Control flow keywords**
+    if (current.type == TokenType::KEYWORD) {
+        if (current.value == "return") {
+            advance();
+            return parseReturnStatement();
+        }
+        if (current.value == "if") {
+            advance();
+            return parseIfStatement();
+        }
+        if (current.value == "while") {
+            advance();
+            return parseWhileLoop();
+        }
+        if (current.value == "for") {
+            advance();
+            return parseForLoop();
+        }
+        if (current.value == "switch") {
+            advance();
+            return parseSwitch();
+        }
+        if (current.value == "delete") {
+            advance();
+            bool array = check(TokenType::SEPARATOR, "[");
+            if (array) {
+                advance();
+                expect(TokenType::SEPARATOR, "]", "Expected ']' after 'delete['");
             }
+            ASTNodePtr operand = parseExpression();
+            expect(TokenType::SEPARATOR, ";", "Expected ';' after delete");
+            return std::make_shared<DeleteStatementNode>(operand, array);
+        }
+        if (current.value == "break" || current.value == "continue") {
+            advance();
+            expect(TokenType::SEPARATOR, ";", "Expected ';' after '" + current.value + "'");
+            if (current.value == "break") return std::make_shared<BreakStatementNode>();
+            return std::make_shared<ContinueStatementNode>();
         }
     }
 
-    // **Return statement**
-    if (match(TokenType::KEYWORD) && tokens[currentTokenIndex - 1].value == "return") {
-        return parseReturnStatement();
+    if (current.type == TokenType::KEYWORD && (current.value == "struct" || current.value == "class")) {
+        advance();
+        return parseStruct();
+    }
+    if (current.type == TokenType::KEYWORD && current.value == "enum") {
+        advance();
+        return parseEnum();
+    }
+    if (check(TokenType::IDENTIFIER, "template") && peekAhead(1).type == TokenType::OPERATOR && peekAhead(1).value == "<") {
+        return parseTemplate();
+    }
+
+    // Attributes are ignored, except `[[benchmark]]` (in any namespace), which like a
+    // `// @benchmark` comment marks the function that follows for --emit-benchmarks
+    if (blockDepth == 0 && (benchmarkMarkers.count(currentTokenIndex) > 0 ||
+                            (check(TokenType::SEPARATOR, "[") && peekAhead(1).value == "["))) {
+        bool benchmark = benchmarkMarkers.erase(currentTokenIndex) > 0;
+        while (check(TokenType::SEPARATOR, "[") && peekAhead(1).value == "[") {
+            advance();
+            advance();
+            while (!(check(TokenType::SEPARATOR, "]") && peekAhead(1).value == "]")) {
+                if (peek().type == TokenType::END_OF_FILE) {
+                    throw std::runtime_error("Parsing Error: Expected ']]' after attribute at line " + std::to_string(peek().line));
+                }
+                std::string previous = tokens[currentTokenIndex - 1].value;
+                if (advance().value == "benchmark" && (previous == "[" || previous == "," || previous == "::")) benchmark = true;
+            }
+            advance();
+            advance();
+        }
+        ASTNodePtr declaration = parseStatement();
+        if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(declaration)) {
+            funcDecl->benchmark = funcDecl->benchmark || benchmark;
+        }
+        return declaration;
+    }
+
+    // `static` at file scope gives internal linkage; `inline` changes nothing in Java
+    bool internalLinkage = false;
+    while (check(TokenType::KEYWORD, "static") || check(TokenType::IDENTIFIER, "inline")) {
+        if (blockDepth > 0) {
+            throw std::runtime_error("Parsing Error: Static and inline local variables are not supported at line " +
+                                     std::to_string(peek().line));
+        }
+        internalLinkage = internalLinkage || advance().value == "static";
+    }
+    if (internalLinkage) {
+        if (!isDeclarationStart()) {
+            throw std::runtime_error("Parsing Error: Expected a declaration after 'static' at line " +
+                                     std::to_string(peek().line));
+        }
+        ASTNodePtr declaration = parseStatement();
+        if (auto funcDecl = std::dynamic_pointer_cast<FunctionDeclarationNode>(declaration)) funcDecl->internalLinkage = true;
+        if (auto varDecl = std::dynamic_pointer_cast<VariableDeclarationNode>(declaration)) varDecl->internalLinkage = true;
+        return declaration;
+    }
+
+    // **Function or variable declaration**
+    if (isDeclarationStart()) {
+        bool reference = false;
+        std::string type = parseType(&reference);
+        // Inside a body `T name(...)` constructs a variable; functions are only defined at file scope,
+        // where a literal or an operator after the `(` still marks a constructed global, `std::atomic<int> n(0)`
+        TokenType firstArgument = peekAhead(2).type;
+        if (blockDepth == 0 && peek().type == TokenType::IDENTIFIER &&
+            peekAhead(1).type == TokenType::SEPARATOR && peekAhead(1).value == "(" &&
+            firstArgument != TokenType::NUMBER && firstArgument != TokenType::STRING_LITERAL &&
+            firstArgument != TokenType::CHAR_LITERAL && firstArgument != TokenType::OPERATOR) {
+            ASTNodePtr funcDecl = parseFunctionDeclaration(type);
+            std::static_pointer_cast<FunctionDeclarationNode>(funcDecl)->returnsReference = reference;
+            return funcDecl;
+        }
+        ASTNodePtr varDecl = parseVariableDeclaration(type);
+        std::static_pointer_cast<VariableDeclarationNode>(varDecl)->reference = reference;
+        return varDecl;
+    }
+
+    // **Expression statement (assignments, calls, increments)**
+    if (current.type == TokenType::IDENTIFIER || current.type == TokenType::OPERATOR ||
+        current.type == TokenType::NUMBER || check(TokenType::SEPARATOR, "(") || check(TokenType::KEYWORD, "new")) {
+        ASTNodePtr expr = parseExpression();
+        expect(TokenType::SEPARATOR, ";", "Expected ';' after expression");
+        return expr;
     }
 
     throw std::runtime_error("Parsing Error: Unexpected statement at line " + std::to_string(peek().line));
 }
 
 ASTNodePtr Parser::parseBlock() {
-    expect(TokenType::SEPARATOR, "Expected '{' before block body");
+    expect(TokenType::SEPARATOR, "{", "Expected '{' before block body");
 
     std::vector<ASTNodePtr> statements;
-    while (!(peek().type == TokenType::SEPARATOR && peek().value == "}")) {
+    blockDepth++;
+    while (!check(TokenType::SEPARATOR, "}")) {
+        if (peek().type == TokenType::END_OF_FILE) {
+            throw std::runtime_error("Parsing Error: Expected '}' at the end of block at line " + std::to_string(peek().line));
+        }
         ASTNodePtr stmt = parseStatement();
         if (stmt) statements.push_back(stmt);
     }
+    blockDepth--;
+
+    expect(TokenType::SEPARATOR, "}", "Expected '}' at the end of block");
+    return std::make_shared<BlockNode>(statements);
+}
 
-    expect(TokenType::SEPARATOR, "Expected '}' at the end of block");
+// Bodies of control flow statements are always blocks, even when the
+// source omits the braces around a single statement.
+ASTNodePtr Parser::parseStatementOrBlock() {
+    if (check(TokenType::SEPARATOR, "{")) {
+        return parseBlock();
+    }
+
+    std::vector<ASTNodePtr> statements;
+    ASTNodePtr stmt = parseStatement();
+    if (stmt) statements.push_back(stmt);
     return std::make_shared<BlockNode>(statements);
 }
 
@@ -117,45 +558,367 @@ ASTNodePtr Parser::parseBlock() {
 // 🛠️ Function & Variable Parsing
 // ===============================
 
-ASTNodePtr Parser::parseFunctionDeclaration() {
-    std::string returnType = tokens[currentTokenIndex - 1].value;
+// `template <typename T, class U, int N>` before a struct or a function. The
+// declaration is parsed as written, with the parameters as type names;
+// Monomorphization makes one copy of it per set of arguments used.
+ASTNodePtr Parser::parseTemplate() {
+    size_t line = peek().line;
+    if (blockDepth > 0) {
+        throw std::runtime_error("Parsing Error: Templates are only supported at file scope at line " + std::to_string(line));
+    }
+    advance();
+    expect(TokenType::OPERATOR, "<", "Expected '<' after 'template'");
+
+    std::vector<std::string> parameters;
+    while (true) {
+        if (check(TokenType::IDENTIFIER, "typename") || check(TokenType::KEYWORD, "class")) {
+            advance();
+        } else if (isDeclarationStart()) {
+            parseType();  // Non-type parameters are substituted as literals, whatever their type
+        } else {
+            throw std::runtime_error("Parsing Error: Expected template parameter at line " + std::to_string(peek().line));
+        }
+        expect(TokenType::IDENTIFIER, "Expected template parameter name");
+        parameters.push_back(tokens[currentTokenIndex - 1].value);
+        if (check(TokenType::OPERATOR, "=")) {
+            throw std::runtime_error("Parsing Error: Default template arguments are not supported at line " +
+                                     std::to_string(peek().line));
+        }
+        if (!check(TokenType::SEPARATOR, ",")) break;
+        advance();
+    }
+    expect(TokenType::OPERATOR, ">", "Expected '>' after template parameters");
+
+    if (check(TokenType::KEYWORD, "struct") || check(TokenType::KEYWORD, "class")) {
+        advance();
+        auto structDecl = std::static_pointer_cast<StructDeclarationNode>(parseStruct());
+        structDecl->templateParameters = parameters;
+        return structDecl;
+    }
+    if (isDeclarationStart()) {
+        bool reference = false;
+        std::string returnType = parseType(&reference);
+        if (peek().type == TokenType::IDENTIFIER && peekAhead(1).type == TokenType::SEPARATOR && peekAhead(1).value == "(") {
+            templateFunctions.insert(peek().value);
+            auto funcDecl = std::static_pointer_cast<FunctionDeclarationNode>(parseFunctionDeclaration(returnType));
+            funcDecl->templateParameters = parameters;
+            funcDecl->returnsReference = reference;
+            return funcDecl;
+        }
+    }
+    throw std::runtime_error("Parsing Error: Only struct and function templates are supported at line " + std::to_string(line));
+}
+
+// `struct Name { T a, b; U c = 1; };` — data members only, access specifiers are skipped
+ASTNodePtr Parser::parseStruct() {
+    expect(TokenType::IDENTIFIER, "Expected struct name");
+    std::string name = tokens[currentTokenIndex - 1].value;
+    expect(TokenType::SEPARATOR, "{", "Expected '{' after struct name");
+
+    std::vector<ASTNodePtr> fields;
+    while (!check(TokenType::SEPARATOR, "}")) {
+        if (peek().type == TokenType::END_OF_FILE) {
+            throw std::runtime_error("Parsing Error: Expected '}' at the end of struct at line " + std::to_string(peek().line));
+        }
+        if (peek().type == TokenType::KEYWORD &&
+            (peek().value == "public" || peek().value == "private" || peek().value == "protected")) {
+            advance();
+            expect(TokenType::OPERATOR, ":", "Expected ':' after access specifier");
+            continue;
+        }
+        std::string type = parseType();
+        if (peek().type == TokenType::IDENTIFIER && peekAhead(1).type == TokenType::SEPARATOR && peekAhead(1).value == "(") {
+            throw std::runtime_error("Parsing Error: Member functions are not supported at line " + std::to_string(peek().line));
+        }
+        fields.push_back(parseDeclarator(type));
+        while (check(TokenType::SEPARATOR, ",")) {
+            advance();
+            fields.push_back(parseDeclarator(type));
+        }
+        expect(TokenType::SEPARATOR, ";", "Expected ';' after member declaration");
+    }
+    expect(TokenType::SEPARATOR, "}", "Expected '}' at the end of struct");
+    expect(TokenType::SEPARATOR, ";", "Expected ';' after struct definition");
+    return std::make_shared<StructDeclarationNode>(name, fields);
+}
+
+// `enum [class] Name [: type] { A, B = 4, C };` — the enumerators become integer constants
+ASTNodePtr Parser::parseEnum() {
+    bool scoped = check(TokenType::KEYWORD, "class") || check(TokenType::KEYWORD, "struct");
+    if (scoped) advance();
+
+    std::string name;
+    if (peek().type == TokenType::IDENTIFIER) name = advance().value;
+    else if (scoped) expect(TokenType::IDENTIFIER, "Expected enum class name");
+
+    std::string underlyingType = "int";
+    if (check(TokenType::OPERATOR, ":")) {
+        advance();
+        underlyingType = parseType();
+    }
+    if (!name.empty()) enumTypes[name] = underlyingType;
+    expect(TokenType::SEPARATOR, "{", "Expected '{' after enum name");
+
+    std::vector<std::string> enumerators;
+    std::vector<ASTNodePtr> values;
+    while (!check(TokenType::SEPARATOR, "}")) {
+        expect(TokenType::IDENTIFIER, "Expected enumerator name");
+        enumerators.push_back(tokens[currentTokenIndex - 1].value);
+        ASTNodePtr value = nullptr;
+        if (check(TokenType::OPERATOR, "=")) {
+            advance();
+            value = parseBinaryExpression(1);
+        }
+        values.push_back(value);
+        if (!check(TokenType::SEPARATOR, ",")) break;
+        advance();
+    }
+    expect(TokenType::SEPARATOR, "}", "Expected '}' at the end of enum");
+    expect(TokenType::SEPARATOR, ";", "Expected ';' after enum definition");
+    return std::make_shared<EnumDeclarationNode>(name, scoped, underlyingType, enumerators, values);
+}
+
+ASTNodePtr Parser::parseFunctionDeclaration(const std::string& returnType) {
     expect(TokenType::IDENTIFIER, "Expected function name");
     std::shared_ptr<ASTNode> functionName = std::make_shared<IdentifierNode>(tokens[currentTokenIndex - 1].value);
 
-    expect(TokenType::SEPARATOR, "Expected '(' after function name");
+    expect(TokenType::SEPARATOR, "(", "Expected '(' after function name");
 
     std::vector<ASTNodePtr> parameters;
-    while (!(peek().type == TokenType::SEPARATOR && peek().value == ")")) {
-        parameters.push_back(parsePrimary());
-        if (peek().type == TokenType::SEPARATOR && peek().value == ",") {
+    std::vector<std::string> parameterTypes;
+    std::vector<bool> referenceParameters;
+    if (check(TokenType::KEYWORD, "void") && peekAhead(1).value == ")") {
+        advance();
+    }
+    while (!check(TokenType::SEPARATOR, ")")) {
+        bool reference = false;
+        std::string paramType = parseType(&reference);
+        referenceParameters.push_back(reference);
+        expect(TokenType::IDENTIFIER, "Expected parameter name");
+        parameters.push_back(std::make_shared<IdentifierNode>(tokens[currentTokenIndex - 1].value));
+        // Array parameters decay to pointers: `int a[]` and `int a[N]` mean `int* a`
+        while (check(TokenType::SEPARATOR, "[")) {
             advance();
+            if (!check(TokenType::SEPARATOR, "]")) parseExpression();
+            expect(TokenType::SEPARATOR, "]", "Expected ']' after array parameter");
+            paramType += "*";
         }
+        parameterTypes.push_back(paramType);
+        if (!check(TokenType::SEPARATOR, ",")) break;
+        advance();
     }
-    expect(TokenType::SEPARATOR, "Expected ')' after parameters");
+    expect(TokenType::SEPARATOR, ")", "Expected ')' after parameters");
 
     ASTNodePtr body = parseBlock();
-    return std::make_shared<FunctionDeclarationNode>(returnType, functionName, parameters, body);
+    auto funcDecl = std::make_shared<FunctionDeclarationNode>(returnType, functionName, parameters, body);
+    funcDecl->parameterTypes = parameterTypes;
+    funcDecl->referenceParameters = referenceParameters;
+    return funcDecl;
 }
 
 ASTNodePtr Parser::parseVariableDeclaration(const std::string& type) {
+    ASTNodePtr varDecl = parseDeclarator(type);
+    expect(TokenType::SEPARATOR, ";", "Expected ';' after variable declaration");
+    return varDecl;
+}
+
+// One `name[dims] = init` after the type; the caller consumes the terminator
+ASTNodePtr Parser::parseDeclarator(const std::string& type) {
     expect(TokenType::IDENTIFIER, "Expected variable name");
     std::shared_ptr<ASTNode> identifier = std::make_shared<IdentifierNode>(tokens[currentTokenIndex - 1].value);
 
-    if (match(TokenType::OPERATOR) && tokens[currentTokenIndex - 1].value == "=") {
-        ASTNodePtr initializer = parseExpression();
-        expect(TokenType::SEPARATOR, "Expected ';' after variable declaration");
-        return std::make_shared<VariableDeclarationNode>(type, identifier, initializer);
+    // Array declarators: `int buf[N]`, `double m[4][4]`, `int v[] = {...}`
+    std::string declaredType = type;
+    std::vector<ASTNodePtr> arraySizes;
+    while (check(TokenType::SEPARATOR, "[")) {
+        advance();
+        arraySizes.push_back(check(TokenType::SEPARATOR, "]") ? nullptr : parseExpression());
+        expect(TokenType::SEPARATOR, "]", "Expected ']' after array size");
+        declaredType += "[]";
+    }
+
+    ASTNodePtr initializer = nullptr;
+    std::vector<ASTNodePtr> constructorArguments;
+    if (check(TokenType::OPERATOR, "=")) {
+        advance();
+        initializer = check(TokenType::SEPARATOR, "{") ? parseInitializerList() : parseExpression();
+    } else if (check(TokenType::SEPARATOR, "{")) {
+        initializer = parseInitializerList();
+    } else if (check(TokenType::SEPARATOR, "(")) {
+        // Constructor arguments, e.g. `std::vector<int> v(n, 0)`
+        advance();
+        while (!check(TokenType::SEPARATOR, ")")) {
+            constructorArguments.push_back(parseExpression());
+            if (!check(TokenType::SEPARATOR, ",")) break;
+            advance();
+        }
+        expect(TokenType::SEPARATOR, ")", "Expected ')' after constructor arguments");
+    }
+
+    auto varDecl = std::make_shared<VariableDeclarationNode>(declaredType, identifier, initializer);
+    varDecl->arraySizes = arraySizes;
+    varDecl->constructorArguments = constructorArguments;
+    return varDecl;
+}
+
+ASTNodePtr Parser::parseInitializerList() {
+    expect(TokenType::SEPARATOR, "{", "Expected '{' to start initializer list");
+
+    std::vector<ASTNodePtr> elements;
+    while (!check(TokenType::SEPARATOR, "}")) {
+        elements.push_back(check(TokenType::SEPARATOR, "{") ? parseInitializerList() : parseExpression());
+        if (!check(TokenType::SEPARATOR, ",")) break;
+        advance();  // A trailing comma is allowed
     }
-    throw std::runtime_error("Parsing Error: Expected '=' in variable declaration at line " + std::to_string(peek().line));
+    expect(TokenType::SEPARATOR, "}", "Expected '}' after initializer list");
+    return std::make_shared<InitializerListNode>(elements);
 }
 
 // ===============================
 // 🛠️ Control Flow Parsing
 // ===============================
 
+ASTNodePtr Parser::parseIfStatement() {
+    expect(TokenType::SEPARATOR, "(", "Expected '(' after 'if'");
+    ASTNodePtr condition = parseExpression();
+    expect(TokenType::SEPARATOR, ")", "Expected ')' after if condition");
+
+    ASTNodePtr thenBlock = parseStatementOrBlock();
+    ASTNodePtr elseBlock = nullptr;
+    if (check(TokenType::KEYWORD, "else")) {
+        advance();
+        elseBlock = parseStatementOrBlock();
+    }
+    return std::make_shared<IfStatementNode>(condition, thenBlock, elseBlock);
+}
+
+ASTNodePtr Parser::parseWhileLoop() {
+    expect(TokenType::SEPARATOR, "(", "Expected '(' after 'while'");
+    ASTNodePtr condition = parseExpression();
+    expect(TokenType::SEPARATOR, ")", "Expected ')' after while condition");
+
+    ASTNodePtr body = parseStatementOrBlock();
+    return std::make_shared<WhileLoopNode>(condition, body);
+}
+
+// `for (init; condition; increments)`: the init clause is either one
+// declaration statement (`int i = 0, j = n`) or comma-separated expressions.
+// `for (decl : range)` keeps the element declaration and the range for RangeForLowering.
+ASTNodePtr Parser::parseForLoop() {
+    expect(TokenType::SEPARATOR, "(", "Expected '(' after 'for'");
+
+    std::vector<ASTNodePtr> initializers;
+    if (isDeclarationStart()) {
+        bool reference = false;
+        std::string type = parseType(&reference);
+        std::vector<std::string> bindings;
+        if (check(TokenType::SEPARATOR, "[")) {
+            // A structured binding, `auto& [key, value]`, names the members of each element
+            advance();
+            while (true) {
+                expect(TokenType::IDENTIFIER, "Expected a name in structured binding");
+                bindings.push_back(tokens[currentTokenIndex - 1].value);
+                if (!check(TokenType::SEPARATOR, ",")) break;
+                advance();
+            }
+            expect(TokenType::SEPARATOR, "]", "Expected ']' after structured binding");
+            initializers.push_back(std::make_shared<VariableDeclarationNode>(
+                type, std::make_shared<IdentifierNode>(bindings.front()), nullptr));
+        } else {
+            initializers.push_back(parseDeclarator(type));
+        }
+        std::static_pointer_cast<VariableDeclarationNode>(initializers.back())->reference = reference;
+        if (check(TokenType::OPERATOR, ":")) {
+            advance();
+            ASTNodePtr range = parseExpression();
+            expect(TokenType::SEPARATOR, ")", "Expected ')' after range-based for loop header");
+            auto forLoop = std::make_shared<ForLoopNode>(initializers, nullptr, std::vector<ASTNodePtr>(),
+                                                         parseStatementOrBlock());
+            forLoop->range = range;
+            forLoop->bindings = bindings;
+            return forLoop;
+        }
+        if (!bindings.empty()) {
+            throw std::runtime_error("Parsing Error: Structured bindings are only supported in range-based for loops at line " +
+                                     std::to_string(peek().line));
+        }
+        while (check(TokenType::SEPARATOR, ",")) {
+            advance();
+            initializers.push_back(parseDeclarator(type));
+        }
+    } else if (!check(TokenType::SEPARATOR, ";")) {
+        initializers.push_back(parseExpression());
+        while (check(TokenType::SEPARATOR, ",")) {
+            advance();
+            initializers.push_back(parseExpression());
+        }
+    }
+    expect(TokenType::SEPARATOR, ";", "Expected ';' after for loop initializer");
+
+    ASTNodePtr condition = check(TokenType::SEPARATOR, ";") ? nullptr : parseExpression();
+    expect(TokenType::SEPARATOR, ";", "Expected ';' after for loop condition");
+
+    std::vector<ASTNodePtr> increments;
+    if (!check(TokenType::SEPARATOR, ")")) {
+        increments.push_back(parseExpression());
+        while (check(TokenType::SEPARATOR, ",")) {
+            advance();
+            increments.push_back(parseExpression());
+        }
+    }
+    expect(TokenType::SEPARATOR, ")", "Expected ')' after for loop header");
+
+    ASTNodePtr body = parseStatementOrBlock();
+    return std::make_shared<ForLoopNode>(initializers, condition, increments, body);
+}
+
+// `switch (expr) { case A: ... default: ... }`: each label starts a clause that
+// runs up to the next label, so fallthrough is kept as written
+ASTNodePtr Parser::parseSwitch() {
+    expect(TokenType::SEPARATOR, "(", "Expected '(' after 'switch'");
+    ASTNodePtr expression = parseExpression();
+    expect(TokenType::SEPARATOR, ")", "Expected ')' after switch condition");
+    expect(TokenType::SEPARATOR, "{", "Expected '{' before switch body");
+
+    std::vector<ASTNodePtr> cases;
+    blockDepth++;
+    while (!check(TokenType::SEPARATOR, "}")) {
+        ASTNodePtr value = nullptr;
+        if (check(TokenType::KEYWORD, "case")) {
+            advance();
+            value = parseExpression();
+        } else if (check(TokenType::KEYWORD, "default")) {
+            advance();
+        } else {
+            throw std::runtime_error("Parsing Error: Expected 'case' or 'default' in switch at line " +
+                                     std::to_string(peek().line));
+        }
+        expect(TokenType::OPERATOR, ":", "Expected ':' after case label");
+
+        std::vector<ASTNodePtr> statements;
+        while (!check(TokenType::KEYWORD, "case") && !check(TokenType::KEYWORD, "default") &&
+               !check(TokenType::SEPARATOR, "}")) {
+            if (peek().type == TokenType::END_OF_FILE) {
+                throw std::runtime_error("Parsing Error: Expected '}' at the end of switch at line " +
+                                         std::to_string(peek().line));
+            }
+            ASTNodePtr stmt = parseStatement();
+            if (stmt) statements.push_back(stmt);
+        }
+        cases.push_back(std::make_shared<CaseClauseNode>(value, std::make_shared<BlockNode>(statements)));
+    }
+    blockDepth--;
+
+    expect(TokenType::SEPARATOR, "}", "Expected '}' at the end of switch");
+    return std::make_shared<SwitchStatementNode>(expression, cases);
+}
+
 ASTNodePtr Parser::parseReturnStatement() {
-    ASTNodePtr expr = parseExpression();
-    expect(TokenType::SEPARATOR, "Expected ';' after return statement");
+    ASTNodePtr expr = nullptr;
+    if (!check(TokenType::SEPARATOR, ";")) {
+        expr = parseExpression();
+    }
+    expect(TokenType::SEPARATOR, ";", "Expected ';' after return statement");
     return std::make_shared<ReturnStatementNode>(expr);
 }
 
@@ -163,6 +926,39 @@ ASTNodePtr Parser::parseReturnStatement() {
 // 🛠️ Program Parsing
 // ===============================
 
+// The loop after `#pragma omp parallel for`, marked parallel with its
+// `reduction(op: a, b)` clauses. Other clauses (schedule, private...) do not
+// change what the loop computes and are dropped.
+ASTNodePtr Parser::parseParallelFor() {
+    Token pragma = advance();
+    ASTNodePtr stmt = parseStatement();
+    auto forLoop = std::dynamic_pointer_cast<ForLoopNode>(stmt);
+    if (!forLoop) {
+        throw std::runtime_error("Parsing Error: Expected a for loop after '" + pragma.value + "' at line " +
+                                 std::to_string(pragma.line));
+    }
+    forLoop->parallel = true;
+
+    const std::string& text = pragma.value;
+    for (size_t at = text.find("reduction"); at != std::string::npos; at = text.find("reduction", at + 1)) {
+        size_t open = text.find('(', at), colon = text.find(':', at), close = text.find(')', at);
+        if (open == std::string::npos || colon == std::string::npos || close == std::string::npos ||
+            !(open < colon && colon < close) || trimmed(text.substr(at + 9, open - at - 9)) != "") {
+            throw std::runtime_error("Parsing Error: Malformed reduction clause in '" + text + "' at line " +
+                                     std::to_string(pragma.line));
+        }
+        std::string op = trimmed(text.substr(open + 1, colon - open - 1));
+        std::string variables = text.substr(colon + 1, close - colon - 1);
+        size_t start = 0;
+        for (size_t comma = variables.find(','); ; comma = variables.find(',', start)) {
+            forLoop->reductions.emplace_back(op, trimmed(variables.substr(start, comma - start)));
+            if (comma == std::string::npos) break;
+            start = comma + 1;
+        }
+    }
+    return forLoop;
+}
+
 ASTNodePtr Parser::parseProgram() {
     std::vector<ASTNodePtr> statements;
     while (peek().type != TokenType::END_OF_FILE) {
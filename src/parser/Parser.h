@@ -3,29 +3,57 @@
 
 #include "../lexer/Lexer.h"
 #include "ASTNode.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class Parser {
 private:
     std::vector<Token> tokens;
     size_t currentTokenIndex;
+    int blockDepth;  // Nesting of `{ }` bodies; 0 at file scope
+    std::unordered_map<std::string, std::string> enumTypes;  // Enum name -> underlying type
+    std::unordered_set<std::string> templateFunctions;  // Names that take explicit template arguments, `f<int>(x)`
+    std::unordered_set<size_t> benchmarkMarkers;  // Indices of the tokens that follow a `// @benchmark` comment
 
     Token peek();
+    Token peekAhead(size_t offset);
     Token advance();
     bool match(TokenType type);
+    bool check(TokenType type, const std::string& value);
     void expect(TokenType type, const std::string& errorMessage);
+    void expect(TokenType type, const std::string& value, const std::string& errorMessage);
+
+    bool isTypeKeyword(const Token& token) const;
+    bool isDeclarationStart();
+    // Sets `*reference` when the declarator is a non-const `&`, which the type string leaves out
+    std::string parseType(bool* reference = nullptr);
+    std::string parseTemplateArguments();
 
     ASTNodePtr parseExpression();
     ASTNodePtr parseStatement();
     ASTNodePtr parseBlock();
-    ASTNodePtr parseFunctionDeclaration();
+    ASTNodePtr parseStatementOrBlock();
+    ASTNodePtr parseFunctionDeclaration(const std::string& returnType);
     ASTNodePtr parseVariableDeclaration(const std::string& type);
+    ASTNodePtr parseDeclarator(const std::string& type);
+    ASTNodePtr parseStruct();
+    ASTNodePtr parseTemplate();
+    ASTNodePtr parseEnum();
+    ASTNodePtr parseInitializerList();
     ASTNodePtr parseIfStatement();
     ASTNodePtr parseWhileLoop();
+    ASTNodePtr parseForLoop();
+    ASTNodePtr parseParallelFor();
+    ASTNodePtr parseSwitch();
     ASTNodePtr parseReturnStatement();
     ASTNodePtr parseProgram();
     ASTNodePtr parseBinaryExpression(int precedence);
+    ASTNodePtr parseUnary();
+    ASTNodePtr parsePostfix();
     ASTNodePtr parsePrimary();
+    ASTNodePtr parseNew();
 
 
 public:
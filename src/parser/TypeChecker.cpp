@@ -1,5 +1,6 @@
 #include "TypeChecker.h"
 #include <iostream>
+#include <unordered_map>
 
 // Recursively check the types in the AST
 bool TypeChecker::check(ASTNodePtr node, SymbolTable& table, std::vector<std::string>& errors) {
@@ -19,6 +20,12 @@ bool TypeChecker::check(ASTNodePtr node, SymbolTable& table, std::vector<std::st
             std::string varName = identifierNode->name;
             std::string varType = varDecl->type;
 
+            std::string atomicValue = valueType(normalizeType(varType));
+            if (isAtomicType(normalizeType(varType)) && !isArithmeticType(atomicValue) && !isPointerType(atomicValue)) {
+                errors.push_back("Error: std::atomic<" + atomicValue + "> has no lock-free translation.");
+                return false;
+            }
+
             if (table.isDefined(varName)) {
                 errors.push_back("Error: Variable '" + varName + "' is already declared.");
                 return false;
@@ -71,6 +78,35 @@ bool TypeChecker::check(ASTNodePtr node, SymbolTable& table, std::vector<std::st
             check(whileLoop->body, table, errors);
             break;
         }
+        case NodeType::FOR_LOOP: {
+            auto forLoop = std::static_pointer_cast<ForLoopNode>(node);
+            for (const auto& init : forLoop->initializers) check(init, table, errors);
+            if (forLoop->condition && inferType(forLoop->condition, table, errors) != "bool") {
+                errors.push_back("Error: For loop condition must be a boolean.");
+                return false;
+            }
+            for (const auto& reduction : forLoop->reductions) {
+                if (!table.isDefined(reduction.second) ||
+                    !isArithmeticType(normalizeType(table.getType(reduction.second)))) {
+                    errors.push_back("Error: Reduction variable '" + reduction.second + "' must have an arithmetic type.");
+                    return false;
+                }
+            }
+            check(forLoop->body, table, errors);
+            break;
+        }
+        case NodeType::SWITCH_STATEMENT: {
+            auto switchStmt = std::static_pointer_cast<SwitchStatementNode>(node);
+            std::string selector = inferType(switchStmt->expression, table, errors);
+            if (!isIntegralType(selector)) {
+                errors.push_back("Error: Switch condition must have an integral type.");
+                return false;
+            }
+            for (const auto& clause : switchStmt->cases) {
+                check(std::static_pointer_cast<CaseClauseNode>(clause)->body, table, errors);
+            }
+            break;
+        }
         case NodeType::BLOCK: {
             auto block = std::dynamic_pointer_cast<BlockNode>(node);
             if (!block) return false;
@@ -88,30 +124,368 @@ bool TypeChecker::check(ASTNodePtr node, SymbolTable& table, std::vector<std::st
 
 // Infer the type of an AST node
 std::string TypeChecker::inferType(ASTNodePtr node, SymbolTable& table, std::vector<std::string>& errors) {
-    if (!node) return "UNKNOWN";
+    if (node && node->type == NodeType::BINARY_EXPRESSION && !checkBinaryExpression(node, table, errors)) {
+        return "UNKNOWN";
+    }
+    std::string type = inferType(node, static_cast<const SymbolTable&>(table));
+    return type.empty() ? "UNKNOWN" : type;
+}
+
+std::string TypeChecker::inferType(const ASTNodePtr& node, const SymbolTable& table) {
+    if (!node) return "";
 
     switch (node->type) {
-        case NodeType::NUMBER_LITERAL:
-            return "int";
+        case NodeType::NUMBER_LITERAL: {
+            auto number = std::static_pointer_cast<NumberNode>(node);
+            if (!number->text.empty()) return literalType(number->text);
+            return number->value == static_cast<long long>(number->value) ? "int" : "double";
+        }
         case NodeType::STRING_LITERAL:
             return "string";
+        case NodeType::CHAR_LITERAL:
+            return "char";
         case NodeType::IDENTIFIER: {
-            auto idNode = std::dynamic_pointer_cast<IdentifierNode>(node);
-            if (!idNode) return "UNKNOWN";
-            return table.getType(idNode->name);
+            const std::string& name = std::static_pointer_cast<IdentifierNode>(node)->name;
+            if (name == "true" || name == "false") return "bool";
+            return normalizeType(table.getType(name));
+        }
+        case NodeType::BINARY_EXPRESSION: {
+            auto binExpr = std::static_pointer_cast<BinaryExpressionNode>(node);
+            const std::string& op = binExpr->op;
+            std::string left = valueType(inferType(binExpr->left, table));
+            if (op == "=" || (op.size() >= 2 && op.back() == '=' && op != "==" && op != "!=" && op != "<=" && op != ">=")) {
+                return left;  // Assignment yields its target (an atomic's new value)
+            }
+            if (op == "&&" || op == "||" || op == "==" || op == "!=" ||
+                op == "<" || op == ">" || op == "<=" || op == ">=") {
+                return "bool";
+            }
+            if (op == "<<" || op == ">>") {
+                return isIntegralType(left) ? promote(left) : "";
+            }
+            std::string right = valueType(inferType(binExpr->right, table));
+            if (op == "+" && (left == "string" || right == "string")) return "string";
+            if (op == "-" && isPointerType(left) && isPointerType(right)) return "long";  // ptrdiff_t
+            if ((op == "+" || op == "-") && isPointerType(left)) return elementType(left) + "*";
+            if (op == "+" && isPointerType(right)) return elementType(right) + "*";
+            return arithmeticType(left, right);
+        }
+        case NodeType::UNARY_EXPRESSION: {
+            auto unaryExpr = std::static_pointer_cast<UnaryExpressionNode>(node);
+            std::string operand = valueType(inferType(unaryExpr->operand, table));
+            if (unaryExpr->op == "!") return "bool";
+            if (unaryExpr->op == "*") return isPointerType(operand) ? elementType(operand) : "";
+            if (unaryExpr->op == "&") return operand.empty() ? "" : operand + "*";
+            if (isPointerType(operand)) return operand;  // ++p, p--
+            if (unaryExpr->op == "++" || unaryExpr->op == "--") return operand;
+            return isArithmeticType(operand) ? promote(operand) : "";
+        }
+        case NodeType::MEMBER_ACCESS: {
+            // Struct fields are recorded as `Struct::field`
+            auto access = std::static_pointer_cast<MemberAccessNode>(node);
+            std::string object = inferType(access->object, table);
+            if (access->arrow && isPointerType(object)) object = elementType(object);
+            std::string field = object + "::" + access->member;
+            return table.isDefined(field) ? normalizeType(table.getType(field)) : "";
+        }
+        case NodeType::NEW_EXPRESSION:
+            return normalizeType(std::static_pointer_cast<NewExpressionNode>(node)->typeName) + "*";
+        case NodeType::ARRAY_ACCESS: {
+            std::string array = inferType(std::static_pointer_cast<ArrayAccessNode>(node)->array, table);
+            if (array == "string") return "char";
+            std::string container = templateName(array);
+            std::vector<std::string> arguments = templateArguments(array);
+            if ((container == "vector" || container == "array") && !arguments.empty()) return arguments[0];
+            if ((container == "unordered_map" || container == "map") && arguments.size() == 2) return arguments[1];
+            return isPointerType(array) ? elementType(array) : "";
         }
-        case NodeType::BINARY_EXPRESSION:
-            return checkBinaryExpression(node, table, errors) ? inferType(node, table, errors) : "UNKNOWN";
         case NodeType::FUNCTION_CALL: {
-            auto funcCall = std::dynamic_pointer_cast<FunctionCallNode>(node);
-            if (!funcCall) return "UNKNOWN";
+            auto funcCall = std::static_pointer_cast<FunctionCallNode>(node);
             auto funcNameNode = std::dynamic_pointer_cast<IdentifierNode>(funcCall->functionName);
-            if (!funcNameNode) return "UNKNOWN";
-            return table.getType(funcNameNode->name);
+            if (auto access = std::dynamic_pointer_cast<MemberAccessNode>(funcCall->functionName)) {
+                // Element accessors of standard containers; other members depend on the translated class
+                std::string object = inferType(access->object, table);
+                std::vector<std::string> arguments = templateArguments(object);
+                if (templateName(object) == "vector" && !arguments.empty() &&
+                    (access->member == "at" || access->member == "front" || access->member == "back")) {
+                    return arguments[0];
+                }
+                if (templateName(object) == "vector" && !arguments.empty() &&
+                    (access->member == "begin" || access->member == "end" || access->member == "data")) {
+                    return arguments[0] + "*";  // Iterators behave as pointers into the element array
+                }
+                if (templateName(object) == "unordered_map" && arguments.size() == 2 &&
+                    (access->member == "at" || access->member == "valueAt")) {
+                    return arguments[1];
+                }
+                if ((templateName(object) == "unordered_map" || templateName(object) == "unordered_set") &&
+                    !arguments.empty() && access->member == "keyAt") {
+                    return arguments[0];  // Slot accessors of the runtime hash tables (see RangeForLowering)
+                }
+                if (templateName(object) == "future" && !arguments.empty() && access->member == "get") {
+                    return arguments[0];
+                }
+                if (isAtomicType(object)) {
+                    const std::string& member = access->member;
+                    if (member == "load" || member == "exchange" || member.rfind("fetch_", 0) == 0) return valueType(object);
+                    if (member.rfind("compare_exchange_", 0) == 0 || member == "is_lock_free") return "bool";
+                    return member == "store" ? "void" : "";
+                }
+                return "";
+            }
+            if (!funcNameNode) return "";
+            std::string name = funcNameNode->name;
+            if (name.rfind("std::", 0) == 0) name = name.substr(5);
+            if (table.isDefined(funcNameNode->name)) return normalizeType(table.getType(funcNameNode->name));
+            if (name == "async") {
+                // std::async([policy,] f, args...) yields a future of f's result
+                for (const auto& arg : funcCall->arguments) {
+                    auto callee = std::dynamic_pointer_cast<IdentifierNode>(arg);
+                    if (callee && callee->name.find("launch::") == std::string::npos && table.isDefined(callee->name)) {
+                        return "std::future<" + normalizeType(table.getType(callee->name)) + ">";
+                    }
+                }
+                return "";
+            }
+            if (name == "thread::hardware_concurrency") return "unsigned int";
+            if ((name == "min" || name == "max") && funcCall->arguments.size() == 2) {
+                return arithmeticType(inferType(funcCall->arguments[0], table), inferType(funcCall->arguments[1], table));
+            }
+            if (name == "abs" && funcCall->arguments.size() == 1) {
+                std::string argument = inferType(funcCall->arguments[0], table);
+                return isArithmeticType(argument) ? promote(argument) : "";
+            }
+            if (name == "labs") return "long";
+            if (name == "llabs") return "long long";
+            if (name == "sqrtf") return "float";
+            static const std::vector<std::string> mathFunctions = {
+                "sqrt", "cbrt", "pow", "exp", "log", "log2", "log10", "sin", "cos", "tan",
+                "asin", "acos", "atan", "atan2", "sinh", "cosh", "tanh", "floor", "ceil", "round",
+                "trunc", "fabs", "hypot", "fmin", "fmax"
+            };
+            for (const auto& math : mathFunctions) {
+                if (name == math) return "double";
+            }
+            if (name == "__builtin_bswap32") return "unsigned int";
+            if (name == "__builtin_bswap64") return "unsigned long";
+            if (name == "__mulh") return "long long";
+            if (name == "__umulh") return "unsigned long long";
+            if (name.rfind("__builtin_", 0) == 0) return "int";  // popcount, clz, ctz
+            return "";
         }
         default:
-            return "UNKNOWN";
+            return "";
+    }
+}
+
+std::string TypeChecker::normalizeType(const std::string& type) {
+    std::string result = type;
+    while (result.rfind("const ", 0) == 0) result = result.substr(6);
+
+    size_t open = result.find('<');
+    if (open != std::string::npos) {
+        // Template arguments are normalized too: `std::vector<std::uint32_t>` -> `std::vector<unsigned int>`
+        std::string normalized = result.substr(0, open) + "<";
+        std::vector<std::string> arguments = templateArguments(result);
+        for (size_t i = 0; i < arguments.size(); ++i) {
+            normalized += (i ? ", " : "") + arguments[i];
+        }
+        size_t close = result.rfind('>');
+        return normalized + ">" + (close == std::string::npos ? "" : result.substr(close + 1));
+    }
+    static const std::unordered_map<std::string, std::string> atomicAliases = {
+        {"atomic_bool", "bool"}, {"atomic_char", "char"}, {"atomic_int", "int"}, {"atomic_uint", "unsigned int"},
+        {"atomic_long", "long"}, {"atomic_ulong", "unsigned long"}, {"atomic_llong", "long long"},
+        {"atomic_ullong", "unsigned long long"}, {"atomic_size_t", "unsigned long"}
+    };
+    auto alias = atomicAliases.find(result.rfind("std::", 0) == 0 ? result.substr(5) : result);
+    if (alias != atomicAliases.end()) return "std::atomic<" + alias->second + ">";
+    if (result.rfind("std::", 0) == 0 && result.find("_t") != std::string::npos) result = result.substr(5);
+    if (result == "std::string") return "string";
+
+    if (result == "size_t" || result == "uint64_t" || result == "uintptr_t") return "unsigned long";
+    if (result == "ptrdiff_t" || result == "int64_t" || result == "intptr_t" || result == "ssize_t") return "long";
+    if (result == "uint32_t") return "unsigned int";
+    if (result == "int32_t") return "int";
+    if (result == "uint16_t") return "unsigned short";
+    if (result == "int16_t") return "short";
+    if (result == "uint8_t") return "unsigned char";
+    if (result == "int8_t") return "signed char";
+
+    int longs = 0;
+    bool isUnsigned = false, isSigned = false, isShort = false, isChar = false, isInt = false;
+    size_t start = 0;
+    while (start < result.size()) {
+        size_t end = result.find(' ', start);
+        if (end == std::string::npos) end = result.size();
+        std::string word = result.substr(start, end - start);
+        start = end + 1;
+
+        if (word == "long") longs++;
+        else if (word == "unsigned") isUnsigned = true;
+        else if (word == "signed") isSigned = true;
+        else if (word == "short") isShort = true;
+        else if (word == "char") isChar = true;
+        else if (word == "int") isInt = true;
+        else if (word == "double") return longs ? "long double" : "double";
+        else if (word == "float" || word == "bool" || word == "void" || word == "auto") return word;
+        else return result;  // Class or library type
+    }
+
+    std::string prefix = isUnsigned ? "unsigned " : "";
+    if (isChar) return isUnsigned ? "unsigned char" : (isSigned ? "signed char" : "char");
+    if (isShort) return prefix + "short";
+    if (longs >= 2) return prefix + "long long";
+    if (longs == 1) return prefix + "long";
+    if (isInt || isUnsigned || isSigned) return prefix + "int";
+    return result;
+}
+
+bool TypeChecker::isAtomicType(const std::string& type) {
+    return templateName(normalizeType(type)) == "atomic";
+}
+
+std::string TypeChecker::valueType(const std::string& type) {
+    if (!isAtomicType(type)) return type;
+    std::vector<std::string> arguments = templateArguments(normalizeType(type));
+    return arguments.empty() ? "" : arguments[0];
+}
+
+std::string TypeChecker::templateName(const std::string& type) {
+    std::string result = type;
+    while (result.rfind("const ", 0) == 0) result = result.substr(6);
+    size_t open = result.find('<');
+    if (open == std::string::npos) return "";
+    result = result.substr(0, open);
+    return result.rfind("std::", 0) == 0 ? result.substr(5) : result;
+}
+
+std::vector<std::string> TypeChecker::templateArguments(const std::string& type) {
+    std::vector<std::string> arguments;
+    size_t open = type.find('<');
+    size_t close = type.rfind('>');
+    if (open == std::string::npos || close == std::string::npos || close < open) return arguments;
+
+    // Split on the commas that are not nested inside another argument list
+    int depth = 0;
+    size_t start = open + 1;
+    for (size_t i = start; i <= close; ++i) {
+        if (type[i] == '<') depth++;
+        else if (type[i] == '>' && i != close) depth--;
+        else if ((type[i] == ',' && depth == 0) || i == close) {
+            std::string argument = type.substr(start, i - start);
+            while (!argument.empty() && argument.front() == ' ') argument.erase(argument.begin());
+            while (!argument.empty() && argument.back() == ' ') argument.pop_back();
+            if (!argument.empty()) arguments.push_back(normalizeType(argument));
+            start = i + 1;
+        }
     }
+    return arguments;
+}
+
+bool TypeChecker::isPointerType(const std::string& type) {
+    return (!type.empty() && type.back() == '*') || (type.size() > 2 && type.compare(type.size() - 2, 2, "[]") == 0);
+}
+
+std::string TypeChecker::elementType(const std::string& type) {
+    if (!type.empty() && type.back() == '*') return normalizeType(type.substr(0, type.size() - 1));
+    if (isPointerType(type)) return normalizeType(type.substr(0, type.size() - 2));
+    return "";
+}
+
+bool TypeChecker::isIntegralType(const std::string& type) {
+    return bitWidth(type) > 0 && !isFloatingType(type);
+}
+
+bool TypeChecker::isFloatingType(const std::string& type) {
+    std::string normalized = normalizeType(type);
+    return normalized == "float" || normalized == "double" || normalized == "long double";
+}
+
+bool TypeChecker::isArithmeticType(const std::string& type) {
+    return bitWidth(type) > 0;
+}
+
+bool TypeChecker::isUnsignedType(const std::string& type) {
+    std::string normalized = normalizeType(type);
+    return normalized.rfind("unsigned ", 0) == 0;
+}
+
+int TypeChecker::bitWidth(const std::string& type) {
+    std::string normalized = normalizeType(type);
+    if (normalized.rfind("unsigned ", 0) == 0) normalized = normalized.substr(9);
+
+    if (normalized == "bool") return 1;
+    if (normalized == "char" || normalized == "signed char") return 8;
+    if (normalized == "short") return 16;
+    if (normalized == "int" || normalized == "float") return 32;
+    if (normalized == "long" || normalized == "long long" || normalized == "double") return 64;
+    if (normalized == "long double") return 128;
+    return 0;
+}
+
+std::string TypeChecker::literalType(const std::string& text) {
+    std::string digits = text;
+    std::string suffix;
+    bool hex = text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X');
+    while (!digits.empty() && std::string(hex ? "uUlL" : "uUlLfF").find(digits.back()) != std::string::npos) {
+        suffix.insert(suffix.begin(), digits.back());
+        digits.pop_back();
+    }
+
+    bool isUnsigned = suffix.find_first_of("uU") != std::string::npos;
+    size_t longs = 0;
+    for (char c : suffix) {
+        if (c == 'l' || c == 'L') longs++;
+    }
+
+    if (!hex && digits.find_first_of(".eE") != std::string::npos) {
+        if (suffix.find_first_of("fF") != std::string::npos) return "float";
+        return longs ? "long double" : "double";
+    }
+
+    // An unsuffixed literal takes the first type that can hold its value
+    unsigned long long value = std::stoull(digits, nullptr, hex ? 16 : 10);
+    std::string prefix = isUnsigned ? "unsigned " : "";
+    if (longs >= 2) return prefix + "long long";
+    if (longs == 1) return (!isUnsigned && value > 0x7FFFFFFFFFFFFFFFULL) ? "unsigned long" : prefix + "long";
+    if (isUnsigned) return value > 0xFFFFFFFFULL ? "unsigned long" : "unsigned int";
+    if (value <= 0x7FFFFFFFULL) return "int";
+    if (hex && value <= 0xFFFFFFFFULL) return "unsigned int";
+    if (value <= 0x7FFFFFFFFFFFFFFFULL) return "long";
+    return "unsigned long";
+}
+
+std::string TypeChecker::promote(const std::string& type) {
+    std::string normalized = normalizeType(type);
+    if (isIntegralType(normalized) && bitWidth(normalized) < 32) return "int";
+    return normalized;
+}
+
+std::string TypeChecker::arithmeticType(const std::string& left, const std::string& right) {
+    if (!isArithmeticType(left) || !isArithmeticType(right)) return "";
+
+    std::string l = promote(left);
+    std::string r = promote(right);
+    if (isFloatingType(l) || isFloatingType(r)) {
+        if (!isFloatingType(l)) return r;
+        if (!isFloatingType(r)) return l;
+        return bitWidth(l) >= bitWidth(r) ? l : r;
+    }
+    if (l == r) return l;
+
+    auto rank = [](const std::string& type) {
+        std::string base = isUnsignedType(type) ? type.substr(9) : type;
+        return base == "int" ? 1 : base == "long" ? 2 : 3;
+    };
+    bool lu = isUnsignedType(l), ru = isUnsignedType(r);
+    if (lu == ru) return rank(l) >= rank(r) ? l : r;
+
+    const std::string& u = lu ? l : r;
+    const std::string& sgn = lu ? r : l;
+    if (rank(u) >= rank(sgn)) return u;
+    if (bitWidth(sgn) > bitWidth(u)) return sgn;  // e.g. long holds every unsigned int
+    return "unsigned " + sgn;
 }
 
 // Checks type consistency in binary expressions
@@ -119,10 +493,10 @@ bool TypeChecker::checkBinaryExpression(ASTNodePtr node, SymbolTable& table, std
     auto binExpr = std::dynamic_pointer_cast<BinaryExpressionNode>(node);
     if (!binExpr) return false;
 
-    std::string leftType = inferType(binExpr->left, table, errors);
-    std::string rightType = inferType(binExpr->right, table, errors);
+    std::string leftType = valueType(inferType(binExpr->left, table, errors));
+    std::string rightType = valueType(inferType(binExpr->right, table, errors));
 
-    if (leftType != rightType) {
+    if (leftType != rightType && !(isArithmeticType(leftType) && isArithmeticType(rightType))) {
         errors.push_back("Type Error: Mismatched types in binary expression (" + leftType + " vs. " + rightType + ").");
         return false;
     }
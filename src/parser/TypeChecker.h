@@ -11,6 +11,43 @@ public:
     // Checks the types in the AST and accumulates errors instead of failing on the first one
     static bool check(ASTNodePtr node, SymbolTable& table, std::vector<std::string>& errors);
 
+    // Infers the C++ type of an expression; returns "" when it cannot be determined
+    static std::string inferType(const ASTNodePtr& node, const SymbolTable& table);
+
+    // Canonical spelling of a type with const dropped: `unsigned` -> `unsigned int`,
+    // `long int` -> `long`, `uint32_t` -> `unsigned int`, `std::size_t` -> `unsigned long`
+    static std::string normalizeType(const std::string& type);
+
+    static bool isArithmeticType(const std::string& type);
+    static bool isIntegralType(const std::string& type);
+    static bool isFloatingType(const std::string& type);
+    static bool isUnsignedType(const std::string& type);
+
+    // Pointers (`double*`) and arrays (`int[]`); elementType strips one level
+    static bool isPointerType(const std::string& type);
+    static std::string elementType(const std::string& type);
+
+    // `std::unordered_map<int, long>` -> `unordered_map` and {`int`, `long`}; "" and {} for non-templates
+    static std::string templateName(const std::string& type);
+    static std::vector<std::string> templateArguments(const std::string& type);
+
+    // `std::atomic<T>` (also spelled `std::atomic_int`...) and T itself: an atomic
+    // is read as its value type, so expressions over atomics type as over T
+    static bool isAtomicType(const std::string& type);
+    static std::string valueType(const std::string& type);
+
+    // Width in bits of an arithmetic type (LP64: long is 64 bits)
+    static int bitWidth(const std::string& type);
+
+    // Type of a numeric literal from its spelling, e.g. `10u`, `3000000000`, `1.5f`
+    static std::string literalType(const std::string& text);
+
+    // Integral promotion: bool, char and short operands become int
+    static std::string promote(const std::string& type);
+
+    // Usual arithmetic conversions for a binary operator's operands
+    static std::string arithmeticType(const std::string& left, const std::string& right);
+
 private:
     // Infers the type of an AST node
     static std::string inferType(ASTNodePtr node, SymbolTable& table, std::vector<std::string>& errors);
@@ -0,0 +1,61 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(unsigned threads)
+    : threadCount(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+unsigned WorkStealingPool::size() const {
+    return threadCount;
+}
+
+void WorkStealingPool::run(const std::vector<std::function<void()>>& tasks) const {
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+    unsigned threads = static_cast<unsigned>(std::min<size_t>(threadCount, tasks.size()));
+    if (threads == 0) return;
+    std::vector<Queue> queues(threads);
+    for (size_t i = 0; i < tasks.size(); i++) queues[i % threads].tasks.push_back(i);
+    std::vector<std::exception_ptr> errors(tasks.size());
+
+    auto work = [&](unsigned self) {
+        while (true) {
+            size_t task = 0;
+            bool found = false;
+            for (unsigned k = 0; k < threads && !found; k++) {
+                Queue& queue = queues[(self + k) % threads];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (queue.tasks.empty()) continue;
+                found = true;
+                if (k == 0) {
+                    task = queue.tasks.back();
+                    queue.tasks.pop_back();
+                } else {
+                    task = queue.tasks.front();
+                    queue.tasks.pop_front();
+                }
+            }
+            // Nothing is queued during a run, so once every deque is empty the thread is done
+            if (!found) return;
+            try {
+                tasks[task]();
+            } catch (...) {
+                errors[task] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) workers.emplace_back(work, t);
+    work(0);
+    for (auto& worker : workers) worker.join();
+
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+}
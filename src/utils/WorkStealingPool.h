@@ -0,0 +1,26 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <functional>
+#include <vector>
+
+// Runs a batch of independent tasks on a fixed number of threads. The tasks
+// are dealt out round-robin to one deque per thread; each thread takes from
+// the back of its own deque and, once that is empty, steals from the front
+// of another's, so a few long tasks do not leave the other threads idle.
+class WorkStealingPool {
+public:
+    // 0 uses one thread per hardware thread
+    explicit WorkStealingPool(unsigned threads = 0);
+
+    // Returns once every task has run. If any of them threw, the exception of
+    // the first such task in `tasks` is rethrown, as a serial loop would throw it.
+    void run(const std::vector<std::function<void()>>& tasks) const;
+
+    unsigned size() const;
+
+private:
+    unsigned threadCount;
+};
+
+#endif // WORKSTEALINGPOOL_H
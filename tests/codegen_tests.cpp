@@ -0,0 +1,1992 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <regex>
+#include <string>
+#include <vector>
+#include "lexer/Lexer.h"
+#include "parser/Parser.h"
+#include "codegen/BenchmarkGenerator.h"
+#include "codegen/CodeGenerator.h"
+#include "codegen/JavaEmitter.h"
+#include "codegen/OutputWriter.h"
+#include "codegen/RuntimeLibrary.h"
+#include "optimizer/HotnessProfile.h"
+#include "optimizer/MethodSplitting.h"
+#include "optimizer/Monomorphization.h"
+#include "utils/WorkStealingPool.h"
+
+namespace {
+
+std::string translate(const std::string& source, const CodeGenOptions& options = CodeGenOptions(),
+                      std::vector<std::string>* report = nullptr) {
+    Lexer lexer(source);
+    Parser parser(lexer.tokenize());
+    ASTNodePtr ast = parser.parse();
+
+    std::string path = testing::TempDir() + "codegen_test_output.java";
+    std::string java;
+    {
+        OutputWriter writer(path, true);
+        JavaEmitter emitter(writer);
+        CodeGenerator generator(emitter, options);
+        generator.generateCode(ast);
+        java = writer.getContents();
+        if (report) *report = generator.getReport();
+    }
+    std::remove(path.c_str());
+    return java;
+}
+
+bool contains(const std::string& haystack, const std::string& needle) {
+    return haystack.find(needle) != std::string::npos;
+}
+
+CodeGenOptions optimized() {
+    CodeGenOptions options;
+    options.hoistLoopInvariants = true;
+    return options;
+}
+
+CodeGenOptions keepAll() {
+    CodeGenOptions options;
+    options.eliminateDeadCode = false;
+    return options;
+}
+
+CodeGenOptions structOfArrays() {
+    CodeGenOptions options = keepAll();
+    options.structOfArrays = true;
+    return options;
+}
+
+} // namespace
+
+// ===============================
+// Loop-invariant code motion
+// ===============================
+
+TEST(LoopInvariantMotionTest, HoistsContainerSizeOutOfCondition) {
+    std::string java = translate(
+        "int sum(Buffer v) {\n"
+        "    int i = 0;\n"
+        "    int s = 0;\n"
+        "    while (i < v.size()) {\n"
+        "        s = s + i;\n"
+        "        i = i + 1;\n"
+        "    }\n"
+        "    return s;\n"
+        "}\n", optimized());
+
+    EXPECT_TRUE(contains(java, "final var inv$0 = v.size();\nwhile (i < inv$0) {"));
+}
+
+TEST(LoopInvariantMotionTest, HoistsInvariantArithmeticAndPureCalls) {
+    std::string java = translate(
+        "int scale(int a, int b) { return a * b + 7; }\n"
+        "int kernel(int n, int a, int b) {\n"
+        "    int s = 0;\n"
+        "    while (n > 0) {\n"
+        "        s = s + scale(a, b) * n + a * b;\n"
+        "        n = n - 1;\n"
+        "    }\n"
+        "    return s;\n"
+        "}\n", optimized());
+
+    EXPECT_TRUE(contains(java, "final int inv$0 = scale(a, b);"));
+    EXPECT_TRUE(contains(java, "final int inv$1 = a * b;"));
+    EXPECT_TRUE(contains(java, "s = s + inv$0 * n + inv$1;"));
+}
+
+TEST(LoopInvariantMotionTest, KeepsVariantAndUnsafeExpressionsInLoop) {
+    std::string java = translate(
+        "int total = 0;\n"
+        "void bump() { total = total + 1; }\n"
+        "int kernel(int n, int d, Buffer v) {\n"
+        "    int s = 0;\n"
+        "    while (n > 0) {\n"
+        "        s = s + total * 2 + n * 3 + s / d;\n"
+        "        v.push_back(s);\n"
+        "        bump();\n"
+        "        n = n - 1;\n"
+        "    }\n"
+        "    return s + v.size();\n"
+        "}\n", optimized());
+
+    // `total` may change through bump(), `n` and `s` are written, `d` may be zero
+    EXPECT_FALSE(contains(java, "inv$"));
+    EXPECT_TRUE(contains(java, "s = s + total * 2 + n * 3 + s / d;"));
+}
+
+TEST(LoopInvariantMotionTest, KeepsLoadsAndCallsUnderAGuardInTheLoop) {
+    std::string java = translate(
+        "struct Node { int val; };\n"
+        "int scale(int a) { return 100 / a; }\n"
+        "int kernel(Node* p, int n, int d) {\n"
+        "    int s = 0;\n"
+        "    for (int i = 0; i < n; i++) {\n"
+        "        if (p != nullptr) s += p->val;\n"
+        "        if (d != 0) s += scale(d);\n"
+        "        if (i > 5) s += n * 2;\n"
+        "    }\n"
+        "    return s;\n"
+        "}\n", optimized());
+
+    // Hoisted, they would throw when `p` is null or `d` is zero, which the guards prevent
+    EXPECT_TRUE(contains(java, "s += p[p$off].val;"));
+    EXPECT_TRUE(contains(java, "s += scale(d);"));
+    EXPECT_FALSE(contains(java, " = p[p$off].val;"));
+    EXPECT_FALSE(contains(java, " = scale(d);"));
+    // Arithmetic on locals cannot throw, so it still moves
+    EXPECT_TRUE(contains(java, "final int inv$2 = n * 2;"));
+}
+
+TEST(LoopInvariantMotionTest, KeepsTheRightOfShortCircuitOperatorsInTheLoop) {
+    std::string java = translate(
+        "struct Node { int val; };\n"
+        "int kernel(Node* p, int n) {\n"
+        "    int s = 0;\n"
+        "    while (n > 0) {\n"
+        "        s = s + n;\n"
+        "        bool big = n > 2 && p->val > 3;\n"
+        "        if (p != nullptr && p->val > 3) s = s + 2;\n"
+        "        s = s + p->val;\n"
+        "        n = n - 1;\n"
+        "    }\n"
+        "    return s;\n"
+        "}\n", optimized());
+
+    EXPECT_TRUE(contains(java, "boolean big = n > 2 && p[p$off].val > 3;"));
+    // Only the null test moves; the load stays behind it
+    EXPECT_TRUE(contains(java, "final boolean inv$0 = p != null;"));
+    EXPECT_TRUE(contains(java, "if (inv$0 && p[p$off].val > 3) {"));
+    EXPECT_TRUE(contains(java, "s = s + p[p$off].val;"));
+}
+
+TEST(LoopInvariantMotionTest, KeepsFaultingExpressionsInABodyThatMayNotRun) {
+    std::string java = translate(
+        "struct Node { int val; };\n"
+        "int scale(int a) { return 100 / a; }\n"
+        "int twice(int a) { return a * 2; }\n"
+        "int kernel(Node* p, int n, int d, int m) {\n"
+        "    int s = 0;\n"
+        "    for (int i = 0; i < n; i++) {\n"
+        "        s += p->val;\n"
+        "        s += scale(d);\n"
+        "        s += twice(d);\n"
+        "        for (int j = 0; j < m; j++) s += d * 3;\n"
+        "    }\n"
+        "    return s;\n"
+        "}\n", optimized());
+
+    // With n == 0 the C++ never loads through p or divides by d
+    EXPECT_TRUE(contains(java, "s += p[p$off].val;"));
+    EXPECT_TRUE(contains(java, "s += scale(d);"));
+    // twice() cannot throw, and the inner loop's invariant moves out whole rather than as a copy
+    EXPECT_TRUE(contains(java, "final int inv$1 = twice(d);\nfinal int inv$0 = d * 3;\nfor (int i = 0; i < n; i++) {"));
+    EXPECT_FALSE(contains(java, "inv$2"));
+}
+
+TEST(LoopInvariantMotionTest, DisabledByDefault) {
+    std::string java = translate(
+        "int f(Buffer v) { int i = 0; while (i < v.size()) { i = i + 1; } return i; }\n");
+
+    EXPECT_FALSE(contains(java, "inv$"));
+    EXPECT_TRUE(contains(java, "while (i < v.size()) {"));
+}
+
+// ===============================
+// Tail-call elimination
+// ===============================
+
+TEST(TailCallEliminationTest, RewritesSelfTailCallIntoLoop) {
+    std::string java = translate(
+        "int gcd(int a, int b) {\n"
+        "    if (b == 0) return a;\n"
+        "    return gcd(b, a % b);\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java,
+        "int gcd(int a, int b) {\n"
+        "tailcall: while (true) {\n"
+        "if (b == 0) {\n"
+        "return a;\n"
+        "}\n"
+        "{\n"
+        "int a$next = b;\n"
+        "int b$next = a % b;\n"
+        "a = a$next;\n"
+        "b = b$next;\n"
+        "continue tailcall;\n"
+        "}\n"
+        "}\n"
+        "}\n"));
+}
+
+TEST(TailCallEliminationTest, RewritesVoidTailCallAndKeepsFallOffExit) {
+    std::string java = translate(
+        "void countdown(int n, int step) {\n"
+        "    if (n > 0) {\n"
+        "        countdown(n - step, step);\n"
+        "    }\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "n = n - step;\ncontinue tailcall;\n"));
+    EXPECT_TRUE(contains(java, "}\nreturn;\n}\n}\n"));
+    EXPECT_FALSE(contains(java, "countdown(n - step, step)"));
+}
+
+TEST(TailCallEliminationTest, LeavesMutualRecursionAndNonTailCallsAlone) {
+    std::string java = translate(
+        "bool isEven(int n) { if (n == 0) return true; return isOdd(n - 1); }\n"
+        "bool isOdd(int n) { if (n == 0) return false; return isEven(n - 1); }\n"
+        "int fact(int n) { if (n < 2) return 1; return n * fact(n - 1); }\n");
+
+    EXPECT_FALSE(contains(java, "tailcall"));
+    EXPECT_TRUE(contains(java, "return isOdd(n - 1);"));
+    EXPECT_TRUE(contains(java, "return n * fact(n - 1);"));
+}
+
+// ===============================
+// Dead function elimination
+// ===============================
+
+TEST(DeadCodeEliminationTest, RemovesFunctionsAndGlobalsUnreachableFromMain) {
+    std::vector<std::string> report;
+    std::string java = translate(
+        "int used = 3;\n"
+        "int unused = 4;\n"
+        "int helper(int x) { return x * used; }\n"
+        "int orphan(int x) { return x + unused; }\n"
+        "int orphanCaller(int x) { return orphan(x); }\n"
+        "int main() { return helper(2); }\n", CodeGenOptions(), &report);
+
+    EXPECT_TRUE(contains(java, "int used = 3;"));
+    EXPECT_TRUE(contains(java, "int helper(int x) {"));
+    EXPECT_FALSE(contains(java, "unused"));
+    EXPECT_FALSE(contains(java, "orphan"));
+
+    ASSERT_EQ(report.size(), 3u);
+    EXPECT_EQ(report[0], "Removed global 'unused': only referenced from unreachable code (orphan); roots: main.");
+    EXPECT_EQ(report[1], "Removed function 'orphan': only referenced from unreachable code (orphanCaller); roots: main.");
+    EXPECT_EQ(report[2], "Removed function 'orphanCaller': never referenced; roots: main.");
+}
+
+TEST(DeadCodeEliminationTest, HonoursConfiguredRootsAndKeepsEverythingWithoutOne) {
+    CodeGenOptions options;
+    options.roots = {"api"};
+    std::string java = translate(
+        "int helper(int x) { return x; }\n"
+        "int api(int x) { return helper(x); }\n"
+        "int main() { return 0; }\n", options);
+
+    EXPECT_TRUE(contains(java, "int api(int x) {"));
+    EXPECT_TRUE(contains(java, "int helper(int x) {"));
+    EXPECT_FALSE(contains(java, "main"));
+
+    // No root defined: nothing anchors reachability, so nothing is dropped
+    std::string library = translate("int a(int x) { return x; }\nint b(int x) { return x; }\n");
+    EXPECT_TRUE(contains(library, "int a(int x) {"));
+    EXPECT_TRUE(contains(library, "int b(int x) {"));
+}
+
+// ===============================
+// Type-directed primitive emission
+// ===============================
+
+TEST(PrimitiveEmissionTest, MapsDeclaredTypesToJavaPrimitives) {
+    std::string java = translate(
+        "long long mix(long long a, unsigned char b, short c, bool d, double e) {\n"
+        "    const auto scaled = a * 3;\n"
+        "    float f = 1.5;\n"
+        "    return scaled + b + c;\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "long mix(long a, byte b, short c, boolean d, double e) {"));
+    EXPECT_TRUE(contains(java, "final long scaled = a * 3L;"));
+    EXPECT_TRUE(contains(java, "float f = 1.5f;"));
+    EXPECT_TRUE(contains(java, "return scaled + Byte.toUnsignedInt(b) + c;"));
+}
+
+TEST(PrimitiveEmissionTest, UsesUnsignedHelpersForUnsignedArithmetic) {
+    std::string java = translate(
+        "unsigned int hash(unsigned int h, unsigned int k) {\n"
+        "    h = h / k;\n"
+        "    h %= 7u;\n"
+        "    if (h > k) return h >> 3;\n"
+        "    unsigned long wide = h;\n"
+        "    return 4000000000u;\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "h = Integer.divideUnsigned(h, k);"));
+    EXPECT_TRUE(contains(java, "h = Integer.remainderUnsigned(h, 7);"));
+    EXPECT_TRUE(contains(java, "if (Integer.compareUnsigned(h, k) > 0) {"));
+    EXPECT_TRUE(contains(java, "return h >>> 3;"));
+    EXPECT_TRUE(contains(java, "long wide = Integer.toUnsignedLong(h);"));
+    EXPECT_TRUE(contains(java, "return 0xEE6B2800;"));
+}
+
+TEST(PrimitiveEmissionTest, InsertsNarrowingCastsAndBooleanTests) {
+    std::string java = translate(
+        "int narrow(long x, double y, int flags) {\n"
+        "    int a = x + 1;\n"
+        "    int b = y * 2;\n"
+        "    bool set = flags & 4;\n"
+        "    while (flags) { flags = flags - 1; }\n"
+        "    return set;\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "int a = (int) (x + 1L);"));
+    EXPECT_TRUE(contains(java, "int b = (int) (y * 2);"));
+    EXPECT_TRUE(contains(java, "boolean set = ((flags & 4) != 0);"));
+    EXPECT_TRUE(contains(java, "while (flags != 0) {"));
+    EXPECT_TRUE(contains(java, "return (set ? 1 : 0);"));
+}
+
+TEST(PrimitiveEmissionTest, KeepsCharSignedAndAppendsItAsText) {
+    std::string java = translate(
+        "char shift(char c, int k) { return c + k; }\n"
+        "std::string spell(const std::string& s, char target) {\n"
+        "    char neg = -1;\n"
+        "    int widened = neg;\n"
+        "    char first = s[0];\n"
+        "    char high = '\\xff';\n"
+        "    std::string out = s + first;\n"
+        "    if (s[1] == target) out += shift('a', widened);\n"
+        "    return out;\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "static byte shift(byte c, int k) {\nreturn (byte) (c + k);"));
+    EXPECT_TRUE(contains(java, "byte neg = (byte) (-1);\nint widened = neg;"));
+    EXPECT_TRUE(contains(java, "byte first = (byte) s.charAt(0);"));
+    EXPECT_TRUE(contains(java, "byte high = (byte) '\\u00FF';"));
+    EXPECT_TRUE(contains(java, "StringBuilder out = new StringBuilder(s + (char) (first & 0xFF));"));
+    EXPECT_TRUE(contains(java, "out.append((char) (shift((byte) 'a', widened) & 0xFF));"));
+}
+
+TEST(PrimitiveEmissionTest, NeverEmitsBoxedTypes) {
+    std::string java = translate(
+        "unsigned long long big(unsigned long long a, unsigned int b) { return a / b + a % 10; }\n"
+        "int caller() { int n = 3; return big(n, n); }\n");
+
+    // `Integer`/`Long` may appear only as static helper receivers, never as types
+    EXPECT_FALSE(std::regex_search(java, std::regex("\\b(Integer|Long|Short|Byte|Double|Float|Boolean|Character)\\b(?!\\.)")));
+    EXPECT_TRUE(contains(java, "Long.divideUnsigned(a, Integer.toUnsignedLong(b))"));
+    EXPECT_TRUE(contains(java, "return (int) big(n, n);"));
+}
+
+// ===============================
+// Strings
+// ===============================
+
+TEST(StringTranslationTest, BuildsAppendedLocalsInStringBuilder) {
+    std::string java = translate(
+        "std::string join(int n, std::string sep) {\n"
+        "    std::string out = \"[\";\n"
+        "    int i = 0;\n"
+        "    while (i < n) {\n"
+        "        if (!out.empty()) out += sep;\n"
+        "        out += 48 + i;\n"
+        "        out.push_back('.');\n"
+        "        i = i + 1;\n"
+        "    }\n"
+        "    out.pop_back();\n"
+        "    out = out + \"]\";\n"
+        "    return out;\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "String join(int n, String sep) {"));
+    EXPECT_TRUE(contains(java, "StringBuilder out = new StringBuilder(\"[\");"));
+    EXPECT_TRUE(contains(java, "if (!(out.length() == 0)) {\nout.append(sep);"));
+    EXPECT_TRUE(contains(java, "out.append((char) (48 + i));"));
+    EXPECT_TRUE(contains(java, "out.append('.');"));
+    EXPECT_TRUE(contains(java, "out.setLength(out.length() - 1);"));
+    EXPECT_TRUE(contains(java, "out.replace(0, out.length(), out.toString() + \"]\");"));
+    EXPECT_TRUE(contains(java, "return out.toString();"));
+}
+
+TEST(StringTranslationTest, AppendsMappedToStringArguments) {
+    std::string java = translate(
+        "std::string row(int n, long long big, unsigned int u, double d) {\n"
+        "    std::string s;\n"
+        "    for (int i = 0; i < n; i++) {\n"
+        "        s += std::to_string(i * 2);\n"
+        "        s += std::to_string(big);\n"
+        "        s += std::to_string(u);\n"
+        "        s += std::to_string(d);\n"
+        "    }\n"
+        "    return s;\n"
+        "}\n");
+
+    // Signed integers go to append() as they are; the rest keep their C++ text
+    EXPECT_TRUE(contains(java, "s.append(i * 2);"));
+    EXPECT_TRUE(contains(java, "s.append(big);"));
+    EXPECT_TRUE(contains(java, "s.append(Integer.toUnsignedString(u));"));
+    EXPECT_TRUE(contains(java, "s.append(String.format(java.util.Locale.ROOT, \"%f\", d));"));
+    EXPECT_FALSE(contains(java, "std::"));
+}
+
+TEST(StringTranslationTest, KeepsStringWhenNotAppendedOrUnsupported) {
+    std::string java = translate(
+        "std::string pick(bool a) {\n"
+        "    std::string s = \"x\";\n"
+        "    std::string t = \"y\";\n"
+        "    t += s;\n"
+        "    t.insert(0, s);\n"
+        "    if (a) return s;\n"
+        "    return t;\n"
+        "}\n");
+
+    EXPECT_FALSE(contains(java, "StringBuilder"));
+    EXPECT_TRUE(contains(java, "String s = \"x\";"));
+}
+
+TEST(StringTranslationTest, ComparesContentsWithEquals) {
+    std::string java = translate(
+        "bool same(std::string a, std::string b, const std::string& u) {\n"
+        "    std::string out = \"x\";\n"
+        "    out += a;\n"
+        "    if (a == b) return true;\n"
+        "    if (a != \"lit\") return false;\n"
+        "    if (a == out) return true;\n"
+        "    return a + b == u;\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "if (a.equals(b)) {"));
+    EXPECT_TRUE(contains(java, "if (!a.equals(\"lit\")) {"));
+    EXPECT_TRUE(contains(java, "if (a.contentEquals(out)) {"));  // Without copying the builder
+    EXPECT_TRUE(contains(java, "return (a + b).equals(u);"));
+    EXPECT_FALSE(contains(java, " == "));
+}
+
+TEST(StringTranslationTest, MapsSizeAndEmptyOntoStringMethods) {
+    std::string java = translate(
+        "std::string build(int n) { std::string s = \"ab\"; return s; }\n"
+        "long measure(const std::string& u) {\n"
+        "    if (u.empty()) return 0;\n"
+        "    return u.size() + build(3).size() + u.length();\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "if (u.isEmpty()) {"));
+    EXPECT_TRUE(contains(java, "u.length() + build(3).length() + u.length()"));
+    EXPECT_FALSE(contains(java, ".size()"));
+}
+
+TEST(StringTranslationTest, EscapesLiteralsForJava) {
+    std::string java = translate(
+        "void show() {\n"
+        "    print(\"tab\\there \\\"quoted\\\" back\\\\slash\\n\");\n"
+        "    print(\"bell\\a nul\\0 hex\\x41 caf\\xC3\\xA9 \\u20AC\");\n"
+        "    print('\\'');\n"
+        "    print('\"');\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "print(\"tab\\there \\\"quoted\\\" back\\\\slash\\n\");"));
+    EXPECT_TRUE(contains(java, "print(\"bell\\007 nul\\000 hexA caf\\u00E9 \\u20AC\");"));
+    EXPECT_TRUE(contains(java, "print('\\'');"));
+    EXPECT_TRUE(contains(java, "print('\"');"));
+}
+
+// ===============================
+// Arrays and pointers
+// ===============================
+
+TEST(PointerTranslationTest, EmitsPrimitiveArrays) {
+    std::string java = translate(
+        "int table[4] = {1, 2};\n"
+        "double grid[2][3];\n"
+        "int main() {\n"
+        "    int buf[8];\n"
+        "    char name[16] = \"abc\";\n"
+        "    grid[1][2] = buf[3];\n"
+        "    return table[0] + name[0];\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "int[] table = {1, 2, 0, 0};"));
+    EXPECT_TRUE(contains(java, "double[][] grid = new double[2][3];"));
+    EXPECT_TRUE(contains(java, "int[] buf = new int[8];"));
+    EXPECT_TRUE(contains(java, "byte[] name = java.util.Arrays.copyOf(\"abc\".getBytes(java.nio.charset.StandardCharsets.UTF_8), 16);"));
+    EXPECT_TRUE(contains(java, "grid[1][2] = buf[3];"));
+}
+
+TEST(PointerTranslationTest, CarriesPointersAsArrayAndOffset) {
+    std::string java = translate(
+        "double dot(const double* a, const double* b, int n) {\n"
+        "    double s = 0;\n"
+        "    int i = 0;\n"
+        "    while (i < n) { s += a[i] * b[i]; i++; }\n"
+        "    return s;\n"
+        "}\n"
+        "void fill(int* p, int* end, int v) {\n"
+        "    while (p != end) *p++ = v;\n"
+        "}\n"
+        "int main() {\n"
+        "    int buf[8];\n"
+        "    double xs[] = {1.0, 2.5, 3};\n"
+        "    fill(buf, buf + 8, 7);\n"
+        "    int* q = &buf[2];\n"
+        "    q += 2;\n"
+        "    *(q + 3) = 5;\n"
+        "    long d = (q + 4) - buf;\n"
+        "    q = buf;\n"
+        "    return dot(xs, xs + 1, 2) + q[1] + d;\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "double dot(double[] a, int a$off, double[] b, int b$off, int n) {"));
+    EXPECT_TRUE(contains(java, "s += a[a$off + i] * b[b$off + i];"));
+    EXPECT_TRUE(contains(java, "while (p$off != end$off) {\np[p$off++] = v;"));
+    EXPECT_TRUE(contains(java, "fill(buf, 0, buf, 8, 7);"));
+    EXPECT_TRUE(contains(java, "int[] q = buf;\nint q$off = 2;\nq$off += 2;"));
+    EXPECT_TRUE(contains(java, "q[q$off + 3] = 5;"));
+    EXPECT_TRUE(contains(java, "long d = (q$off + 4);"));
+    EXPECT_TRUE(contains(java, "q = buf;\nq$off = 0;"));
+    EXPECT_TRUE(contains(java, "dot(xs, 0, xs, 1, 2)"));
+    EXPECT_FALSE(contains(java, "ArrayList"));
+    EXPECT_FALSE(contains(java, "Integer"));
+}
+
+TEST(PointerTranslationTest, TailCallOnPointerMovesOnlyTheOffset) {
+    std::string java = translate(
+        "int sum(int* p, int n, int acc) {\n"
+        "    if (n == 0) return acc;\n"
+        "    return sum(p + 1, n - 1, acc + *p);\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "int[] p$next = p;\nint p$next$off = p$off + 1;"));
+    EXPECT_TRUE(contains(java, "int acc$next = acc + p[p$off];"));
+    EXPECT_TRUE(contains(java, "p$off = p$next$off;"));
+}
+
+TEST(PointerTranslationTest, ReturnedPointersKeepTheirOffset) {
+    std::string java = translate(
+        "int* find(int* p, int n, int v) {\n"
+        "    for (int i = 0; i < n; i++) {\n"
+        "        if (p[i] == v) return p + i;\n"
+        "    }\n"
+        "    return nullptr;\n"
+        "}\n"
+        "int* next(int* p) { return find(p + 1, 3, 2); }\n"
+        "int* fresh(int n) { return new int[n]; }\n"
+        "int main() {\n"
+        "    int a[4] = {1, 2, 3, 2};\n"
+        "    int* q = find(a, 4, 2);\n"
+        "    q = next(q);\n"
+        "    int* z = fresh(2);\n"
+        "    return *q + *find(a, 4, 3) + z[0];\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "static int[] find(int[] p, int p$off, int n, int v, int[] result$off) {"));
+    EXPECT_TRUE(contains(java, "result$off[0] = p$off + i;\nreturn p;"));
+    EXPECT_TRUE(contains(java, "result$off[0] = 0;\nreturn null;"));
+    // A returned call hands the caller's holder on
+    EXPECT_TRUE(contains(java, "static int[] next(int[] p, int p$off, int[] result$off) {\nreturn find(p, p$off + 1, 3, 2, result$off);"));
+    EXPECT_TRUE(contains(java, "static int[] fresh(int n) {"));
+    EXPECT_TRUE(contains(java, "final int[] call$off = new int[1];"));
+    EXPECT_TRUE(contains(java, "int[] q = find(a, 0, 4, 2, call$off);\nint q$off = call$off[0];"));
+    EXPECT_TRUE(contains(java, "q = next(q, q$off, call$off);\nq$off = call$off[0];"));
+    EXPECT_TRUE(contains(java, "find(a, 0, 4, 3, call$off)[call$off[0]]"));
+}
+
+TEST(PointerTranslationTest, AddressOfAStructIsSharedAndAScalarIsBoxed) {
+    std::string java = translate(
+        "struct S { int a; };\n"
+        "void f(S* s) { s->a = 1; }\n"
+        "void inc(int* p) { *p += 1; }\n"
+        "int main() {\n"
+        "    S s;\n"
+        "    f(&s);\n"
+        "    int x = 0;\n"
+        "    inc(&x);\n"
+        "    int* q = &*(&x);\n"
+        "    return s.a + x + *q;\n"
+        "}\n");
+
+    // The struct object itself is shared, so `s.a` sees the update; `x` lives in its box
+    EXPECT_TRUE(contains(java, "f(new S[] {s}, 0);"));
+    EXPECT_TRUE(contains(java, "int[] x = {0};\ninc(x, 0);"));
+    EXPECT_TRUE(contains(java, "int[] q = x;\nint q$off = 0;"));
+    EXPECT_TRUE(contains(java, "return s.a + x[0] + q[q$off];"));
+}
+
+TEST(PointerTranslationTest, ReferencesBecomePointersOrAliases) {
+    std::string java = translate(
+        "struct P { int a; };\n"
+        "int total = 0;\n"
+        "void inc(int& x) { x++; }\n"
+        "void add(int* p, int v) { *p += v; }\n"
+        "void setA(P& p) { p.a = 7; }\n"
+        "void reset(P& p) { P q; q.a = 0; p = q; }\n"
+        "int grab(int k) { add(&k, 1); return k; }\n"
+        "int main() {\n"
+        "    int x = 1;\n"
+        "    inc(x);\n"
+        "    int arr[3] = {1, 2, 3};\n"
+        "    inc(arr[1]);\n"
+        "    int& r = arr[2];\n"
+        "    r += 5;\n"
+        "    add(&total, 4);\n"
+        "    P p;\n"
+        "    setA(p);\n"
+        "    reset(p);\n"
+        "    return x + r + total + p.a + grab(3);\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "static void inc(int[] x, int x$off) {\nx[x$off]++;"));
+    EXPECT_TRUE(contains(java, "int[] x = {1};\ninc(x, 0);"));
+    EXPECT_TRUE(contains(java, "inc(arr, 1);"));
+    // A reference to a fixed element is an alias for it
+    EXPECT_TRUE(contains(java, "arr[2] += 5;"));
+    EXPECT_TRUE(contains(java, "static int[] total = {0};"));
+    EXPECT_TRUE(contains(java, "add(total, 0, 4);"));
+    EXPECT_TRUE(contains(java, "int[] k$box = {k};\nadd(k$box, 0, 1);\nreturn k$box[0];"));
+    // A struct is shared as it is, unless the callee replaces it
+    EXPECT_TRUE(contains(java, "static void setA(P p) {"));
+    EXPECT_TRUE(contains(java, "static void reset(P[] p, int p$off) {"));
+    EXPECT_TRUE(contains(java, "return x[0] + arr[2] + total[0] + p[0].a + grab(3);"));
+
+    EXPECT_THROW(translate("struct P { int a; };\nvoid inc(int& x) { x++; }\nvoid f(P p) { inc(p.a); }\n"),
+                 std::runtime_error);
+    EXPECT_THROW(translate("int g[4];\nint& at(int i) { return g[i]; }\n"), std::runtime_error);
+}
+
+TEST(PointerTranslationTest, ByValueStructParametersTheCalleeModifiesAreCopied) {
+    std::string java = translate(
+        "struct P { int a; };\n"
+        "void setA(P* p) { p->a = 1; }\n"
+        "void bump(P p) { p.a = 9; }\n"
+        "void bumpThrough(P p) { setA(&p); }\n"
+        "int read(P p) { return p.a; }\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "static void bump(P p) {\np = p.copy();\np.a = 9;"));
+    EXPECT_TRUE(contains(java, "static void bumpThrough(P p) {\np = p.copy();"));
+    EXPECT_TRUE(contains(java, "static int read(P p) {\nreturn p.a;"));
+}
+
+TEST(PointerTranslationTest, LoopInvariantMotionKeepsLoadsBehindStores) {
+    std::string java = translate(
+        "int first(int* p) { return p[0]; }\n"
+        "int kernel(int* p, int n) {\n"
+        "    int s = 0;\n"
+        "    while (n > 0) {\n"
+        "        p[n] = s;\n"
+        "        s = s + first(p) + *p;\n"
+        "        n = n - 1;\n"
+        "    }\n"
+        "    return s;\n"
+        "}\n", optimized());
+
+    EXPECT_FALSE(contains(java, "inv$"));
+}
+
+// ===============================
+// Primitive container runtime
+// ===============================
+
+TEST(ContainerRuntimeTest, ChoosesSpecialisedClassFromElementTypes) {
+    EXPECT_EQ(RuntimeLibrary::containerClass("std::vector<int>"), "IntVector");
+    EXPECT_EQ(RuntimeLibrary::containerClass("const std::vector<std::uint64_t>"), "LongVector");
+    EXPECT_EQ(RuntimeLibrary::containerClass("std::unordered_map<int, double>"), "IntDoubleMap");
+    EXPECT_EQ(RuntimeLibrary::containerClass("std::unordered_map<long, unsigned int>"), "LongIntMap");
+    EXPECT_EQ(RuntimeLibrary::containerClass("std::unordered_set<long>"), "LongHashSet");
+    EXPECT_EQ(RuntimeLibrary::containerClass("std::vector<std::string>"), "");
+    EXPECT_EQ(RuntimeLibrary::containerClass("std::unordered_map<double, int>"), "");
+    EXPECT_EQ(RuntimeLibrary::containerClass("std::vector<std::vector<int>>"), "");
+
+    std::string map = RuntimeLibrary::source("IntIntMap");
+    EXPECT_TRUE(contains(map, "public final class IntIntMap {"));
+    EXPECT_TRUE(contains(map, "private int[] keys;"));
+    EXPECT_FALSE(contains(map, "${"));
+    EXPECT_TRUE(contains(RuntimeLibrary::source("ByteVector"), "resize(n, (byte) 0);"));
+}
+
+TEST(ContainerRuntimeTest, EmitsVectorsAndMapsWithoutBoxing) {
+    std::string java = translate(
+        "int histogram(const std::vector<int>& data, int n) {\n"
+        "    std::unordered_map<int, int> counts;\n"
+        "    std::vector<long> sums(n, 0);\n"
+        "    std::vector<double> w = {1.5, 2};\n"
+        "    std::unordered_set<long> seen;\n"
+        "    int i = 0;\n"
+        "    while (i < data.size()) {\n"
+        "        counts[data[i]]++;\n"
+        "        counts[i] *= 3;\n"
+        "        sums[i % n] += data[i];\n"
+        "        seen.insert(data[i]);\n"
+        "        i++;\n"
+        "    }\n"
+        "    std::vector<int> copy = data;\n"
+        "    copy.push_back(counts[3]);\n"
+        "    if (seen.count(5) > 0 && !copy.empty()) return copy.back();\n"
+        "    return counts.size();\n"
+        "}\n"
+        "int main() { std::vector<int> v = {1, 2}; return histogram(v, 2); }\n");
+
+    EXPECT_TRUE(contains(java, "int histogram(final IntVector data, int n) {"));
+    EXPECT_TRUE(contains(java, "IntIntMap counts = new IntIntMap();"));
+    EXPECT_TRUE(contains(java, "LongVector sums = new LongVector(n, 0L);"));
+    EXPECT_TRUE(contains(java, "DoubleVector w = DoubleVector.of(1.5, 2);"));
+    EXPECT_TRUE(contains(java, "counts.add(data.data[i], 1);"));
+    EXPECT_TRUE(contains(java, "counts.put(i, counts.get(i) * 3);"));
+    EXPECT_TRUE(contains(java, "sums.data[i % n] += data.data[i];"));
+    EXPECT_TRUE(contains(java, "seen.add(data.data[i]);"));
+    EXPECT_TRUE(contains(java, "IntVector copy = data.copy();"));
+    EXPECT_TRUE(contains(java, "copy.add(counts.get(3));"));
+    EXPECT_TRUE(contains(java, "seen.count(5L) > 0 && !copy.isEmpty()"));
+    EXPECT_FALSE(contains(java, "Integer"));
+    EXPECT_FALSE(contains(java, "std::"));
+}
+
+TEST(ContainerRuntimeTest, TestsCountsAndSizesAgainstZeroInConditions) {
+    testing::internal::CaptureStderr();
+    std::string java = translate(
+        "std::unordered_map<int, int> m;\n"
+        "int drain(std::string s) {\n"
+        "    std::vector<std::vector<int>> rows;\n"
+        "    if (m.count(5)) return 1;\n"
+        "    while (m.size() && s.size()) m.erase(1);\n"
+        "    return 0;\n"
+        "}\n", keepAll());
+    std::string warnings = testing::internal::GetCapturedStderr();
+
+    EXPECT_TRUE(contains(java, "if (m.count(5) != 0) {"));
+    EXPECT_TRUE(contains(java, "while ((m.size() != 0) && (s.length() != 0)) {"));
+    EXPECT_TRUE(contains(warnings, "'std::vector<std::vector<int>>' has no primitive runtime class; emitted unchanged."));
+}
+
+TEST(ContainerRuntimeTest, CopiesByValueContainerParametersTheCalleeModifies) {
+    std::string java = translate(
+        "void fill(std::vector<int>& out, int n) { out.push_back(n); }\n"
+        "int sum(std::vector<int> v) { int s = 0; for (int i = 0; i < v.size(); i++) s += v[i]; return s; }\n"
+        "int grow(std::vector<int> v) { v[0] = 7; return v.size(); }\n"
+        "int viaReference(std::vector<int> v) { fill(v, 3); return v.size(); }\n"
+        "int smallest(std::vector<int> v) { std::sort(v.begin(), v.end()); return v[0]; }\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "static int grow(IntVector v) {\nv = v.copy();"));
+    EXPECT_TRUE(contains(java, "static int viaReference(IntVector v) {\nv = v.copy();"));
+    EXPECT_TRUE(contains(java, "static int smallest(IntVector v) {\nv = v.copy();"));
+    EXPECT_TRUE(contains(java, "static int sum(IntVector v) {\nint s = 0;"));
+    EXPECT_TRUE(contains(java, "static void fill(IntVector out, int n) {\nout.add(n);"));
+}
+
+TEST(ContainerRuntimeTest, LowersRangeBasedForLoops) {
+    std::string java = translate(
+        "int table[4] = {1, 2, 3, 4};\n"
+        "int walk(std::vector<int> v, std::string s, std::unordered_map<int, int> m, std::unordered_set<int> u) {\n"
+        "    int sum = 0;\n"
+        "    for (auto x : v) sum += x;\n"
+        "    for (auto& x : v) x *= 2;\n"
+        "    for (int t : table) sum += t;\n"
+        "    for (char c : s) sum += c;\n"
+        "    for (auto& [k, value] : m) value += k;\n"
+        "    for (const auto& p : m) sum += p.first * p.second;\n"
+        "    for (int e : u) sum += e;\n"
+        "    return sum;\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "x$i++) {\nint x = v.data[x$i];\nsum += x;"));
+    EXPECT_TRUE(contains(java, "for (int x$i = 0; x$i < v.size(); x$i++) {\nv.data[x$i] *= 2;"));
+    EXPECT_TRUE(contains(java, "for (int t$i = 0; t$i < 4; t$i++) {\nint t = table[t$i];"));
+    EXPECT_TRUE(contains(java, "byte c = (byte) s.charAt(c$i);"));
+    EXPECT_TRUE(contains(java, "for (int k$i = 0; k$i < m.slots(); k$i++) {\nif (m.full(k$i)) {\n"
+                               "m.add(m.keyAt(k$i), m.keyAt(k$i));"));
+    EXPECT_TRUE(contains(java, "int p$first = m.keyAt(p$i);\nint p$second = m.valueAt(p$i);\nsum += p$first * p$second;"));
+    EXPECT_TRUE(contains(java, "if (u.full(e$i)) {\nint e = u.keyAt(e$i);"));
+
+    EXPECT_THROW(translate("std::vector<int> make() { std::vector<int> v; return v; }\n"
+                           "int f() { int s = 0; for (int x : make()) s += x; return s; }\n"), std::runtime_error);
+    EXPECT_THROW(translate("int f(std::unordered_map<int, int> m) { int s = 0; for (auto p : m) s += p.size(); return s; }\n"),
+                 std::runtime_error);
+}
+
+TEST(ContainerRuntimeTest, WritesUsedRuntimeClassesNextToOutput) {
+    CodeGenOptions options;
+    options.runtimeDirectory = testing::TempDir();
+    translate("int main() { std::unordered_map<long, long> m; m[1] = 2; return m[1]; }\n", options);
+
+    std::string path = options.runtimeDirectory + "/LongLongMap.java";
+    std::ifstream runtime(path);
+    ASSERT_TRUE(runtime.is_open());
+    std::string firstLine;
+    std::getline(runtime, firstLine);
+    EXPECT_EQ(firstLine, "import java.util.Arrays;");
+    runtime.close();
+    std::remove(path.c_str());
+
+    std::ifstream unused(options.runtimeDirectory + "/IntVector.java");
+    EXPECT_FALSE(unused.is_open());
+}
+
+// ===============================
+// Intrinsic mapping
+// ===============================
+
+TEST(IntrinsicMappingTest, RewritesMemoryAndRangeCallsOntoArrays) {
+    std::string java = translate(
+        "void kernel(int* dst, const int* src, int n, double* d, std::vector<int>& v) {\n"
+        "    memcpy(dst, src, n * sizeof(int));\n"
+        "    std::memmove(dst, src + 1, n);\n"
+        "    memset(dst, 0, n * sizeof(int));\n"
+        "    memset(dst, -1, sizeof(int) * n);\n"
+        "    std::fill(d, d + n, 1);\n"
+        "    std::copy(src, src + n, dst + 1);\n"
+        "    std::sort(dst, dst + n);\n"
+        "    std::sort(v.begin(), v.end());\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "System.arraycopy(src, src$off, dst, dst$off, n);"));
+    EXPECT_TRUE(contains(java, "System.arraycopy(src, src$off + 1, dst, dst$off, n / 4);"));
+    EXPECT_TRUE(contains(java, "java.util.Arrays.fill(dst, dst$off, dst$off + n, 0);"));
+    EXPECT_TRUE(contains(java, "java.util.Arrays.fill(dst, dst$off, dst$off + n, 0xFFFFFFFF);"));
+    EXPECT_TRUE(contains(java, "java.util.Arrays.fill(d, d$off, d$off + n, 1);"));
+    EXPECT_TRUE(contains(java, "System.arraycopy(src, src$off, dst, dst$off + 1, n);"));
+    EXPECT_TRUE(contains(java, "java.util.Arrays.sort(dst, dst$off, dst$off + n);"));
+    EXPECT_TRUE(contains(java, "java.util.Arrays.sort(v.data, 0, v.size());"));
+}
+
+TEST(IntrinsicMappingTest, AdaptsScalarCallsToArgumentTypes) {
+    std::string java = translate(
+        "int sort(int x) { return x; }\n"
+        "int main() {\n"
+        "    int n = 7;\n"
+        "    unsigned int u = 9;\n"
+        "    unsigned long long w = 5;\n"
+        "    int a = std::min(n, 3);\n"
+        "    long c = std::max(n, 3L);\n"
+        "    unsigned int b = std::max(u, 5u);\n"
+        "    int p = __builtin_popcount(u) + __builtin_clz(u) + __builtin_popcountll(w);\n"
+        "    float f = std::sqrt(n);\n"
+        "    return sort(a) + p;\n"
+        "}\n");
+
+    EXPECT_TRUE(contains(java, "int a = Math.min(n, 3);"));
+    EXPECT_TRUE(contains(java, "long c = Math.max(n, 3L);"));
+    EXPECT_TRUE(contains(java, "int b = (Math.max(u ^ Integer.MIN_VALUE, 5 ^ Integer.MIN_VALUE) ^ Integer.MIN_VALUE);"));
+    EXPECT_TRUE(contains(java, "Integer.bitCount(u) + Integer.numberOfLeadingZeros(u) + Long.bitCount(w)"));
+    EXPECT_TRUE(contains(java, "float f = (float) Math.sqrt(n);"));
+    EXPECT_TRUE(contains(java, "return sort(a) + p;"));  // Program functions shadow the table
+}
+
+TEST(IntrinsicMappingTest, FoldsSizeofFromDeclaredTypes) {
+    std::string java = translate(
+        "struct Pair { int x; int y; };\n"
+        "float kernel(int* dst, unsigned* keys, int n, float x, Pair p) {\n"
+        "    int a[16];\n"
+        "    double d[4];\n"
+        "    memset(a, 0, sizeof(a));\n"
+        "    memset(d, 0, sizeof(d));\n"
+        "    memcpy(dst, a, 4 * sizeof(a[0]));\n"
+        "    memset(a, 0, sizeof(p));\n"
+        "    std::sort(keys, keys + n);\n"
+        "    int per = n / sizeof(a);\n"
+        "    return sqrtf(x) + per;\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "java.util.Arrays.fill(a, 0, a.length, 0);"));
+    EXPECT_TRUE(contains(java, "java.util.Arrays.fill(d, 0, d.length, 0);"));
+    EXPECT_TRUE(contains(java, "System.arraycopy(a, 0, dst, dst$off, 4);"));
+    EXPECT_TRUE(contains(java, "memset(a, 0, sizeof(p));"));  // No fixed size for a class
+    EXPECT_TRUE(contains(java, "std::sort(keys, keys + n);"));  // Unsigned order
+    EXPECT_TRUE(contains(java, "int per = n / (a.length * 4);"));
+    EXPECT_TRUE(contains(java, "return (float) Math.sqrt(x) + per;"));
+}
+
+TEST(IntrinsicMappingTest, MapsRoundingLog2AndToStringWithCSemantics) {
+    testing::internal::CaptureStderr();
+    std::string java = translate(
+        "std::string show(int i, double d, unsigned int u, unsigned long long w, bool b) {\n"
+        "    double r = std::round(d) + std::trunc(d) + std::log2(d) + roundf(2.5f);\n"
+        "    std::swap(i, i);\n"
+        "    return std::to_string(i) + std::to_string(r) + std::to_string(u) + std::to_string(w) + std::to_string(b);\n"
+        "}\n", keepAll());
+    std::string warnings = testing::internal::GetCapturedStderr();
+
+    EXPECT_TRUE(contains(java, "double r = CRT.round(d) + CRT.trunc(d) + CRT.log2(d) + (float) CRT.round(2.5f);"));
+    EXPECT_TRUE(contains(java, "String.valueOf(i) + String.format(java.util.Locale.ROOT, \"%f\", r)"));
+    EXPECT_TRUE(contains(java, "Integer.toUnsignedString(u) + Long.toUnsignedString(w) + String.valueOf((b ? 1 : 0))"));
+    EXPECT_TRUE(contains(warnings, "'std::swap' has no Java translation; emitted unchanged."));
+
+    std::string crt = RuntimeLibrary::source("CRT");
+    EXPECT_TRUE(contains(crt, "public static double round(double x) {"));
+    EXPECT_TRUE(contains(crt, "public static double log2(double x) {"));
+}
+
+// ===============================
+// Structure of arrays
+// ===============================
+
+TEST(StructOfArraysTest, SplitsFieldAccessedArraysIntoOneArrayPerField) {
+    std::string java = translate(
+        "struct Particle {\n"
+        "    double x;\n"
+        "    double mass = 1.0;\n"
+        "};\n"
+        "double energy(int n) {\n"
+        "    Particle ps[n];\n"
+        "    std::vector<Particle> vs(n * 2);\n"
+        "    double total = 0;\n"
+        "    int i = 0;\n"
+        "    while (i < n) {\n"
+        "        ps[i].x = i;\n"
+        "        total = total + ps[i].mass * vs[i].x;\n"
+        "        i++;\n"
+        "    }\n"
+        "    return total + vs.size();\n"
+        "}\n", structOfArrays());
+
+    EXPECT_TRUE(contains(java, "static final class Particle {"));
+    EXPECT_TRUE(contains(java, "double[] ps$x = new double[n];"));
+    EXPECT_TRUE(contains(java, "java.util.Arrays.fill(ps$mass, 1.0);"));
+    EXPECT_TRUE(contains(java, "int vs$length = n * 2;"));
+    EXPECT_TRUE(contains(java, "double[] vs$mass = new double[vs$length];"));
+    EXPECT_TRUE(contains(java, "ps$x[i] = i;"));
+    EXPECT_TRUE(contains(java, "total = total + ps$mass[i] * vs$x[i];"));
+    EXPECT_TRUE(contains(java, "return total + vs$x.length;"));
+}
+
+TEST(StructOfArraysTest, KeepsObjectArraysWhenElementsEscape) {
+    std::string java = translate(
+        "struct Point { int a; int b; };\n"
+        "int escapes() {\n"
+        "    Point pts[4];\n"
+        "    Point p = {1, 2};\n"
+        "    pts[0] = p;\n"
+        "    Point* r = &pts[1];\n"
+        "    return pts[0].a + r->b;\n"
+        "}\n", structOfArrays());
+
+    EXPECT_TRUE(contains(java, "java.util.Arrays.setAll(pts, i$ -> new Point());"));
+    EXPECT_TRUE(contains(java, "p.b = 2;"));
+    EXPECT_TRUE(contains(java, "pts[0] = p.copy();"));  // Struct assignment copies
+    EXPECT_TRUE(contains(java, "return pts[0].a + r[r$off].b;"));
+    EXPECT_FALSE(contains(java, "pts$a"));
+}
+
+// ===============================
+// Counted loops
+// ===============================
+
+TEST(CountedLoopTest, EmitsIntInductionVariablesAndHoistedBounds) {
+    std::string java = translate(
+        "long sum(const std::vector<int>& v, int* a, int n) {\n"
+        "    long total = 0;\n"
+        "    for (size_t i = 0; i < v.size(); ++i) total += v[i];\n"
+        "    for (long k = n - 1; k >= 0; --k) total += a[k];\n"
+        "    for (size_t s = 0; 10 > s; s++) total += a[s + 1];\n"
+        "    for (int p = 0, q = n; p < q; p++, q--) total += a[p];\n"
+        "    for (;;) break;\n"
+        "    return total;\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "final int end$0 = v.size();"));
+    EXPECT_TRUE(contains(java, "for (int i = 0; i < end$0; ++i) {"));
+    EXPECT_TRUE(contains(java, "for (int k = n - 1; k >= 0; --k) {"));
+    EXPECT_TRUE(contains(java, "for (int s = 0; s < 10; s++) {"));
+    EXPECT_TRUE(contains(java, "for (int p = 0, q = n; p < q; p++, q--) {"));
+    EXPECT_TRUE(contains(java, "for (;;) {"));
+}
+
+TEST(CountedLoopTest, KeepsWideVariablesAndChangingBounds) {
+    std::string java = translate(
+        "long f(std::vector<int>& v, long n) {\n"
+        "    long total = 0;\n"
+        "    for (size_t i = 0; i < n; ++i) total += i;\n"
+        "    for (long j = 0; j < 100; j++) total += j * j;\n"
+        "    for (int k = 0; k < v.size(); ++k) v.push_back(k);\n"
+        "    return total;\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "for (long i = 0L; Long.compareUnsigned(i, n) < 0; ++i) {"));  // n may exceed an int
+    EXPECT_TRUE(contains(java, "for (long j = 0L; j < 100L; j++) {"));  // j * j would overflow an int
+    EXPECT_TRUE(contains(java, "for (int k = 0; k < v.size(); ++k) {"));  // The loop grows v
+    EXPECT_FALSE(contains(java, "end$"));
+}
+
+// ===============================
+// Switch statements and enums
+// ===============================
+
+TEST(SwitchTest, KeepsIntSwitchesAndFallthrough) {
+    std::string java = translate(
+        "int classify(int x, long long v) {\n"
+        "    int r = 0;\n"
+        "    switch (x) {\n"
+        "        case 0:\n"
+        "        case 1: r = 10; break;\n"
+        "        case 2: r = 20;\n"
+        "        case 3: r += 1; break;\n"
+        "        default: r = -1;\n"
+        "    }\n"
+        "    switch (v) { case 7: return 7; }\n"
+        "    return r;\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "switch (x) {\ncase 0:\ncase 1:\nr = 10;\nbreak;\ncase 2:\nr = 20;\ncase 3:\nr += 1;\nbreak;\ndefault:\nr = -1;\n}"));
+    EXPECT_TRUE(contains(java, "final long sw$0 = v;"));  // Java cannot switch on a long
+    EXPECT_TRUE(contains(java, "switch ((int) sw$0 == sw$0 ? (int) sw$0 : Integer.MIN_VALUE) {"));
+    EXPECT_FALSE(contains(java, "if ("));
+}
+
+TEST(SwitchTest, SwitchesOnEnumValuesAsIntegers) {
+    std::string java = translate(
+        "enum class Color { Red, Green = 4, Blue };\n"
+        "enum Mode : unsigned char { Fast, Slow };\n"
+        "int shade(Color c, Mode m) {\n"
+        "    switch (c) {\n"
+        "        case Color::Red: return 1;\n"
+        "        case Color::Blue: return 2;\n"
+        "    }\n"
+        "    switch (m) { case Slow: return 3; }\n"
+        "    return 0;\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "static final int Color$Red = 0;"));
+    EXPECT_TRUE(contains(java, "static final int Color$Blue = 5;"));
+    EXPECT_TRUE(contains(java, "static final byte Slow = 1;"));
+    EXPECT_TRUE(contains(java, "int shade(int c, byte m) {"));
+    EXPECT_TRUE(contains(java, "switch (c) {\ncase Color$Red:"));
+    EXPECT_TRUE(contains(java, "switch (Byte.toUnsignedInt(m)) {\ncase Slow & 0xFF:"));
+    EXPECT_FALSE(contains(java, "equals"));
+}
+
+TEST(SwitchTest, SwitchesOnLongEnumsThroughIntLabels) {
+    std::string java = translate(
+        "enum class Small : long long { X = 2, Y, Z = 9 };\n"
+        "enum class Big : long long { A, B = 1LL << 40, C, D = -3 };\n"
+        "int pick(Small s, Big b) {\n"
+        "    switch (s) { case Small::Y: return 5; case Small::Z: return 6; }\n"
+        "    switch (b) { case Big::A: return 1; case Big::C: return 2; case Big::D: return 4; default: return 3; }\n"
+        "    return 0;\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "switch ((int) sw$0 == sw$0 ? (int) sw$0 : Integer.MIN_VALUE) {\n"
+                               "case (int) Small$Y:\nreturn 5;\ncase (int) Small$Z:"));
+    EXPECT_TRUE(contains(java, "static final long[] Big$values = {Big$D, Big$A, Big$B, Big$C};"));
+    EXPECT_TRUE(contains(java, "switch (java.util.Arrays.binarySearch(Big$values, b)) {\n"
+                               "case 1:\nreturn 1;\ncase 3:\nreturn 2;\ncase 0:\nreturn 4;\ndefault:"));
+    EXPECT_FALSE(contains(java, "== Big$"));
+    EXPECT_FALSE(contains(java, "Small$values"));
+}
+
+// ===============================
+// C runtime helpers
+// ===============================
+
+TEST(CRuntimeTest, ConvertsUnsignedLongsThroughRuntimeHelpers) {
+    std::string java = translate(
+        "double avg(unsigned long total, unsigned long n) { double t = total; return t / n; }\n"
+        "float half(unsigned long long v) { return v * 0.5f; }\n"
+        "unsigned long toUnsigned(double d) { return d; }\n"
+        "unsigned long long high(unsigned long long a, unsigned long long b) { return __umulh(a, b); }\n"
+        "long long signedHigh(long long a, long long b) { return __mulh(a, b); }\n"
+        "double widen(unsigned int u) { return u; }\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "double t = CRT.unsignedToDouble(total);"));
+    EXPECT_TRUE(contains(java, "return t / CRT.unsignedToDouble(n);"));
+    EXPECT_TRUE(contains(java, "return CRT.unsignedToFloat(v) * 0.5f;"));
+    EXPECT_TRUE(contains(java, "return CRT.doubleToUnsigned(d);"));
+    EXPECT_TRUE(contains(java, "return CRT.multiplyHighUnsigned(a, b);"));
+    EXPECT_TRUE(contains(java, "return Math.multiplyHigh(a, b);"));
+    EXPECT_TRUE(contains(java, "return Integer.toUnsignedLong(u);"));  // One JDK call needs no helper
+
+    std::string crt = RuntimeLibrary::source("CRT");
+    EXPECT_TRUE(contains(crt, "public final class CRT {"));
+    EXPECT_TRUE(contains(crt, "public static long multiplyHighUnsigned(long x, long y) {"));
+}
+
+TEST(CRuntimeTest, UsesRawBitsForTypePunningAndNoHelpersForSignedTypes) {
+    std::string java = translate(
+        "unsigned int bits(float f) { unsigned int b; memcpy(&b, &f, sizeof(b)); return b; }\n"
+        "double fromBits(long long b) { double d; memcpy(&d, &b, 8); return d; }\n"
+        "double plain(long n, int i) { double x = n; return x + i; }\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "b = Float.floatToRawIntBits(f);"));
+    EXPECT_TRUE(contains(java, "d = Double.longBitsToDouble(b);"));
+    EXPECT_TRUE(contains(java, "double x = n;"));
+    EXPECT_FALSE(contains(java, "CRT."));
+}
+
+// ===============================
+// Allocation pooling
+// ===============================
+
+TEST(AllocationPoolingTest, ReusesBuffersAndVectorsAllocatedPerIteration) {
+    std::vector<std::string> report;
+    std::string java = translate(
+        "long work(int* data, int n, int rounds) {\n"
+        "    long total = 0;\n"
+        "    for (int r = 0; r < rounds; ++r) {\n"
+        "        int* tmp = new int[n];\n"
+        "        memcpy(tmp, data, n * sizeof(int));\n"
+        "        total += tmp[0];\n"
+        "        delete[] tmp;\n"
+        "        std::vector<int> acc;\n"
+        "        acc.push_back(r);\n"
+        "        total += acc.size();\n"
+        "    }\n"
+        "    return total;\n"
+        "}\n", keepAll(), &report);
+
+    EXPECT_TRUE(contains(java, "long work(int[] data, int data$off, int n, int rounds) {\nint[] tmp$pool = new int[0];\n"
+                               "IntVector acc$pool = new IntVector();"));
+    EXPECT_TRUE(contains(java, "int[] tmp = (tmp$pool.length >= n ? tmp$pool : (tmp$pool = new int[n]));"));
+    EXPECT_TRUE(contains(java, "acc$pool.clear();\nIntVector acc = acc$pool;"));
+    ASSERT_EQ(report.size(), 2u);
+    EXPECT_EQ(report[0], "Pooled 'new int[]' for 'tmp' in 'work': one buffer 'tmp$pool' reused across iterations");
+    EXPECT_EQ(report[1], "Pooled 'std::vector<int> acc' in 'work': cleared into 'acc$pool' each iteration");
+}
+
+TEST(AllocationPoolingTest, UsesFreeListsOutsideLoopsAndKeepsEscapingAllocations) {
+    std::vector<std::string> report;
+    std::string java = translate(
+        "std::vector<int> keep;\n"
+        "double once(int n) {\n"
+        "    double* buf = new double[n];\n"
+        "    buf[0] = 1.5;\n"
+        "    double v = buf[0];\n"
+        "    delete[] buf;\n"
+        "    return v;\n"
+        "}\n"
+        "int* leak(int n) { int* p = new int[n]; return p; }\n"
+        "void fill(int n) {\n"
+        "    while (n-- > 0) { std::vector<int> v; v.push_back(n); keep = v; }\n"
+        "}\n", keepAll(), &report);
+
+    EXPECT_TRUE(contains(java, "double[] buf = DoubleArrayPool.take(n);"));
+    EXPECT_TRUE(contains(java, "DoubleArrayPool.give(buf);"));
+    EXPECT_TRUE(contains(java, "int[] p = new int[n];"));
+    EXPECT_TRUE(contains(java, "IntVector v = new IntVector();"));
+    ASSERT_EQ(report.size(), 3u);
+    EXPECT_EQ(report[0], "Pooled 'new double[]' for 'buf' in 'once': per-thread free list");
+    EXPECT_EQ(report[1], "Kept 'new int[]' for 'p' in 'leak': not freed by one delete[] in the same block");
+    EXPECT_EQ(report[2], "Kept 'std::vector<int> v' in 'fill': the vector escapes");
+
+    std::string pool = RuntimeLibrary::source("DoubleArrayPool");
+    EXPECT_TRUE(contains(pool, "public static double[] take(int n) {"));
+}
+
+// ===============================
+// Threads and parallel loops
+// ===============================
+
+TEST(ParallelTest, SplitsOpenMpLoopsWithPerTaskPartialReductions) {
+    std::string java = translate(
+        "#include <omp.h>\n"
+        "long dot(int* a, int* b, int n) {\n"
+        "    long sum = 0;\n"
+        "    int scale = 1;\n"
+        "    scale = scale * 2;\n"
+        "    #pragma omp parallel for reduction(+:sum) schedule(static)\n"
+        "    for (int i = 0; i < n; ++i) {\n"
+        "        sum += a[i] * b[i] * scale;\n"
+        "    }\n"
+        "    return sum;\n"
+        "}\n"
+        "void fill(int* out, int n) {\n"
+        "    int last = 0;\n"
+        "    #pragma omp parallel for\n"
+        "    for (int i = 0; i < n; ++i) out[i] = i;\n"
+        "    #pragma omp parallel for\n"
+        "    for (int i = 0; i < n; ++i) { last = i; }\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "final int scale$final = scale;\n"
+                               "final long sum$total = Parallel.reduceLong(0, n, 0L, (lo$0, hi$0) -> {\n"
+                               "long sum$part = 0L;\n"
+                               "for (int i = lo$0; i < hi$0; ++i) {\n"
+                               "sum$part += a[a$off + i] * b[b$off + i] * scale$final;\n"
+                               "}\n"
+                               "return sum$part;\n"
+                               "}, Long::sum);\n"
+                               "sum += sum$total;"));
+    // Chunk bounds are numbered per function
+    EXPECT_TRUE(contains(java, "Parallel.forRange(0, n, (lo$0, hi$0) -> {\nfor (int i = lo$0; i < hi$0; ++i) {\n"
+                               "out[out$off + i] = i;\n}\n});"));
+    // A write to a shared local races in C++ as well; the loop stays serial
+    EXPECT_TRUE(contains(java, "for (int i = 0; i < n; ++i) {\nlast = i;\n}"));
+
+    std::string parallel = RuntimeLibrary::source("Parallel");
+    EXPECT_TRUE(contains(parallel, "public static long reduceLong(int from, int to, long identity, LongRange body"));
+}
+
+TEST(ParallelTest, RunsThreadsAndAsyncCallsOnTheSharedExecutor) {
+    std::string java = translate(
+        "int work(int x, int y) { return x * y; }\n"
+        "void log(int x) { }\n"
+        "long run() {\n"
+        "    int k = 3;\n"
+        "    k = k + 1;\n"
+        "    std::thread t(log, k);\n"
+        "    std::future<long> f = std::async(std::launch::async, work, k, 5);\n"
+        "    auto g = std::async(work, 2, 3);\n"
+        "    t.join();\n"
+        "    return f.get() + g.get();\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "final int t$arg0 = k;\n"
+                               "java.util.concurrent.Future<?> t = Parallel.start(() -> log(t$arg0));"));
+    EXPECT_TRUE(contains(java, "java.util.concurrent.CompletableFuture<Long> f = "
+                               "java.util.concurrent.CompletableFuture.supplyAsync(() -> (long) work(f$arg0, 5), "
+                               "Parallel.EXECUTOR);"));
+    EXPECT_TRUE(contains(java, "java.util.concurrent.CompletableFuture<Integer> g = "
+                               "java.util.concurrent.CompletableFuture.supplyAsync(() -> work(2, 3), Parallel.EXECUTOR);"));
+    EXPECT_TRUE(contains(java, "Parallel.join(t);"));
+    EXPECT_TRUE(contains(java, "return f.join() + g.join();"));
+}
+
+// ===============================
+// Atomics and locks
+// ===============================
+
+TEST(ConcurrencyTest, MapsMemoryOrdersToTheWeakestVarHandleMode) {
+    std::string java = translate(
+        "std::atomic<int> hits(0);\n"
+        "std::atomic<bool> ready;\n"
+        "int run(int k) {\n"
+        "    hits.fetch_add(k, std::memory_order_relaxed);\n"
+        "    hits++;\n"
+        "    hits -= 2;\n"
+        "    ready.store(true, std::memory_order_release);\n"
+        "    int expected = 2;\n"
+        "    bool swapped = hits.compare_exchange_strong(expected, 7, std::memory_order_acquire);\n"
+        "    if (ready.load(std::memory_order_acquire)) return hits;\n"
+        "    return hits.load(std::memory_order_relaxed);\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "IntAtomic hits = new IntAtomic(0);"));
+    EXPECT_TRUE(contains(java, "BooleanAtomic ready = new BooleanAtomic(false);"));
+    EXPECT_TRUE(contains(java, "hits.getAndAddAcquire(k);\nhits.getAndAdd(1);\nhits.addAndGet(-2);"));
+    EXPECT_TRUE(contains(java, "ready.setRelease(true);"));
+    EXPECT_TRUE(contains(java, "boolean swapped = (expected == (expected = hits.compareAndExchangeAcquire(expected, 7)));"));
+    EXPECT_TRUE(contains(java, "if (ready.getAcquire()) {\nreturn hits.get();\n}"));
+    EXPECT_TRUE(contains(java, "return hits.getOpaque();"));
+    EXPECT_FALSE(contains(java, "synchronized"));
+
+    std::string atomic = RuntimeLibrary::source("IntAtomic");
+    EXPECT_TRUE(contains(atomic, "private volatile int value;"));
+    EXPECT_TRUE(contains(atomic, "return (int) VALUE.getAndAddRelease(this, delta);"));
+}
+
+TEST(ConcurrencyTest, CompareExchangeAsAStatementOnlyUpdatesExpected) {
+    std::string java = translate(
+        "std::atomic<int> counter(0);\n"
+        "int bump() {\n"
+        "    int expected = 0;\n"
+        "    counter.compare_exchange_strong(expected, 3);\n"
+        "    counter.compare_exchange_weak(expected, 4, std::memory_order_release, std::memory_order_relaxed);\n"
+        "    counter.compare_exchange_strong(expected, 5, std::memory_order_release, std::memory_order_acquire);\n"
+        "    for (int i = 0; i < 2; counter.compare_exchange_weak(expected, i)) ++i;\n"
+        "    return expected;\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "expected = counter.compareAndExchange(expected, 3);"));
+    EXPECT_TRUE(contains(java, "expected = counter.compareAndExchangeRelease(expected, 4);"));
+    EXPECT_TRUE(contains(java, "expected = counter.compareAndExchange(expected, 5);"));
+    EXPECT_TRUE(contains(java, "; expected = counter.compareAndExchange(expected, i)) {"));
+    EXPECT_FALSE(contains(java, "(expected == (expected ="));
+}
+
+TEST(ConcurrencyTest, ReleasesLockGuardsInFinallyOnEveryExit) {
+    std::string java = translate(
+        "std::mutex m;\n"
+        "int total = 0;\n"
+        "int add(int v) {\n"
+        "    std::lock_guard<std::mutex> guard(m);\n"
+        "    total += v;\n"
+        "    if (total > 100) return total;\n"
+        "    return 0;\n"
+        "}\n"
+        "void reset() {\n"
+        "    std::unique_lock<std::mutex> lock(m);\n"
+        "    total = 0;\n"
+        "    lock.unlock();\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "java.util.concurrent.locks.ReentrantLock m = new java.util.concurrent.locks.ReentrantLock();"));
+    EXPECT_TRUE(contains(java, "m.lock();\ntry {\ntotal += v;\nif (total > 100) {\nreturn total;\n}\nreturn 0;\n"
+                               "} finally {\nm.unlock();\n}"));
+    EXPECT_TRUE(contains(java, "m.lock();\ntry {\ntotal = 0;\nm.unlock();\n"
+                               "} finally {\nif (m.isHeldByCurrentThread()) m.unlock();\n}"));
+}
+
+// ===============================
+// Method splitting
+// ===============================
+
+TEST(MethodSplittingTest, SplitsHugeFunctionsIntoTailCalledPrivateParts) {
+    CodeGenOptions options = keepAll();
+    options.methodSizeLimit = 60;
+    std::vector<std::string> report;
+    std::string java = translate(
+        "int total = 0;\n"
+        "void accumulate(int n, int* data) {\n"
+        "    int sum = 0;\n"
+        "    long scale = 3;\n"
+        "    sum += data[0] * n;\n"
+        "    sum += data[1] * n;\n"
+        "    total += sum;\n"
+        "    sum += data[2] * n;\n"
+        "    sum += data[3] * n;\n"
+        "    total += sum * scale;\n"
+        "    if (sum > n) return;\n"
+        "    total += n;\n"
+        "}\n", options, &report);
+
+    EXPECT_TRUE(contains(java, "sum += data[data$off + 1] * n;\naccumulate$part1(n, data, data$off, sum, scale);\n}\n"
+                               "private static void accumulate$part1(int n, int[] data, int data$off, int sum, long scale) {\n"
+                               "total += sum;"));
+    // Only what the last part still reads is passed on
+    EXPECT_TRUE(contains(java, "accumulate$part2(n, sum, scale);\n}\n"
+                               "private static void accumulate$part2(int n, int sum, long scale) {\n"
+                               "total += sum * scale;\nif (sum > n) {\nreturn;\n}\ntotal += n;\n}"));
+    ASSERT_EQ(report.size(), 1u);
+    EXPECT_EQ(report[0], "Split 'accumulate' (~117 bytes of bytecode) into accumulate (~38), "
+                         "accumulate$part1 (~41), accumulate$part2 (~37)");
+}
+
+TEST(MethodSplittingTest, KeepsFunctionsWhoseLiveLocalsCannotBePassed) {
+    CodeGenOptions options = keepAll();
+    options.methodSizeLimit = 30;
+    std::vector<std::string> report;
+    std::string java = translate(
+        "std::string render(int n) {\n"
+        "    std::string out;\n"
+        "    out += \"a\";\n"
+        "    out += \"b\";\n"
+        "    out += \"c\";\n"
+        "    out += \"d\";\n"
+        "    return out;\n"
+        "}\n"
+        "int twice(int n) { return n * 2; }\n", options, &report);
+
+    // A StringBuilder local is only a String at its reads
+    EXPECT_FALSE(contains(java, "render$part1"));
+    ASSERT_EQ(report.size(), 1u);
+    EXPECT_EQ(report[0].rfind("Kept 'render' (~", 0), 0u);
+
+    std::unordered_set<std::string> locals = {"x"};
+    auto increment = std::make_shared<BinaryExpressionNode>(
+        std::make_shared<IdentifierNode>("x"), "+=", std::make_shared<NumberNode>(1));
+    EXPECT_EQ(MethodSplitting::estimateBytecodeSize(increment, locals), 7);
+}
+
+// ===============================
+// Static and final members
+// ===============================
+
+TEST(ModifierTest, EmitsStaticMembersOfAFinalClass) {
+    std::string java = translate(
+        "static int counter = 0;\n"
+        "const int LIMIT = 10;\n"
+        "static int bump(int k) { counter += k; return counter; }\n"
+        "inline int twice(int k) { return k * 2; }\n"
+        "int main() { return bump(twice(LIMIT)); }\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "public final class Main {"));
+    EXPECT_TRUE(contains(java, "private static int counter = 0;\nstatic final int LIMIT = 10;"));
+    EXPECT_TRUE(contains(java, "private static int bump(int k) {"));
+    EXPECT_TRUE(contains(java, "static int twice(int k) {"));
+    EXPECT_TRUE(contains(java, "static int main() {\nreturn bump(twice(LIMIT));"));
+    EXPECT_FALSE(contains(java, "private static int twice"));
+}
+
+TEST(ModifierTest, FinishesGlobalInitialisationInStaticBlocks) {
+    std::string java = translate(
+        "struct Point { int x; int y; };\n"
+        "Point origin = {1, 2};\n"
+        "Point pts[3];\n"
+        "int main() { return origin.x + pts[0].y; }\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "static Point origin = new Point();\nstatic {\norigin.x = 1;\norigin.y = 2;\n}"));
+    EXPECT_TRUE(contains(java, "static Point[] pts = new Point[3];\nstatic {\n"
+                               "java.util.Arrays.setAll(pts, i$ -> new Point());\n}"));
+    // Struct fields stay instance fields
+    EXPECT_TRUE(contains(java, "static final class Point {\nint x;\nint y;"));
+    EXPECT_THROW(translate("int next() { static int n = 0; return ++n; }\n"), std::runtime_error);
+}
+
+// ===============================
+// Constant tables as resources
+// ===============================
+
+TEST(ResourceTableTest, WritesLargeConstantTablesBigEndianBesideTheClass) {
+    CodeGenOptions options = keepAll();
+    options.resourceThreshold = 4;
+    options.runtimeDirectory = testing::TempDir();
+    std::string java = translate(
+        "const uint32_t table[6] = {0x01020304u, 0xFFFFFFFFu, 7, -2};\n"
+        "const short deltas[] = {1, -1, 'A', 0x7FFF};\n"
+        "int small[3] = {1, 2, 3};\n", options);
+
+    EXPECT_TRUE(contains(java, "static final int[] table = Resources.ints(Main.class, \"Main$table.bin\", 6);"));
+    EXPECT_TRUE(contains(java, "static final short[] deltas = Resources.shorts(Main.class, \"Main$deltas.bin\", 4);"));
+    EXPECT_TRUE(contains(java, "static int[] small = {1, 2, 3};"));
+
+    std::ifstream file(testing::TempDir() + "Main$table.bin", std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(bytes, std::string("\x01\x02\x03\x04\xFF\xFF\xFF\xFF\x00\x00\x00\x07\xFF\xFF\xFF\xFE", 16));
+    std::ifstream shorts(testing::TempDir() + "Main$deltas.bin", std::ios::binary);
+    std::string shortBytes((std::istreambuf_iterator<char>(shorts)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(shortBytes, std::string("\x00\x01\xFF\xFF\x00\x41\x7F\xFF", 8));
+    for (const char* name : {"Main$table.bin", "Main$deltas.bin", "Resources.java"}) {
+        std::remove((testing::TempDir() + name).c_str());
+    }
+}
+
+TEST(ResourceTableTest, KeepsComputedAndLocalTablesInline) {
+    CodeGenOptions options = keepAll();
+    options.resourceThreshold = 2;
+    std::string java = translate(
+        "int n = 4;\n"
+        "int computed[3] = {1, n, 3};\n"
+        "int sum() {\n"
+        "    int local[3] = {4, 5, 6};\n"
+        "    return local[0] + computed[1];\n"
+        "}\n", options);
+
+    EXPECT_TRUE(contains(java, "static int[] computed = {1, n, 3};"));
+    EXPECT_TRUE(contains(java, "int[] local = {4, 5, 6};"));
+    EXPECT_FALSE(contains(java, "Resources."));
+
+    std::string resources = RuntimeLibrary::source("Resources");
+    EXPECT_TRUE(contains(resources, "java.nio.ByteBuffer.wrap(in.readAllBytes())"));
+    EXPECT_TRUE(contains(resources, "public static double[] doubles(Class<?> owner, String name, int length)"));
+}
+
+// ===============================
+// Template monomorphisation
+// ===============================
+
+TEST(TemplateTest, SpecialisesStructsOncePerArgumentList) {
+    std::vector<std::string> report;
+    std::string java = translate(
+        "template <typename T, int N>\n"
+        "struct RingBuffer {\n"
+        "    T data[N];\n"
+        "    int head = 0;\n"
+        "};\n"
+        "RingBuffer<int, 16> events;\n"
+        "double peek(RingBuffer<double, 8>* samples) { return samples->data[samples->head]; }\n"
+        "int main() {\n"
+        "    RingBuffer<int, 16> local;\n"
+        "    RingBuffer<double, 8>* samples = new RingBuffer<double, 8>;\n"
+        "    return events.data[0] + local.head + peek(samples);\n"
+        "}\n", keepAll(), &report);
+
+    EXPECT_TRUE(contains(java, "static final class RingBuffer_int_16 {\nint[] data = new int[16];\nint head = 0;"));
+    EXPECT_TRUE(contains(java, "static final class RingBuffer_double_8 {\ndouble[] data = new double[8];"));
+    EXPECT_TRUE(contains(java, "static RingBuffer_int_16 events = new RingBuffer_int_16();"));
+    EXPECT_TRUE(contains(java, "RingBuffer_int_16 local = new RingBuffer_int_16();"));
+    EXPECT_FALSE(contains(java, "RingBuffer<"));
+    // Each argument list is instantiated once, however often it is named
+    ASSERT_EQ(report.size(), 2u);
+    EXPECT_EQ(report[0], "Instantiated RingBuffer<int, 16> as RingBuffer_int_16");
+    EXPECT_EQ(report[1], "Instantiated RingBuffer<double, 8> as RingBuffer_double_8");
+}
+
+TEST(TemplateTest, DeducesFunctionArgumentsOrTakesThemExplicitly) {
+    std::vector<std::string> report;
+    std::string java = translate(
+        "template <typename T>\n"
+        "T maxOf(T a, T b) {\n"
+        "    if (a > b) return a;\n"
+        "    return b;\n"
+        "}\n"
+        "template <typename T>\n"
+        "int width(const T* values) { return sizeof(T); }\n"
+        "int main() {\n"
+        "    double xs[4];\n"
+        "    int a = maxOf(3, 4);\n"
+        "    long b = maxOf<long>(a, 7);\n"
+        "    return maxOf(a, 5) + b + width(xs) + maxOf(1.5, 0.5);\n"
+        "}\n", keepAll(), &report);
+
+    EXPECT_TRUE(contains(java, "static int maxOf_int(int a, int b) {"));
+    EXPECT_TRUE(contains(java, "static long maxOf_long(long a, long b) {"));
+    EXPECT_TRUE(contains(java, "static int width_double(double[] values, int values$off) {\nreturn 8;"));
+    EXPECT_TRUE(contains(java, "int a = maxOf_int(3, 4);\nlong b = maxOf_long(a, 7L);"));
+    EXPECT_EQ(report.size(), 4u);
+
+    EXPECT_EQ(Monomorphization::mangledName("Pair", {"std::string", "Box<unsigned int*>"}),
+              "Pair_string_Box_unsigned_int_ptr");
+    EXPECT_THROW(translate("template <typename T> T zero() { return 0; }\nint main() { return zero(); }\n"),
+                 std::runtime_error);
+}
+
+TEST(TemplateTest, DeducesFromFieldsOfStructsInstantiatedInTheBody) {
+    std::string java = translate(
+        "template <typename T, int N>\n"
+        "struct RingBuffer {\n"
+        "    T data[N];\n"
+        "    T count;\n"
+        "};\n"
+        "template <typename T>\n"
+        "T maxOf(T a, T b) {\n"
+        "    if (a > b) return a;\n"
+        "    return b;\n"
+        "}\n"
+        "int main() {\n"
+        "    RingBuffer<long, 8> a;\n"
+        "    RingBuffer<long, 8> c;\n"
+        "    auto top = maxOf(a.count, c.count);\n"
+        "    return maxOf(top, 2L);\n"
+        "}\n", keepAll());
+
+    EXPECT_TRUE(contains(java, "static long maxOf_long(long a, long b) {"));
+    EXPECT_TRUE(contains(java, "long top = maxOf_long(a.count, c.count);"));
+    EXPECT_TRUE(contains(java, "return (int) maxOf_long(top, 2L);"));
+}
+
+// ===============================
+// Vector API loops
+// ===============================
+
+TEST(VectorizeTest, EmitsLaneKernelsWithScalarTailsBehindAFallback) {
+    CodeGenOptions options = keepAll();
+    options.vectorize = true;
+    std::string java = translate(
+        "void saxpy(int n, float a, const float* x, float* y) {\n"
+        "    for (int i = 0; i < n; i++) y[i] = a * x[i] + y[i];\n"
+        "}\n"
+        "double dot(const double* x, const double* y, int n) {\n"
+        "    double sum = 0.0;\n"
+        "    for (int i = 0; i < n; ++i) sum += x[i] * y[i];\n"
+        "    return sum;\n"
+        "}\n", options);
+
+    // The scalar loop runs when the module is missing or the pointers overlap at different offsets
+    EXPECT_TRUE(contains(java, "if (VectorSupport.ENABLED && (y != x || y$off == x$off)) {\n"
+                               "Vectorized.saxpy$loop0(0, n, y, y$off, a, x, x$off);\n"
+                               "} else {\nfor (int i = 0; i < n; i++) {\n"));
+    EXPECT_TRUE(contains(java, "static void saxpy$loop0(int lo$, int hi$, float[] y, int y$off, float a, float[] x, int x$off) {\n"
+                               "int i = lo$;\n"
+                               "for (int upper$ = lo$ + FLOATS.loopBound(hi$ - lo$); i < upper$; i += FLOATS.length()) {\n"
+                               "jdk.incubator.vector.FloatVector.fromArray(FLOATS, x, x$off + i).mul(a)"
+                               ".add(jdk.incubator.vector.FloatVector.fromArray(FLOATS, y, y$off + i)).intoArray(y, y$off + i);\n"
+                               "}\nfor (; i < hi$; i++) {\ny[y$off + i] = a * x[x$off + i] + y[y$off + i];\n}\n}"));
+    // A reduction accumulates lanes, then adds the tail to their sum
+    EXPECT_TRUE(contains(java, "if (VectorSupport.ENABLED) {\nsum += Vectorized.dot$loop0(0, n, x, x$off, y, y$off);"));
+    EXPECT_TRUE(contains(java, "sum$lanes = sum$lanes.add(jdk.incubator.vector.DoubleVector.fromArray(DOUBLES, x, x$off + i)"
+                               ".mul(jdk.incubator.vector.DoubleVector.fromArray(DOUBLES, y, y$off + i)));\n}\n"
+                               "double sum = sum$lanes.reduceLanes(jdk.incubator.vector.VectorOperators.ADD);\n"
+                               "for (; i < hi$; ++i) {\nsum += x[x$off + i] * y[y$off + i];\n}\nreturn sum;"));
+    EXPECT_TRUE(contains(java, "static final class Vectorized {\n"
+                               "private static final jdk.incubator.vector.VectorSpecies<Float> FLOATS = "
+                               "jdk.incubator.vector.FloatVector.SPECIES_PREFERRED;"));
+    EXPECT_TRUE(contains(RuntimeLibrary::source("VectorSupport"),
+                         "ENABLED = ModuleLayer.boot().findModule(\"jdk.incubator.vector\").isPresent();"));
+
+    // Opt-in only
+    EXPECT_FALSE(contains(translate("void scale(int n, double* v) { for (int i = 0; i < n; i++) v[i] *= 2.0; }\n",
+                                    keepAll()), "Vectorized"));
+}
+
+TEST(VectorizeTest, KeepsDependentAndWideningLoopsScalar) {
+    CodeGenOptions options = keepAll();
+    options.vectorize = true;
+    std::string java = translate(
+        "double grid[64];\n"
+        "void transform(int n, float* a, const float* x, int* k) {\n"
+        "    for (int i = 1; i < n; i++) a[i] = a[i - 1] + x[i];\n"
+        "    for (int i = 0; i < n; i++) a[i] = x[i] * 0.5;\n"
+        "    for (int i = 0; i < n; i++) k[i] = k[i] * 2;\n"
+        "    for (int i = 0; i < n; i++) { a[i] = x[i] * 2; if (a[i] > 1) break; }\n"
+        "    for (int i = 0; i < 64; i++) grid[i] = 2.0 - std::sqrt(grid[i]) / n;\n"
+        "}\n", options);
+
+    // Loop-carried, computed in double, int elements, leaves early: all stay as they were
+    EXPECT_TRUE(contains(java, "static void transform(int n, float[] a, int a$off, float[] x, int x$off, int[] k, int k$off) {\n"
+                               "for (int i = 1; i < n; i++) {"));
+    EXPECT_TRUE(contains(java, "a[a$off + i] = (float) (x[x$off + i] * 0.5);\n}\nfor (int i = 0; i < n; i++) {\n"
+                               "k[k$off + i] = k[k$off + i] * 2;\n}\nfor (int i = 0; i < n; i++) {\na[a$off + i] = x[x$off + i] * 2;"));
+    // An invariant left operand of `-` is broadcast; int operands convert like C++ does
+    EXPECT_TRUE(contains(java, "if (VectorSupport.ENABLED) {\nVectorized.transform$loop0(0, 64, grid, n);"));
+    EXPECT_TRUE(contains(java, "jdk.incubator.vector.DoubleVector.broadcast(DOUBLES, 2.0).sub(jdk.incubator.vector.DoubleVector"
+                               ".fromArray(DOUBLES, grid, i).lanewise(jdk.incubator.vector.VectorOperators.SQRT).div(n))"
+                               ".intoArray(grid, i);"));
+}
+
+// ===============================
+// Benchmark harnesses
+// ===============================
+
+TEST(BenchmarkTest, WritesJmhAndGoogleBenchmarkHarnessesFromCallSiteLiterals) {
+    std::string source =
+        "// @benchmark\n"
+        "void saxpy(int n, float a, const float* x, float* y) {\n"
+        "    for (int i = 0; i < n; i++) y[i] = a * x[i] + y[i];\n"
+        "}\n"
+        "int unmarked(int n) { return n; }\n"
+        "int main() {\n"
+        "    float* x = new float[1000];\n"
+        "    saxpy(1000, 2.0f, x, x);\n"
+        "    saxpy(50, -1.5f, x, x);\n"
+        "    return unmarked(3);\n"
+        "}\n";
+    Lexer lexer(source);
+    Parser parser(lexer.tokenize());
+    std::vector<BenchmarkGenerator::Harness> harnesses;
+    std::vector<std::string> report = BenchmarkGenerator::generate(parser.parse(), "Kernels", "src/kernels.cpp", "", harnesses);
+
+    ASSERT_EQ(harnesses.size(), 2u);
+    EXPECT_EQ(harnesses[0].fileName, "KernelsSaxpyBenchmark.java");
+    const std::string& java = harnesses[0].source;
+    // The values of one call site are run together, as by Google Benchmark
+    EXPECT_TRUE(contains(java, "public class KernelsSaxpyBenchmark {\n"
+                               "    // The parameter sets BM_saxpy is registered with, in the same order\n"
+                               "    private static final int[] n$sets = {1000, 50};\n"
+                               "    private static final float[] a$sets = {2.0f, -1.5f};\n\n"
+                               "    @Param({\"0\", \"1\"})\n    public int parameterSet;\n\n"
+                               "    private int n;\n    private float a;\n    private float[] x;\n    private float[] y;\n"));
+    // Arrays are as long as the first integer parameter
+    EXPECT_TRUE(contains(java, "        n = n$sets[parameterSet];\n        a = a$sets[parameterSet];\n"
+                               "        x = new float[n];\n"
+                               "        for (int i = 0; i < x.length; i++) x[i] = (float) (i % 17 + 1);\n"));
+    EXPECT_TRUE(contains(java, "    @Benchmark\n    public void saxpy() {\n        Kernels.saxpy(n, a, x, 0, y, 0);\n    }\n"));
+
+    EXPECT_EQ(harnesses[1].fileName, "KernelsBenchmark.cpp");
+    const std::string& cpp = harnesses[1].source;
+    EXPECT_TRUE(contains(cpp, "#define main cpp2java_original_main\n#include \"kernels.cpp\"\n#undef main\n"));
+    EXPECT_TRUE(contains(cpp, "static void BM_saxpy(benchmark::State& state, int n, float a) {\n"
+                              "    std::vector<float> x(n);\n"));
+    EXPECT_TRUE(contains(cpp, "        saxpy(n, a, x.data(), y.data());\n        benchmark::ClobberMemory();\n"));
+    EXPECT_TRUE(contains(cpp, "BENCHMARK_CAPTURE(BM_saxpy, n:1000/a:2.0, 1000, 2.0);\n"
+                              "BENCHMARK_CAPTURE(BM_saxpy, n:50/a:-1.5, 50, -1.5);\n\nBENCHMARK_MAIN();"));
+    EXPECT_FALSE(contains(cpp, "unmarked"));
+    ASSERT_EQ(report.size(), 1u);
+    EXPECT_EQ(report[0], "Benchmark KernelsSaxpyBenchmark: saxpy with 2 parameter set(s)");
+}
+
+TEST(BenchmarkTest, TakesSidecarParametersAndSkipsWhatItCannotCall) {
+    std::string source =
+        "[[cpp2java::benchmark]] double dot(const double* x, const double* y, long n) {\n"
+        "    double sum = 0.0;\n"
+        "    for (long i = 0; i < n; i++) sum += x[i] * y[i];\n"
+        "    return sum;\n"
+        "}\n"
+        "[[benchmark]] static int twice(int n) { return 2 * n; }\n"
+        "// @benchmark\n"
+        "int count(std::vector<int> v) { return v.size(); }\n"
+        "[[nodiscard]] int main() { double d[8]; return dot(d, d, 8) > 0; }\n";
+    Lexer lexer(source);
+    Parser parser(lexer.tokenize());
+    ASTNodePtr program = parser.parse();
+    std::vector<BenchmarkGenerator::Harness> harnesses;
+    std::vector<std::string> report = BenchmarkGenerator::generate(
+        program, "Kernels", "kernels.cpp", "# function  parameter=values\ndot n=4096,65536 y[]=512\n", harnesses);
+
+    ASSERT_EQ(harnesses.size(), 2u);
+    const std::string& java = harnesses[0].source;
+    EXPECT_TRUE(contains(java, "    private static final long[] n$sets = {4096L, 65536L};\n"));
+    EXPECT_TRUE(contains(java, "    @Param({\"0\", \"1\"})\n    public int parameterSet;\n"));
+    EXPECT_TRUE(contains(java, "        x = new double[(int) n];\n"));
+    EXPECT_TRUE(contains(java, "        y = new double[512];\n"));
+    EXPECT_TRUE(contains(java, "    public void dot(Blackhole bh) {\n        bh.consume(Kernels.dot(x, 0, y, 0, n));\n"));
+    EXPECT_TRUE(contains(harnesses[1].source, "        benchmark::DoNotOptimize(dot(x.data(), y.data(), n));\n"));
+    EXPECT_TRUE(contains(harnesses[1].source, "BENCHMARK_CAPTURE(BM_dot, n:65536, 65536);\n"));
+    EXPECT_EQ(report, (std::vector<std::string>{
+        "Benchmark KernelsDotBenchmark: dot with 2 parameter set(s)",
+        "Benchmark skipped: twice is static, so its translation is private",
+        "Benchmark skipped: count cannot be called with made-up arguments, its parameter 'v' is a std::vector<int>"}));
+
+    EXPECT_THROW(BenchmarkGenerator::generate(program, "Kernels", "kernels.cpp", "dot q=1\n", harnesses),
+                 std::runtime_error);
+
+    // Marked functions are roots for dead code elimination
+    CodeGenOptions options;
+    options.emitBenchmarks = true;
+    std::vector<std::string> translated;
+    std::string output = translate("// @benchmark\nint square(int n) { return n * n; }\n"
+                                   "// @benchmark\nint cube(int n) { return n * n * n; }\n"
+                                   "int unused() { return 0; }\nint main() { return 0; }\n", options, &translated);
+    EXPECT_TRUE(contains(output, "static int square(int n) {"));
+    EXPECT_FALSE(contains(output, "unused"));
+    EXPECT_EQ(translated[translated.size() - 2], "Benchmark skipped: square has no literal argument or sidecar value for 'n'");
+    options.benchmarkParameters = "square n=7\ncube n=3";
+    translate("// @benchmark\nint square(int n) { return n * n; }\nint main() { return 0; }\n", options, &translated);
+    EXPECT_EQ(translated.back(), "Benchmark MainSquareBenchmark: square with 1 parameter set(s)");
+}
+
+// ===============================
+// Profile-guided translation
+// ===============================
+
+TEST(HotnessProfileTest, ReadsPerfGprofAndCsvProfiles) {
+    auto perf = HotnessProfile::parse(
+        "# Overhead  Command  Shared Object  Symbol\n"
+        "    61.50%    70.00%  app  app        [.] kernels::saxpy(int, float, float const*, float*)\n"
+        "     2.25%     3.00%  app  app        [.] double maxOf<double>(double, double) [clone .isra.0]\n"
+        "     1.00%     1.00%  app  libc.so.6  [.] __memset_avx2\n");
+    EXPECT_EQ(perf.size(), 3u);
+    EXPECT_DOUBLE_EQ(perf["saxpy"], 70.0);
+    EXPECT_DOUBLE_EQ(perf["maxOf_double"], 3.0);
+
+    auto gprof = HotnessProfile::parse(
+        "Flat profile:\n\n"
+        "  %   cumulative   self              self     total\n"
+        " time   seconds   seconds    calls  ms/call  ms/call  name\n"
+        " 80.00      0.08     0.08     1000     0.08     0.08  dot(double const*, double const*, int)\n"
+        " 15.00      0.09     0.01                             main\n"
+        "  5.00      0.10     0.01       10     0.10     0.10  reset.part.0\n");
+    EXPECT_EQ(gprof.size(), 3u);
+    EXPECT_DOUBLE_EQ(gprof["dot"], 80.0);
+    EXPECT_DOUBLE_EQ(gprof["main"], 15.0);
+    EXPECT_DOUBLE_EQ(gprof["reset"], 5.0);
+
+    auto csv = HotnessProfile::parse("function,weight\nsaxpy,1200\nhelper, 30\nsaxpy,300\n");
+    EXPECT_EQ(csv.size(), 2u);
+    EXPECT_DOUBLE_EQ(csv["saxpy"], 1500.0);
+    EXPECT_DOUBLE_EQ(csv["helper"], 30.0);
+}
+
+TEST(HotnessProfileTest, ColdFunctionsSkipTheOptimizationPasses) {
+    std::string source =
+        "double scale(double v) { return v * 2.0; }\n"
+        "void hot(int n, double* a) { for (int i = 0; i < n; i++) a[i] = scale(a[i]) * (n * 3.0); }\n"
+        "void cold(int n, double* a) { for (int i = 0; i < n; i++) a[i] = a[i] * (n * 3.0); }\n"
+        "int main() { double a[8]; hot(8, a); cold(8, a); return 0; }\n";
+    CodeGenOptions options = optimized();
+    options.profile = "hot,95\ncold,4\nmain,1\n";
+    std::vector<std::string> report;
+    std::string java = translate(source, options, &report);
+
+    // The heaviest functions covering 90% of the time are hot, with the unlisted functions they call
+    EXPECT_EQ(report, (std::vector<std::string>{"Hot: scale (called from hot code, not in the profile)",
+                                                "Hot: hot (95.0% of the profiled time)",
+                                                "Cold: cold (4.0% of the profiled time)",
+                                                "Cold: main (1.0% of the profiled time)"}));
+    EXPECT_TRUE(contains(java, "static void hot(int n, double[] a, int a$off) {\nfinal double inv$0 = n * 3.0;"));
+    EXPECT_TRUE(contains(java, "static void cold(int n, double[] a, int a$off) {\nfor (int i = 0; i < n; i++) {\n"
+                               "a[a$off + i] = a[a$off + i] * (n * 3.0);"));
+    // Without a profile every function is hot
+    EXPECT_TRUE(contains(translate(source, optimized()), "static void cold(int n, double[] a, int a$off) {\nfinal double"));
+
+    // Cold functions are split only near javac's limit
+    std::string body;
+    for (int i = 0; i < 400; i++) body += "    total += values[" + std::to_string(i % 16) + "] * " + std::to_string(i) + ";\n";
+    std::string large = "long values[16];\nlong sum() {\n    long total = 0;\n" + body + "    return total;\n}\n"
+                        "int main() { return sum() > 0; }\n";
+    options.methodSizeLimit = 1000;
+    options.profile = "main,1\nsum,0\n";
+    EXPECT_FALSE(contains(translate(large, options), "sum$part1"));
+    options.profile = "sum,1\n";
+    EXPECT_TRUE(contains(translate(large, options), "sum$part1"));
+}
+
+// ===============================
+// Output writer
+// ===============================
+
+TEST(OutputWriterTest, WritesInBlocksAcrossTheBufferSize) {
+    std::string path = testing::TempDir() + "output_writer_blocks.java";
+    std::string expected;
+    {
+        OutputWriter writer(path);
+        for (int i = 0; i < 100000; i++) {
+            std::string line = "x[x$off + " + std::to_string(i) + "] = " + std::to_string(i) + ";";
+            writer.write(line);
+            expected += line + "\n";
+        }
+        // Longer than the whole buffer
+        std::string longLine(3 << 20, 'a');
+        writer.write(longLine);
+        writer.write("}");
+        expected += longLine + "\n}\n";
+        EXPECT_THROW(writer.getContents(), std::runtime_error);
+    }
+    std::ifstream file(path, std::ios::binary);
+    std::string written((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(written.size(), expected.size());
+    EXPECT_TRUE(written == expected);
+    std::remove(path.c_str());
+}
+
+TEST(OutputWriterTest, KeepsContentsOnlyWhenAskedAndRejectsWritesAfterClose) {
+    std::string path = testing::TempDir() + "output_writer_contents.java";
+    OutputWriter writer(path, true);
+    writer.write("public final class Main {");
+    writer.write("}");
+    EXPECT_EQ(writer.getContents(), "public final class Main {\n}\n");
+    EXPECT_TRUE(writer.isOpen());
+    writer.close();
+    EXPECT_FALSE(writer.isOpen());
+    EXPECT_THROW(writer.write("static int x;"), std::runtime_error);
+
+    std::ifstream file(path);
+    std::string written((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(written, "public final class Main {\n}\n");
+    std::remove(path.c_str());
+}
+
+TEST(OutputWriterTest, AppendsPiecesAndTracksIndentation) {
+    std::string path = testing::TempDir() + "output_writer_pieces.java";
+    OutputWriter writer(path, true);
+    writer.setIndentUnit("  ");
+    writer.writeLine("static double f(int n) {");
+    writer.append("final double x = ", 0.1, " * ", 3000000000LL);
+    writer.writeLine(';');
+    writer.writeLine("switch (n) {");
+    writer.writeLine("case ", 1, ':');
+    writer.indent();
+    writer.writeLine("return ", 1e300, ';');
+    writer.dedent();
+    writer.writeLine('}');
+    writer.writeLine("");
+    writer.writeLine("} else {");
+    writer.writeLine("return ", -2.5f, ';');
+    writer.write("}");
+    EXPECT_EQ(writer.getContents(), "static double f(int n) {\n"
+                                    "  final double x = 0.1 * 3000000000;\n"
+                                    "  switch (n) {\n"
+                                    "    case 1:\n"
+                                    "      return 1e+300;\n"
+                                    "  }\n"
+                                    "\n"
+                                    "} else {\n"
+                                    "  return -2.5;\n"
+                                    "}\n");
+    writer.close();
+    std::remove(path.c_str());
+}
+
+TEST(OutputWriterTest, EmitterOutputIsIndentedWhenAskedFor) {
+    Lexer lexer("int classify(int x) {\n"
+                "    int r = 0;\n"
+                "    switch (x) {\n"
+                "        case 1: r = 10; break;\n"
+                "        default: if (x > 5) { r = x * 2; }\n"
+                "    }\n"
+                "    return r;\n"
+                "}\n");
+    Parser parser(lexer.tokenize());
+    ASTNodePtr ast = parser.parse();
+    std::string path = testing::TempDir() + "output_writer_indented.java";
+    OutputWriter writer(path, true);
+    writer.setIndentUnit("    ");
+    JavaEmitter emitter(writer);
+    CodeGenerator generator(emitter, keepAll());
+    generator.generateCode(ast);
+    EXPECT_EQ(writer.getContents(), "public final class Main {\n"
+                                    "    static int classify(int x) {\n"
+                                    "        int r = 0;\n"
+                                    "        switch (x) {\n"
+                                    "            case 1:\n"
+                                    "                r = 10;\n"
+                                    "                break;\n"
+                                    "            default:\n"
+                                    "                if (x > 5) {\n"
+                                    "                    r = x * 2;\n"
+                                    "                }\n"
+                                    "        }\n"
+                                    "        return r;\n"
+                                    "    }\n"
+                                    "}\n");
+    writer.close();
+    std::remove(path.c_str());
+}
+
+// ===============================
+// Parallel code generation
+// ===============================
+
+TEST(ParallelCodegenTest, OutputIsByteIdenticalToSerialGeneration) {
+    const std::string source =
+        "#include <omp.h>\n"
+        "const int weights[6] = {1, 2, 3, 4, 5, 6};\n"
+        "enum class Color { Red, Green = 4, Blue };\n"
+        "void saxpy(int n, float a, const float* x, float* y) {\n"
+        "    for (int i = 0; i < n; i++) y[i] = a * x[i] + y[i];\n"
+        "}\n"
+        "long total = 0;\n"
+        "int classify(long long v, Color c) {\n"
+        "    switch (v) { case 7: return 7; }\n"
+        "    switch (c) { case Color::Blue: return 2; }\n"
+        "    return weights[0];\n"
+        "}\n"
+        "struct Point { int x; int y; };\n"
+        "long sum(const std::vector<int>& v, Point p) {\n"
+        "    long s = p.x;\n"
+        "    #pragma omp parallel for reduction(+:s)\n"
+        "    for (int i = 0; i < 100; ++i) s += i;\n"
+        "    for (int i = 0; i < v.size(); i++) total += v[i];\n"
+        "    return s;\n"
+        "}\n"
+        "double dot(const double* x, const double* y, int n) {\n"
+        "    double d = 0.0;\n"
+        "    for (int i = 0; i < n; ++i) d += x[i] * y[i];\n"
+        "    return d;\n"
+        "}\n"
+        "void saxpy(int n, float a, float* y) {\n"
+        "    for (int i = 0; i < n; i++) y[i] = a * y[i];\n"
+        "}\n";
+
+    // Indented, as the command line writes it, so that fragments must also start at the right depth
+    auto generate = [&](unsigned threads, std::set<std::string>& runtimeClasses, std::vector<std::string>& resources) {
+        Lexer lexer(source);
+        Parser parser(lexer.tokenize());
+        ASTNodePtr ast = parser.parse();
+        CodeGenOptions options = keepAll();
+        options.vectorize = true;
+        options.resourceThreshold = 4;
+        options.codegenThreads = threads;
+        std::string path = testing::TempDir() + "parallel_codegen_" + std::to_string(threads) + ".java";
+        std::string java;
+        {
+            OutputWriter writer(path, true);
+            writer.setIndentUnit("    ");
+            JavaEmitter emitter(writer);
+            CodeGenerator generator(emitter, options);
+            generator.generateCode(ast);
+            java = writer.getContents();
+            runtimeClasses = emitter.usedRuntimeClasses();
+            for (const auto& resource : emitter.resourceFiles()) resources.push_back(resource.first);
+        }
+        std::remove(path.c_str());
+        return java;
+    };
+
+    std::set<std::string> serialClasses, parallelClasses;
+    std::vector<std::string> serialResources, parallelResources;
+    std::string serial = generate(1, serialClasses, serialResources);
+    std::string parallel = generate(4, parallelClasses, parallelResources);
+    EXPECT_EQ(parallel, serial);
+    EXPECT_EQ(parallelClasses, serialClasses);
+    EXPECT_EQ(parallelResources, serialResources);
+
+    // Generated names are numbered per function, and kernels follow their functions
+    EXPECT_TRUE(contains(serial, "        final long sw$0 = v;\n"));
+    EXPECT_TRUE(contains(serial, "(lo$0, hi$0) -> {"));
+    size_t saxpyKernel = serial.find("static void saxpy$loop0(");
+    size_t dotKernel = serial.find("static double dot$loop0(");
+    ASSERT_NE(saxpyKernel, std::string::npos);
+    ASSERT_NE(dotKernel, std::string::npos);
+    EXPECT_LT(saxpyKernel, dotKernel);
+    // An overload's kernels are numbered apart from those of the first function of the name
+    EXPECT_TRUE(contains(serial, "Vectorized.saxpy$1$loop0(0, n, y, y$off, a);"));
+    EXPECT_TRUE(contains(serial, "static void saxpy$1$loop0("));
+    EXPECT_TRUE(contains(serial, "    }\n    static long total = 0L;\n    static int classify("));
+    EXPECT_EQ(serialClasses, (std::set<std::string>{"IntVector", "Parallel", "Resources", "VectorSupport"}));
+}
+
+TEST(ParallelCodegenTest, PoolRunsEveryTaskAndRethrowsTheFirstFailure) {
+    std::vector<int> runs(64, 0);
+    std::vector<std::function<void()>> tasks;
+    for (size_t i = 0; i < runs.size(); i++) {
+        tasks.push_back([&runs, i] {
+            runs[i]++;
+            if (i == 9 || i == 40) throw std::runtime_error("task " + std::to_string(i));
+        });
+    }
+    WorkStealingPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+    try {
+        pool.run(tasks);
+        FAIL() << "Expected the failure of task 9";
+    } catch (const std::runtime_error& e) {
+        EXPECT_STREQ(e.what(), "task 9");
+    }
+    EXPECT_EQ(runs, std::vector<int>(64, 1));
+
+    pool.run({});
+    EXPECT_GE(WorkStealingPool().size(), 1u);
+}